@@ -168,10 +168,12 @@ DEFINE_SAFE_EQUALITY(LineColumnInfo)
 DEFINE_SAFE_EQUALITY(ShaderCompileFlag)
 DEFINE_SAFE_EQUALITY(ShaderConstant)
 DEFINE_SAFE_EQUALITY(ShaderDebugState)
+DEFINE_SAFE_EQUALITY(ShaderDebugStateDelta)
 DEFINE_SAFE_EQUALITY(ShaderResource)
 DEFINE_SAFE_EQUALITY(ShaderSampler)
 DEFINE_SAFE_EQUALITY(ShaderSourceFile)
 DEFINE_SAFE_EQUALITY(ShaderVariable)
+DEFINE_SAFE_EQUALITY(ShaderVariableChange)
 DEFINE_SAFE_EQUALITY(RegisterRange)
 DEFINE_SAFE_EQUALITY(LocalVariableMapping)
 DEFINE_SAFE_EQUALITY(SigParameter)
@@ -96,6 +96,31 @@
 }
 %typemap(freearg) rdcarray<rdcstr> *supportedProtocols { }
 
+// same for RENDERDOC_CalcTextureMinMax and RENDERDOC_CalcTextureHistogram
+%typemap(in, numinputs=0) rdcpair<PixelValue, PixelValue> *minmax {
+  $1 = new rdcpair<PixelValue, PixelValue>;
+}
+%typemap(argout) rdcpair<PixelValue, PixelValue> *minmax {
+  $result = ConvertToPy(*$1);
+  delete $1;
+}
+%typemap(freearg) rdcpair<PixelValue, PixelValue> *minmax { }
+
+%typemap(in, numinputs=0) rdcarray<uint32_t> *histogram { $1 = new rdcarray<uint32_t>; }
+%typemap(argout) rdcarray<uint32_t> *histogram {
+  $result = ConvertToPy(*$1);
+  delete $1;
+}
+%typemap(freearg) rdcarray<uint32_t> *histogram { }
+
+// same for RENDERDOC_DecodeMeshVertices
+%typemap(in, numinputs=0) rdcarray<FloatVector> *positions { $1 = new rdcarray<FloatVector>; }
+%typemap(argout) rdcarray<FloatVector> *positions {
+  $result = ConvertToPy(*$1);
+  delete $1;
+}
+%typemap(freearg) rdcarray<FloatVector> *positions { }
+
 // same for RENDERDOC_CreateRemoteServerConnection
 %typemap(in, numinputs=0) IRemoteServer **rend (IRemoteServer *outRenderer) {
   outRenderer = NULL;
@@ -259,6 +284,26 @@ Invalid if the object is not actually a string.
   PyObject *AsString() { return ConvertToPy($self->data.str); }
 }
 
+// traces used to store every state in full as a 'states' list. Keep that working for existing
+// scripts as a read-only property, reconstructed when it's accessed
+%immutable ShaderDebugTrace::states;
+
+%extend ShaderDebugTrace {
+  %feature("docstring") R"(The full state after each step, as a list of :class:`ShaderDebugState`.
+
+.. deprecated::
+  This is reconstructed with :meth:`GetAllStates` on every access. Use :meth:`GetState` instead.
+)";
+  PyObject *states;
+}
+
+%{
+PyObject *ShaderDebugTrace_states_get(ShaderDebugTrace *trace)
+{
+  return ConvertToPy(trace->GetAllStates());
+}
+%}
+
 // add python array members that aren't in slots
 EXTEND_ARRAY_CLASS_METHODS(rdcarray)
 EXTEND_ARRAY_CLASS_METHODS(StructuredChunkList)
@@ -287,16 +332,19 @@ TEMPLATE_ARRAY_INSTANTIATE(rdcarray, EnvironmentModification)
 TEMPLATE_ARRAY_INSTANTIATE(rdcarray, EventUsage)
 TEMPLATE_ARRAY_INSTANTIATE(rdcarray, PathEntry)
 TEMPLATE_ARRAY_INSTANTIATE(rdcarray, PixelModification)
+TEMPLATE_ARRAY_INSTANTIATE(rdcarray, PixelValue)
 TEMPLATE_ARRAY_INSTANTIATE(rdcarray, ResourceDescription)
 TEMPLATE_ARRAY_INSTANTIATE(rdcarray, ResourceId)
 TEMPLATE_ARRAY_INSTANTIATE(rdcarray, LineColumnInfo)
 TEMPLATE_ARRAY_INSTANTIATE(rdcarray, ShaderCompileFlag)
 TEMPLATE_ARRAY_INSTANTIATE(rdcarray, ShaderConstant)
 TEMPLATE_ARRAY_INSTANTIATE(rdcarray, ShaderDebugState)
+TEMPLATE_ARRAY_INSTANTIATE(rdcarray, ShaderDebugStateDelta)
 TEMPLATE_ARRAY_INSTANTIATE(rdcarray, ShaderResource)
 TEMPLATE_ARRAY_INSTANTIATE(rdcarray, ShaderSampler)
 TEMPLATE_ARRAY_INSTANTIATE(rdcarray, ShaderSourceFile)
 TEMPLATE_ARRAY_INSTANTIATE(rdcarray, ShaderVariable)
+TEMPLATE_ARRAY_INSTANTIATE(rdcarray, ShaderVariableChange)
 TEMPLATE_ARRAY_INSTANTIATE(rdcarray, ShaderEncoding)
 TEMPLATE_ARRAY_INSTANTIATE(rdcarray, RegisterRange)
 TEMPLATE_ARRAY_INSTANTIATE(rdcarray, LocalVariableMapping)
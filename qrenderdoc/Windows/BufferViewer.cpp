@@ -2488,6 +2488,46 @@ void BufferViewer::calcBoundingData(CalcBoundingBoxData &bbox)
 
     CacheDataForIteration(cache, s.columns, s.props, s.buffers, bbox.input[0].curInstance);
 
+    // decode each column with plain per-vertex data in one batch, which is much faster than going
+    // through QVariants for every element below
+    QVector<rdcarray<FloatVector>> decoded(s.columns.count());
+
+    for(int col = 0; col < s.columns.count(); col++)
+    {
+      const CachedElData &d = cache[col];
+      const ResourceFormat &fmt = d.prop->format;
+
+      if(!d.data || d.prop->perinstance || d.el->type.descriptor.rows > 1 ||
+         fmt.type != ResourceFormatType::Regular || fmt.compByteWidth > 4)
+        continue;
+
+      if(fmt.compType != CompType::Float && fmt.compType != CompType::UNorm &&
+         fmt.compType != CompType::SNorm && fmt.compType != CompType::UInt &&
+         fmt.compType != CompType::SInt)
+        continue;
+
+      MeshFormat mesh;
+      mesh.format = fmt;
+      mesh.vertexByteOffset = d.el->byteOffset;
+      mesh.vertexByteStride = (uint32_t)d.stride;
+
+      bytebuf noIndices;
+      const bytebuf *indices = &noIndices;
+
+      if(s.indices && s.indices->hasData())
+      {
+        mesh.indexByteStride = sizeof(uint32_t);
+        mesh.numIndices = s.numRows;
+        mesh.baseVertex = s.baseVertex;
+        mesh.allowRestart = s.primRestart != 0;
+        mesh.restartIndex = s.primRestart;
+        indices = &s.indices->storage;
+      }
+
+      RENDERDOC_DecodeMeshVertices(mesh, *indices, s.buffers[d.prop->buffer]->storage, 0,
+                                   s.numRows, &decoded[col]);
+    }
+
     // possible optimisation here if this shows up as a hot spot - sort and unique the indices and
     // iterate in ascending order, to be more cache friendly
 
@@ -2512,7 +2552,24 @@ void BufferViewer::calcBoundingData(CalcBoundingBoxData &bbox)
         float *minOut = (float *)&minOutputList[col];
         float *maxOut = (float *)&maxOutputList[col];
 
-        if(d.data)
+        if(!decoded[col].isEmpty())
+        {
+          // vertices that run off the end of the data are skipped, the same as below
+          if(d.data + d.stride * idx + d.byteSize > d.end)
+            continue;
+
+          const float *vals = &decoded[col][row].x;
+
+          for(int comp = 0; comp < 4 && comp < (int)prop->format.compCount; comp++)
+          {
+            if(qIsFinite(vals[comp]))
+            {
+              minOut[comp] = qMin(minOut[comp], vals[comp]);
+              maxOut[comp] = qMax(maxOut[comp], vals[comp]);
+            }
+          }
+        }
+        else if(d.data)
         {
           const byte *bytes = d.data;
 
@@ -3681,7 +3738,7 @@ void BufferViewer::debugVertex()
     trace = r->DebugVertex(vertid, m_Config.curInstance, index, m_Ctx.CurDrawcall()->instanceOffset,
                            m_Ctx.CurDrawcall()->vertexOffset);
 
-    if(trace->states.isEmpty())
+    if(trace->steps.isEmpty())
     {
       r->FreeTrace(trace);
       trace = NULL;
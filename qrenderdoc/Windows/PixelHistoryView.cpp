@@ -701,7 +701,7 @@ void PixelHistoryView::startDebug(EventTag tag)
     trace = r->DebugPixel((uint32_t)m_Pixel.x(), (uint32_t)m_Pixel.y(),
                           m_Display.subresource.sample, tag.primitive);
 
-    if(trace->states.isEmpty())
+    if(trace->steps.isEmpty())
     {
       r->FreeTrace(trace);
       trace = NULL;
@@ -1305,16 +1305,16 @@ bool ShaderViewer::stepBack()
 
   if(isSourceDebugging())
   {
-    const ShaderDebugState &oldstate = m_Trace->states[CurrentStep()];
+    const ShaderDebugStateDelta &oldstate = m_Trace->steps[CurrentStep()];
 
     LineColumnInfo oldLine =
         m_Trace->lineInfo[qMin(m_Trace->lineInfo.size() - 1, (size_t)oldstate.nextInstruction)];
 
-    while(CurrentStep() < m_Trace->states.count())
+    while(CurrentStep() < m_Trace->steps.count())
     {
       m_CurrentStep--;
 
-      const ShaderDebugState &state = m_Trace->states[m_CurrentStep];
+      const ShaderDebugStateDelta &state = m_Trace->steps[m_CurrentStep];
 
       if(m_Breakpoints.contains((int)state.nextInstruction))
         break;
@@ -1343,25 +1343,25 @@ bool ShaderViewer::stepNext()
   if(!m_Trace)
     return false;
 
-  if(CurrentStep() + 1 >= m_Trace->states.count())
+  if(CurrentStep() + 1 >= m_Trace->steps.count())
     return false;
 
   if(isSourceDebugging())
   {
-    const ShaderDebugState &oldstate = m_Trace->states[CurrentStep()];
+    const ShaderDebugStateDelta &oldstate = m_Trace->steps[CurrentStep()];
 
     LineColumnInfo oldLine = m_Trace->lineInfo[oldstate.nextInstruction];
 
-    while(CurrentStep() < m_Trace->states.count())
+    while(CurrentStep() < m_Trace->steps.count())
     {
       m_CurrentStep++;
 
-      const ShaderDebugState &state = m_Trace->states[m_CurrentStep];
+      const ShaderDebugStateDelta &state = m_Trace->steps[m_CurrentStep];
 
       if(m_Breakpoints.contains((int)state.nextInstruction))
         break;
 
-      if(m_CurrentStep + 1 >= m_Trace->states.count())
+      if(m_CurrentStep + 1 >= m_Trace->steps.count())
         break;
 
       if(m_Trace->lineInfo[state.nextInstruction] == oldLine)
@@ -1478,21 +1478,21 @@ void ShaderViewer::runTo(QVector<size_t> runToInstruction, bool forward, ShaderE
 
   bool firstStep = true;
 
-  while(step < m_Trace->states.count())
+  while(step < m_Trace->steps.count())
   {
-    if(runToInstruction.contains(m_Trace->states[step].nextInstruction))
+    if(runToInstruction.contains(m_Trace->steps[step].nextInstruction))
       break;
 
-    if(!firstStep && (step + inc >= 0) && (step + inc < m_Trace->states.count()) &&
-       (m_Trace->states[step + inc].flags & condition))
+    if(!firstStep && (step + inc >= 0) && (step + inc < m_Trace->steps.count()) &&
+       (m_Trace->steps[step + inc].flags & condition))
       break;
 
-    if(!firstStep && m_Breakpoints.contains((int)m_Trace->states[step].nextInstruction))
+    if(!firstStep && m_Breakpoints.contains((int)m_Trace->steps[step].nextInstruction))
       break;
 
     firstStep = false;
 
-    if(step + inc < 0 || step + inc >= m_Trace->states.count())
+    if(step + inc < 0 || step + inc >= m_Trace->steps.count())
       break;
 
     step += inc;
@@ -1729,7 +1729,7 @@ RDTreeWidgetItem *ShaderViewer::findLocal(RDTreeWidgetItem *root, QString name)
 
 void ShaderViewer::updateDebugging()
 {
-  if(!m_Trace || m_CurrentStep < 0 || m_CurrentStep >= m_Trace->states.count())
+  if(!m_Trace || m_CurrentStep < 0 || m_CurrentStep >= m_Trace->steps.count())
     return;
 
   if(ui->debugToggle->isEnabled())
@@ -1740,12 +1740,12 @@ void ShaderViewer::updateDebugging()
       ui->debugToggle->setText(tr("Debug in HLSL"));
   }
 
-  const ShaderDebugState &state = m_Trace->states[m_CurrentStep];
+  const ShaderDebugState &state = GetCurrentState();
 
   uint32_t nextInst = state.nextInstruction;
   bool done = false;
 
-  if(m_CurrentStep == m_Trace->states.count() - 1)
+  if(m_CurrentStep == m_Trace->steps.count() - 1)
   {
     nextInst--;
     done = true;
@@ -2430,9 +2430,20 @@ void ShaderViewer::updateDebugging()
   updateVariableTooltip();
 }
 
+const ShaderDebugState &ShaderViewer::GetCurrentState()
+{
+  if(m_CurrentStateStep != m_CurrentStep)
+  {
+    m_CurrentState = m_Trace->GetState(m_CurrentStep);
+    m_CurrentStateStep = m_CurrentStep;
+  }
+
+  return m_CurrentState;
+}
+
 const ShaderVariable *ShaderViewer::GetRegisterVariable(const RegisterRange &r)
 {
-  const ShaderDebugState &state = m_Trace->states[m_CurrentStep];
+  const ShaderDebugState &state = GetCurrentState();
 
   const ShaderVariable *var = NULL;
   switch(r.type)
@@ -2475,8 +2486,8 @@ int ShaderViewer::CurrentStep()
 
 void ShaderViewer::SetCurrentStep(int step)
 {
-  if(m_Trace && !m_Trace->states.empty())
-    m_CurrentStep = qBound(0, step, m_Trace->states.count() - 1);
+  if(m_Trace && !m_Trace->steps.empty())
+    m_CurrentStep = qBound(0, step, m_Trace->steps.count() - 1);
   else
     m_CurrentStep = 0;
 
@@ -3080,7 +3091,7 @@ bool ShaderViewer::eventFilter(QObject *watched, QEvent *event)
 void ShaderViewer::disasm_tooltipShow(int x, int y)
 {
   // do nothing if there's no trace
-  if(!m_Trace || m_CurrentStep < 0 || m_CurrentStep >= m_Trace->states.count())
+  if(!m_Trace || m_CurrentStep < 0 || m_CurrentStep >= m_Trace->steps.count())
     return;
 
   ScintillaEdit *sc = qobject_cast<ScintillaEdit *>(QObject::sender());
@@ -3164,10 +3175,10 @@ const rdcarray<ShaderVariable> *ShaderViewer::GetVariableList(VariableCategory v
 {
   const rdcarray<ShaderVariable> *vars = NULL;
 
-  if(!m_Trace || m_CurrentStep < 0 || m_CurrentStep >= m_Trace->states.count())
+  if(!m_Trace || m_CurrentStep < 0 || m_CurrentStep >= m_Trace->steps.count())
     return vars;
 
-  const ShaderDebugState &state = m_Trace->states[m_CurrentStep];
+  const ShaderDebugState &state = GetCurrentState();
 
   arrayIdx = qMax(0, arrayIdx);
 
@@ -3223,10 +3234,10 @@ void ShaderViewer::getRegisterFromWord(const QString &text, VariableCategory &va
 
 void ShaderViewer::updateVariableTooltip()
 {
-  if(!m_Trace || m_CurrentStep < 0 || m_CurrentStep >= m_Trace->states.count())
+  if(!m_Trace || m_CurrentStep < 0 || m_CurrentStep >= m_Trace->steps.count())
     return;
 
-  const ShaderDebugState &state = m_Trace->states[m_CurrentStep];
+  const ShaderDebugState &state = GetCurrentState();
 
   if(m_TooltipVarCat == VariableCategory::ByString)
   {
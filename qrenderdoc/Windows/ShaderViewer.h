@@ -235,6 +235,9 @@ private:
 
   ShaderDebugTrace *m_Trace = NULL;
   int m_CurrentStep;
+  // the trace only stores changes between steps, so cache the full state at the current step
+  ShaderDebugState m_CurrentState;
+  int m_CurrentStateStep = -1;
   QList<int> m_Breakpoints;
 
   static const int CURRENT_MARKER = 0;
@@ -265,6 +268,7 @@ private:
   void updateDebugging();
 
   const ShaderVariable *GetRegisterVariable(const RegisterRange &r);
+  const ShaderDebugState &GetCurrentState();
 
   void ensureLineScrolled(ScintillaEdit *s, int i);
 
@@ -5,3 +5,22 @@
 
 #define TINYEXR_IMPLEMENTATION
 #include "tinyexr.h"
+
+// PIZ compresses one block of scanlines, stored as they are in the file, for writers that lay out
+// the rest of the file themselves. Returns false if PIZ isn't available on this platform.
+bool tinyexr_CompressPizBlock(unsigned char *out, unsigned int *outSize, const unsigned char *in,
+                              size_t inSize, const EXRChannelInfo *channels, int numChannels,
+                              int width, int numLines)
+{
+  std::vector<tinyexr::ChannelInfo> infos(numChannels);
+  for(int i = 0; i < numChannels; i++)
+  {
+    infos[i].name = channels[i].name;
+    infos[i].pixel_type = channels[i].pixel_type;
+    infos[i].x_sampling = channels[i].x_sampling;
+    infos[i].y_sampling = channels[i].y_sampling;
+    infos[i].p_linear = channels[i].p_linear;
+  }
+
+  return tinyexr::CompressPiz(out, outSize, in, inSize, infos, width, numLines);
+}
@@ -462,6 +462,9 @@ It is an :class:`AlphaMapping` that controls what behaviour to use.
 
   DOCUMENT("The quality to use when saving to a ``JPG`` file. Valid values are between 1 and 100.");
   int jpegQuality = 90;
+
+  DOCUMENT("The :class:`EXRCompression` to use when saving to an ``EXR`` file.");
+  EXRCompression exrCompression = EXRCompression::None;
 };
 
 DECLARE_REFLECTION_STRUCT(TextureSave);
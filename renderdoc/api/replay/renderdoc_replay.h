@@ -1207,6 +1207,50 @@ only ever have one result (only one entry point per shader).
   virtual PixelValue PickPixel(ResourceId textureId, uint32_t x, uint32_t y, const Subresource &sub,
                                CompType typeCast) = 0;
 
+  DOCUMENT(R"(Retrieves the contents of many pixels at once, from a list of co-ordinates. This gives
+the same values as calling :meth:`PickPixel` for each co-ordinate, but where possible fetches the
+texture data in a single readback instead of a round-trip for every pixel.
+
+Co-ordinates follow the same top-left convention as :meth:`PickPixel`. Any co-ordinates outside of
+the subresource return zeroes.
+
+:param ResourceId textureId: The texture to pick the pixels from.
+:param list coords: A list of ``int`` co-ordinates as alternating x and y values, e.g.
+  ``[x0, y0, x1, y1]``.
+:param Subresource sub: The subresource within this texture to use.
+:param CompType typeCast: If possible interpret the texture with this type instead of its normal
+  type. If set to :data:`CompType.Typeless` then no cast is applied, otherwise where allowed the
+  texture data will be reinterpreted - e.g. from unsigned integers to floats, or to unsigned
+  normalised values.
+:return: The contents of each pixel, in the same order as the co-ordinates.
+:rtype: ``list`` of PixelValue
+)");
+  virtual rdcarray<PixelValue> PickPixels(ResourceId textureId, const rdcarray<uint32_t> &coords,
+                                          const Subresource &sub, CompType typeCast) = 0;
+
+  DOCUMENT(R"(Retrieves the contents of every pixel in a rectangular region of a texture. See
+:meth:`PickPixels`.
+
+The region is clipped to the size of the subresource. If nothing is left after clipping, or the
+region covers more than 4096x4096 pixels, an empty list is returned.
+
+:param ResourceId textureId: The texture to pick the pixels from.
+:param int x: The x co-ordinate of the top-left of the region.
+:param int y: The y co-ordinate of the top-left of the region.
+:param int width: The width of the region.
+:param int height: The height of the region.
+:param Subresource sub: The subresource within this texture to use.
+:param CompType typeCast: If possible interpret the texture with this type instead of its normal
+  type. If set to :data:`CompType.Typeless` then no cast is applied, otherwise where allowed the
+  texture data will be reinterpreted - e.g. from unsigned integers to floats, or to unsigned
+  normalised values.
+:return: The contents of each pixel in the clipped region, row by row from the top-left.
+:rtype: ``list`` of PixelValue
+)");
+  virtual rdcarray<PixelValue> PickPixelRegion(ResourceId textureId, uint32_t x, uint32_t y,
+                                               uint32_t width, uint32_t height,
+                                               const Subresource &sub, CompType typeCast) = 0;
+
   DOCUMENT(R"(Retrieves the minimum and maximum values in the specified texture.
 
 :param ResourceId textureId: The texture to get the values from.
@@ -2397,6 +2441,64 @@ DOCUMENT(R"(Returns the current process's memory usage in bytes
 )");
 extern "C" RENDERDOC_API uint64_t RENDERDOC_CC RENDERDOC_GetCurrentProcessMemoryUsage();
 
+DOCUMENT(R"(Calculate the minimum and maximum values in texture data on the CPU, without needing a
+replay. This gives the same results as :meth:`ReplayController.GetMinMax`, and can be used on data
+from any source such as an image file.
+
+Block compressed, YUV and other formats that can't be decoded per-texel aren't supported, and give
+a minimum of 0 and maximum of 1 the same as when :meth:`ReplayController.GetMinMax` fails.
+
+:param ResourceFormat format: The format of the texture data.
+:param bytes data: The tightly packed texels to process.
+:return: A tuple with the minimum and maximum pixel values respectively.
+:rtype: ``tuple`` of PixelValue and PixelValue
+)");
+extern "C" RENDERDOC_API void RENDERDOC_CC RENDERDOC_CalcTextureMinMax(
+    const ResourceFormat &format, const bytebuf &data, rdcpair<PixelValue, PixelValue> *minmax);
+
+DOCUMENT(R"(Calculate a histogram of the values in texture data on the CPU, without needing a
+replay. This gives the same results as :meth:`ReplayController.GetHistogram`, and can be used on
+data from any source such as an image file.
+
+:param ResourceFormat format: The format of the texture data.
+:param bytes data: The tightly packed texels to process.
+:param float minval: The lower end of the smallest bucket. If any values are below this, they are
+  not added to any bucket.
+:param float maxval: The upper end of the largest bucket. If any values are above this, they are
+  not added to any bucket.
+:param list channels: A list of four ``bool`` values indicating whether each of RGBA should be
+  included in the count.
+:return: A list of the unnormalised bucket values, which is empty if the format can't be decoded
+  on the CPU or the range is empty.
+:rtype: ``list`` of ``int``
+)");
+extern "C" RENDERDOC_API void RENDERDOC_CC RENDERDOC_CalcTextureHistogram(
+    const ResourceFormat &format, const bytebuf &data, float minval, float maxval,
+    bool channels[4], rdcarray<uint32_t> *histogram);
+
+DOCUMENT(R"(Decode the positions of many vertices in a mesh on the CPU in a single call, the same
+way the mesh preview interprets them. This can be used with data from
+:meth:`ReplayController.GetBufferData`, for example for the buffers in a :class:`MeshFormat` from
+:meth:`ReplayController.GetPostVSData`.
+
+The mesh's position format, strides, base vertex and primitive restart properties are used. The
+index and vertex byte offsets are applied to the data passed in, which should begin at the start of
+each buffer.
+
+:param MeshFormat mesh: The mesh to decode.
+:param bytes indexData: The contents of the index buffer, or empty if the mesh is not indexed.
+:param bytes vertexData: The contents of the vertex buffer.
+:param int first: The first index to decode, or the first vertex if the mesh is not indexed.
+:param int count: The number of vertices to decode.
+:return: The decoded positions. Primitive restarts and vertices that lie outside of the data are
+  given as ``(0, 0, 0, 1)``.
+:rtype: ``list`` of :class:`FloatVector`
+)");
+extern "C" RENDERDOC_API void RENDERDOC_CC
+RENDERDOC_DecodeMeshVertices(const MeshFormat &mesh, const bytebuf &indexData,
+                             const bytebuf &vertexData, uint32_t first, uint32_t count,
+                             rdcarray<FloatVector> *positions);
+
 DOCUMENT("Internal function for retrieving a config setting.");
 extern "C" RENDERDOC_API const char *RENDERDOC_CC RENDERDOC_GetConfigSetting(const char *name);
 
@@ -162,6 +162,18 @@ rdcstr DoStringise(const FileType &el)
   END_ENUM_STRINGISE();
 }
 
+template <>
+rdcstr DoStringise(const EXRCompression &el)
+{
+  BEGIN_ENUM_STRINGISE(EXRCompression)
+  {
+    STRINGISE_ENUM_CLASS(None);
+    STRINGISE_ENUM_CLASS(ZIP);
+    STRINGISE_ENUM_CLASS(PIZ);
+  }
+  END_ENUM_STRINGISE();
+}
+
 template <>
 rdcstr DoStringise(const AlphaMapping &el)
 {
@@ -962,6 +974,7 @@ rdcstr DoStringise(const SectionType &el)
     STRINGISE_ENUM_CLASS_NAMED(ResourceRenames, "renderdoc/ui/resrenames");
     STRINGISE_ENUM_CLASS_NAMED(AMDRGPProfile, "amd/rgp/profile");
     STRINGISE_ENUM_CLASS_NAMED(ExtendedThumbnail, "renderdoc/internal/exthumb");
+    STRINGISE_ENUM_CLASS_NAMED(ScaledThumbnails, "renderdoc/internal/scaledthumbs");
   }
   END_ENUM_STRINGISE();
 }
@@ -83,6 +83,13 @@ version of RenderDoc that addes a new section type. They should be considered eq
   lossless.
 
   The name for this section will be "renderdoc/internal/exthumb".
+
+.. data:: ScaledThumbnails
+
+  This section contains copies of the thumbnail pre-scaled to several smaller sizes, so that small
+  previews can be fetched without decoding and resampling the full-size thumbnail.
+
+  The name for this section will be "renderdoc/internal/scaledthumbs".
 )");
 enum class SectionType : uint32_t
 {
@@ -95,6 +102,7 @@ enum class SectionType : uint32_t
   ResourceRenames,
   AMDRGPProfile,
   ExtendedThumbnail,
+  ScaledThumbnails,
   Count,
 };
 
@@ -1141,6 +1149,32 @@ enum class FileType : uint32_t
 ITERABLE_OPERATORS(FileType);
 DECLARE_REFLECTION_ENUM(FileType);
 
+DOCUMENT(R"(The compression to use when saving an ``EXR`` file.
+
+.. data:: None
+
+  No compression. The fastest to write and read, but gives the largest files.
+
+.. data:: ZIP
+
+  Lossless zlib compression of blocks of 16 scanlines.
+
+.. data:: PIZ
+
+  Lossless wavelet compression, which usually does best on noisy images but is slower to write.
+)");
+enum class EXRCompression : uint32_t
+{
+  None,
+  First = None,
+  ZIP,
+  PIZ,
+  Count,
+};
+
+ITERABLE_OPERATORS(EXRCompression);
+DECLARE_REFLECTION_ENUM(EXRCompression);
+
 DOCUMENT(R"(What to do with the alpha channel from a texture while saving out to a file.
 
 .. data:: Discard
@@ -375,8 +375,13 @@ struct LocalVariableMapping
 
   bool operator==(const LocalVariableMapping &o) const
   {
-    return localName == o.localName && type == o.type && builtin == o.builtin && rows == o.rows &&
-           columns == o.columns && elements == o.elements && registers == o.registers;
+    if(!(localName == o.localName && type == o.type && builtin == o.builtin && rows == o.rows &&
+         columns == o.columns && elements == o.elements))
+      return false;
+    for(size_t i = 0; i < sizeof(registers) / sizeof(registers[0]); i++)
+      if(!(registers[i] == o.registers[i]))
+        return false;
+    return true;
   }
   bool operator<(const LocalVariableMapping &o) const
   {
@@ -392,8 +397,9 @@ struct LocalVariableMapping
       return columns < o.columns;
     if(!(elements == o.elements))
       return elements < o.elements;
-    if(!(registers == o.registers))
-      return registers < o.registers;
+    for(size_t i = 0; i < sizeof(registers) / sizeof(registers[0]); i++)
+      if(!(registers[i] == o.registers[i]))
+        return registers[i] < o.registers[i];
     return false;
   }
   DOCUMENT("The name and member of this local variable that's being mapped from.");
@@ -542,6 +548,109 @@ shader execution happened will have ``nextInstruction == 0``.
 
 DECLARE_REFLECTION_STRUCT(ShaderDebugState);
 
+DOCUMENT("The new contents of one variable that was changed by a shader debugging step.");
+struct ShaderVariableChange
+{
+  DOCUMENT("");
+  ShaderVariableChange() = default;
+  ShaderVariableChange(const ShaderVariableChange &) = default;
+  ShaderVariableChange &operator=(const ShaderVariableChange &) = default;
+
+  bool operator==(const ShaderVariableChange &o) const
+  {
+    return index == o.index && value == o.value;
+  }
+  bool operator<(const ShaderVariableChange &o) const
+  {
+    if(!(index == o.index))
+      return index < o.index;
+    if(!(value == o.value))
+      return value < o.value;
+    return false;
+  }
+
+  DOCUMENT("The index of the variable in its list.");
+  uint32_t index = 0;
+
+  DOCUMENT("The new contents of the variable, as a :class:`ShaderVariable`.");
+  ShaderVariable value;
+};
+
+DECLARE_REFLECTION_STRUCT(ShaderVariableChange);
+
+DOCUMENT(R"(The changes made by a single step of shader debugging, relative to the step before it.
+
+The full state for any step can be fetched with :meth:`ShaderDebugTrace.GetState`.
+)");
+struct ShaderDebugStateDelta
+{
+  DOCUMENT("");
+  ShaderDebugStateDelta() = default;
+  ShaderDebugStateDelta(const ShaderDebugStateDelta &) = default;
+  ShaderDebugStateDelta &operator=(const ShaderDebugStateDelta &) = default;
+
+  bool operator==(const ShaderDebugStateDelta &o) const
+  {
+    return keyframe == o.keyframe && registers == o.registers && outputs == o.outputs &&
+           indexableTemps == o.indexableTemps && localsChanged == o.localsChanged &&
+           locals == o.locals && modified == o.modified && nextInstruction == o.nextInstruction &&
+           flags == o.flags;
+  }
+  bool operator<(const ShaderDebugStateDelta &o) const
+  {
+    if(!(keyframe == o.keyframe))
+      return keyframe < o.keyframe;
+    if(!(registers == o.registers))
+      return registers < o.registers;
+    if(!(outputs == o.outputs))
+      return outputs < o.outputs;
+    if(!(indexableTemps == o.indexableTemps))
+      return indexableTemps < o.indexableTemps;
+    if(!(localsChanged == o.localsChanged))
+      return localsChanged < o.localsChanged;
+    if(!(locals == o.locals))
+      return locals < o.locals;
+    if(!(modified == o.modified))
+      return modified < o.modified;
+    if(!(nextInstruction == o.nextInstruction))
+      return nextInstruction < o.nextInstruction;
+    if(!(flags == o.flags))
+      return flags < o.flags;
+    return false;
+  }
+
+  DOCUMENT(R"(If this step is stored in full, the index of its state in
+:data:`ShaderDebugTrace.keyframes`. Otherwise ``-1`` and the state is derived from the previous
+step.
+)");
+  int32_t keyframe = -1;
+
+  DOCUMENT("The registers that changed, as a list of :class:`ShaderVariableChange`.");
+  rdcarray<ShaderVariableChange> registers;
+  DOCUMENT("The outputs that changed, as a list of :class:`ShaderVariableChange`.");
+  rdcarray<ShaderVariableChange> outputs;
+  DOCUMENT("The indexable temporaries that changed, as a list of :class:`ShaderVariableChange`.");
+  rdcarray<ShaderVariableChange> indexableTemps;
+
+  DOCUMENT("``True`` if the :data:`locals` mapping differs from the previous step.");
+  bool localsChanged = false;
+  DOCUMENT(R"(The new list of :class:`LocalVariableMapping`, only valid if :data:`localsChanged` is
+``True``.
+)");
+  rdcarray<LocalVariableMapping> locals;
+
+  DOCUMENT("The same as :data:`ShaderDebugState.modified`.");
+  rdcarray<RegisterRange> modified;
+
+  DOCUMENT("The same as :data:`ShaderDebugState.nextInstruction`.");
+  uint32_t nextInstruction = 0;
+
+  DOCUMENT("The same as :data:`ShaderDebugState.flags`.");
+  ShaderEvents flags = ShaderEvents::NoEvent;
+};
+
+DECLARE_REFLECTION_STRUCT(ShaderDebugStateDelta);
+
 DOCUMENT(R"(This stores the whole state of a shader's execution from start to finish, with each
 individual debugging step along the way, as well as the immutable global constant values that do not
 change with shader execution.
@@ -562,10 +671,87 @@ Each entry in this list corresponds to a constant block with the same index in t
 )");
   rdcarray<ShaderVariable> constantBlocks;
 
-  DOCUMENT(R"(A list of :class:`ShaderDebugState` states representing the state after each
-instruction was executed
+  DOCUMENT(R"(Retrieves the number of steps in the trace, the initial state plus one for each
+instruction that was executed.
+
+:return: The number of steps.
+:rtype: ``int``
+)");
+  int32_t GetNumStates() const { return steps.count(); }
+  DOCUMENT(R"(Reconstructs the full state at a given step, starting from the closest keyframe at or
+before it.
+
+:param int step: The index of the step, between 0 and :meth:`GetNumStates` exclusive.
+:return: The state after that step, or an empty state if the step is out of range.
+:rtype: ShaderDebugState
 )");
-  rdcarray<ShaderDebugState> states;
+  ShaderDebugState GetState(int32_t step) const
+  {
+    ShaderDebugState ret;
+
+    if(step < 0 || step >= steps.count())
+      return ret;
+
+    int32_t first = step;
+    while(first > 0 && steps[first].keyframe < 0)
+      first--;
+
+    if(steps[first].keyframe < 0 || steps[first].keyframe >= keyframes.count())
+      return ret;
+
+    ret = keyframes[steps[first].keyframe];
+
+    for(int32_t i = first + 1; i <= step; i++)
+      ApplyDelta(ret, steps[i]);
+
+    return ret;
+  }
+
+  DOCUMENT(R"(Reconstructs the full state at every step in one pass over the trace.
+
+This is for scripts written against older versions, where the trace stored a list of full states.
+That list is still available to python as the read-only ``states`` property, which calls this
+function each time it's accessed, so fetch it once rather than indexing ``trace.states`` in a loop.
+New code should use :meth:`GetState` to reconstruct only the steps it needs.
+
+:return: The state after each step, as a list of :class:`ShaderDebugState`.
+:rtype: ``list`` of ShaderDebugState
+)");
+  rdcarray<ShaderDebugState> GetAllStates() const
+  {
+    rdcarray<ShaderDebugState> ret;
+    ret.reserve(steps.count());
+
+    for(int32_t i = 0; i < steps.count(); i++)
+    {
+      if(steps[i].keyframe >= 0 && steps[i].keyframe < keyframes.count())
+      {
+        ret.push_back(keyframes[steps[i].keyframe]);
+      }
+      else if(i > 0)
+      {
+        ret.push_back(ret.back());
+        ApplyDelta(ret.back(), steps[i]);
+      }
+      else
+      {
+        ret.push_back(ShaderDebugState());
+      }
+    }
+
+    return ret;
+  }
+
+  DOCUMENT(R"(A list of :class:`ShaderDebugStateDelta` with one entry for each step, the initial
+state before any execution and then the state after each instruction was executed.
+
+Only the changes from one step to the next are stored, except for periodic steps stored in full in
+:data:`keyframes`. Use :meth:`GetState` to get the full state at any step.
+)");
+  rdcarray<ShaderDebugStateDelta> steps;
+
+  DOCUMENT("The list of :class:`ShaderDebugState` keyframes referenced by :data:`steps`.");
+  rdcarray<ShaderDebugState> keyframes;
 
   DOCUMENT("A flag indicating whether this trace has locals information");
   bool hasLocals = false;
@@ -574,6 +760,31 @@ instruction was executed
 corresponds to
 )");
   rdcarray<LineColumnInfo> lineInfo;
+
+private:
+  static void ApplyChanges(rdcarray<ShaderVariable> &vars,
+                           const rdcarray<ShaderVariableChange> &changes)
+  {
+    // traces can come from elsewhere, e.g. over the network, so skip any changes that don't fit
+    // the keyframe rather than writing out of bounds
+    for(const ShaderVariableChange &c : changes)
+      if(c.index < (uint32_t)vars.count())
+        vars[c.index] = c.value;
+  }
+
+  static void ApplyDelta(ShaderDebugState &state, const ShaderDebugStateDelta &delta)
+  {
+    ApplyChanges(state.registers, delta.registers);
+    ApplyChanges(state.outputs, delta.outputs);
+    ApplyChanges(state.indexableTemps, delta.indexableTemps);
+
+    if(delta.localsChanged)
+      state.locals = delta.locals;
+
+    state.modified = delta.modified;
+    state.nextInstruction = delta.nextInstruction;
+    state.flags = delta.flags;
+  }
 };
 
 DECLARE_REFLECTION_STRUCT(ShaderDebugTrace);
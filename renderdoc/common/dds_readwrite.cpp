@@ -25,9 +25,13 @@
 #include "dds_readwrite.h"
 #include <stdint.h>
 #include "common/common.h"
+#include "common/threading.h"
 
 static const uint32_t dds_fourcc = MAKE_FOURCC('D', 'D', 'S', ' ');
 
+// below this size the subresources are written serially through the stream
+static const uint64_t parallelWriteSize = 4 * 1024 * 1024;
+
 // from MSDN
 struct DDS_PIXELFORMAT
 {
@@ -849,6 +853,11 @@ bool write_dds_to_file(FILE *f, const dds_data &data)
     if(dx10Header)
       FileIO::fwrite(&headerDXT10, sizeof(headerDXT10), 1, f);
 
+    // work out where each subresource goes first, so they can be written independently
+    std::vector<const byte *> srcs;
+    std::vector<size_t> sizes;
+    uint64_t totalSize = 0;
+
     int i = 0;
     for(int slice = 0; slice < RDCMAX(1, data.slices); slice++)
     {
@@ -857,8 +866,6 @@ bool write_dds_to_file(FILE *f, const dds_data &data)
         int numdepths = RDCMAX(1, data.depth >> mip);
         for(int d = 0; d < numdepths; d++)
         {
-          byte *bytedata = data.subdata[i];
-
           int rowlen = RDCMAX(1, data.width >> mip);
           int numRows = RDCMAX(1, data.height >> mip);
           int pitch = RDCMAX(1U, rowlen * bytesPerPixel);
@@ -876,22 +883,73 @@ bool write_dds_to_file(FILE *f, const dds_data &data)
             pitch = RDCMAX(blockSize, (((rowlen + 3) / 4)) * blockSize);
           }
 
-          for(int row = 0; row < numRows; row++)
-          {
-            FileIO::fwrite(bytedata, 1, pitch, f);
-
-            bytedata += pitch;
-          }
+          // subresources are tightly packed so rows are contiguous, write them all in one go
+          srcs.push_back(data.subdata[i]);
+          sizes.push_back(size_t(pitch) * numRows);
+          totalSize += sizes.back();
 
           i++;
         }
       }
     }
+
+    // large files with several subresources are written from multiple threads at once, each
+    // straight to its own place in the file. Small ones aren't worth the threads.
+    if(srcs.size() > 1 && totalSize >= parallelWriteSize)
+    {
+      FileIO::fflush(f);
+
+      const uint64_t base = FileIO::ftell64(f);
+
+      std::vector<uint64_t> offsets(srcs.size());
+      for(size_t s = 1; s < srcs.size(); s++)
+        offsets[s] = offsets[s - 1] + sizes[s - 1];
+
+      volatile int32_t failed = 0;
+
+      Threading::ParallelFor((uint32_t)srcs.size(), [&](uint32_t s) {
+        if(!FileIO::fwriteat(srcs[s], sizes[s], f, base + offsets[s]))
+          Atomic::Inc32(&failed);
+      });
+
+      FileIO::fseek64(f, base + totalSize, SEEK_SET);
+
+      if(Atomic::CmpExch32(&failed, 0, 0) != 0)
+      {
+        RDCERR("Failed to write DDS data");
+        return false;
+      }
+    }
+    else
+    {
+      for(size_t s = 0; s < srcs.size(); s++)
+        FileIO::fwrite(srcs[s], 1, sizes[s], f);
+    }
   }
 
   return true;
 }
 
+void free_dds_data(dds_data &data)
+{
+  if(data.storage)
+  {
+    if(data.storageMapped)
+      FileIO::funmap(data.storage, data.storageSize);
+    else
+      delete[] data.storage;
+  }
+
+  delete[] data.subdata;
+  delete[] data.subsizes;
+
+  data.storage = NULL;
+  data.storageSize = 0;
+  data.storageMapped = false;
+  data.subdata = NULL;
+  data.subsizes = NULL;
+}
+
 bool is_dds_file(FILE *f)
 {
   FileIO::fseek64(f, 0, SEEK_SET);
@@ -904,7 +962,7 @@ bool is_dds_file(FILE *f)
   return magic == dds_fourcc;
 }
 
-dds_data load_dds_from_file(FILE *f)
+dds_data load_dds_from_file(FILE *f, bool mapFile)
 {
   dds_data ret = {};
   dds_data error = {};
@@ -1078,9 +1136,19 @@ dds_data load_dds_from_file(FILE *f)
     }
   }
 
+  const uint64_t dataOffset = FileIO::ftell64(f);
+
+  FileIO::fseek64(f, 0, SEEK_END);
+  const uint64_t fileSize = FileIO::ftell64(f);
+  FileIO::fseek64(f, dataOffset, SEEK_SET);
+
   ret.subsizes = new uint32_t[ret.slices * ret.mips];
   ret.subdata = new byte *[ret.slices * ret.mips];
 
+  // subresources are tightly packed one after another in the file, so calculate where each one
+  // starts and then point straight into the file data instead of reading each one separately.
+  uint64_t dataSize = 0;
+
   int i = 0;
   for(int slice = 0; slice < ret.slices; slice++)
   {
@@ -1106,42 +1174,62 @@ dds_data load_dds_from_file(FILE *f)
       }
 
       ret.subsizes[i] = numdepths * numRows * pitch;
+      dataSize += ret.subsizes[i];
 
-      byte *bytedata = ret.subdata[i] = new byte[ret.subsizes[i]];
+      i++;
+    }
+  }
 
-      for(int d = 0; d < numdepths; d++)
-      {
-        for(int row = 0; row < numRows; row++)
-        {
-          FileIO::fread(bytedata, 1, pitch, f);
+  if(dataOffset > fileSize || dataSize > fileSize - dataOffset)
+  {
+    RDCERR("DDS file is truncated, expected %llu bytes of data but only %llu are present",
+           dataSize, fileSize - RDCMIN(fileSize, dataOffset));
+    free_dds_data(ret);
+    return error;
+  }
 
-          if(bgrSwap)
-          {
-            byte *rgba = bytedata;
-
-            if(bytesPerPixel >= 3)
-            {
-              for(int p = 0; p < rowlen; p++)
-              {
-                std::swap(rgba[0], rgba[2]);
-                rgba += bytesPerPixel;
-              }
-            }
-            else
-            {
-              for(int p = 0; p < rowlen; p++)
-              {
-                std::swap(rgba[0], rgba[1]);
-                rgba += bytesPerPixel;
-              }
-            }
-          }
+  // map the file if we can, so that only the pages that are used get read. Otherwise read the
+  // whole of the data in one go.
+  byte *data = NULL;
 
-          bytedata += pitch;
-        }
-      }
+  if(mapFile)
+    ret.storage = (byte *)FileIO::fmap(f, ret.storageSize);
 
-      i++;
+  if(ret.storage && ret.storageSize >= dataOffset + dataSize)
+  {
+    ret.storageMapped = true;
+    data = ret.storage + dataOffset;
+  }
+  else
+  {
+    FileIO::funmap(ret.storage, ret.storageSize);
+
+    ret.storageSize = dataSize;
+    ret.storage = data = new byte[(size_t)dataSize];
+
+    if(FileIO::fread(data, 1, (size_t)dataSize, f) != dataSize)
+    {
+      RDCERR("Failed to read DDS data");
+      free_dds_data(ret);
+      return error;
+    }
+  }
+
+  for(i = 0; i < ret.slices * ret.mips; i++)
+  {
+    ret.subdata[i] = data;
+    data += ret.subsizes[i];
+  }
+
+  // the mapping is copy-on-write so this doesn't modify the file
+  if(bgrSwap)
+  {
+    const int swapOffset = bytesPerPixel >= 3 ? 2 : 1;
+    for(i = 0; i < ret.slices * ret.mips; i++)
+    {
+      byte *rgba = ret.subdata[i];
+      for(uint32_t p = 0; p + swapOffset < ret.subsizes[i]; p += bytesPerPixel)
+        std::swap(rgba[p], rgba[p + swapOffset]);
     }
   }
 
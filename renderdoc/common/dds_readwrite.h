@@ -41,8 +41,18 @@ struct dds_data
 
   byte **subdata;
   uint32_t *subsizes;
+
+  // when loaded from a file, subdata points into this storage rather than owning separate
+  // allocations. It's either a copy-on-write mapping of the file or a single buffer holding the
+  // whole file. Release with free_dds_data.
+  byte *storage;
+  uint64_t storageSize;
+  bool storageMapped;
 };
 
 extern bool is_dds_file(FILE *f);
-extern dds_data load_dds_from_file(FILE *f);
+// if mapFile is true, the file is mapped instead of read where possible. Accessing the data then
+// faults if the file is truncated while it's mapped, so only map files that won't change.
+extern dds_data load_dds_from_file(FILE *f, bool mapFile);
+extern void free_dds_data(dds_data &data);
 extern bool write_dds_to_file(FILE *f, const dds_data &data);
@@ -0,0 +1,210 @@
+/******************************************************************************
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2019 Baldur Karlsson
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+#include "common/dds_readwrite.h"
+#include "common/common.h"
+#include "os/os_specific.h"
+#include "strings/string_utils.h"
+
+#if ENABLED(ENABLE_UNIT_TESTS)
+
+#include "3rdparty/catch/catch.hpp"
+
+TEST_CASE("Test DDS round trip", "[dds]")
+{
+  std::string path = StringFormat::Fmt("%s/rdoc_dds_test_%u.dds",
+                                       FileIO::GetTempFolderFilename().c_str(),
+                                       Process::GetCurrentPID());
+
+  ResourceFormat fmt;
+  fmt.type = ResourceFormatType::Regular;
+  fmt.compType = CompType::UNorm;
+  fmt.compCount = 4;
+  fmt.compByteWidth = 1;
+
+  SECTION("Array with mips")
+  {
+    const int width = 64, height = 32, mips = 3, slices = 2;
+
+    std::vector<std::vector<byte>> contents;
+    std::vector<byte *> subdata;
+    for(int slice = 0; slice < slices; slice++)
+    {
+      for(int mip = 0; mip < mips; mip++)
+      {
+        std::vector<byte> sub(size_t((width >> mip) * (height >> mip) * 4));
+        for(size_t i = 0; i < sub.size(); i++)
+          sub[i] = byte(i * 7 + slice * 31 + mip * 3);
+        contents.push_back(sub);
+      }
+    }
+    for(std::vector<byte> &sub : contents)
+      subdata.push_back(sub.data());
+
+    dds_data write_data = {};
+    write_data.width = width;
+    write_data.height = height;
+    write_data.depth = 1;
+    write_data.mips = mips;
+    write_data.slices = slices;
+    write_data.format = fmt;
+    write_data.subdata = subdata.data();
+
+    FILE *f = FileIO::fopen(path.c_str(), "wb");
+    REQUIRE(f);
+    CHECK(write_dds_to_file(f, write_data));
+    FileIO::fclose(f);
+
+    f = FileIO::fopen(path.c_str(), "rb");
+    REQUIRE(f);
+    CHECK(is_dds_file(f));
+    dds_data read_data = load_dds_from_file(f, true);
+    FileIO::fclose(f);
+
+    REQUIRE(read_data.subdata);
+    CHECK(read_data.width == width);
+    CHECK(read_data.height == height);
+    CHECK(read_data.mips == mips);
+    CHECK(read_data.slices == slices);
+    CHECK((read_data.format == fmt));
+
+    for(size_t i = 0; i < contents.size(); i++)
+    {
+      REQUIRE(read_data.subsizes[i] == contents[i].size());
+      CHECK(memcmp(read_data.subdata[i], contents[i].data(), contents[i].size()) == 0);
+    }
+
+    // subresources are views into one block of storage, which is writeable without affecting the
+    // file
+    CHECK(read_data.storage);
+    read_data.subdata[0][0] ^= 0xff;
+
+    free_dds_data(read_data);
+    CHECK(read_data.subdata == NULL);
+    CHECK(read_data.storage == NULL);
+
+    f = FileIO::fopen(path.c_str(), "rb");
+    REQUIRE(f);
+    read_data = load_dds_from_file(f, true);
+    FileIO::fclose(f);
+
+    REQUIRE(read_data.subdata);
+    CHECK(read_data.subdata[0][0] == contents[0][0]);
+
+    free_dds_data(read_data);
+  };
+
+  SECTION("Truncated file")
+  {
+    std::vector<byte> sub(16 * 16 * 4, 0x80);
+    byte *subdata = sub.data();
+
+    dds_data write_data = {};
+    write_data.width = 16;
+    write_data.height = 16;
+    write_data.depth = 1;
+    write_data.mips = 1;
+    write_data.slices = 1;
+    write_data.format = fmt;
+    write_data.subdata = &subdata;
+
+    FILE *f = FileIO::fopen(path.c_str(), "wb");
+    REQUIRE(f);
+    CHECK(write_dds_to_file(f, write_data));
+    FileIO::ftruncateat(f, FileIO::ftell64(f) - 100);
+    FileIO::fclose(f);
+
+    f = FileIO::fopen(path.c_str(), "rb");
+    REQUIRE(f);
+    dds_data read_data = load_dds_from_file(f, true);
+    FileIO::fclose(f);
+
+    CHECK(read_data.subdata == NULL);
+  };
+
+  SECTION("Large files are written in parallel")
+  {
+    // big enough to go over the threshold for parallel writes, with many subresources
+    const int width = 512, height = 512, mips = 10, slices = 6;
+
+    std::vector<std::vector<byte>> contents;
+    std::vector<byte *> subdata;
+    for(int slice = 0; slice < slices; slice++)
+    {
+      for(int mip = 0; mip < mips; mip++)
+      {
+        std::vector<byte> sub(size_t(RDCMAX(1, width >> mip) * RDCMAX(1, height >> mip) * 4));
+        for(size_t i = 0; i < sub.size(); i++)
+          sub[i] = byte((i >> 2) * 13 + slice * 31 + mip * 3);
+        contents.push_back(sub);
+      }
+    }
+    for(std::vector<byte> &sub : contents)
+      subdata.push_back(sub.data());
+
+    dds_data write_data = {};
+    write_data.width = width;
+    write_data.height = height;
+    write_data.depth = 1;
+    write_data.mips = mips;
+    write_data.slices = slices;
+    write_data.format = fmt;
+    write_data.subdata = subdata.data();
+
+    FILE *f = FileIO::fopen(path.c_str(), "wb");
+    REQUIRE(f);
+    CHECK(write_dds_to_file(f, write_data));
+
+    // the stream is left at the end of the data
+    uint64_t endOffset = FileIO::ftell64(f);
+    FileIO::fclose(f);
+
+    f = FileIO::fopen(path.c_str(), "rb");
+    REQUIRE(f);
+    FileIO::fseek64(f, 0, SEEK_END);
+    CHECK(FileIO::ftell64(f) == endOffset);
+    FileIO::fseek64(f, 0, SEEK_SET);
+
+    // read without mapping, the whole file is read into one buffer
+    dds_data read_data = load_dds_from_file(f, false);
+    FileIO::fclose(f);
+
+    REQUIRE(read_data.subdata);
+    CHECK(read_data.mips == mips);
+    CHECK(read_data.slices == slices);
+    CHECK_FALSE(read_data.storageMapped);
+
+    for(size_t i = 0; i < contents.size(); i++)
+    {
+      REQUIRE(read_data.subsizes[i] == contents[i].size());
+      CHECK(memcmp(read_data.subdata[i], contents[i].data(), contents[i].size()) == 0);
+    }
+
+    free_dds_data(read_data);
+  };
+
+  FileIO::Delete(path.c_str());
+}
+
+#endif    // ENABLED(ENABLE_UNIT_TESTS)
@@ -0,0 +1,466 @@
+/******************************************************************************
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014-2019 Baldur Karlsson
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+#include "exr_readwrite.h"
+#include "common/common.h"
+#include "common/threading.h"
+#include "maths/half_convert.h"
+#include "miniz/miniz.h"
+#include "os/os_specific.h"
+#include "tinyexr/tinyexr.h"
+
+// implemented in tinyexr.cpp, where tinyexr's internals are available
+bool tinyexr_CompressPizBlock(unsigned char *out, unsigned int *outSize, const unsigned char *in,
+                              size_t inSize, const EXRChannelInfo *channels, int numChannels,
+                              int width, int numLines);
+
+// EXR scanline files are a header, then a table of offsets to each block of scanlines, then the
+// blocks themselves. Each block holds a run of scanlines, and each scanline stores every channel
+// in turn (in the alphabetical order of the channel list) for the whole width. Everything is
+// little endian.
+
+static const byte exr_magic[] = {0x76, 0x2f, 0x31, 0x01};
+
+// these match TINYEXR_PIXELTYPE_* and TINYEXR_COMPRESSIONTYPE_*, which are the values in the file
+static const int32_t exr_pixeltype_half = 1;
+static const int32_t exr_pixeltype_float = 2;
+
+static const byte exr_compression_none = 0;
+static const byte exr_compression_zips = 2;
+static const byte exr_compression_zip = 3;
+static const byte exr_compression_piz = 4;
+
+// the channels we write, in the order they're stored. Many viewers assume this order without
+// checking the channel names.
+static const char exr_channels[] = {'A', 'B', 'G', 'R'};
+// index of each of those channels in an RGBA pixel
+static const int exr_channel_rgba[] = {3, 2, 1, 0};
+// the names of the channels in an RGBA pixel
+static const char *const exr_channel_names[] = {"R", "G", "B", "A"};
+
+static void AppendBytes(std::vector<byte> &out, const void *data, size_t size)
+{
+  const byte *bytes = (const byte *)data;
+  out.insert(out.end(), bytes, bytes + size);
+}
+
+static void AppendAttribute(std::vector<byte> &out, const char *name, const char *type,
+                            const void *value, int32_t size)
+{
+  AppendBytes(out, name, strlen(name) + 1);
+  AppendBytes(out, type, strlen(type) + 1);
+  AppendBytes(out, &size, sizeof(size));
+  AppendBytes(out, value, size);
+}
+
+// ZIP compression first splits the bytes into two halves of even and odd bytes, then stores each
+// byte as a delta from the previous one, and finally deflates the result.
+static void ZipPredict(const byte *src, size_t size, byte *dst)
+{
+  byte *t1 = dst;
+  byte *t2 = dst + (size + 1) / 2;
+
+  for(size_t i = 0; i < size; i++)
+  {
+    if(i & 1)
+      *(t2++) = src[i];
+    else
+      *(t1++) = src[i];
+  }
+
+  byte prev = dst[0];
+  for(size_t i = 1; i < size; i++)
+  {
+    byte cur = dst[i];
+    dst[i] = byte(int(cur) - int(prev) + (128 + 256));
+    prev = cur;
+  }
+}
+
+static void ZipUnpredict(byte *src, size_t size, byte *dst)
+{
+  for(size_t i = 1; i < size; i++)
+    src[i] = byte(int(src[i - 1]) + int(src[i]) - 128);
+
+  const byte *t1 = src;
+  const byte *t2 = src + (size + 1) / 2;
+
+  for(size_t i = 0; i < size; i++)
+    dst[i] = (i & 1) ? *(t2++) : *(t1++);
+}
+
+bool write_exr_to_file(FILE *f, uint32_t width, uint32_t height, bool halfFloat,
+                       EXRCompression compression, exr_row_callback getRow)
+{
+  if(!f || width == 0 || height == 0)
+    return false;
+
+  const bool zip = (compression == EXRCompression::ZIP);
+  const bool piz = (compression == EXRCompression::PIZ);
+
+  std::vector<byte> header;
+  AppendBytes(header, exr_magic, sizeof(exr_magic));
+
+  // version 2, single part scanline file
+  const byte version[] = {2, 0, 0, 0};
+  AppendBytes(header, version, sizeof(version));
+
+  {
+    std::vector<byte> chlist;
+    for(char name : exr_channels)
+    {
+      const char chname[] = {name, 0};
+      AppendBytes(chlist, chname, sizeof(chname));
+
+      int32_t pixelType = halfFloat ? exr_pixeltype_half : exr_pixeltype_float;
+      AppendBytes(chlist, &pixelType, sizeof(pixelType));
+
+      // pLinear and reserved bytes, then x and y sampling
+      const byte reserved[4] = {};
+      AppendBytes(chlist, reserved, sizeof(reserved));
+      const int32_t sampling[2] = {1, 1};
+      AppendBytes(chlist, sampling, sizeof(sampling));
+    }
+    chlist.push_back(0);
+
+    AppendAttribute(header, "channels", "chlist", chlist.data(), (int32_t)chlist.size());
+  }
+
+  const byte comp = zip ? exr_compression_zip : piz ? exr_compression_piz : exr_compression_none;
+  AppendAttribute(header, "compression", "compression", &comp, sizeof(comp));
+
+  const int32_t window[4] = {0, 0, int32_t(width) - 1, int32_t(height) - 1};
+  AppendAttribute(header, "dataWindow", "box2i", window, sizeof(window));
+  AppendAttribute(header, "displayWindow", "box2i", window, sizeof(window));
+
+  // increasing Y
+  const byte lineOrder = 0;
+  AppendAttribute(header, "lineOrder", "lineOrder", &lineOrder, sizeof(lineOrder));
+
+  const float aspect = 1.0f;
+  AppendAttribute(header, "pixelAspectRatio", "float", &aspect, sizeof(aspect));
+
+  const float center[2] = {0.0f, 0.0f};
+  AppendAttribute(header, "screenWindowCenter", "v2f", center, sizeof(center));
+
+  const float windowWidth = 1.0f;
+  AppendAttribute(header, "screenWindowWidth", "float", &windowWidth, sizeof(windowWidth));
+
+  // end of header
+  header.push_back(0);
+
+  const uint32_t linesPerBlock = zip ? 16 : piz ? 32 : 1;
+  const uint32_t numBlocks = (height + linesPerBlock - 1) / linesPerBlock;
+  const uint32_t compSize = halfFloat ? sizeof(uint16_t) : sizeof(float);
+
+  bool success = FileIO::fwrite(header.data(), 1, header.size(), f) == header.size();
+
+  // the offset table is filled in once all the blocks have been written
+  std::vector<uint64_t> offsets(numBlocks);
+  uint64_t offset = header.size() + offsets.size() * sizeof(uint64_t);
+  success &= FileIO::fwrite(offsets.data(), sizeof(uint64_t), offsets.size(), f) == offsets.size();
+
+  auto encodeBlock = [&](uint32_t block, std::vector<byte> &out) {
+    const uint32_t firstLine = block * linesPerBlock;
+    const uint32_t numLines = RDCMIN(linesPerBlock, height - firstLine);
+
+    std::vector<float> row(width * 4);
+    std::vector<byte> raw(size_t(numLines) * width * 4 * compSize);
+
+    byte *dst = raw.data();
+    for(uint32_t line = 0; line < numLines; line++)
+    {
+      getRow(firstLine + line, row.data());
+
+      for(int c = 0; c < 4; c++)
+      {
+        const float *src = row.data() + exr_channel_rgba[c];
+
+        if(halfFloat)
+        {
+          for(uint32_t x = 0; x < width; x++, dst += sizeof(uint16_t))
+          {
+            uint16_t val = ConvertToHalf(src[x * 4]);
+            memcpy(dst, &val, sizeof(val));
+          }
+        }
+        else
+        {
+          for(uint32_t x = 0; x < width; x++, dst += sizeof(float))
+            memcpy(dst, &src[x * 4], sizeof(float));
+        }
+      }
+    }
+
+    const byte *payload = raw.data();
+    int32_t payloadSize = (int32_t)raw.size();
+
+    std::vector<byte> compressed;
+    if(zip)
+    {
+      std::vector<byte> predicted(raw.size());
+      ZipPredict(raw.data(), raw.size(), predicted.data());
+
+      mz_ulong zipSize = mz_compressBound((mz_ulong)predicted.size());
+      compressed.resize(zipSize);
+      int ret = mz_compress(compressed.data(), &zipSize, predicted.data(),
+                            (mz_ulong)predicted.size());
+
+      // blocks that don't compress are stored as-is, readers spot this from the size
+      if(ret == MZ_OK && zipSize < raw.size())
+      {
+        payload = compressed.data();
+        payloadSize = (int32_t)zipSize;
+      }
+    }
+    else if(piz)
+    {
+      // the wavelet and huffman coding is tinyexr's, which also falls back to storing the block
+      // as-is if it doesn't compress
+      EXRChannelInfo channels[4] = {};
+      for(int c = 0; c < 4; c++)
+      {
+        channels[c].name[0] = exr_channels[c];
+        channels[c].pixel_type = halfFloat ? exr_pixeltype_half : exr_pixeltype_float;
+        channels[c].x_sampling = channels[c].y_sampling = 1;
+      }
+
+      unsigned int pizSize = 1024 + (unsigned int)(raw.size() * 6 / 5);
+      compressed.resize(pizSize);
+      if(tinyexr_CompressPizBlock(compressed.data(), &pizSize, raw.data(), raw.size(), channels, 4,
+                                  (int)width, (int)numLines))
+      {
+        payload = compressed.data();
+        payloadSize = (int32_t)pizSize;
+      }
+    }
+
+    out.clear();
+    const int32_t y = (int32_t)firstLine;
+    AppendBytes(out, &y, sizeof(y));
+    AppendBytes(out, &payloadSize, sizeof(payloadSize));
+    AppendBytes(out, payload, payloadSize);
+  };
+
+  // encode a batch of blocks in parallel, then write them out in order before moving on so that
+  // only a batch is ever in memory.
+  const uint32_t blocksPerBatch = RDCMAX(Threading::GetNumberOfCores() * 4, 64U / linesPerBlock);
+  std::vector<std::vector<byte>> blocks(blocksPerBatch);
+
+  for(uint32_t batch = 0; batch < numBlocks && success; batch += blocksPerBatch)
+  {
+    const uint32_t count = RDCMIN(blocksPerBatch, numBlocks - batch);
+
+    Threading::ParallelFor(count, [&](uint32_t i) { encodeBlock(batch + i, blocks[i]); });
+
+    for(uint32_t i = 0; i < count; i++)
+    {
+      offsets[batch + i] = offset;
+      offset += blocks[i].size();
+      success &= FileIO::fwrite(blocks[i].data(), 1, blocks[i].size(), f) == blocks[i].size();
+    }
+  }
+
+  FileIO::fseek64(f, header.size(), SEEK_SET);
+  success &= FileIO::fwrite(offsets.data(), sizeof(uint64_t), offsets.size(), f) == offsets.size();
+  FileIO::fseek64(f, 0, SEEK_END);
+
+  if(!success)
+    RDCERR("Error writing EXR file");
+
+  return success;
+}
+
+bool load_exr_rgba(const byte *data, size_t size, uint32_t &width, uint32_t &height,
+                   std::vector<byte> &rgba)
+{
+  EXRVersion exrVersion;
+  if(ParseEXRVersionFromMemory(&exrVersion, data, size) != 0 || exrVersion.tiled ||
+     exrVersion.multipart || exrVersion.non_image)
+    return false;
+
+  EXRHeader exrHeader;
+  InitEXRHeader(&exrHeader);
+
+  const char *err = NULL;
+  if(ParseEXRHeaderFromMemory(&exrHeader, &exrVersion, data, size, &err) != 0)
+    return false;
+
+  uint32_t linesPerBlock = 0;
+  if(exrHeader.compression_type == exr_compression_none ||
+     exrHeader.compression_type == exr_compression_zips)
+    linesPerBlock = 1;
+  else if(exrHeader.compression_type == exr_compression_zip)
+    linesPerBlock = 16;
+
+  const bool zip = (exrHeader.compression_type != exr_compression_none);
+
+  // byte offset of each channel in a scanline, in units of the width. -1 for missing channels
+  int32_t channelOffset[4] = {-1, -1, -1, -1};
+  bool channelHalf[4] = {};
+  uint32_t pixelSize = 0;
+
+  bool supported = linesPerBlock > 0;
+  for(int i = 0; supported && i < exrHeader.num_channels; i++)
+  {
+    int type = exrHeader.pixel_types[i];
+    if(type != TINYEXR_PIXELTYPE_HALF && type != TINYEXR_PIXELTYPE_FLOAT)
+    {
+      supported = false;
+      break;
+    }
+
+    // only plain RGBA channels. Layers such as "diffuse.R" or any other channels are left to the
+    // general loader
+    const char *name = exrHeader.channels[i].name;
+    int c = -1;
+    for(int rgba = 0; rgba < 4; rgba++)
+      if(!strcmp(name, exr_channel_names[rgba]))
+        c = rgba;
+
+    if(c < 0 || channelOffset[c] >= 0)
+    {
+      supported = false;
+      break;
+    }
+
+    channelOffset[c] = (int32_t)pixelSize;
+    channelHalf[c] = (type == TINYEXR_PIXELTYPE_HALF);
+
+    pixelSize += type == TINYEXR_PIXELTYPE_HALF ? sizeof(uint16_t) : sizeof(float);
+  }
+
+  const int32_t minX = exrHeader.data_window[0], minY = exrHeader.data_window[1];
+  const int64_t w = int64_t(exrHeader.data_window[2]) - minX + 1;
+  const int64_t h = int64_t(exrHeader.data_window[3]) - minY + 1;
+
+  const size_t tableOffset = exrHeader.header_len + 8;
+
+  FreeEXRHeader(&exrHeader);
+
+  if(!supported || w <= 0 || h <= 0 || w > 65536 || h > 65536)
+    return false;
+
+  width = (uint32_t)w;
+  height = (uint32_t)h;
+
+  const uint32_t numBlocks = (height + linesPerBlock - 1) / linesPerBlock;
+  const size_t scanlineSize = size_t(width) * pixelSize;
+
+  if(tableOffset + numBlocks * sizeof(uint64_t) > size)
+    return false;
+
+  rgba.resize(size_t(width) * height * 4 * sizeof(float));
+  float *out = (float *)rgba.data();
+
+  volatile int32_t failed = 0;
+
+  Threading::ParallelFor(numBlocks, [&](uint32_t block) {
+    std::vector<byte> decompressed, predicted;
+
+    uint64_t offset;
+    memcpy(&offset, data + tableOffset + block * sizeof(uint64_t), sizeof(offset));
+
+    int32_t blockHeader[2];
+    if(offset > size || size - offset < sizeof(blockHeader))
+    {
+      Atomic::Inc32(&failed);
+      return;
+    }
+    memcpy(blockHeader, data + offset, sizeof(blockHeader));
+
+    const int64_t firstLine = int64_t(blockHeader[0]) - minY;
+    const uint64_t dataSize = (uint32_t)blockHeader[1];
+    if(firstLine < 0 || firstLine >= h || dataSize > size - offset - sizeof(blockHeader))
+    {
+      Atomic::Inc32(&failed);
+      return;
+    }
+
+    const uint32_t numLines = RDCMIN(linesPerBlock, height - (uint32_t)firstLine);
+    const size_t expectedSize = scanlineSize * numLines;
+
+    const byte *src = data + offset + sizeof(blockHeader);
+
+    if(dataSize != expectedSize)
+    {
+      if(!zip)
+      {
+        Atomic::Inc32(&failed);
+        return;
+      }
+
+      predicted.resize(expectedSize);
+      mz_ulong outSize = (mz_ulong)expectedSize;
+      if(mz_uncompress(predicted.data(), &outSize, src, (mz_ulong)dataSize) != MZ_OK ||
+         outSize != expectedSize)
+      {
+        Atomic::Inc32(&failed);
+        return;
+      }
+
+      decompressed.resize(expectedSize);
+      ZipUnpredict(predicted.data(), expectedSize, decompressed.data());
+      src = decompressed.data();
+    }
+
+    for(uint32_t line = 0; line < numLines; line++)
+    {
+      float *dst = out + (size_t(firstLine) + line) * width * 4;
+
+      for(int c = 0; c < 4; c++)
+      {
+        if(channelOffset[c] < 0)
+        {
+          // RGB channels default to 0, alpha defaults to 1
+          const float def = c < 3 ? 0.0f : 1.0f;
+          for(uint32_t x = 0; x < width; x++)
+            dst[x * 4 + c] = def;
+          continue;
+        }
+
+        const byte *channel = src + size_t(channelOffset[c]) * width;
+
+        if(channelHalf[c])
+        {
+          for(uint32_t x = 0; x < width; x++)
+          {
+            uint16_t val;
+            memcpy(&val, channel + x * sizeof(uint16_t), sizeof(val));
+            dst[x * 4 + c] = ConvertFromHalf(val);
+          }
+        }
+        else
+        {
+          for(uint32_t x = 0; x < width; x++)
+            memcpy(&dst[x * 4 + c], channel + x * sizeof(float), sizeof(float));
+        }
+      }
+
+      src += scanlineSize;
+    }
+  });
+
+  return Atomic::CmpExch32(&failed, 0, 0) == 0;
+}
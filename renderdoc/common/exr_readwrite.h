@@ -0,0 +1,43 @@
+/******************************************************************************
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014-2019 Baldur Karlsson
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+#pragma once
+
+#include <functional>
+#include "api/replay/renderdoc_replay.h"
+
+// fills in row y of the image as width RGBA floats, with y counting down from the top. This may be
+// called from several threads at once.
+typedef std::function<void(uint32_t y, float *rgba)> exr_row_callback;
+
+// writes an RGBA EXR with half or float channels. Blocks of scanlines are fetched and encoded in
+// parallel, and written out as they finish, so the whole image is never held in memory.
+extern bool write_exr_to_file(FILE *f, uint32_t width, uint32_t height, bool halfFloat,
+                              EXRCompression compression, exr_row_callback getRow);
+
+// decodes an uncompressed or ZIP compressed scanline EXR to RGBA floats, decoding blocks of
+// scanlines in parallel. Returns false for anything else (tiled, PIZ, channels other than R, G, B
+// and A, or unusual channel types), so that the caller can fall back to a general loader.
+extern bool load_exr_rgba(const byte *data, size_t size, uint32_t &width, uint32_t &height,
+                          std::vector<byte> &rgba);
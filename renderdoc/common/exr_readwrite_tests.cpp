@@ -0,0 +1,197 @@
+/******************************************************************************
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014-2019 Baldur Karlsson
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+#include "common/exr_readwrite.h"
+#include "common/common.h"
+#include "maths/half_convert.h"
+#include "os/os_specific.h"
+#include "strings/string_utils.h"
+
+#if ENABLED(ENABLE_UNIT_TESTS)
+
+#include "3rdparty/catch/catch.hpp"
+#include "tinyexr/tinyexr.h"
+
+static float TestPixel(uint32_t x, uint32_t y, uint32_t c)
+{
+  // values that are exactly representable as halfs
+  return float((x * 3 + y * 5 + c * 7) % 61) * 0.25f - 2.0f;
+}
+
+static std::vector<byte> WriteTestEXR(uint32_t width, uint32_t height, bool halfFloat,
+                                      EXRCompression compression)
+{
+  std::string path = StringFormat::Fmt("%s/rdoc_exr_test_%u.exr",
+                                       FileIO::GetTempFolderFilename().c_str(),
+                                       Process::GetCurrentPID());
+
+  FILE *f = FileIO::fopen(path.c_str(), "wb");
+  REQUIRE(f);
+  CHECK(write_exr_to_file(f, width, height, halfFloat, compression, [&](uint32_t y, float *rgba) {
+    for(uint32_t x = 0; x < width; x++)
+      for(uint32_t c = 0; c < 4; c++)
+        rgba[x * 4 + c] = TestPixel(x, y, c);
+  }));
+  FileIO::fclose(f);
+
+  std::vector<byte> contents;
+  FileIO::slurp(path.c_str(), contents);
+  FileIO::Delete(path.c_str());
+
+  return contents;
+}
+
+static void CheckTinyEXR(const std::vector<byte> &contents, uint32_t width, uint32_t height)
+{
+  EXRVersion exrVersion;
+  REQUIRE(ParseEXRVersionFromMemory(&exrVersion, contents.data(), contents.size()) == 0);
+
+  EXRHeader exrHeader;
+  InitEXRHeader(&exrHeader);
+  const char *err = NULL;
+  REQUIRE(ParseEXRHeaderFromMemory(&exrHeader, &exrVersion, contents.data(), contents.size(),
+                                   &err) == 0);
+
+  for(int i = 0; i < exrHeader.num_channels; i++)
+    exrHeader.requested_pixel_types[i] = TINYEXR_PIXELTYPE_FLOAT;
+
+  EXRImage exrImage;
+  InitEXRImage(&exrImage);
+  REQUIRE(LoadEXRImageFromMemory(&exrImage, &exrHeader, contents.data(), contents.size(), &err) ==
+          0);
+
+  CHECK(exrImage.width == (int)width);
+  CHECK(exrImage.height == (int)height);
+  REQUIRE(exrImage.num_channels == 4);
+
+  bool match = true;
+  for(int i = 0; i < exrHeader.num_channels; i++)
+  {
+    uint32_t c = exrHeader.channels[i].name[0] == 'R'
+                     ? 0
+                     : exrHeader.channels[i].name[0] == 'G'
+                           ? 1
+                           : exrHeader.channels[i].name[0] == 'B' ? 2 : 3;
+    const float *plane = (const float *)exrImage.images[i];
+    for(uint32_t y = 0; y < height; y++)
+      for(uint32_t x = 0; x < width; x++)
+        match &= (plane[y * width + x] == TestPixel(x, y, c));
+  }
+  CHECK(match);
+
+  FreeEXRImage(&exrImage);
+  FreeEXRHeader(&exrHeader);
+}
+
+TEST_CASE("Test EXR round trip", "[exr]")
+{
+  // odd size so the last ZIP block is partial
+  const uint32_t width = 37, height = 53;
+
+  for(EXRCompression compression : {EXRCompression::None, EXRCompression::ZIP})
+  {
+    for(bool halfFloat : {false, true})
+    {
+      std::vector<byte> contents = WriteTestEXR(width, height, halfFloat, compression);
+
+      uint32_t readWidth = 0, readHeight = 0;
+      std::vector<byte> rgba;
+      REQUIRE(load_exr_rgba(contents.data(), contents.size(), readWidth, readHeight, rgba));
+
+      CHECK(readWidth == width);
+      CHECK(readHeight == height);
+      REQUIRE(rgba.size() == width * height * 4 * sizeof(float));
+
+      const float *pixels = (const float *)rgba.data();
+      bool match = true;
+      for(uint32_t y = 0; y < height; y++)
+        for(uint32_t x = 0; x < width; x++)
+          for(uint32_t c = 0; c < 4; c++)
+            match &= (pixels[(y * width + x) * 4 + c] == TestPixel(x, y, c));
+      CHECK(match);
+
+      // files must be readable by other implementations, not just our own reader
+      CheckTinyEXR(contents, width, height);
+
+      // truncated files fail cleanly
+      contents.resize(contents.size() - 10);
+      CHECK_FALSE(load_exr_rgba(contents.data(), contents.size(), readWidth, readHeight, rgba));
+    }
+  }
+
+  SECTION("PIZ")
+  {
+    for(bool halfFloat : {false, true})
+    {
+      std::vector<byte> contents = WriteTestEXR(width, height, halfFloat, EXRCompression::PIZ);
+      CheckTinyEXR(contents, width, height);
+
+      // we don't decode PIZ ourselves
+      uint32_t readWidth = 0, readHeight = 0;
+      std::vector<byte> rgba;
+      CHECK_FALSE(load_exr_rgba(contents.data(), contents.size(), readWidth, readHeight, rgba));
+    }
+  };
+
+  SECTION("Layer channels")
+  {
+    const int numPixels = int(width * height);
+    std::vector<float> planes(numPixels * 4, 1.0f);
+    float *images[4] = {&planes[0], &planes[numPixels], &planes[numPixels * 2],
+                        &planes[numPixels * 3]};
+
+    EXRChannelInfo channels[4] = {
+        {"diffuse.A"}, {"diffuse.B"}, {"diffuse.G"}, {"diffuse.R"},
+    };
+    int pixTypes[4] = {TINYEXR_PIXELTYPE_FLOAT, TINYEXR_PIXELTYPE_FLOAT, TINYEXR_PIXELTYPE_FLOAT,
+                       TINYEXR_PIXELTYPE_FLOAT};
+
+    EXRHeader exrHeader;
+    InitEXRHeader(&exrHeader);
+    exrHeader.num_channels = 4;
+    exrHeader.channels = channels;
+    exrHeader.pixel_types = pixTypes;
+    exrHeader.requested_pixel_types = pixTypes;
+
+    EXRImage exrImage;
+    InitEXRImage(&exrImage);
+    exrImage.images = (unsigned char **)images;
+    exrImage.width = (int)width;
+    exrImage.height = (int)height;
+
+    unsigned char *mem = NULL;
+    const char *err = NULL;
+    size_t memSize = SaveEXRImageToMemory(&exrImage, &exrHeader, &mem, &err);
+    REQUIRE(memSize > 0);
+
+    // channels in a layer aren't plain RGBA, so they're left to tinyexr
+    uint32_t readWidth = 0, readHeight = 0;
+    std::vector<byte> rgba;
+    CHECK_FALSE(load_exr_rgba(mem, memSize, readWidth, readHeight, rgba));
+
+    free(mem);
+  };
+}
+
+#endif    // ENABLED(ENABLE_UNIT_TESTS)
@@ -0,0 +1,387 @@
+/******************************************************************************
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014-2019 Baldur Karlsson
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+#include "image_write.h"
+#include <math.h>
+#include "common/common.h"
+#include "common/threading.h"
+#include "miniz/miniz.h"
+#include "os/os_specific.h"
+
+// bands of rows are sized so each is worth handing to another thread, which also keeps the
+// compression lost by restarting the deflate stream per band negligible
+static const size_t minBandBytes = 256 * 1024;
+
+static uint32_t RowsPerBand(size_t rowBytes)
+{
+  return (uint32_t)RDCMAX(size_t(1), minBandBytes / RDCMAX(size_t(1), rowBytes));
+}
+
+static void AppendBytes(std::vector<byte> &out, const void *data, size_t size)
+{
+  const byte *bytes = (const byte *)data;
+  out.insert(out.end(), bytes, bytes + size);
+}
+
+static void AppendBE32(std::vector<byte> &out, uint32_t val)
+{
+  byte bytes[4] = {byte(val >> 24), byte(val >> 16), byte(val >> 8), byte(val)};
+  AppendBytes(out, bytes, 4);
+}
+
+static byte Paeth(int a, int b, int c)
+{
+  int p = a + b - c;
+  int pa = abs(p - a);
+  int pb = abs(p - b);
+  int pc = abs(p - c);
+  if(pa <= pb && pa <= pc)
+    return byte(a);
+  if(pb <= pc)
+    return byte(b);
+  return byte(c);
+}
+
+// filters a row with the given PNG filter type. prev is NULL for the first row
+static void FilterPNGRow(int type, const byte *row, const byte *prev, size_t rowBytes,
+                         uint32_t bpp, byte *out)
+{
+  for(size_t i = 0; i < rowBytes; i++)
+  {
+    int a = i >= bpp ? row[i - bpp] : 0;
+    int b = prev ? prev[i] : 0;
+    int c = prev && i >= bpp ? prev[i - bpp] : 0;
+
+    switch(type)
+    {
+      default:
+      case 0: out[i] = row[i]; break;
+      case 1: out[i] = byte(row[i] - a); break;
+      case 2: out[i] = byte(row[i] - b); break;
+      case 3: out[i] = byte(row[i] - ((a + b) >> 1)); break;
+      case 4: out[i] = byte(row[i] - Paeth(a, b, c)); break;
+    }
+  }
+}
+
+// combines the adler-32 of two buffers into that of both together, len2 being the second's length
+static uint32_t Adler32Combine(uint32_t adler1, uint32_t adler2, uint64_t len2)
+{
+  const uint32_t base = 65521;
+
+  uint32_t rem = uint32_t(len2 % base);
+  uint32_t sum1 = adler1 & 0xffff;
+  uint32_t sum2 = uint32_t((uint64_t(rem) * sum1) % base);
+  sum1 += (adler2 & 0xffff) + base - 1;
+  sum2 += ((adler1 >> 16) & 0xffff) + ((adler2 >> 16) & 0xffff) + base - rem;
+  if(sum1 >= base)
+    sum1 -= base;
+  if(sum1 >= base)
+    sum1 -= base;
+  if(sum2 >= (base << 1))
+    sum2 -= (base << 1);
+  if(sum2 >= base)
+    sum2 -= base;
+  return sum1 | (sum2 << 16);
+}
+
+static bool WritePNGChunk(FILE *f, const char *type, const byte *data, size_t size)
+{
+  std::vector<byte> header;
+  AppendBE32(header, (uint32_t)size);
+  AppendBytes(header, type, 4);
+
+  mz_ulong crc = mz_crc32(MZ_CRC32_INIT, (const byte *)type, 4);
+  crc = mz_crc32(crc, data, size);
+
+  std::vector<byte> footer;
+  AppendBE32(footer, (uint32_t)crc);
+
+  bool success = FileIO::fwrite(header.data(), 1, header.size(), f) == header.size();
+  if(size > 0)
+    success &= FileIO::fwrite(data, 1, size, f) == size;
+  success &= FileIO::fwrite(footer.data(), 1, footer.size(), f) == footer.size();
+  return success;
+}
+
+bool write_png_to_file(FILE *f, uint32_t width, uint32_t height, uint32_t numComps,
+                       const byte *data, uint32_t rowPitch)
+{
+  if(numComps < 1 || numComps > 4 || width == 0 || height == 0)
+    return false;
+
+  const size_t rowBytes = size_t(width) * numComps;
+  const uint32_t rowsPerBand = RowsPerBand(rowBytes + 1);
+  const uint32_t numBands = (height + rowsPerBand - 1) / rowsPerBand;
+
+  // each band is deflated on its own. All but the last end on a full flush so they're byte aligned
+  // and don't refer back into the previous band, which makes them valid to concatenate.
+  struct Band
+  {
+    std::vector<byte> deflated;
+    uint32_t adler;
+    uint64_t length;
+    bool success;
+  };
+
+  std::vector<Band> bands(numBands);
+
+  Threading::ParallelFor(numBands, [&](uint32_t b) {
+    const uint32_t firstRow = b * rowsPerBand;
+    const uint32_t endRow = RDCMIN(height, firstRow + rowsPerBand);
+
+    std::vector<byte> filtered((endRow - firstRow) * (rowBytes + 1));
+    std::vector<byte> candidate(rowBytes);
+
+    byte *out = filtered.data();
+    for(uint32_t y = firstRow; y < endRow; y++)
+    {
+      const byte *row = data + size_t(y) * rowPitch;
+      const byte *prev = y > 0 ? row - rowPitch : NULL;
+
+      // pick the filter with the smallest sum of absolute differences, the usual heuristic
+      int bestType = 0;
+      uint64_t bestScore = ~0ULL;
+      for(int type = 0; type < 5; type++)
+      {
+        FilterPNGRow(type, row, prev, rowBytes, numComps, candidate.data());
+
+        uint64_t score = 0;
+        for(size_t i = 0; i < rowBytes; i++)
+          score += (uint64_t)abs((int8_t)candidate[i]);
+
+        if(score < bestScore)
+        {
+          bestScore = score;
+          bestType = type;
+        }
+      }
+
+      out[0] = byte(bestType);
+      FilterPNGRow(bestType, row, prev, rowBytes, numComps, out + 1);
+      out += rowBytes + 1;
+    }
+
+    Band &band = bands[b];
+    band.length = filtered.size();
+    band.adler = (uint32_t)mz_adler32(MZ_ADLER32_INIT, filtered.data(), filtered.size());
+
+    const bool last = (b + 1 == numBands);
+
+    mz_stream stream = {};
+    band.success = mz_deflateInit2(&stream, MZ_DEFAULT_LEVEL, MZ_DEFLATED, -MZ_DEFAULT_WINDOW_BITS,
+                                   9, MZ_DEFAULT_STRATEGY) == MZ_OK;
+
+    if(band.success)
+    {
+      // the bound doesn't include the flush's empty stored block
+      band.deflated.resize(mz_deflateBound(&stream, (mz_ulong)filtered.size()) + 64);
+
+      stream.next_in = filtered.data();
+      stream.avail_in = (unsigned int)filtered.size();
+      stream.next_out = band.deflated.data();
+      stream.avail_out = (unsigned int)band.deflated.size();
+
+      int ret = mz_deflate(&stream, last ? MZ_FINISH : MZ_FULL_FLUSH);
+      band.success = (last ? ret == MZ_STREAM_END : ret == MZ_OK) && stream.avail_in == 0;
+      band.deflated.resize(stream.total_out);
+
+      mz_deflateEnd(&stream);
+    }
+  });
+
+  static const byte png_magic[] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n'};
+  // colour types for grey, grey & alpha, RGB and RGBA
+  static const byte png_colourtype[] = {0, 4, 2, 6};
+
+  std::vector<byte> ihdr;
+  AppendBE32(ihdr, width);
+  AppendBE32(ihdr, height);
+  ihdr.push_back(8);
+  ihdr.push_back(png_colourtype[numComps - 1]);
+  ihdr.push_back(0);    // deflate
+  ihdr.push_back(0);    // adaptive filtering
+  ihdr.push_back(0);    // not interlaced
+
+  bool success = FileIO::fwrite(png_magic, 1, sizeof(png_magic), f) == sizeof(png_magic);
+  success &= WritePNGChunk(f, "IHDR", ihdr.data(), ihdr.size());
+
+  // the zlib stream is split over several IDAT chunks, which readers join back together: the zlib
+  // header, each band, then the adler-32 of all the filtered data.
+  const byte zlibHeader[] = {0x78, 0x9c};
+  success &= WritePNGChunk(f, "IDAT", zlibHeader, sizeof(zlibHeader));
+
+  uint32_t adler = MZ_ADLER32_INIT;
+  for(const Band &band : bands)
+  {
+    success &= band.success;
+    if(!success)
+      break;
+
+    success &= WritePNGChunk(f, "IDAT", band.deflated.data(), band.deflated.size());
+    adler = Adler32Combine(adler, band.adler, band.length);
+  }
+
+  std::vector<byte> zlibFooter;
+  AppendBE32(zlibFooter, adler);
+  success &= WritePNGChunk(f, "IDAT", zlibFooter.data(), zlibFooter.size());
+  success &= WritePNGChunk(f, "IEND", NULL, 0);
+
+  if(!success)
+    RDCERR("Error writing PNG file");
+
+  return success;
+}
+
+static void LinearToRGBE(const float *rgb, byte *rgbe)
+{
+  float maxcomp = RDCMAX(rgb[0], RDCMAX(rgb[1], rgb[2]));
+
+  if(maxcomp < 1e-32f)
+  {
+    rgbe[0] = rgbe[1] = rgbe[2] = rgbe[3] = 0;
+  }
+  else
+  {
+    int exponent = 0;
+    float normalize = frexpf(maxcomp, &exponent) * 256.0f / maxcomp;
+
+    rgbe[0] = byte(rgb[0] * normalize);
+    rgbe[1] = byte(rgb[1] * normalize);
+    rgbe[2] = byte(rgb[2] * normalize);
+    rgbe[3] = byte(exponent + 128);
+  }
+}
+
+// run-length encodes one channel of a scanline. Runs of 3 or more are stored as a count over 128
+// and the byte, anything else as a count of up to 128 literal bytes.
+static void EncodeHDRChannel(const byte *channel, uint32_t width, std::vector<byte> &out)
+{
+  uint32_t x = 0;
+  while(x < width)
+  {
+    // find where the next run starts
+    uint32_t run = x;
+    while(run + 2 < width &&
+          !(channel[run] == channel[run + 1] && channel[run] == channel[run + 2]))
+      run++;
+    if(run + 2 >= width)
+      run = width;
+
+    while(x < run)
+    {
+      uint32_t len = RDCMIN(run - x, 128U);
+      out.push_back(byte(len));
+      AppendBytes(out, channel + x, len);
+      x += len;
+    }
+
+    if(run < width)
+    {
+      uint32_t end = run;
+      while(end < width && channel[end] == channel[run])
+        end++;
+
+      while(x < end)
+      {
+        uint32_t len = RDCMIN(end - x, 127U);
+        out.push_back(byte(len + 128));
+        out.push_back(channel[x]);
+        x += len;
+      }
+    }
+  }
+}
+
+bool write_hdr_to_file(FILE *f, uint32_t width, uint32_t height, exr_row_callback getRow)
+{
+  if(width == 0 || height == 0)
+    return false;
+
+  // scanlines can only be run-length encoded within these widths, otherwise they're stored flat
+  const bool rle = width >= 8 && width < 32768;
+
+  const uint32_t rowsPerBand = RowsPerBand(size_t(width) * 4 * sizeof(float));
+  const uint32_t numBands = (height + rowsPerBand - 1) / rowsPerBand;
+
+  std::string header = StringFormat::Fmt(
+      "#?RADIANCE\nFORMAT=32-bit_rle_rgbe\n\n-Y %u +X %u\n", height, width);
+
+  bool success = FileIO::fwrite(header.c_str(), 1, header.size(), f) == header.size();
+
+  // encode a batch of bands in parallel, then write them out in order before moving on so that
+  // only a batch is ever in memory.
+  const uint32_t bandsPerBatch = Threading::GetNumberOfCores() * 2;
+  std::vector<std::vector<byte>> bands(bandsPerBatch);
+
+  for(uint32_t batch = 0; batch < numBands && success; batch += bandsPerBatch)
+  {
+    const uint32_t count = RDCMIN(bandsPerBatch, numBands - batch);
+
+    Threading::ParallelFor(count, [&](uint32_t i) {
+      const uint32_t firstRow = (batch + i) * rowsPerBand;
+      const uint32_t endRow = RDCMIN(height, firstRow + rowsPerBand);
+
+      std::vector<float> rgba(width * 4);
+      std::vector<byte> rgbe(width * 4);
+      std::vector<byte> channel(width);
+
+      std::vector<byte> &out = bands[i];
+      out.clear();
+
+      for(uint32_t y = firstRow; y < endRow; y++)
+      {
+        getRow(y, rgba.data());
+
+        for(uint32_t x = 0; x < width; x++)
+          LinearToRGBE(&rgba[x * 4], &rgbe[x * 4]);
+
+        if(!rle)
+        {
+          AppendBytes(out, rgbe.data(), rgbe.size());
+          continue;
+        }
+
+        const byte scanlineHeader[] = {2, 2, byte(width >> 8), byte(width & 0xff)};
+        AppendBytes(out, scanlineHeader, sizeof(scanlineHeader));
+
+        for(uint32_t c = 0; c < 4; c++)
+        {
+          for(uint32_t x = 0; x < width; x++)
+            channel[x] = rgbe[x * 4 + c];
+
+          EncodeHDRChannel(channel.data(), width, out);
+        }
+      }
+    });
+
+    for(uint32_t i = 0; i < count; i++)
+      success &= FileIO::fwrite(bands[i].data(), 1, bands[i].size(), f) == bands[i].size();
+  }
+
+  if(!success)
+    RDCERR("Error writing HDR file");
+
+  return success;
+}
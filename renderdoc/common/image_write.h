@@ -0,0 +1,37 @@
+/******************************************************************************
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014-2019 Baldur Karlsson
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+#pragma once
+
+#include "exr_readwrite.h"
+
+// writes an 8-bit PNG with numComps channels (grey, grey & alpha, RGB or RGBA) from rows that are
+// rowPitch bytes apart. Bands of rows are filtered and deflated in parallel, then joined into one
+// zlib stream.
+extern bool write_png_to_file(FILE *f, uint32_t width, uint32_t height, uint32_t numComps,
+                              const byte *data, uint32_t rowPitch);
+
+// writes a run-length encoded Radiance HDR, ignoring alpha. As with EXRs, rows are fetched with
+// getRow and bands of them are encoded in parallel.
+extern bool write_hdr_to_file(FILE *f, uint32_t width, uint32_t height, exr_row_callback getRow);
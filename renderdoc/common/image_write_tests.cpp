@@ -0,0 +1,167 @@
+/******************************************************************************
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014-2019 Baldur Karlsson
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+#include "common/image_write.h"
+#include "common/common.h"
+#include "os/os_specific.h"
+#include "strings/string_utils.h"
+
+#if ENABLED(ENABLE_UNIT_TESTS)
+
+#include "3rdparty/catch/catch.hpp"
+#include "stb/stb_image.h"
+#include "stb/stb_image_write.h"
+
+static std::vector<byte> WriteTestImage(std::function<bool(FILE *)> write)
+{
+  std::string path = StringFormat::Fmt("%s/rdoc_image_test_%u.img",
+                                       FileIO::GetTempFolderFilename().c_str(),
+                                       Process::GetCurrentPID());
+
+  FILE *f = FileIO::fopen(path.c_str(), "wb");
+  REQUIRE(f);
+  CHECK(write(f));
+  FileIO::fclose(f);
+
+  std::vector<byte> contents;
+  FileIO::slurp(path.c_str(), contents);
+  FileIO::Delete(path.c_str());
+
+  return contents;
+}
+
+static void appendFunc(void *context, void *data, int size)
+{
+  std::vector<byte> &out = *(std::vector<byte> *)context;
+  out.insert(out.end(), (byte *)data, (byte *)data + size);
+}
+
+TEST_CASE("Test PNG writing", "[image]")
+{
+  // a single band, and one large enough to be split into several bands
+  for(uint32_t width : {37U, 1031U})
+  {
+    const uint32_t height = width == 37 ? 53 : 517;
+
+    for(uint32_t numComps = 1; numComps <= 4; numComps++)
+    {
+      // padded rows, with noise and flat areas so every filter type is useful somewhere
+      const uint32_t rowPitch = width * numComps + 13;
+      std::vector<byte> pixels(rowPitch * height);
+
+      uint32_t rng = 12345 + numComps;
+      for(uint32_t y = 0; y < height; y++)
+      {
+        for(uint32_t x = 0; x < width * numComps; x++)
+        {
+          rng = rng * 1103515245 + 12345;
+          byte &p = pixels[y * rowPitch + x];
+          if((y / 16) % 3 == 0)
+            p = byte(rng >> 16);
+          else if((y / 16) % 3 == 1)
+            p = byte(x / 7 + y);
+          else
+            p = 0x80;
+        }
+      }
+
+      std::vector<byte> contents = WriteTestImage([&](FILE *f) {
+        return write_png_to_file(f, width, height, numComps, pixels.data(), rowPitch);
+      });
+
+      int w = 0, h = 0, comp = 0;
+      byte *decoded = stbi_load_from_memory(contents.data(), (int)contents.size(), &w, &h, &comp,
+                                            (int)numComps);
+      REQUIRE(decoded);
+
+      CHECK(w == (int)width);
+      CHECK(h == (int)height);
+      CHECK(comp == (int)numComps);
+
+      bool match = true;
+      for(uint32_t y = 0; y < height; y++)
+        match &= memcmp(decoded + y * width * numComps, &pixels[y * rowPitch],
+                        width * numComps) == 0;
+      CHECK(match);
+
+      stbi_image_free(decoded);
+    }
+  }
+}
+
+TEST_CASE("Test HDR writing", "[image]")
+{
+  // too narrow to run-length encode, and wide enough to be split into several bands
+  for(uint32_t width : {5U, 2053U})
+  {
+    const uint32_t height = 67;
+
+    auto getRow = [width](uint32_t y, float *rgba) {
+      for(uint32_t x = 0; x < width; x++)
+      {
+        for(uint32_t c = 0; c < 4; c++)
+        {
+          // runs of repeated pixels, ramps, zeroes and large values
+          float &v = rgba[x * 4 + c];
+          if((x / 40) % 3 == 0)
+            v = float(y) * 0.5f;
+          else if((x / 40) % 3 == 1)
+            v = float((x * 3 + y * 5 + c * 7) % 61) * 0.25f;
+          else
+            v = (c == 0 && x % 2) ? 1.0e5f : 0.0f;
+        }
+      }
+    };
+
+    std::vector<byte> contents =
+        WriteTestImage([&](FILE *f) { return write_hdr_to_file(f, width, height, getRow); });
+
+    // stb's own writer gives the reference, since RGBE is lossy
+    std::vector<float> rgba(width * height * 4);
+    for(uint32_t y = 0; y < height; y++)
+      getRow(y, &rgba[y * width * 4]);
+
+    std::vector<byte> reference;
+    REQUIRE(stbi_write_hdr_to_func(&appendFunc, &reference, width, height, 4, rgba.data()));
+
+    int w = 0, h = 0, comp = 0;
+    float *decoded =
+        stbi_loadf_from_memory(contents.data(), (int)contents.size(), &w, &h, &comp, 4);
+    REQUIRE(decoded);
+
+    int refw = 0, refh = 0, refcomp = 0;
+    float *expected =
+        stbi_loadf_from_memory(reference.data(), (int)reference.size(), &refw, &refh, &refcomp, 4);
+    REQUIRE(expected);
+
+    CHECK(w == (int)width);
+    CHECK(h == (int)height);
+    CHECK(memcmp(decoded, expected, width * height * 4 * sizeof(float)) == 0);
+
+    stbi_image_free(decoded);
+    stbi_image_free(expected);
+  }
+}
+
+#endif    // ENABLED(ENABLE_UNIT_TESTS)
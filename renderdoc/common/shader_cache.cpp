@@ -0,0 +1,230 @@
+/******************************************************************************
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2019 Baldur Karlsson
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+#include "shader_cache.h"
+#include <algorithm>
+#include "common/common.h"
+#include "strings/string_utils.h"
+
+#include "3rdparty/zstd/xxhash.h"
+
+static const uint32_t ShaderDiskCacheMagic = MAKE_FOURCC('R', 'D', 'S', 'C');
+
+// temporary files older than this are left over from a crashed writer and can be removed
+static const uint64_t StaleTempFileSeconds = 60 * 60;
+
+struct ShaderDiskCacheEntryHeader
+{
+  uint32_t magic;
+  uint32_t version;
+  ShaderCacheKey key;
+  uint64_t size;
+  uint64_t checksum;
+};
+
+ShaderCacheHasher::ShaderCacheHasher()
+{
+  for(int i = 0; i < 2; i++)
+  {
+    XXH64_state_t *state = XXH64_createState();
+    // use different seeds so the two halves are independent
+    XXH64_reset(state, i == 0 ? 0 : 0x9E3779B97F4A7C15ULL);
+    m_State[i] = state;
+  }
+}
+
+ShaderCacheHasher::~ShaderCacheHasher()
+{
+  for(int i = 0; i < 2; i++)
+    XXH64_freeState((XXH64_state_t *)m_State[i]);
+}
+
+void ShaderCacheHasher::Add(const void *data, size_t size)
+{
+  uint64_t len = size;
+
+  for(int i = 0; i < 2; i++)
+  {
+    XXH64_update((XXH64_state_t *)m_State[i], &len, sizeof(len));
+    if(size > 0)
+      XXH64_update((XXH64_state_t *)m_State[i], data, size);
+  }
+}
+
+ShaderCacheKey ShaderCacheHasher::Finish() const
+{
+  ShaderCacheKey ret;
+  for(int i = 0; i < 2; i++)
+    ret.hash[i] = XXH64_digest((XXH64_state_t *)m_State[i]);
+  return ret;
+}
+
+ShaderDiskCache::ShaderDiskCache(const std::string &directory, uint32_t version, uint64_t maxSize)
+    : m_Version(version), m_MaxSize(maxSize)
+{
+  m_Directory = StringFormat::Fmt("%s/v%u", directory.c_str(), version);
+
+  FileIO::CreateParentDirectory(m_Directory + "/entry");
+}
+
+std::string ShaderDiskCache::GetEntryFilename(const ShaderCacheKey &key) const
+{
+  return StringFormat::Fmt("%s/%016llx%016llx.shader", m_Directory.c_str(), key.hash[0],
+                           key.hash[1]);
+}
+
+bool ShaderDiskCache::Load(const ShaderCacheKey &key, std::vector<byte> &data)
+{
+  std::string filename = GetEntryFilename(key);
+
+  FILE *f = FileIO::fopen(filename.c_str(), "rb");
+
+  // another process may have just evicted it, which is the same as a miss
+  if(!f)
+    return false;
+
+  ShaderDiskCacheEntryHeader header = {};
+  bool valid = FileIO::fread(&header, 1, sizeof(header), f) == sizeof(header);
+
+  valid = valid && header.magic == ShaderDiskCacheMagic && header.version == m_Version &&
+          header.key == key;
+
+  if(valid)
+  {
+    FileIO::fseek64(f, 0, SEEK_END);
+    valid = FileIO::ftell64(f) == sizeof(header) + header.size;
+    FileIO::fseek64(f, sizeof(header), SEEK_SET);
+  }
+
+  if(valid)
+  {
+    data.resize((size_t)header.size);
+    valid = FileIO::fread(data.data(), 1, data.size(), f) == data.size() &&
+            XXH64(data.data(), data.size(), 0) == header.checksum;
+  }
+
+  FileIO::fclose(f);
+
+  if(!valid)
+  {
+    RDCWARN("Discarding corrupt shader cache entry %s", filename.c_str());
+    data.clear();
+    FileIO::Delete(filename.c_str());
+    return false;
+  }
+
+  // mark it as recently used for eviction
+  FileIO::UpdateModifiedTimestamp(filename);
+
+  return true;
+}
+
+void ShaderDiskCache::Store(const ShaderCacheKey &key, const void *data, size_t size)
+{
+  std::string filename = GetEntryFilename(key);
+
+  // write to a file unique to this process and thread, so that concurrent writers never see each
+  // other's partial data, then move it into place.
+  std::string tempname = StringFormat::Fmt("%s.%u.%llu.tmp", filename.c_str(),
+                                           Process::GetCurrentPID(), Threading::GetCurrentID());
+
+  FILE *f = FileIO::fopen(tempname.c_str(), "wb");
+
+  if(!f)
+  {
+    RDCWARN("Couldn't open shader cache entry %s for write", tempname.c_str());
+    return;
+  }
+
+  ShaderDiskCacheEntryHeader header = {};
+  header.magic = ShaderDiskCacheMagic;
+  header.version = m_Version;
+  header.key = key;
+  header.size = size;
+  header.checksum = XXH64(data, size, 0);
+
+  bool success = FileIO::fwrite(&header, 1, sizeof(header), f) == sizeof(header) &&
+                 FileIO::fwrite(data, 1, size, f) == size;
+
+  FileIO::fclose(f);
+
+  // if another process wrote the same entry first the contents are identical, so it doesn't matter
+  // which one wins.
+  if(!success || !FileIO::Move(tempname.c_str(), filename.c_str(), true))
+    FileIO::Delete(tempname.c_str());
+}
+
+void ShaderDiskCache::Trim()
+{
+  std::vector<PathEntry> files = FileIO::GetFilesInDirectory(m_Directory.c_str());
+
+  uint64_t now = Timing::GetUnixTimestamp();
+
+  std::vector<PathEntry> entries;
+  uint64_t totalSize = 0;
+
+  for(const PathEntry &file : files)
+  {
+    if(file.flags & (PathProperty::Directory | PathProperty::ErrorAccessDenied |
+                     PathProperty::ErrorInvalidPath))
+      continue;
+
+    std::string name = file.filename;
+
+    if(endswith(name, ".tmp"))
+    {
+      if(file.lastmod + StaleTempFileSeconds < now)
+        FileIO::Delete((m_Directory + "/" + name).c_str());
+    }
+    else if(endswith(name, ".shader"))
+    {
+      entries.push_back(file);
+      totalSize += file.size;
+    }
+  }
+
+  if(totalSize <= m_MaxSize)
+    return;
+
+  // oldest first
+  std::sort(entries.begin(), entries.end(),
+            [](const PathEntry &a, const PathEntry &b) { return a.lastmod < b.lastmod; });
+
+  // trim a bit below the limit so we don't end up evicting on every run
+  uint64_t target = m_MaxSize - m_MaxSize / 4;
+
+  uint32_t numEvicted = 0;
+
+  for(const PathEntry &entry : entries)
+  {
+    if(totalSize <= target)
+      break;
+
+    FileIO::Delete((m_Directory + "/" + entry.filename).c_str());
+    totalSize -= entry.size;
+    numEvicted++;
+  }
+
+  RDCDEBUG("Evicted %u entries from shader cache %s", numEvicted, m_Directory.c_str());
+}
@@ -183,3 +183,64 @@ void SaveShaderCache(const char *filename, uint32_t magicNumber, uint32_t versio
 
   RDCDEBUG("Successfully wrote %u shaders to shader cache", numentries);
 }
+
+// 128-bit content hash identifying a compiled shader. It should cover everything that affects the
+// compiled result - source, compile settings and compiler version - so that entries written by a
+// different build are never returned.
+struct ShaderCacheKey
+{
+  uint64_t hash[2];
+
+  bool operator==(const ShaderCacheKey &o) const
+  {
+    return hash[0] == o.hash[0] && hash[1] == o.hash[1];
+  }
+  bool operator<(const ShaderCacheKey &o) const
+  {
+    if(hash[0] != o.hash[0])
+      return hash[0] < o.hash[0];
+    return hash[1] < o.hash[1];
+  }
+};
+
+class ShaderCacheHasher
+{
+public:
+  ShaderCacheHasher();
+  ~ShaderCacheHasher();
+
+  // each added element is length-prefixed, so adding "ab","c" and "a","bc" produces different keys
+  void Add(const void *data, size_t size);
+  void Add(const std::string &str) { Add(str.c_str(), str.size()); }
+  void Add(uint32_t val) { Add(&val, sizeof(val)); }
+  ShaderCacheKey Finish() const;
+
+  // no copying
+  ShaderCacheHasher(const ShaderCacheHasher &) = delete;
+  ShaderCacheHasher &operator=(const ShaderCacheHasher &) = delete;
+
+private:
+  void *m_State[2];
+};
+
+// On-disk shader cache with one file per entry, stored in a directory per cache version. Entries
+// are only read from disk when they're looked up, and each one is written to a temporary file then
+// renamed into place so several processes can share the same cache. Lookups refresh an entry's
+// timestamp, and Trim() deletes the least recently used entries once the cache exceeds its size.
+class ShaderDiskCache
+{
+public:
+  ShaderDiskCache(const std::string &directory, uint32_t version, uint64_t maxSize);
+
+  bool Load(const ShaderCacheKey &key, std::vector<byte> &data);
+  void Store(const ShaderCacheKey &key, const void *data, size_t size);
+  void Trim();
+
+  const std::string &GetDirectory() const { return m_Directory; }
+private:
+  std::string GetEntryFilename(const ShaderCacheKey &key) const;
+
+  std::string m_Directory;
+  uint32_t m_Version;
+  uint64_t m_MaxSize;
+};
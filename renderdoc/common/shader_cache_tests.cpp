@@ -0,0 +1,150 @@
+/******************************************************************************
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2019 Baldur Karlsson
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+#include "common/shader_cache.h"
+#include "common/common.h"
+#include "strings/string_utils.h"
+
+#if ENABLED(ENABLE_UNIT_TESTS)
+
+#include "3rdparty/catch/catch.hpp"
+
+static ShaderCacheKey HashStrings(const std::vector<std::string> &strs)
+{
+  ShaderCacheHasher hasher;
+  for(const std::string &s : strs)
+    hasher.Add(s);
+  return hasher.Finish();
+}
+
+static uint32_t CountEntries(const std::string &dir)
+{
+  uint32_t ret = 0;
+  for(const PathEntry &f : FileIO::GetFilesInDirectory(dir.c_str()))
+    if(endswith(f.filename, ".shader"))
+      ret++;
+  return ret;
+}
+
+static void ClearDirectory(const std::string &dir)
+{
+  for(const PathEntry &f : FileIO::GetFilesInDirectory(dir.c_str()))
+    if(!(f.flags & PathProperty::Directory))
+      FileIO::Delete((dir + "/" + f.filename).c_str());
+}
+
+TEST_CASE("Test shader cache keys", "[shadercache]")
+{
+  ShaderCacheKey a = HashStrings({"void main() {}", "frag"});
+
+  CHECK((a == HashStrings({"void main() {}", "frag"})));
+  CHECK_FALSE((a == HashStrings({"void main() {}", "vert"})));
+  CHECK_FALSE((a == HashStrings({"void main() {}frag"})));
+  CHECK_FALSE((HashStrings({"ab", "c"}) == HashStrings({"a", "bc"})));
+
+  // the two halves are independent
+  CHECK(a.hash[0] != a.hash[1]);
+};
+
+TEST_CASE("Test shader disk cache", "[shadercache]")
+{
+  std::string root = StringFormat::Fmt("%s/rdoc_shadercache_test_%u",
+                                       FileIO::GetTempFolderFilename().c_str(),
+                                       Process::GetCurrentPID());
+
+  ShaderDiskCache cache(root, 1, 4096);
+  std::string dir = cache.GetDirectory();
+  ClearDirectory(dir);
+
+  std::vector<byte> blob;
+  blob.resize(1000);
+  for(size_t i = 0; i < blob.size(); i++)
+    blob[i] = byte(i * 7);
+
+  ShaderCacheKey key = HashStrings({"shader"});
+  ShaderCacheKey other = HashStrings({"other shader"});
+
+  SECTION("Round trip")
+  {
+    std::vector<byte> data;
+    CHECK_FALSE(cache.Load(key, data));
+
+    cache.Store(key, blob.data(), blob.size());
+
+    CHECK(cache.Load(key, data));
+    CHECK(data == blob);
+
+    CHECK_FALSE(cache.Load(other, data));
+
+    // a second cache on the same directory sees the entry
+    ShaderDiskCache cache2(root, 1, 4096);
+    CHECK(cache2.Load(key, data));
+    CHECK(data == blob);
+
+    // but a different version doesn't
+    ShaderDiskCache cache3(root, 2, 4096);
+    CHECK_FALSE(cache3.Load(key, data));
+    ClearDirectory(cache3.GetDirectory());
+  };
+
+  SECTION("Corrupt entries are discarded")
+  {
+    cache.Store(key, blob.data(), blob.size());
+    CHECK(CountEntries(dir) == 1);
+
+    // truncate the entry
+    std::string filename;
+    for(const PathEntry &f : FileIO::GetFilesInDirectory(dir.c_str()))
+      if(endswith(f.filename, ".shader"))
+        filename = dir + "/" + f.filename;
+
+    FileIO::dump(filename.c_str(), blob.data(), 100);
+
+    std::vector<byte> data;
+    CHECK_FALSE(cache.Load(key, data));
+    CHECK(CountEntries(dir) == 0);
+  };
+
+  SECTION("Trim evicts down below the size limit")
+  {
+    for(uint32_t i = 0; i < 10; i++)
+      cache.Store(HashStrings({"shader", ToStr(i)}), blob.data(), blob.size());
+
+    CHECK(CountEntries(dir) == 10);
+
+    cache.Trim();
+
+    uint64_t totalSize = 0;
+    for(const PathEntry &f : FileIO::GetFilesInDirectory(dir.c_str()))
+      totalSize += f.size;
+
+    CHECK(totalSize <= 4096);
+    CHECK(CountEntries(dir) > 0);
+    CHECK(CountEntries(dir) < 10);
+  };
+
+  ClearDirectory(dir);
+};
+
+#endif    // ENABLED(ENABLE_UNIT_TESTS)
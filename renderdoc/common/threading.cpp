@@ -0,0 +1,208 @@
+/******************************************************************************
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2019 Baldur Karlsson
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+#include "common/threading.h"
+#include <algorithm>
+#include "common/common.h"
+
+namespace Threading
+{
+struct ParallelJob
+{
+  std::function<void(uint32_t)> *func = NULL;
+  uint32_t count = 0;
+
+  // how many pool threads may help the calling thread, and how many have so far
+  uint32_t maxHelpers = 0;
+  uint32_t helpers = 0;
+
+  volatile int32_t next = -1;
+
+  // woken once by each helper when it's done
+  Semaphore finished;
+
+  void Run()
+  {
+    for(;;)
+    {
+      int32_t idx = Atomic::Inc32(&next);
+      if(idx >= (int32_t)count)
+        break;
+      (*func)((uint32_t)idx);
+    }
+  }
+};
+
+struct WorkerPool
+{
+  CriticalSection lock;
+  Semaphore wake;
+
+  std::vector<ThreadHandle> threads;
+  // jobs that are still being run, innermost last if they're nested
+  std::vector<ParallelJob *> jobs;
+  bool shutdown = false;
+
+  volatile int32_t running = 0;
+
+  void Work()
+  {
+    for(;;)
+    {
+      wake.Wait();
+
+      ParallelJob *job = NULL;
+
+      {
+        SCOPED_LOCK(lock);
+
+        if(shutdown)
+          break;
+
+        for(size_t i = jobs.size(); i > 0; i--)
+        {
+          if(jobs[i - 1]->helpers < jobs[i - 1]->maxHelpers)
+          {
+            job = jobs[i - 1];
+            job->helpers++;
+            break;
+          }
+        }
+      }
+
+      // we may have been woken for a job that's already finished
+      if(job)
+      {
+        job->Run();
+        job->finished.Wake(1);
+      }
+    }
+
+    // nothing in the pool can be touched after this
+    Atomic::Dec32(&running);
+  }
+};
+
+static CriticalSection poolLock;
+static WorkerPool *pool = NULL;
+static bool poolShutdown = false;
+
+static WorkerPool *GetWorkerPool()
+{
+  SCOPED_LOCK(poolLock);
+
+  if(pool == NULL && !poolShutdown)
+  {
+    WorkerPool *p = new WorkerPool;
+
+    // the thread calling ParallelFor always takes part, so one fewer than the number of cores
+    p->threads.resize(GetNumberOfCores() - 1);
+    p->running = (int32_t)p->threads.size();
+
+    for(ThreadHandle &t : p->threads)
+      t = CreateThread([p]() { p->Work(); });
+
+    pool = p;
+  }
+
+  return pool;
+}
+
+void ParallelFor(uint32_t count, std::function<void(uint32_t)> func, uint32_t maxThreads)
+{
+  if(maxThreads == 0)
+    maxThreads = GetNumberOfCores();
+
+  uint32_t numThreads = maxThreads < count ? maxThreads : count;
+
+  WorkerPool *p = numThreads > 1 ? GetWorkerPool() : NULL;
+
+  if(p == NULL || p->threads.empty())
+  {
+    for(uint32_t i = 0; i < count; i++)
+      func(i);
+    return;
+  }
+
+  ParallelJob job;
+  job.func = &func;
+  job.count = count;
+  job.maxHelpers = RDCMIN(numThreads - 1, (uint32_t)p->threads.size());
+
+  {
+    SCOPED_LOCK(p->lock);
+    p->jobs.push_back(&job);
+  }
+
+  p->wake.Wake(job.maxHelpers);
+
+  job.Run();
+
+  // once the job is out of the list no more helpers can join, so we know how many to wait for
+  uint32_t helpers = 0;
+  {
+    SCOPED_LOCK(p->lock);
+    p->jobs.erase(std::find(p->jobs.begin(), p->jobs.end(), &job));
+    helpers = job.helpers;
+  }
+
+  for(uint32_t i = 0; i < helpers; i++)
+    job.finished.Wait();
+}
+
+void ShutdownWorkerPool()
+{
+  WorkerPool *p = NULL;
+
+  {
+    SCOPED_LOCK(poolLock);
+    p = pool;
+    pool = NULL;
+    poolShutdown = true;
+  }
+
+  if(p == NULL)
+    return;
+
+  {
+    SCOPED_LOCK(p->lock);
+    p->shutdown = true;
+  }
+
+  p->wake.Wake((uint32_t)p->threads.size());
+
+  // as with the target control thread we can't join these, since we may be in the middle of being
+  // unloaded. Give them a little while to notice the shutdown and leave instead.
+  for(int i = 0; i < 100 && p->running > 0; i++)
+    Sleep(1);
+
+  for(ThreadHandle t : p->threads)
+    CloseThread(t);
+
+  // if the threads are already gone without leaving, e.g. they were killed as the process exits,
+  // we can't know nothing still references the pool so it's leaked
+  if(p->running == 0)
+    delete p;
+}
+};
@@ -89,6 +89,15 @@ public:
 private:
   SpinLock *m_Spin;
 };
+
+// calls func(i) for every i in [0, count) spread over up to maxThreads threads, or one per core if
+// maxThreads is 0. The calling thread takes part, and this returns once every index is processed.
+// The other threads come from a pool that's started the first time it's needed and kept for later
+// calls. It's safe to call this from inside func.
+void ParallelFor(uint32_t count, std::function<void(uint32_t)> func, uint32_t maxThreads = 0);
+
+// stops the pool's threads, if they were started. ParallelFor must not be called afterwards.
+void ShutdownWorkerPool();
 };
 
 #define SCOPED_LOCK(cs) Threading::ScopedLock CONCAT(scopedlock, __LINE__)(&cs);
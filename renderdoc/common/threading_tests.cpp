@@ -27,6 +27,7 @@
 
 #if ENABLED(ENABLE_UNIT_TESTS)
 
+#include <set>
 #include "3rdparty/catch/catch.hpp"
 
 static int value = 0;
@@ -71,4 +72,88 @@ TEST_CASE("Test spin lock", "[threading]")
   CHECK(finalValue == value);
 }
 
+TEST_CASE("Test parallel for", "[threading]")
+{
+  CHECK(Threading::GetNumberOfCores() >= 1);
+
+  for(uint32_t maxThreads : {0U, 1U, 3U, 16U})
+  {
+    std::vector<int32_t> visited;
+    visited.resize(1000);
+
+    Threading::ParallelFor((uint32_t)visited.size(),
+                           [&visited](uint32_t i) { Atomic::Inc32(&visited[i]); }, maxThreads);
+
+    bool allOnce = true;
+    for(int32_t v : visited)
+      allOnce &= (v == 1);
+
+    CHECK(allOnce);
+  }
+
+  // no work is fine
+  int32_t calls = 0;
+  Threading::ParallelFor(0, [&calls](uint32_t) { calls++; });
+  CHECK(calls == 0);
+}
+
+TEST_CASE("Test parallel for worker pool", "[threading]")
+{
+  SECTION("Threads are reused between calls")
+  {
+    std::set<uint64_t> threadIDs;
+    Threading::CriticalSection lock;
+
+    for(int i = 0; i < 50; i++)
+    {
+      Threading::ParallelFor(64, [&](uint32_t) {
+        uint64_t id = Threading::GetCurrentID();
+        SCOPED_LOCK(lock);
+        threadIDs.insert(id);
+      });
+    }
+
+    // the caller plus at most one pool thread per other core, no matter how many calls
+    CHECK(threadIDs.size() <= Threading::GetNumberOfCores());
+  };
+
+  SECTION("Nested and concurrent calls")
+  {
+    std::vector<int32_t> visited;
+    visited.resize(64 * 64);
+
+    Threading::ParallelFor(64, [&visited](uint32_t outer) {
+      Threading::ParallelFor(64, [&visited, outer](uint32_t inner) {
+        Atomic::Inc32(&visited[outer * 64 + inner]);
+      });
+    });
+
+    // two threads of our own calling it at the same time
+    std::vector<int32_t> other;
+    other.resize(10000);
+
+    Threading::ThreadHandle t = Threading::CreateThread([&other]() {
+      Threading::ParallelFor((uint32_t)other.size(),
+                             [&other](uint32_t i) { Atomic::Inc32(&other[i]); });
+    });
+
+    Threading::ParallelFor((uint32_t)visited.size(),
+                           [&visited](uint32_t i) { Atomic::Inc32(&visited[i]); });
+
+    Threading::JoinThread(t);
+    Threading::CloseThread(t);
+
+    bool allTwice = true;
+    for(int32_t v : visited)
+      allTwice &= (v == 2);
+
+    bool allOnce = true;
+    for(int32_t v : other)
+      allOnce &= (v == 1);
+
+    CHECK(allTwice);
+    CHECK(allOnce);
+  };
+}
+
 #endif    // ENABLED(ENABLE_UNIT_TESTS)
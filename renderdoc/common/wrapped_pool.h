@@ -48,27 +48,42 @@ public:
   typedef C Type;
 };
 
-// allocate each class in its own pool so we can identify the type by the pointer
+// allocate each class in its own pool so we can identify the type by the pointer.
+//
+// Allocation and deallocation are lock-free. Each ItemPool keeps its free slots in several
+// lock-free stacks (stripes) and each thread pushes and pops on the stripe picked by its thread ID,
+// so threads creating and destroying objects at the same time mostly don't touch the same cache
+// line. A thread only steals from other stripes when its own is empty. The lock is only taken when
+// every pool is full and a new additional pool has to be created.
 template <typename WrapType, int PoolCount = 8192, int MaxPoolByteSize = 1024 * 1024, bool DebugClear = true>
 class WrappingPool
 {
 public:
   void *Allocate()
   {
-    SCOPED_LOCK(m_Lock);
+    uint32_t stripe = GetThreadStripe();
 
     // try and allocate from immediate pool
-    void *ret = m_ImmediatePool.Allocate();
+    void *ret = m_ImmediatePool.Allocate(stripe);
     if(ret != NULL)
       return ret;
 
     // fall back to additional pools, if there are any
-    for(size_t i = 0; i < m_AdditionalPools.size(); i++)
-    {
-      ret = m_AdditionalPools[i]->Allocate();
-      if(ret != NULL)
-        return ret;
-    }
+    ret = AllocateAdditional(stripe);
+    if(ret != NULL)
+      return ret;
+
+    // every pool is full. Lock so that only one thread creates a new pool, then check again in case
+    // another thread already did that (or freed something) while we were waiting.
+    SCOPED_LOCK(m_Lock);
+
+    ret = m_ImmediatePool.Allocate(stripe);
+    if(ret != NULL)
+      return ret;
+
+    ret = AllocateAdditional(stripe);
+    if(ret != NULL)
+      return ret;
 
 // warn when we need to allocate an additional pool
 #if ENABLED(INCLUDE_TYPE_NAMES)
@@ -77,34 +92,35 @@ public:
     RDCWARN("Ran out of free slots in pool 0x%p!", &m_ImmediatePool.items[0]);
 #endif
 
-    // allocate a new additional pool and use that to allocate from
-    m_AdditionalPools.push_back(new ItemPool());
+    // allocate a new additional pool and use that to allocate from. We take our slot before the
+    // pool is visible to other threads so it can't be drained from under us.
+    ItemPool *pool = new ItemPool();
+    ret = pool->Allocate(stripe);
 
 #if ENABLED(INCLUDE_TYPE_NAMES)
-    RDCDEBUG("WrappingPool[%d]<%s>: %p -> %p", (uint32_t)m_AdditionalPools.size() - 1,
-             GetTypeName<WrapType>::Name(), &m_AdditionalPools.back()->items[0],
-             &m_AdditionalPools.back()->items[AllocCount - 1]);
+    RDCDEBUG("WrappingPool[%d]<%s>: %p -> %p", m_NumAdditionalPools, GetTypeName<WrapType>::Name(),
+             &pool->items[0], &pool->items[AllocCount - 1]);
 #endif
 
-    return m_AdditionalPools.back()->Allocate();
+    // the list is only ever modified under the lock, so this can't fail. The atomic is a full
+    // barrier, so anyone walking the list without the lock sees the pool fully constructed.
+    pool->next = m_AdditionalPools;
+    Atomic::CmpExchPtr((void *volatile *)&m_AdditionalPools, pool->next, pool);
+    m_NumAdditionalPools++;
+
+    return ret;
   }
 
   bool IsAlloc(const void *p)
   {
-    // we can check the immediate pool without locking
     if(m_ImmediatePool.IsAlloc(p))
       return true;
 
-    // if we have additional pools, lock and check them.
-    // TODO: Check for additional pools in a lock-free manner,
-    // to prevent the cost of locking if there are no more pools.
-    {
-      SCOPED_LOCK(m_Lock);
-
-      for(size_t i = 0; i < m_AdditionalPools.size(); i++)
-        if(m_AdditionalPools[i]->IsAlloc(p))
-          return true;
-    }
+    // additional pools are never removed until the pool is destroyed, so we can walk the list
+    // without locking.
+    for(ItemPool *pool = m_AdditionalPools; pool != NULL; pool = pool->next)
+      if(pool->IsAlloc(p))
+        return true;
 
     return false;
   }
@@ -114,24 +130,22 @@ public:
     if(p == NULL)
       return;
 
-    SCOPED_LOCK(m_Lock);
+    uint32_t stripe = GetThreadStripe();
 
     // try immediate pool
     if(m_ImmediatePool.IsAlloc(p))
     {
-      m_ImmediatePool.Deallocate(p);
+      m_ImmediatePool.Deallocate(p, stripe);
       return;
     }
-    else if(!m_AdditionalPools.empty())
+
+    // fall back and try additional pools
+    for(ItemPool *pool = m_AdditionalPools; pool != NULL; pool = pool->next)
     {
-      // fall back and try additional pools
-      for(size_t i = 0; i < m_AdditionalPools.size(); i++)
+      if(pool->IsAlloc(p))
       {
-        if(m_AdditionalPools[i]->IsAlloc(p))
-        {
-          m_AdditionalPools[i]->Deallocate(p);
-          return;
-        }
+        pool->Deallocate(p, stripe);
+        return;
       }
     }
 
@@ -149,6 +163,9 @@ public:
   static const size_t AllocMaxByteSize = MaxPoolByteSize;
   static const size_t AllocByteSize;
 
+  // number of free-list stripes in each pool, threads are spread over these by ID
+  static const uint32_t StripeCount = 8;
+
 private:
   WrappingPool()
   {
@@ -162,48 +179,108 @@ private:
   }
   ~WrappingPool()
   {
-    for(size_t i = 0; i < m_AdditionalPools.size(); i++)
-      delete m_AdditionalPools[i];
+    ItemPool *pool = m_AdditionalPools;
+    while(pool)
+    {
+      ItemPool *next = pool->next;
+      delete pool;
+      pool = next;
+    }
+
+    m_AdditionalPools = NULL;
+  }
+
+  static uint32_t GetThreadStripe()
+  {
+    // thread IDs are often pointers or multiples of 4, so mix the bits before picking a stripe
+    uint64_t id = Threading::GetCurrentID();
+    id ^= id >> 33;
+    id *= 0xff51afd7ed558ccdULL;
+    id ^= id >> 33;
+    return uint32_t(id % StripeCount);
+  }
+
+  void *AllocateAdditional(uint32_t stripe)
+  {
+    for(ItemPool *pool = m_AdditionalPools; pool != NULL; pool = pool->next)
+    {
+      void *ret = pool->Allocate(stripe);
+      if(ret != NULL)
+        return ret;
+    }
 
-    m_AdditionalPools.clear();
+    return NULL;
   }
 
   Threading::CriticalSection m_Lock;
 
   struct ItemPool
   {
+    // each stripe is a lock-free stack of free slot indices. The head packs an ABA tag in the upper
+    // 32 bits and the index of the top slot + 1 in the lower 32 bits, so 0 is an empty stack. Each
+    // stripe is padded out to its own cache line.
+    struct Stripe
+    {
+      volatile int64_t head;
+      uint8_t padding[64 - sizeof(int64_t)];
+    };
+
+    static int32_t HeadIndex(int64_t head)
+    {
+      return int32_t(uint32_t(uint64_t(head) & 0xffffffff)) - 1;
+    }
+    static uint32_t HeadTag(int64_t head) { return uint32_t(uint64_t(head) >> 32); }
+    static int64_t MakeHead(uint32_t tag, int32_t idx)
+    {
+      return int64_t((uint64_t(tag) << 32) | uint64_t(uint32_t(idx + 1)));
+    }
+
     ItemPool()
     {
       items = (WrapType *)(new uint8_t[AllocCount * AllocByteSize]);
-      freeStack = new int[AllocCount];
-      for(int i = 0; i < (int)AllocCount; ++i)
+      nextFree = new int32_t[AllocCount];
+      stripes = new Stripe[StripeCount];
+      next = NULL;
+
+      for(uint32_t s = 0; s < StripeCount; s++)
+        stripes[s].head = MakeHead(0, -1);
+
+      // deal the slots out over the stripes, pushing backwards so each stripe pops in order
+      for(int i = (int)AllocCount - 1; i >= 0; --i)
       {
-        freeStack[i] = i;
+        Stripe &stripe = stripes[i % StripeCount];
+        nextFree[i] = HeadIndex(stripe.head);
+        stripe.head = MakeHead(0, i);
       }
-      freeStackHead = AllocCount;
     }
     ~ItemPool()
     {
       delete[](uint8_t *) items;
-      delete[] freeStack;
+      delete[] nextFree;
+      delete[] stripes;
     }
-    void *Allocate()
+    void *Allocate(uint32_t stripe)
     {
-      if(freeStackHead == 0)
+      // start on our own stripe, and only steal from the others if it's empty
+      for(uint32_t s = 0; s < StripeCount; s++)
       {
-        return NULL;
-      }
-      --freeStackHead;
-      void *ret = items + freeStack[freeStackHead];
+        int32_t idx = Pop(stripes[(stripe + s) % StripeCount]);
+        if(idx < 0)
+          continue;
+
+        void *ret = items + idx;
 
 #if ENABLED(RDOC_DEVEL)
-      memset(ret, 0xb0, AllocByteSize);
+        memset(ret, 0xb0, AllocByteSize);
 #endif
 
-      return ret;
+        return ret;
+      }
+
+      return NULL;
     }
 
-    void Deallocate(void *p)
+    void Deallocate(void *p, uint32_t stripe)
     {
       RDCASSERT(IsAlloc(p));
 
@@ -215,25 +292,61 @@ private:
       }
 #endif
 
-      int idx = (int)((WrapType *)p - &items[0]);
-
-      freeStack[freeStackHead] = idx;
-      ++freeStackHead;
+      int32_t idx = (int32_t)((WrapType *)p - &items[0]);
 
+// clear before pushing, as once the slot is on the free list another thread can take it
 #if ENABLED(RDOC_DEVEL)
       if(DebugClear)
         memset(p, 0xfe, AllocByteSize);
 #endif
+
+      Push(stripes[stripe], idx);
+    }
+
+    int32_t Pop(Stripe &stripe)
+    {
+      for(;;)
+      {
+        int64_t head = stripe.head;
+        int32_t idx = HeadIndex(head);
+        if(idx < 0)
+          return -1;
+
+        // nextFree[idx] may be stale if another thread pops idx first, but then the tag has changed
+        // and the exchange fails.
+        int64_t newHead = MakeHead(HeadTag(head) + 1, nextFree[idx]);
+        if(Atomic::CmpExch64(&stripe.head, head, newHead) == head)
+          return idx;
+      }
+    }
+
+    void Push(Stripe &stripe, int32_t idx)
+    {
+      for(;;)
+      {
+        int64_t head = stripe.head;
+        nextFree[idx] = HeadIndex(head);
+
+        int64_t newHead = MakeHead(HeadTag(head) + 1, idx);
+        if(Atomic::CmpExch64(&stripe.head, head, newHead) == head)
+          return;
+      }
     }
 
     bool IsAlloc(const void *p) const { return p >= &items[0] && p < &items[PoolCount]; }
     WrapType *items;
-    int *freeStack;
-    int freeStackHead;
+    volatile int32_t *nextFree;
+    Stripe *stripes;
+
+    // next additional pool, immutable once the pool is published
+    ItemPool *next;
   };
 
   ItemPool m_ImmediatePool;
-  std::vector<ItemPool *> m_AdditionalPools;
+
+  // singly linked list of additional pools, newest first. Only added to under m_Lock
+  ItemPool *volatile m_AdditionalPools = NULL;
+  int32_t m_NumAdditionalPools = 0;
 
   friend typename FriendMaker<WrapType>::Type;
 };
@@ -0,0 +1,236 @@
+/******************************************************************************
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2019 Baldur Karlsson
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+#include "common/wrapped_pool.h"
+#include "common/timing.h"
+
+#if ENABLED(ENABLE_UNIT_TESTS)
+
+#include <set>
+#include "3rdparty/catch/catch.hpp"
+
+struct PoolTestObject
+{
+  uint64_t owner;
+  uint64_t serial;
+
+  static const int AllocPoolCount = 256;
+  ALLOCATE_WITH_WRAPPED_POOL(PoolTestObject, AllocPoolCount);
+};
+
+WRAPPED_POOL_INST(PoolTestObject);
+
+TEST_CASE("Test wrapped pool allocation", "[wrappedpool]")
+{
+  const size_t count = PoolTestObject::PoolType::AllocCount;
+
+  SECTION("Immediate pool")
+  {
+    std::set<PoolTestObject *> objs;
+
+    for(size_t i = 0; i < count; i++)
+    {
+      PoolTestObject *o = new PoolTestObject;
+      CHECK(PoolTestObject::IsAlloc(o));
+      objs.insert(o);
+    }
+
+    // every allocation must be unique
+    CHECK(objs.size() == count);
+
+    for(PoolTestObject *o : objs)
+      delete o;
+
+    // after freeing everything we can allocate the same number again
+    objs.clear();
+
+    for(size_t i = 0; i < count; i++)
+      objs.insert(new PoolTestObject);
+
+    CHECK(objs.size() == count);
+
+    for(PoolTestObject *o : objs)
+      delete o;
+  };
+
+  SECTION("Additional pools")
+  {
+    std::set<PoolTestObject *> objs;
+
+    // allocate enough to need at least two additional pools
+    for(size_t i = 0; i < count * 3; i++)
+    {
+      PoolTestObject *o = new PoolTestObject;
+      CHECK(PoolTestObject::IsAlloc(o));
+      objs.insert(o);
+    }
+
+    CHECK(objs.size() == count * 3);
+
+    for(PoolTestObject *o : objs)
+      delete o;
+  };
+
+  SECTION("Foreign pointers")
+  {
+    PoolTestObject local;
+    uint64_t other[2];
+
+    CHECK_FALSE(PoolTestObject::IsAlloc(&local));
+    CHECK_FALSE(PoolTestObject::IsAlloc(other));
+    CHECK_FALSE(PoolTestObject::IsAlloc(NULL));
+  };
+};
+
+TEST_CASE("Stress test wrapped pool across threads", "[wrappedpool]")
+{
+  const int numThreads = 8;
+  const int iterations = 20000;
+
+  // each thread keeps up to this many objects alive so threads overlap and overflow into additional
+  // pools between them
+  const size_t maxLive = PoolTestObject::PoolType::AllocCount / 4 + 16;
+
+  std::vector<Threading::ThreadHandle> threads;
+  std::vector<int> errors;
+
+  threads.resize(numThreads);
+  errors.resize(numThreads);
+
+  for(int t = 0; t < numThreads; t++)
+  {
+    threads[t] = Threading::CreateThread([&errors, t, iterations, maxLive]() {
+      std::vector<PoolTestObject *> live;
+      uint32_t rng = 0x1234567 * (t + 1);
+
+      for(int i = 0; i < iterations; i++)
+      {
+        rng = rng * 1103515245 + 12345;
+
+        bool doAlloc = live.empty() || (live.size() < maxLive && (rng & 0x10000));
+
+        if(doAlloc)
+        {
+          PoolTestObject *o = new PoolTestObject;
+          if(!PoolTestObject::IsAlloc(o))
+            errors[t]++;
+          o->owner = (uint64_t)t;
+          o->serial = (uint64_t)i;
+          live.push_back(o);
+        }
+        else
+        {
+          size_t idx = (rng >> 17) % live.size();
+          PoolTestObject *o = live[idx];
+
+          // if another thread had been handed the same slot it would have stamped over this
+          if(o->owner != (uint64_t)t)
+            errors[t]++;
+
+          live[idx] = live.back();
+          live.pop_back();
+          delete o;
+        }
+
+        // verify all live objects still belong to us every so often
+        if((i % 1024) == 0)
+        {
+          for(PoolTestObject *o : live)
+            if(o->owner != (uint64_t)t)
+              errors[t]++;
+        }
+      }
+
+      for(PoolTestObject *o : live)
+      {
+        if(o->owner != (uint64_t)t)
+          errors[t]++;
+        delete o;
+      }
+    });
+  }
+
+  for(Threading::ThreadHandle t : threads)
+  {
+    Threading::JoinThread(t);
+    Threading::CloseThread(t);
+  }
+
+  for(int t = 0; t < numThreads; t++)
+    CHECK(errors[t] == 0);
+
+  // everything was freed, so a full pool's worth of allocations must all be unique
+  const size_t count = PoolTestObject::PoolType::AllocCount;
+
+  std::set<PoolTestObject *> objs;
+  for(size_t i = 0; i < count; i++)
+    objs.insert(new PoolTestObject);
+
+  CHECK(objs.size() == count);
+
+  for(PoolTestObject *o : objs)
+    delete o;
+};
+
+// not run by default, run explicitly with the [benchmark] tag
+TEST_CASE("Benchmark wrapped pool allocation", "[.][benchmark][wrappedpool]")
+{
+  const int iterations = 1000000;
+
+  for(int numThreads = 1; numThreads <= 8; numThreads *= 2)
+  {
+    std::vector<Threading::ThreadHandle> threads;
+    threads.resize(numThreads);
+
+    PerformanceTimer timer;
+
+    for(int t = 0; t < numThreads; t++)
+    {
+      threads[t] = Threading::CreateThread([iterations]() {
+        PoolTestObject *objs[16];
+
+        for(int i = 0; i < iterations; i += 16)
+        {
+          for(int o = 0; o < 16; o++)
+            objs[o] = new PoolTestObject;
+          for(int o = 0; o < 16; o++)
+            delete objs[o];
+        }
+      });
+    }
+
+    for(Threading::ThreadHandle t : threads)
+    {
+      Threading::JoinThread(t);
+      Threading::CloseThread(t);
+    }
+
+    double ms = timer.GetMilliseconds();
+
+    RDCLOG("%d threads: %d alloc/free pairs per thread in %.2f ms (%.1f ns per pair)", numThreads,
+           iterations, ms, (ms * 1000000.0) / double(iterations));
+  }
+};
+
+#endif    // ENABLED(ENABLE_UNIT_TESTS)
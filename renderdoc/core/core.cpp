@@ -28,6 +28,7 @@
 #include <algorithm>
 #include "api/replay/version.h"
 #include "common/common.h"
+#include "common/threading.h"
 #include "hooks/hooks.h"
 #include "maths/formatpacking.h"
 #include "replay/replay_driver.h"
@@ -424,6 +425,35 @@ void RenderDoc::Initialise()
 
   m_FrameTimer.InitTimers();
 
+  // allow the memory captures can use while queued for writing to be overridden
+  {
+    const char *limit = Process::GetEnvVariable("RENDERDOC_CAPTURE_WRITE_MEMORY_MB");
+    if(limit && limit[0])
+    {
+      m_CaptureWriteMemoryLimit = uint64_t(atoi(limit)) * 1024ULL * 1024ULL;
+      RDCLOG("Capture write memory limit set to %s MB", limit);
+    }
+  }
+
+  // ring capture mode, retaining the last N frames in memory
+  {
+    const char *frames = Process::GetEnvVariable("RENDERDOC_CAPTURE_RING_FRAMES");
+    if(frames && frames[0] && atoi(frames) > 0)
+    {
+      uint64_t budget = 512ULL * 1024ULL * 1024ULL;
+
+      const char *mb = Process::GetEnvVariable("RENDERDOC_CAPTURE_RING_MEMORY_MB");
+      if(mb && mb[0])
+        budget = uint64_t(atoi(mb)) * 1024ULL * 1024ULL;
+
+      SetCaptureRing((uint32_t)atoi(frames), budget);
+
+      const char *ms = Process::GetEnvVariable("RENDERDOC_CAPTURE_RING_FRAME_BUDGET_MS");
+      if(ms && ms[0])
+        SetCaptureRingFrameBudget(atof(ms));
+    }
+  }
+
   m_ExHandler = NULL;
 
   {
@@ -450,6 +480,11 @@ void RenderDoc::Initialise()
 
 RenderDoc::~RenderDoc()
 {
+  // finish writing any captures still queued. Shutdown() normally flushes these already. The writer
+  // only exits once its queue is empty so joining it is enough, and if process teardown has already
+  // killed the thread then the join returns straight away.
+  JoinCaptureWriter();
+
   if(m_ExHandler)
   {
     UnloadCrashHandler();
@@ -489,6 +524,8 @@ RenderDoc::~RenderDoc()
 
   Network::Shutdown();
 
+  Threading::ShutdownWorkerPool();
+
   Threading::Shutdown();
 
   StringFormat::Shutdown();
@@ -496,6 +533,11 @@ RenderDoc::~RenderDoc()
 
 void RenderDoc::Shutdown()
 {
+  // frames in the capture ring that were never saved are discarded
+  SetCaptureRing(0, 0);
+
+  FlushCaptureWrites();
+
   if(m_ExHandler)
   {
     UnloadCrashHandler();
@@ -880,6 +922,20 @@ std::string RenderDoc::GetOverlayText(RDCDriver driver, uint32_t frameNumber, in
 
     overlayText += "\n";
 
+    if(IsCaptureRingActive() && capturesEnabled)
+    {
+      uint32_t skipped = 0;
+      {
+        SCOPED_LOCK(m_CaptureWriteLock);
+        skipped = m_CaptureRingSkipped;
+      }
+
+      overlayText += StringFormat::Fmt(
+          "Capture ring: %u frames held (%.2f MB), %u skipped to stay within %.1f ms/frame.\n",
+          GetRingCaptureCount(), float(GetRingCaptureMemory()) / 1024.0f / 1024.0f, skipped,
+          m_CaptureRingFrameBudget);
+    }
+
     if((overlay & eRENDERDOC_Overlay_CaptureList) && capturesEnabled)
     {
       overlayText += StringFormat::Fmt("%d Captures saved.\n", (uint32_t)m_Captures.size());
@@ -927,6 +983,18 @@ std::string RenderDoc::GetOverlayText(RDCDriver driver, uint32_t frameNumber, in
   return overlayText;
 }
 
+void RenderDoc::TriggerCapture(uint32_t numFrames)
+{
+  // in ring capture mode, the frames have already been captured - write out the most recent ones
+  if(IsCaptureRingActive() && GetRingCaptureCount() > 0)
+  {
+    SaveRingCaptures(numFrames);
+    return;
+  }
+
+  m_Cap = numFrames;
+}
+
 void RenderDoc::QueueCapture(uint32_t frameNumber)
 {
   auto it = std::lower_bound(m_QueuedFrameCaptures.begin(), m_QueuedFrameCaptures.end(), frameNumber);
@@ -964,6 +1032,87 @@ bool RenderDoc::ShouldTriggerCapture(uint32_t frameNumber)
   return ret;
 }
 
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define THUMBNAIL_SSE2 OPTION_ON
+#include <emmintrin.h>
+#else
+#define THUMBNAIL_SSE2 OPTION_OFF
+#endif
+
+namespace
+{
+// adds each byte of a row of 4-byte pixels into the matching 32-bit accumulator
+void AccumulateThumbnailRow(const byte *src, uint32_t numPixels, uint32_t *acc)
+{
+  uint32_t i = 0;
+  const uint32_t count = numPixels * 4;
+
+#if ENABLED(THUMBNAIL_SSE2)
+  const __m128i zero = _mm_setzero_si128();
+
+  for(; i + 16 <= count; i += 16)
+  {
+    __m128i bytes = _mm_loadu_si128((const __m128i *)(src + i));
+    __m128i lo = _mm_unpacklo_epi8(bytes, zero);
+    __m128i hi = _mm_unpackhi_epi8(bytes, zero);
+
+    __m128i widened[4] = {
+        _mm_unpacklo_epi16(lo, zero), _mm_unpackhi_epi16(lo, zero),
+        _mm_unpacklo_epi16(hi, zero), _mm_unpackhi_epi16(hi, zero),
+    };
+
+    __m128i *dst = (__m128i *)(acc + i);
+    for(int j = 0; j < 4; j++)
+      _mm_storeu_si128(dst + j, _mm_add_epi32(_mm_loadu_si128(dst + j), widened[j]));
+  }
+#endif
+
+  for(; i < count; i++)
+    acc[i] += src[i];
+}
+
+// sums the accumulated columns in [colStart[x], colStart[x+1]) for each output pixel and writes
+// the rounded average out as RGB8, swapping R and B if needed.
+void ResolveThumbnailRow(const uint32_t *acc, const uint32_t *colStart, uint32_t outWidth,
+                         uint32_t numRows, bool swapRB, byte *dst)
+{
+  for(uint32_t x = 0; x < outWidth; x++)
+  {
+    const uint32_t first = colStart[x], last = colStart[x + 1];
+    const float invCount = 1.0f / float((last - first) * numRows);
+
+    byte avg[4];
+
+#if ENABLED(THUMBNAIL_SSE2)
+    __m128i sum = _mm_setzero_si128();
+    for(uint32_t c = first; c < last; c++)
+      sum = _mm_add_epi32(sum, _mm_loadu_si128((const __m128i *)(acc + c * 4)));
+
+    __m128 avgf = _mm_add_ps(_mm_mul_ps(_mm_cvtepi32_ps(sum), _mm_set1_ps(invCount)),
+                             _mm_set1_ps(0.5f));
+    __m128i avgi = _mm_cvttps_epi32(avgf);
+    avgi = _mm_packs_epi32(avgi, avgi);
+    avgi = _mm_packus_epi16(avgi, avgi);
+    uint32_t packed = (uint32_t)_mm_cvtsi128_si32(avgi);
+    memcpy(avg, &packed, sizeof(packed));
+#else
+    uint32_t sum[4] = {};
+    for(uint32_t c = first; c < last; c++)
+      for(uint32_t i = 0; i < 4; i++)
+        sum[i] += acc[c * 4 + i];
+
+    for(uint32_t i = 0; i < 4; i++)
+      avg[i] = byte(float(sum[i]) * invCount + 0.5f);
+#endif
+
+    dst[0] = avg[swapRB ? 2 : 0];
+    dst[1] = avg[1];
+    dst[2] = avg[swapRB ? 0 : 2];
+    dst += 3;
+  }
+}
+};
+
 void RenderDoc::ResamplePixels(const FramePixels &in, RDCThumb &out)
 {
   if(in.width == 0 || in.height == 0)
@@ -982,40 +1131,58 @@ void RenderDoc::ResamplePixels(const FramePixels &in, RDCThumb &out)
   out.pixels = new byte[out.len];
   out.format = FileType::Raw;
 
-  byte *dst = (byte *)out.pixels;
-  byte *source = (byte *)in.data;
+  if(out.width == 0 || out.height == 0)
+    return;
 
-  for(uint32_t y = 0; y < out.height; y++)
-  {
-    for(uint32_t x = 0; x < out.width; x++)
+  const uint32_t outWidth = out.width, outHeight = out.height;
+
+  // the thumbnail is never bigger than the source, so every output pixel is a box filter over a
+  // footprint of at least one source pixel. Precalculate where each footprint starts.
+  std::vector<uint32_t> colStart(outWidth + 1), rowStart(outHeight + 1);
+  for(uint32_t x = 0; x <= outWidth; x++)
+    colStart[x] = uint32_t(uint64_t(x) * in.width / outWidth);
+  for(uint32_t y = 0; y <= outHeight; y++)
+    rowStart[y] = uint32_t(uint64_t(y) * in.height / outHeight);
+
+  // 8-bit RGBA/BGRA can be accumulated straight from the source, anything else is first decoded a
+  // row at a time to RGBX8.
+  const bool packed = in.buf1010102 || in.buf565 || in.buf5551;
+  const bool direct = !packed && in.bpc == 1 && in.stride == 4;
+
+  byte unorm10[1024], unorm6[64], unorm5[32];
+  for(uint32_t i = 0; i < 1024; i++)
+    unorm10[i] = (byte)(float(i) / 1023.0f * 255.0f);
+  for(uint32_t i = 0; i < 64; i++)
+    unorm6[i] = (byte)(float(i) / 63.0f * 255.0f);
+  for(uint32_t i = 0; i < 32; i++)
+    unorm5[i] = (byte)(float(i) / 31.0f * 255.0f);
+
+  auto decodeRow = [&](const byte *src, byte *dst) {
+    for(uint32_t x = 0; x < in.width; x++, src += in.stride, dst += 4)
     {
-      uint32_t xSource = x * in.width / out.width;
-      uint32_t ySource = y * in.height / out.height;
-      byte *src = &source[in.stride * xSource + in.pitch * ySource];
-
       if(in.buf1010102)
       {
-        uint32_t *src1010102 = (uint32_t *)src;
-        Vec4f unorm = ConvertFromR10G10B10A2(*src1010102);
-        dst[0] = (byte)(unorm.x * 255.0f);
-        dst[1] = (byte)(unorm.y * 255.0f);
-        dst[2] = (byte)(unorm.z * 255.0f);
+        uint32_t val;
+        memcpy(&val, src, sizeof(val));
+        dst[0] = unorm10[(val >> 0) & 0x3ff];
+        dst[1] = unorm10[(val >> 10) & 0x3ff];
+        dst[2] = unorm10[(val >> 20) & 0x3ff];
       }
       else if(in.buf565)
       {
-        uint16_t *src565 = (uint16_t *)src;
-        Vec3f unorm = ConvertFromB5G6R5(*src565);
-        dst[0] = (byte)(unorm.z * 255.0f);
-        dst[1] = (byte)(unorm.y * 255.0f);
-        dst[2] = (byte)(unorm.x * 255.0f);
+        uint16_t val;
+        memcpy(&val, src, sizeof(val));
+        dst[0] = unorm5[(val >> 11) & 0x1f];
+        dst[1] = unorm6[(val >> 5) & 0x3f];
+        dst[2] = unorm5[(val >> 0) & 0x1f];
       }
       else if(in.buf5551)
       {
-        uint16_t *src5551 = (uint16_t *)src;
-        Vec4f unorm = ConvertFromB5G5R5A1(*src5551);
-        dst[0] = (byte)(unorm.z * 255.0f);
-        dst[1] = (byte)(unorm.y * 255.0f);
-        dst[2] = (byte)(unorm.x * 255.0f);
+        uint16_t val;
+        memcpy(&val, src, sizeof(val));
+        dst[0] = unorm5[(val >> 10) & 0x1f];
+        dst[1] = unorm5[(val >> 5) & 0x1f];
+        dst[2] = unorm5[(val >> 0) & 0x1f];
       }
       else if(in.bgra)
       {
@@ -1025,26 +1192,7 @@ void RenderDoc::ResamplePixels(const FramePixels &in, RDCThumb &out)
       }
       else if(in.bpc == 2)    // R16G16B16A16 backbuffer
       {
-        uint16_t *src16 = (uint16_t *)src;
-
-        float linearR = RDCCLAMP(ConvertFromHalf(src16[0]), 0.0f, 1.0f);
-        float linearG = RDCCLAMP(ConvertFromHalf(src16[1]), 0.0f, 1.0f);
-        float linearB = RDCCLAMP(ConvertFromHalf(src16[2]), 0.0f, 1.0f);
-
-        if(linearR < 0.0031308f)
-          dst[0] = byte(255.0f * (12.92f * linearR));
-        else
-          dst[0] = byte(255.0f * (1.055f * powf(linearR, 1.0f / 2.4f) - 0.055f));
-
-        if(linearG < 0.0031308f)
-          dst[1] = byte(255.0f * (12.92f * linearG));
-        else
-          dst[1] = byte(255.0f * (1.055f * powf(linearG, 1.0f / 2.4f) - 0.055f));
-
-        if(linearB < 0.0031308f)
-          dst[2] = byte(255.0f * (12.92f * linearB));
-        else
-          dst[2] = byte(255.0f * (1.055f * powf(linearB, 1.0f / 2.4f) - 0.055f));
+        ConvertHalfLinearToSRGB8((const uint16_t *)src, dst, 3);
       }
       else
       {
@@ -1052,34 +1200,52 @@ void RenderDoc::ResamplePixels(const FramePixels &in, RDCThumb &out)
         dst[1] = src[1];
         dst[2] = src[2];
       }
-      dst += 3;
+      dst[3] = 0;
     }
-  }
+  };
 
-  if(!in.is_y_flipped)
-  {
-    for(uint16_t y = 0; y <= out.height / 2; y++)
+  // split the output rows into bands that are filtered in parallel. Small backbuffers aren't
+  // worth spinning up threads for.
+  const uint64_t minSourcePixelsPerBand = 256 * 1024;
+  uint32_t numBands = (uint32_t)RDCMIN(uint64_t(outHeight),
+                                       uint64_t(in.width) * in.height / minSourcePixelsPerBand);
+  numBands = RDCMAX(1U, numBands);
+  const uint32_t rowsPerBand = (outHeight + numBands - 1) / numBands;
+  numBands = (outHeight + rowsPerBand - 1) / rowsPerBand;
+
+  Threading::ParallelFor(numBands, [&](uint32_t band) {
+    std::vector<uint32_t> acc(in.width * 4);
+    std::vector<byte> decoded(direct ? 0 : in.width * 4);
+
+    const uint32_t firstRow = band * rowsPerBand;
+    const uint32_t endRow = RDCMIN(outHeight, firstRow + rowsPerBand);
+
+    for(uint32_t y = firstRow; y < endRow; y++)
     {
-      uint16_t flipY = (out.height - 1 - y);
-      for(uint16_t x = 0; x < out.width; x++)
+      std::fill(acc.begin(), acc.end(), 0);
+
+      for(uint32_t sy = rowStart[y]; sy < rowStart[y + 1]; sy++)
       {
-        byte *src = (byte *)out.pixels;
-        byte save[3];
-        save[0] = src[(y * out.width + x) * 3 + 0];
-        save[1] = src[(y * out.width + x) * 3 + 1];
-        save[2] = src[(y * out.width + x) * 3 + 2];
-
-        src[(y * out.width + x) * 3 + 0] = src[(flipY * out.width + x) * 3 + 0];
-        src[(y * out.width + x) * 3 + 1] = src[(flipY * out.width + x) * 3 + 1];
-        src[(y * out.width + x) * 3 + 2] = src[(flipY * out.width + x) * 3 + 2];
-
-        src[(flipY * out.width + x) * 3 + 0] = save[0];
-        src[(flipY * out.width + x) * 3 + 1] = save[1];
-        src[(flipY * out.width + x) * 3 + 2] = save[2];
+        const byte *src = in.data + in.pitch * sy;
+
+        if(!direct)
+        {
+          decodeRow(src, decoded.data());
+          src = decoded.data();
+        }
+
+        AccumulateThumbnailRow(src, in.width, acc.data());
       }
+
+      // flip while filtering if the source is upside down
+      uint32_t dstRow = in.is_y_flipped ? y : outHeight - 1 - y;
+
+      ResolveThumbnailRow(acc.data(), colStart.data(), outWidth, rowStart[y + 1] - rowStart[y],
+                          direct && in.bgra, (byte *)out.pixels + dstRow * outWidth * 3);
     }
-  }
+  });
 }
+
 void RenderDoc::EncodePixelsPNG(const RDCThumb &in, RDCThumb &out)
 {
   if(in.width == 0 || in.height == 0)
@@ -1111,53 +1277,127 @@ void RenderDoc::EncodePixelsPNG(const RDCThumb &in, RDCThumb &out)
   out.format = FileType::PNG;
 }
 
-RDCFile *RenderDoc::CreateRDC(RDCDriver driver, uint32_t frameNum, const FramePixels &fp)
+void RenderDoc::MakeScaledThumbnails(const RDCThumb &raw, std::vector<RDCThumb> &out)
 {
-  RDCFile *ret = new RDCFile;
+  out.clear();
+
+  if(raw.width == 0 || raw.height == 0 || raw.format != FileType::Raw)
+    return;
+
+  // longest edge of each pre-scaled thumbnail, largest first. Each one is filtered down from the
+  // previous level rather than the full thumbnail, so the whole chain costs little more than the
+  // first level.
+  const uint32_t sizes[] = {512, 256, 128, 64};
+
+  RDCThumb prev = raw;
+  std::vector<RDCThumb> rawLevels;
+
+  for(uint32_t size : sizes)
+  {
+    if(RDCMAX(prev.width, prev.height) <= size)
+      continue;
+
+    FramePixels fp;
+    fp.data = (uint8_t *)prev.pixels;
+    fp.len = prev.len;
+    fp.width = prev.width;
+    fp.height = prev.height;
+    fp.pitch = prev.width * 3;
+    fp.stride = 3;
+    fp.bpc = 1;
+    fp.pitch_requirement = 1;
+    fp.max_width = prev.width >= prev.height ? size : size * prev.width / prev.height;
 
+    RDCThumb level;
+    ResamplePixels(fp, level);
+
+    // the pixels are borrowed, don't let the FramePixels destructor free them
+    fp.data = NULL;
+
+    if(level.width == 0 || level.height == 0)
+    {
+      delete[] level.pixels;
+      break;
+    }
+
+    RDCThumb png;
+    EncodePixelsPNG(level, png);
+    out.push_back(png);
+
+    rawLevels.push_back(level);
+    prev = level;
+  }
+
+  for(RDCThumb &level : rawLevels)
+    delete[] level.pixels;
+}
+
+std::string RenderDoc::ReserveCapturePath(uint32_t frameNum)
+{
   std::string suffix = StringFormat::Fmt("_frame%u", frameNum);
 
   if(frameNum == ~0U)
     suffix = "_capture";
 
-  m_CurrentLogFile = StringFormat::Fmt("%s%s.rdc", m_CaptureFileTemplate.c_str(), suffix.c_str());
+  std::string path = StringFormat::Fmt("%s%s.rdc", m_CaptureFileTemplate.c_str(), suffix.c_str());
 
-  // make sure we don't stomp another capture if we make multiple captures in the same frame.
+  // make sure we don't stomp another capture if we make multiple captures in the same frame,
+  // including ones that are still queued to be written.
+  SCOPED_LOCK(m_CaptureLock);
+  int altnum = 2;
+  while(m_ReservedCapturePaths.find(path) != m_ReservedCapturePaths.end() ||
+        std::find_if(m_Captures.begin(), m_Captures.end(), [&path](const CaptureData &o) {
+          return o.path == path;
+        }) != m_Captures.end())
   {
-    SCOPED_LOCK(m_CaptureLock);
-    int altnum = 2;
-    while(std::find_if(m_Captures.begin(), m_Captures.end(), [this](const CaptureData &o) {
-            return o.path == m_CurrentLogFile;
-          }) != m_Captures.end())
-    {
-      m_CurrentLogFile =
-          StringFormat::Fmt("%s%s_%d.rdc", m_CaptureFileTemplate.c_str(), suffix.c_str(), altnum);
-      altnum++;
-    }
+    path = StringFormat::Fmt("%s%s_%d.rdc", m_CaptureFileTemplate.c_str(), suffix.c_str(), altnum);
+    altnum++;
   }
 
+  m_ReservedCapturePaths.insert(path);
+
+  return path;
+}
+
+RDCFile *RenderDoc::CreateRDC(RDCDriver driver, uint32_t frameNum, const FramePixels &fp)
+{
+  return CreateRDC(driver, ReserveCapturePath(frameNum), fp);
+}
+
+RDCFile *RenderDoc::CreateRDC(RDCDriver driver, const std::string &path, const FramePixels &fp)
+{
+  RDCFile *ret = new RDCFile;
+
   RDCThumb outRaw, outPng;
+  std::vector<RDCThumb> outScaled;
   if(fp.data)
   {
     // point sample info into raw buffer
     ResamplePixels(fp, outRaw);
     EncodePixelsPNG(outRaw, outPng);
+    MakeScaledThumbnails(outRaw, outScaled);
   }
 
   ret->SetData(driver, ToStr(driver).c_str(), OSUtility::GetMachineIdent(), &outPng);
+  ret->SetScaledThumbnails(outScaled);
 
-  FileIO::CreateParentDirectory(m_CurrentLogFile);
+  FileIO::CreateParentDirectory(path);
 
-  ret->Create(m_CurrentLogFile.c_str());
+  ret->Create(path.c_str());
 
   if(ret->ErrorCode() != ContainerError::NoError)
   {
-    RDCERR("Error creating RDC at '%s'", m_CurrentLogFile.c_str());
+    RDCERR("Error creating RDC at '%s'", path.c_str());
     SAFE_DELETE(ret);
+
+    SCOPED_LOCK(m_CaptureLock);
+    m_ReservedCapturePaths.erase(path);
   }
 
   SAFE_DELETE_ARRAY(outRaw.pixels);
   SAFE_DELETE_ARRAY(outPng.pixels);
+  for(RDCThumb &thumb : outScaled)
+    SAFE_DELETE_ARRAY(thumb.pixels);
 
   return ret;
 }
@@ -1635,12 +1875,41 @@ void RenderDoc::FinishCaptureWriting(RDCFile *rdc, uint32_t frameNumber)
       delete w;
     }
 
-    RDCLOG("Written to disk: %s", m_CurrentLogFile.c_str());
+    const std::vector<RDCThumb> &scaledThumbs = rdc->GetScaledThumbnails();
+    if(!scaledThumbs.empty())
+    {
+      SectionProperties props = {};
+      props.type = SectionType::ScaledThumbnails;
+      props.version = 1;
+      StreamWriter *w = rdc->WriteSection(props);
+
+      w->Write((uint32_t)scaledThumbs.size());
+
+      for(const RDCThumb &scaled : scaledThumbs)
+      {
+        ExtThumbnailHeader header;
+        header.width = scaled.width;
+        header.height = scaled.height;
+        header.len = scaled.len;
+        header.format = scaled.format;
+        w->Write(header);
+        w->Write(scaled.pixels, scaled.len);
+      }
+
+      w->Finish();
+
+      delete w;
+    }
+
+    const std::string &path = rdc->GetFilename();
 
-    CaptureData cap(m_CurrentLogFile, Timing::GetUnixTimestamp(), rdc->GetDriver(), frameNumber);
+    RDCLOG("Written to disk: %s", path.c_str());
+
+    CaptureData cap(path, Timing::GetUnixTimestamp(), rdc->GetDriver(), frameNumber);
     {
       SCOPED_LOCK(m_CaptureLock);
       m_Captures.push_back(cap);
+      m_ReservedCapturePaths.erase(path);
     }
 
     delete rdc;
@@ -1653,6 +1922,338 @@ void RenderDoc::FinishCaptureWriting(RDCFile *rdc, uint32_t frameNumber)
   RenderDoc::Inst().SetProgress(CaptureProgress::FileWriting, 1.0f);
 }
 
+struct RenderDoc::CaptureWriteJob
+{
+  RDCDriver driver;
+  uint32_t frameNumber;
+  // resolved on the application thread when the job is queued, the writer only ever uses this copy
+  std::string path;
+  FramePixels fp;
+  SectionProperties props;
+  StreamWriter *contents;
+
+  uint64_t GetMemorySize() { return contents->GetOffset() + fp.len; }
+};
+
+RenderDoc::CaptureWriteJob *RenderDoc::MakeCaptureWriteJob(RDCDriver driver, uint32_t frameNumber,
+                                                           FramePixels &fp,
+                                                           const SectionProperties &props,
+                                                           StreamWriter *contents)
+{
+  CaptureWriteJob *job = new CaptureWriteJob;
+  job->driver = driver;
+  job->frameNumber = frameNumber;
+  job->props = props;
+  job->contents = contents;
+
+  // take ownership of the pixel data
+  job->fp = fp;
+  fp.data = NULL;
+
+  return job;
+}
+
+void RenderDoc::QueueCaptureWrite(RDCDriver driver, uint32_t frameNumber, FramePixels &fp,
+                                  const SectionProperties &props, StreamWriter *contents)
+{
+  QueueCaptureWrite(MakeCaptureWriteJob(driver, frameNumber, fp, props, contents));
+}
+
+void RenderDoc::QueueCaptureWrite(CaptureWriteJob *job)
+{
+  job->path = ReserveCapturePath(job->frameNumber);
+
+  uint64_t size = job->GetMemorySize();
+
+  if(size > m_CaptureWriteMemoryLimit)
+  {
+    RDCLOG("Capture of frame %u is %llu MB, writing synchronously", job->frameNumber,
+           size / (1024 * 1024));
+
+    // wait for anything already queued so captures are still written in order
+    FlushCaptureWrites();
+    WriteCapture(job);
+    return;
+  }
+
+  // if queueing this capture would go over the memory limit, wait for the writer to catch up
+  for(;;)
+  {
+    {
+      SCOPED_LOCK(m_CaptureWriteLock);
+      if(m_CaptureWriteQueuedBytes + size <= m_CaptureWriteMemoryLimit)
+      {
+        m_CaptureWriteQueue.push_back(job);
+        m_CaptureWriteQueuedBytes += size;
+
+        if(!m_CaptureWriteThreadRunning)
+        {
+          // the previous writer thread (if any) has already run out of work and is exiting
+          if(m_CaptureWriteThread)
+          {
+            Threading::JoinThread(m_CaptureWriteThread);
+            Threading::CloseThread(m_CaptureWriteThread);
+          }
+
+          m_CaptureWriteThreadRunning = true;
+          m_CaptureWriteThread = Threading::CreateThread([this]() { CaptureWriteThread(); });
+        }
+
+        return;
+      }
+    }
+
+    Threading::Sleep(1);
+  }
+}
+
+void RenderDoc::CaptureWriteThread()
+{
+  for(;;)
+  {
+    CaptureWriteJob *job = NULL;
+
+    {
+      SCOPED_LOCK(m_CaptureWriteLock);
+      if(m_CaptureWriteQueue.empty())
+      {
+        m_CaptureWriteThreadRunning = false;
+        return;
+      }
+
+      // leave the job in the queue until it's written, so flushing waits for it
+      job = m_CaptureWriteQueue.front();
+    }
+
+    uint64_t size = job->GetMemorySize();
+
+    WriteCapture(job);
+
+    {
+      SCOPED_LOCK(m_CaptureWriteLock);
+      m_CaptureWriteQueue.erase(m_CaptureWriteQueue.begin());
+      m_CaptureWriteQueuedBytes -= size;
+    }
+  }
+}
+
+void RenderDoc::WriteCapture(CaptureWriteJob *job)
+{
+  RDCFile *rdc = CreateRDC(job->driver, job->path, job->fp);
+
+  if(rdc)
+  {
+    StreamWriter *w = rdc->WriteSection(job->props);
+
+    const byte *data = job->contents->GetData();
+    const uint64_t len = job->contents->GetOffset();
+
+    // write in blocks so we can report progress while compressing
+    const uint64_t blockSize = 4 * 1024 * 1024;
+    for(uint64_t offs = 0; offs < len; offs += blockSize)
+    {
+      SetProgress(CaptureProgress::FileWriting, float(offs) / float(len));
+      w->Write(data + offs, RDCMIN(blockSize, len - offs));
+    }
+
+    w->Finish();
+
+    delete w;
+  }
+
+  FinishCaptureWriting(rdc, job->frameNumber);
+
+  delete job->contents;
+  delete job;
+}
+
+void RenderDoc::JoinCaptureWriter()
+{
+  Threading::ThreadHandle writer = 0;
+
+  // take the handle so that only this thread joins it. If more captures are queued while we wait
+  // they either go to the same writer, or start a new one once it has exited.
+  {
+    SCOPED_LOCK(m_CaptureWriteLock);
+    writer = m_CaptureWriteThread;
+    m_CaptureWriteThread = 0;
+  }
+
+  if(writer)
+  {
+    Threading::JoinThread(writer);
+    Threading::CloseThread(writer);
+  }
+}
+
+void RenderDoc::FlushCaptureWrites()
+{
+  for(;;)
+  {
+    bool otherJoining = false;
+
+    {
+      SCOPED_LOCK(m_CaptureWriteLock);
+      if(m_CaptureWriteQueue.empty() && !m_CaptureWriteThreadRunning)
+      {
+        if(m_CaptureWriteThread)
+        {
+          Threading::JoinThread(m_CaptureWriteThread);
+          Threading::CloseThread(m_CaptureWriteThread);
+          m_CaptureWriteThread = 0;
+        }
+
+        return;
+      }
+
+      // another flush already took the writer's handle and is joining it
+      otherJoining = (m_CaptureWriteThread == 0);
+    }
+
+    if(otherJoining)
+      Threading::Sleep(1);
+    else
+      JoinCaptureWriter();
+  }
+}
+
+void RenderDoc::SetCaptureRing(uint32_t numFrames, uint64_t memoryBudget)
+{
+  std::vector<CaptureWriteJob *> discard;
+
+  {
+    SCOPED_LOCK(m_CaptureWriteLock);
+
+    m_CaptureRingFrames = numFrames;
+    m_CaptureRingMemoryBudget = memoryBudget;
+
+    // drop the oldest frames that no longer fit
+    while(!m_CaptureRing.empty() &&
+          (m_CaptureRing.size() > numFrames || m_CaptureRingBytes > memoryBudget))
+    {
+      discard.push_back(m_CaptureRing.front());
+      m_CaptureRingBytes -= m_CaptureRing.front()->GetMemorySize();
+      m_CaptureRing.erase(m_CaptureRing.begin());
+    }
+  }
+
+  for(CaptureWriteJob *job : discard)
+  {
+    delete job->contents;
+    delete job;
+  }
+
+  if(numFrames > 0)
+    RDCLOG("Capture ring enabled, keeping the last %u frames in up to %llu MB", numFrames,
+           memoryBudget / (1024 * 1024));
+}
+
+void RenderDoc::SetCaptureRingFrameBudget(double milliseconds)
+{
+  SCOPED_LOCK(m_CaptureWriteLock);
+  m_CaptureRingFrameBudget = RDCMAX(0.0, milliseconds);
+  m_CaptureRingCredit = 0.0;
+
+  RDCLOG("Capture ring limited to %.2f ms of capture overhead per frame", m_CaptureRingFrameBudget);
+}
+
+bool RenderDoc::ShouldCaptureRingFrame()
+{
+  SCOPED_LOCK(m_CaptureWriteLock);
+
+  if(m_CaptureRingFrameBudget <= 0.0)
+    return true;
+
+  // every presented frame earns its share of the budget. The credit is capped at one capture's
+  // cost, so idle periods can't be saved up and spent on a burst of back to back captures.
+  m_CaptureRingCredit = RDCMIN(m_CaptureRingCredit + m_CaptureRingFrameBudget,
+                               RDCMAX(m_CaptureRingFrameBudget, m_CaptureRingLastCost));
+
+  if(m_CaptureRingCredit < m_CaptureRingLastCost)
+  {
+    m_CaptureRingSkipped++;
+    return false;
+  }
+
+  return true;
+}
+
+void RenderDoc::AddRingFrameCost(double milliseconds)
+{
+  SCOPED_LOCK(m_CaptureWriteLock);
+  m_CaptureRingLastCost = milliseconds;
+  m_CaptureRingCredit -= milliseconds;
+}
+
+void RenderDoc::AddRingCapture(RDCDriver driver, uint32_t frameNumber, FramePixels &fp,
+                               const SectionProperties &props, StreamWriter *contents)
+{
+  CaptureWriteJob *job = MakeCaptureWriteJob(driver, frameNumber, fp, props, contents);
+
+  std::vector<CaptureWriteJob *> discard;
+
+  {
+    SCOPED_LOCK(m_CaptureWriteLock);
+
+    m_CaptureRing.push_back(job);
+    m_CaptureRingBytes += job->GetMemorySize();
+
+    // always keep the newest frame, even if it's over budget by itself, otherwise the ring would
+    // never have anything to save
+    while(m_CaptureRing.size() > 1 && (m_CaptureRing.size() > m_CaptureRingFrames ||
+                                       m_CaptureRingBytes > m_CaptureRingMemoryBudget))
+    {
+      discard.push_back(m_CaptureRing.front());
+      m_CaptureRingBytes -= m_CaptureRing.front()->GetMemorySize();
+      m_CaptureRing.erase(m_CaptureRing.begin());
+    }
+  }
+
+  // free outside the lock, this can be a lot of memory
+  for(CaptureWriteJob *j : discard)
+  {
+    delete j->contents;
+    delete j;
+  }
+}
+
+uint32_t RenderDoc::SaveRingCaptures(uint32_t numFrames)
+{
+  std::vector<CaptureWriteJob *> save;
+
+  {
+    SCOPED_LOCK(m_CaptureWriteLock);
+
+    size_t first = m_CaptureRing.size() - RDCMIN((size_t)numFrames, m_CaptureRing.size());
+
+    save.assign(m_CaptureRing.begin() + first, m_CaptureRing.end());
+    m_CaptureRing.erase(m_CaptureRing.begin() + first, m_CaptureRing.end());
+
+    for(CaptureWriteJob *job : save)
+      m_CaptureRingBytes -= job->GetMemorySize();
+  }
+
+  RDCLOG("Saving %u frames from the capture ring", (uint32_t)save.size());
+
+  // oldest first, so the captures are written in order
+  for(CaptureWriteJob *job : save)
+    QueueCaptureWrite(job);
+
+  return (uint32_t)save.size();
+}
+
+uint32_t RenderDoc::GetRingCaptureCount()
+{
+  SCOPED_LOCK(m_CaptureWriteLock);
+  return (uint32_t)m_CaptureRing.size();
+}
+
+uint64_t RenderDoc::GetRingCaptureMemory()
+{
+  SCOPED_LOCK(m_CaptureWriteLock);
+  return m_CaptureRingBytes;
+}
+
 void RenderDoc::AddDeviceFrameCapturer(void *dev, IFrameCapturer *cap)
 {
   if(IsReplayApp())
@@ -1766,6 +2367,8 @@ void RenderDoc::RemoveFrameCapturer(void *dev, void *wnd)
 #undef None
 
 #include "3rdparty/catch/catch.hpp"
+#include "common/timing.h"
+#include "stb/stb_image.h"
 
 TEST_CASE("Check ResourceId tostr", "[tostr]")
 {
@@ -1809,4 +2412,382 @@ TEST_CASE("Check ResourceId tostr", "[tostr]")
   CHECK(ToStr(*u.id) == "ResourceId::1311768465173141112");
 }
 
+TEST_CASE("Check capture ring eviction", "[core]")
+{
+  RenderDoc &rdoc = RenderDoc::Inst();
+
+  SectionProperties props;
+  props.type = SectionType::FrameCapture;
+
+  auto addFrame = [&rdoc, &props](uint32_t frame, uint64_t size) {
+    RenderDoc::FramePixels fp;
+    StreamWriter *w = new StreamWriter(size);
+    byte zero[64] = {};
+    for(uint64_t i = 0; i < size; i += sizeof(zero))
+      w->Write(zero, sizeof(zero));
+    rdoc.AddRingCapture(RDCDriver::Vulkan, frame, fp, props, w);
+  };
+
+  SECTION("Frame count limit")
+  {
+    rdoc.SetCaptureRing(3, 1024 * 1024);
+
+    for(uint32_t i = 0; i < 10; i++)
+      addFrame(i, 1024);
+
+    CHECK(rdoc.GetRingCaptureCount() == 3);
+    CHECK(rdoc.GetRingCaptureMemory() == 3 * 1024);
+  };
+
+  SECTION("Memory budget")
+  {
+    rdoc.SetCaptureRing(10, 4096);
+
+    for(uint32_t i = 0; i < 10; i++)
+      addFrame(i, 1024);
+
+    CHECK(rdoc.GetRingCaptureCount() == 4);
+    CHECK(rdoc.GetRingCaptureMemory() == 4096);
+
+    // an oversized frame is still kept on its own
+    addFrame(10, 8192);
+
+    CHECK(rdoc.GetRingCaptureCount() == 1);
+    CHECK(rdoc.GetRingCaptureMemory() == 8192);
+  };
+
+  SECTION("Shrinking the ring")
+  {
+    rdoc.SetCaptureRing(8, 1024 * 1024);
+
+    for(uint32_t i = 0; i < 8; i++)
+      addFrame(i, 1024);
+
+    CHECK(rdoc.GetRingCaptureCount() == 8);
+
+    rdoc.SetCaptureRing(2, 1024 * 1024);
+
+    CHECK(rdoc.GetRingCaptureCount() == 2);
+  };
+
+  SECTION("Frame overhead budget")
+  {
+    rdoc.SetCaptureRing(8, 1024 * 1024);
+    rdoc.SetCaptureRingFrameBudget(2.0);
+
+    // each capture costs 10ms, so with a 2ms budget only every 5th frame can be captured
+    uint32_t captured = 0;
+    double spent = 0.0;
+    for(uint32_t i = 0; i < 100; i++)
+    {
+      if(rdoc.ShouldCaptureRingFrame())
+      {
+        captured++;
+        spent += 10.0;
+        rdoc.AddRingFrameCost(10.0);
+      }
+    }
+
+    CHECK(captured >= 19);
+    CHECK(captured <= 21);
+    CHECK(spent <= 100 * 2.0 + 10.0);
+
+    // cheap captures fit in the budget every frame
+    rdoc.SetCaptureRingFrameBudget(2.0);
+    rdoc.AddRingFrameCost(0.5);
+    captured = 0;
+    for(uint32_t i = 0; i < 100; i++)
+    {
+      if(rdoc.ShouldCaptureRingFrame())
+      {
+        captured++;
+        rdoc.AddRingFrameCost(0.5);
+      }
+    }
+
+    CHECK(captured == 100);
+
+    rdoc.SetCaptureRingFrameBudget(0.0);
+    rdoc.AddRingFrameCost(1000.0);
+    CHECK(rdoc.ShouldCaptureRingFrame());
+  };
+
+  rdoc.SetCaptureRing(0, 0);
+
+  CHECK(rdoc.GetRingCaptureCount() == 0);
+  CHECK(rdoc.GetRingCaptureMemory() == 0);
+}
+
+TEST_CASE("Check thumbnail downscaling", "[core]")
+{
+  RenderDoc &rdoc = RenderDoc::Inst();
+
+  auto makePixels = [](uint32_t width, uint32_t height, uint32_t stride) {
+    RenderDoc::FramePixels *fp = new RenderDoc::FramePixels;
+    fp->width = width;
+    fp->height = height;
+    fp->stride = stride;
+    fp->pitch = width * stride;
+    fp->bpc = 1;
+    fp->len = fp->pitch * height;
+    fp->data = new uint8_t[fp->len];
+    fp->pitch_requirement = 8;
+    fp->max_width = width / 2;
+    return fp;
+  };
+
+  RDCThumb thumb;
+
+  SECTION("Solid colours survive filtering")
+  {
+    // 100 wide doesn't downscale by a whole factor
+    RenderDoc::FramePixels *fp = makePixels(100, 60, 4);
+    fp->max_width = 96;
+    for(uint32_t i = 0; i < fp->len; i += 4)
+    {
+      fp->data[i + 0] = 10;
+      fp->data[i + 1] = 200;
+      fp->data[i + 2] = 77;
+      fp->data[i + 3] = 255;
+    }
+
+    rdoc.ResamplePixels(*fp, thumb);
+
+    REQUIRE(thumb.width == 96);
+    REQUIRE(thumb.height == 57);
+
+    uint32_t mismatches = 0;
+    for(uint32_t i = 0; i < thumb.len; i += 3)
+      if(thumb.pixels[i + 0] != 10 || thumb.pixels[i + 1] != 200 || thumb.pixels[i + 2] != 77)
+        mismatches++;
+
+    CHECK(mismatches == 0);
+
+    delete fp;
+  };
+
+  SECTION("Pixels are box filtered")
+  {
+    // a one pixel checkerboard of black and white averages to grey
+    RenderDoc::FramePixels *fp = makePixels(64, 32, 4);
+    for(uint32_t y = 0; y < fp->height; y++)
+      for(uint32_t x = 0; x < fp->width; x++)
+        memset(&fp->data[(y * fp->width + x) * 4], ((x ^ y) & 1) ? 255 : 0, 4);
+
+    rdoc.ResamplePixels(*fp, thumb);
+
+    REQUIRE(thumb.width == 32);
+    REQUIRE(thumb.height == 16);
+
+    uint32_t mismatches = 0;
+    for(uint32_t i = 0; i < thumb.len; i++)
+      if(thumb.pixels[i] != 128)
+        mismatches++;
+
+    CHECK(mismatches == 0);
+
+    delete fp;
+  };
+
+  SECTION("BGRA is swizzled and the image is flipped")
+  {
+    RenderDoc::FramePixels *fp = makePixels(16, 16, 4);
+    fp->bgra = true;
+    fp->is_y_flipped = false;
+    for(uint32_t y = 0; y < fp->height; y++)
+    {
+      for(uint32_t x = 0; x < fp->width; x++)
+      {
+        byte *pixel = &fp->data[(y * fp->width + x) * 4];
+        pixel[0] = byte(y * 8);
+        pixel[1] = byte(x * 8);
+        pixel[2] = 255;
+        pixel[3] = 0;
+      }
+    }
+
+    rdoc.ResamplePixels(*fp, thumb);
+
+    REQUIRE(thumb.width == 8);
+    REQUIRE(thumb.height == 8);
+
+    // the first output row is the average of the last two source rows, blue is in the first
+    // source byte
+    CHECK(thumb.pixels[0] == 255);
+    CHECK(thumb.pixels[1] == 4);
+    CHECK(thumb.pixels[2] == 116);
+
+    const byte *last = thumb.pixels + (7 * 8 + 7) * 3;
+    CHECK(last[0] == 255);
+    CHECK(last[1] == 116);
+    CHECK(last[2] == 4);
+
+    delete fp;
+  };
+
+  SECTION("Packed formats")
+  {
+    RenderDoc::FramePixels *fp = makePixels(16, 8, 4);
+    fp->buf1010102 = true;
+    fp->bpc = 0;
+    for(uint32_t i = 0; i < fp->len; i += 4)
+    {
+      uint32_t val = (1023U << 0) | (0U << 10) | (512U << 20) | (3U << 30);
+      memcpy(&fp->data[i], &val, sizeof(val));
+    }
+
+    rdoc.ResamplePixels(*fp, thumb);
+
+    REQUIRE(thumb.width == 8);
+    CHECK(thumb.pixels[0] == 255);
+    CHECK(thumb.pixels[1] == 0);
+    CHECK(thumb.pixels[2] == byte(512.0f / 1023.0f * 255.0f));
+
+    delete fp;
+
+    SAFE_DELETE_ARRAY(thumb.pixels);
+
+    fp = makePixels(16, 8, 2);
+    fp->buf565 = true;
+    fp->bpc = 0;
+    for(uint32_t i = 0; i < fp->len; i += 2)
+    {
+      uint16_t val = (31U << 11) | (32U << 5) | (0U << 0);
+      memcpy(&fp->data[i], &val, sizeof(val));
+    }
+
+    rdoc.ResamplePixels(*fp, thumb);
+
+    REQUIRE(thumb.width == 8);
+    CHECK(thumb.pixels[0] == 255);
+    CHECK(thumb.pixels[1] == byte(32.0f / 63.0f * 255.0f));
+    CHECK(thumb.pixels[2] == 0);
+
+    delete fp;
+  };
+
+  SECTION("Pre-scaled thumbnails")
+  {
+    auto makeRaw = [](uint16_t width, uint16_t height) {
+      RDCThumb raw;
+      raw.width = width;
+      raw.height = height;
+      raw.len = width * height * 3;
+      raw.format = FileType::Raw;
+      byte *pixels = new byte[raw.len];
+      for(uint32_t i = 0; i < raw.len; i += 3)
+      {
+        pixels[i + 0] = 40;
+        pixels[i + 1] = 90;
+        pixels[i + 2] = 250;
+      }
+      raw.pixels = pixels;
+      return raw;
+    };
+
+    RDCThumb raw = makeRaw(1024, 600);
+    std::vector<RDCThumb> scaled;
+    rdoc.MakeScaledThumbnails(raw, scaled);
+
+    REQUIRE(scaled.size() == 4);
+    CHECK(scaled[0].width == 512);
+    CHECK(scaled[0].height == 300);
+    CHECK(scaled[1].width == 256);
+    CHECK(scaled[1].height == 150);
+    CHECK(scaled[2].width == 128);
+    CHECK(scaled[2].height == 75);
+    CHECK(scaled[3].width == 64);
+    CHECK(scaled[3].height == 37);
+
+    for(const RDCThumb &level : scaled)
+    {
+      CHECK(level.format == FileType::PNG);
+
+      int w = 0, h = 0, comp = 0;
+      byte *decoded = stbi_load_from_memory(level.pixels, (int)level.len, &w, &h, &comp, 3);
+      REQUIRE(decoded);
+      CHECK(w == level.width);
+      CHECK(h == level.height);
+
+      uint32_t mismatches = 0;
+      for(int i = 0; i < w * h * 3; i += 3)
+        if(decoded[i + 0] != 40 || decoded[i + 1] != 90 || decoded[i + 2] != 250)
+          mismatches++;
+
+      CHECK(mismatches == 0);
+
+      free(decoded);
+      delete[] level.pixels;
+    }
+
+    delete[] raw.pixels;
+
+    // only sizes smaller than the thumbnail are generated, with the aspect ratio kept for tall
+    // images too
+    raw = makeRaw(100, 200);
+    rdoc.MakeScaledThumbnails(raw, scaled);
+
+    REQUIRE(scaled.size() == 2);
+    CHECK(scaled[0].width == 64);
+    CHECK(scaled[0].height == 128);
+    CHECK(scaled[1].width == 32);
+    CHECK(scaled[1].height == 64);
+
+    for(const RDCThumb &level : scaled)
+      delete[] level.pixels;
+
+    delete[] raw.pixels;
+  };
+
+  SECTION("Too small to thumbnail")
+  {
+    RenderDoc::FramePixels *fp = makePixels(6, 6, 4);
+    memset(fp->data, 0, fp->len);
+
+    rdoc.ResamplePixels(*fp, thumb);
+
+    CHECK(thumb.width == 0);
+    CHECK(thumb.len == 0);
+
+    delete fp;
+  };
+
+  SAFE_DELETE_ARRAY(thumb.pixels);
+}
+
+// not run by default, run explicitly with the [benchmark] tag
+TEST_CASE("Benchmark thumbnail downscaling", "[.][benchmark][core]")
+{
+  RenderDoc &rdoc = RenderDoc::Inst();
+
+  RenderDoc::FramePixels fp;
+  fp.width = 3840;
+  fp.height = 2160;
+  fp.pitch_requirement = 8;
+  fp.max_width = 2048;
+
+  for(uint32_t bpc : {1, 2})
+  {
+    fp.bpc = bpc;
+    fp.stride = bpc * 4;
+    fp.pitch = fp.width * fp.stride;
+    fp.len = fp.pitch * fp.height;
+    fp.data = new uint8_t[fp.len];
+    for(uint32_t i = 0; i < fp.len; i++)
+      fp.data[i] = uint8_t((i * 2654435761U) >> 17);
+
+    RDCThumb thumb;
+
+    PerformanceTimer timer;
+    rdoc.ResamplePixels(fp, thumb);
+    double resampleMS = timer.GetMilliseconds();
+
+    RDCLOG("%ux%u %u bytes per channel to %ux%u thumbnail: %.2f ms", fp.width, fp.height, bpc,
+           thumb.width, thumb.height, resampleMS);
+
+    SAFE_DELETE_ARRAY(thumb.pixels);
+    SAFE_DELETE_ARRAY(fp.data);
+  }
+}
+
 #endif
@@ -27,6 +27,7 @@
 
 #include <stdint.h>
 #include <map>
+#include <set>
 #include <string>
 #include <vector>
 #include "api/app/renderdoc_app.h"
@@ -37,6 +38,7 @@
 #include "os/os_specific.h"
 
 class Chunk;
+class StreamWriter;
 struct RDCThumb;
 
 // not provided by tinyexr, just do by hand
@@ -386,13 +388,22 @@ public:
   template <typename ProgressType>
   void SetProgressCallback(RENDERDOC_ProgressCallback progress)
   {
+    SCOPED_LOCK(m_ProgressLock);
     m_ProgressCallbacks[TypeName<ProgressType>()] = progress;
   }
 
+  // this can be called from the capture writer thread as well as the application's threads
   template <typename ProgressType>
   void SetProgress(ProgressType section, float delta)
   {
-    RENDERDOC_ProgressCallback cb = m_ProgressCallbacks[TypeName<ProgressType>()];
+    RENDERDOC_ProgressCallback cb = NULL;
+    {
+      SCOPED_LOCK(m_ProgressLock);
+      auto it = m_ProgressCallbacks.find(TypeName<ProgressType>());
+      if(it != m_ProgressCallbacks.end())
+        cb = it->second;
+    }
+
     if(!cb || section < ProgressType::First || section >= ProgressType::Count)
       return;
 
@@ -448,9 +459,46 @@ public:
   ICrashHandler *GetCrashHandler() const { return m_ExHandler; }
   void ResamplePixels(const FramePixels &in, RDCThumb &out);
   void EncodePixelsPNG(const RDCThumb &in, RDCThumb &out);
+  void MakeScaledThumbnails(const RDCThumb &raw, std::vector<RDCThumb> &out);
   RDCFile *CreateRDC(RDCDriver driver, uint32_t frameNum, const FramePixels &fp);
   void FinishCaptureWriting(RDCFile *rdc, uint32_t frameNumber);
 
+  // hands a finished frame off to be written to disk on a background thread, so the application
+  // can continue straight away. contents holds the already serialised frame capture section. The
+  // writer takes ownership of contents and of the pixel data in fp.
+  void QueueCaptureWrite(RDCDriver driver, uint32_t frameNumber, FramePixels &fp,
+                         const SectionProperties &props, StreamWriter *contents);
+  // blocks until every queued capture has been written to disk
+  void FlushCaptureWrites();
+  // how much memory queued captures can hold before QueueCaptureWrite blocks to wait for the
+  // writer. Captures bigger than this are written synchronously, so 0 disables background writes.
+  void SetCaptureWriteMemoryLimit(uint64_t bytes) { m_CaptureWriteMemoryLimit = bytes; }
+
+  // in ring capture mode frames are captured in the background and the last numFrames are kept
+  // in memory, within memoryBudget bytes, so they can be written out after the fact by
+  // TriggerCapture(). Setting 0 frames disables the ring and discards any frames held.
+  void SetCaptureRing(uint32_t numFrames, uint64_t memoryBudget);
+  bool IsCaptureRingActive() { return m_CaptureRingFrames > 0; }
+  // the average time per presented frame that capturing for the ring may stall the application, in
+  // milliseconds. Frames are skipped as needed to stay within it, 0 captures every frame. Ring
+  // frames don't read back a thumbnail or wait for idle when they end, but beginning a capture
+  // still has to synchronise to fetch initial contents so that cost is what the budget bounds.
+  void SetCaptureRingFrameBudget(double milliseconds);
+  // drivers call this once per presented frame while the ring is active, and only capture the frame
+  // for the ring if it returns true.
+  bool ShouldCaptureRingFrame();
+  // drivers report how long capturing each ring frame stalled the application for
+  void AddRingFrameCost(double milliseconds);
+  // like QueueCaptureWrite, but hands the frame to the capture ring instead of writing it. The
+  // oldest frames are discarded as needed to stay within the ring's frame count and budget.
+  void AddRingCapture(RDCDriver driver, uint32_t frameNumber, FramePixels &fp,
+                      const SectionProperties &props, StreamWriter *contents);
+  // writes out the most recent numFrames frames held in the capture ring and removes them from it.
+  // Returns how many frames were written.
+  uint32_t SaveRingCaptures(uint32_t numFrames);
+  uint32_t GetRingCaptureCount();
+  uint64_t GetRingCaptureMemory();
+
   void AddChildProcess(uint32_t pid, uint32_t ident)
   {
     SCOPED_LOCK(m_ChildLock);
@@ -569,7 +617,7 @@ public:
     wnd = m_ActiveWindow.wnd;
   }
 
-  void TriggerCapture(uint32_t numFrames) { m_Cap = numFrames; }
+  void TriggerCapture(uint32_t numFrames);
   uint32_t GetOverlayBits() { return m_Overlay; }
   void MaskOverlayBits(uint32_t And, uint32_t Or) { m_Overlay = (m_Overlay & And) | Or; }
   void QueueCapture(uint32_t frameNumber);
@@ -625,7 +673,6 @@ private:
 
   std::string m_Target;
   std::string m_CaptureFileTemplate;
-  std::string m_CurrentLogFile;
   CaptureOptions m_Options;
   uint32_t m_Overlay;
 
@@ -641,10 +688,43 @@ private:
   Threading::ThreadHandle m_AvailableGPUThread = 0;
   rdcarray<GPUDevice> m_AvailableGPUs;
 
+  Threading::CriticalSection m_ProgressLock;
   std::map<rdcstr, RENDERDOC_ProgressCallback> m_ProgressCallbacks;
 
   Threading::CriticalSection m_CaptureLock;
   std::vector<CaptureData> m_Captures;
+  // paths handed out to captures that haven't been written yet, so that two captures queued
+  // before either is finished don't get the same path. Protected by m_CaptureLock.
+  std::set<std::string> m_ReservedCapturePaths;
+
+  std::string ReserveCapturePath(uint32_t frameNum);
+  RDCFile *CreateRDC(RDCDriver driver, const std::string &path, const FramePixels &fp);
+
+  struct CaptureWriteJob;
+  CaptureWriteJob *MakeCaptureWriteJob(RDCDriver driver, uint32_t frameNumber, FramePixels &fp,
+                                       const SectionProperties &props, StreamWriter *contents);
+  void QueueCaptureWrite(CaptureWriteJob *job);
+  void JoinCaptureWriter();
+  void CaptureWriteThread();
+  void WriteCapture(CaptureWriteJob *job);
+
+  Threading::CriticalSection m_CaptureWriteLock;
+  std::vector<CaptureWriteJob *> m_CaptureWriteQueue;
+  uint64_t m_CaptureWriteQueuedBytes = 0;
+  uint64_t m_CaptureWriteMemoryLimit = 1024ULL * 1024ULL * 1024ULL;
+  bool m_CaptureWriteThreadRunning = false;
+  Threading::ThreadHandle m_CaptureWriteThread = 0;
+
+  // protected by m_CaptureWriteLock, oldest frame first
+  std::vector<CaptureWriteJob *> m_CaptureRing;
+  uint64_t m_CaptureRingBytes = 0;
+  uint32_t m_CaptureRingFrames = 0;
+  uint64_t m_CaptureRingMemoryBudget = 0;
+  double m_CaptureRingFrameBudget = 2.0;
+  // budget built up by presented frames and not yet spent on captures, in milliseconds
+  double m_CaptureRingCredit = 0.0;
+  double m_CaptureRingLastCost = 0.0;
+  uint32_t m_CaptureRingSkipped = 0;
 
   Threading::CriticalSection m_ChildLock;
   std::vector<rdcpair<uint32_t, uint32_t> > m_Children;
@@ -23,6 +23,7 @@
  ******************************************************************************/
 
 #include "common/dds_readwrite.h"
+#include "common/exr_readwrite.h"
 #include "core/core.h"
 #include "replay/replay_driver.h"
 #include "serialise/rdcfile.h"
@@ -123,6 +124,13 @@ public:
 
     m_Proxy->PickPixel(m_TextureID, x, y, sub, typeCast, pixel);
   }
+  rdcarray<PixelValue> PickPixels(ResourceId texture, const rdcarray<uint32_t> &coords,
+                                  const Subresource &sub, CompType typeCast)
+  {
+    // a GL proxy's texture data is bottom-up, which only PickPixel flips for
+    return StandardPickPixels(this, texture, coords, sub, typeCast,
+                              m_Props.localRenderer != GraphicsAPI::OpenGL);
+  }
   bool GetMinMax(ResourceId texid, const Subresource &sub, CompType typeCast, float *minval,
                  float *maxval)
   {
@@ -332,8 +340,35 @@ private:
   std::vector<ResourceDescription> m_Resources;
   SDFile m_File;
   TextureDescription m_TexDetails;
+
+  // buffers reused between reloads, since watched files are typically rewritten with the same
+  // size over and over
+  std::vector<byte> m_FileData;
+  std::vector<byte> m_Decoded;
+  // fingerprint of the last loaded file contents, to skip reloads when nothing changed
+  uint64_t m_LoadedHash = 0;
 };
 
+// cheap fingerprint of a file's contents, processing a word at a time. This only needs to spot
+// when a file has been rewritten with different contents, it isn't a general purpose hash.
+static uint64_t HashFileContents(const byte *data, size_t size)
+{
+  uint64_t hash = 14695981039346656037ULL;
+
+  size_t i = 0;
+  for(; i + sizeof(uint64_t) <= size; i += sizeof(uint64_t))
+  {
+    uint64_t word;
+    memcpy(&word, data + i, sizeof(word));
+    hash = (hash ^ word) * 1099511628211ULL;
+  }
+
+  for(; i < size; i++)
+    hash = (hash ^ data[i]) * 1099511628211ULL;
+
+  return hash ^ uint64_t(size);
+}
+
 ReplayStatus IMG_CreateReplayDevice(RDCFile *rdc, IReplayDriver **driver)
 {
   if(!rdc)
@@ -407,7 +442,8 @@ ReplayStatus IMG_CreateReplayDevice(RDCFile *rdc, IReplayDriver **driver)
   else if(is_dds_file(f))
   {
     FileIO::fseek64(f, 0, SEEK_SET);
-    dds_data read_data = load_dds_from_file(f);
+    // this only validates the file, mapping it means none of the pixel data is read
+    dds_data read_data = load_dds_from_file(f, true);
 
     if(read_data.subdata == NULL)
     {
@@ -416,11 +452,7 @@ ReplayStatus IMG_CreateReplayDevice(RDCFile *rdc, IReplayDriver **driver)
       return ReplayStatus::ImageUnsupported;
     }
 
-    for(int i = 0; i < read_data.slices * read_data.mips; i++)
-      delete[] read_data.subdata[i];
-
-    delete[] read_data.subdata;
-    delete[] read_data.subsizes;
+    free_dds_data(read_data);
   }
   else
   {
@@ -523,131 +555,160 @@ void ImageViewer::RefreshFile()
   byte *data = NULL;
   size_t datasize = 0;
 
-  bool dds = false;
+  bool dds = is_dds_file(f);
 
   FileIO::fseek64(f, 0, SEEK_END);
   uint64_t fileSize = FileIO::ftell64(f);
   FileIO::fseek64(f, 0, SEEK_SET);
 
-  if(is_exr_file(f))
-  {
-    texDetails.format = rgba32_float;
-
-    FileIO::fseek64(f, 0, SEEK_SET);
-
-    std::vector<byte> buffer;
-    buffer.resize((size_t)fileSize);
-
-    FileIO::fread(buffer.data(), 1, buffer.size(), f);
+  // DDS files are mapped rather than read, everything else is decoded from memory. Watchers can
+  // notify several times for one save, so skip decoding and uploading if nothing has changed.
+  // The hash is only kept once the texture is updated, so a failed load is retried.
+  uint64_t hash = 0;
 
-    EXRVersion exrVersion;
-    int ret = ParseEXRVersionFromMemory(&exrVersion, buffer.data(), buffer.size());
+  if(!dds)
+  {
+    m_FileData.resize((size_t)fileSize);
+    m_FileData.resize(FileIO::fread(m_FileData.data(), 1, m_FileData.size(), f));
 
-    if(ret != 0)
+    hash = HashFileContents(m_FileData.data(), m_FileData.size());
+    if(m_TextureID != ResourceId() && hash == m_LoadedHash)
     {
-      RDCERR("EXR file detected, but couldn't load with ParseEXRVersionFromMemory: %d", ret);
       FileIO::fclose(f);
       return;
     }
+  }
 
-    if(exrVersion.multipart || exrVersion.non_image || exrVersion.tiled)
+  const std::vector<byte> &buffer = m_FileData;
+
+  if(is_exr_file(f))
+  {
+    texDetails.format = rgba32_float;
+
+    // our own loader decodes scanline blocks in parallel straight into RGBA, and handles the
+    // files we write. Anything it doesn't support goes through tinyexr
+    uint32_t exrWidth = 0, exrHeight = 0;
+    if(load_exr_rgba(buffer.data(), buffer.size(), exrWidth, exrHeight, m_Decoded))
     {
-      RDCERR("Unsupported EXR file detected - multipart or similar.");
-      FileIO::fclose(f);
-      return;
+      texDetails.width = exrWidth;
+      texDetails.height = exrHeight;
+
+      datasize = m_Decoded.size();
+      data = m_Decoded.data();
     }
+    else
+    {
+      EXRVersion exrVersion;
+      int ret = ParseEXRVersionFromMemory(&exrVersion, buffer.data(), buffer.size());
 
-    EXRHeader exrHeader;
-    InitEXRHeader(&exrHeader);
+      if(ret != 0)
+      {
+        RDCERR("EXR file detected, but couldn't load with ParseEXRVersionFromMemory: %d", ret);
+        FileIO::fclose(f);
+        return;
+      }
 
-    const char *err = NULL;
+      if(exrVersion.multipart || exrVersion.non_image || exrVersion.tiled)
+      {
+        RDCERR("Unsupported EXR file detected - multipart or similar.");
+        FileIO::fclose(f);
+        return;
+      }
 
-    ret = ParseEXRHeaderFromMemory(&exrHeader, &exrVersion, buffer.data(), buffer.size(), &err);
-    if(ret != 0)
-    {
-      RDCERR("EXR file detected, but couldn't load with ParseEXRHeaderFromMemory %d: '%s'", ret, err);
-      FileIO::fclose(f);
-      return;
-    }
+      EXRHeader exrHeader;
+      InitEXRHeader(&exrHeader);
 
-    for(int i = 0; i < exrHeader.num_channels; i++)
-      exrHeader.requested_pixel_types[i] = TINYEXR_PIXELTYPE_FLOAT;
+      const char *err = NULL;
 
-    EXRImage exrImage;
-    InitEXRImage(&exrImage);
+      ret = ParseEXRHeaderFromMemory(&exrHeader, &exrVersion, buffer.data(), buffer.size(), &err);
+      if(ret != 0)
+      {
+        RDCERR("EXR file detected, but couldn't load with ParseEXRHeaderFromMemory %d: '%s'", ret,
+               err);
+        FileIO::fclose(f);
+        return;
+      }
 
-    ret = LoadEXRImageFromMemory(&exrImage, &exrHeader, buffer.data(), buffer.size(), &err);
-    if(ret != 0)
-    {
-      RDCERR("EXR file detected, but couldn't load with LoadEXRImageFromMemory %d: '%s'", ret, err);
-      FileIO::fclose(f);
-      return;
-    }
+      for(int i = 0; i < exrHeader.num_channels; i++)
+        exrHeader.requested_pixel_types[i] = TINYEXR_PIXELTYPE_FLOAT;
 
-    texDetails.width = exrImage.width;
-    texDetails.height = exrImage.height;
+      EXRImage exrImage;
+      InitEXRImage(&exrImage);
 
-    datasize = texDetails.width * texDetails.height * 4 * sizeof(float);
-    data = (byte *)malloc(datasize);
+      ret = LoadEXRImageFromMemory(&exrImage, &exrHeader, buffer.data(), buffer.size(), &err);
+      if(ret != 0)
+      {
+        RDCERR("EXR file detected, but couldn't load with LoadEXRImageFromMemory %d: '%s'", ret,
+               err);
+        FileIO::fclose(f);
+        return;
+      }
 
-    int channels[4] = {-1, -1, -1, -1};
-    for(int i = 0; i < exrImage.num_channels; i++)
-    {
-      switch(exrHeader.channels[i].name[0])
+      texDetails.width = exrImage.width;
+      texDetails.height = exrImage.height;
+
+      datasize = texDetails.width * texDetails.height * 4 * sizeof(float);
+      m_Decoded.resize(datasize);
+      data = m_Decoded.data();
+
+      int channels[4] = {-1, -1, -1, -1};
+      for(int i = 0; i < exrImage.num_channels; i++)
       {
-        case 'R': channels[0] = i; break;
-        case 'G': channels[1] = i; break;
-        case 'B': channels[2] = i; break;
-        case 'A': channels[3] = i; break;
+        switch(exrHeader.channels[i].name[0])
+        {
+          case 'R': channels[0] = i; break;
+          case 'G': channels[1] = i; break;
+          case 'B': channels[2] = i; break;
+          case 'A': channels[3] = i; break;
+        }
       }
-    }
 
-    float *rgba = (float *)data;
-    float **src = (float **)exrImage.images;
+      float *rgba = (float *)data;
+      float **src = (float **)exrImage.images;
 
-    for(uint32_t i = 0; i < texDetails.width * texDetails.height; i++)
-    {
-      for(int c = 0; c < 4; c++)
+      for(uint32_t i = 0; i < texDetails.width * texDetails.height; i++)
       {
-        if(channels[c] >= 0)
-          rgba[i * 4 + c] = src[channels[c]][i];
-        else if(c < 3)    // RGB channels default to 0
-          rgba[i * 4 + c] = 0.0f;
-        else    // alpha defaults to 1
-          rgba[i * 4 + c] = 1.0f;
+        for(int c = 0; c < 4; c++)
+        {
+          if(channels[c] >= 0)
+            rgba[i * 4 + c] = src[channels[c]][i];
+          else if(c < 3)    // RGB channels default to 0
+            rgba[i * 4 + c] = 0.0f;
+          else    // alpha defaults to 1
+            rgba[i * 4 + c] = 1.0f;
+        }
       }
-    }
 
-    FreeEXRImage(&exrImage);
+      FreeEXRImage(&exrImage);
 
-    // shouldn't get here but let's be safe
-    if(ret != 0)
-    {
-      free(data);
-      RDCERR("EXR file detected, but couldn't load with LoadEXRFromMemory %d: '%s'", ret, err);
-      FileIO::fclose(f);
-      return;
+      // shouldn't get here but let's be safe
+      if(ret != 0)
+      {
+        RDCERR("EXR file detected, but couldn't load with LoadEXRFromMemory %d: '%s'", ret, err);
+        FileIO::fclose(f);
+        return;
+      }
     }
   }
-  else if(stbi_is_hdr_from_file(f))
+  else if(dds)
+  {
+    // loaded below
+  }
+  else if(stbi_is_hdr_from_memory(buffer.data(), (int)buffer.size()))
   {
     texDetails.format = rgba32_float;
 
-    FileIO::fseek64(f, 0, SEEK_SET);
-
     int ignore = 0;
-    data = (byte *)stbi_loadf_from_file(f, (int *)&texDetails.width, (int *)&texDetails.height,
-                                        &ignore, 4);
+    data = (byte *)stbi_loadf_from_memory(buffer.data(), (int)buffer.size(),
+                                          (int *)&texDetails.width, (int *)&texDetails.height,
+                                          &ignore, 4);
     datasize = texDetails.width * texDetails.height * 4 * sizeof(float);
   }
-  else if(is_dds_file(f))
-  {
-    dds = true;
-  }
   else
   {
     int ignore = 0;
-    int ret = stbi_info_from_file(f, (int *)&texDetails.width, (int *)&texDetails.height, &ignore);
+    int ret = stbi_info_from_memory(buffer.data(), (int)buffer.size(), (int *)&texDetails.width,
+                                    (int *)&texDetails.height, &ignore);
 
     // just in case (we shouldn't have come in here if this weren't true), make sure
     // the format is supported
@@ -660,7 +721,8 @@ void ImageViewer::RefreshFile()
 
     texDetails.format = rgba8_unorm;
 
-    data = stbi_load_from_file(f, (int *)&texDetails.width, (int *)&texDetails.height, &ignore, 4);
+    data = stbi_load_from_memory(buffer.data(), (int)buffer.size(), (int *)&texDetails.width,
+                                 (int *)&texDetails.height, &ignore, 4);
     datasize = texDetails.width * texDetails.height * 4 * sizeof(byte);
   }
 
@@ -681,7 +743,9 @@ void ImageViewer::RefreshFile()
   if(dds)
   {
     FileIO::fseek64(f, 0, SEEK_SET);
-    read_data = load_dds_from_file(f);
+    // the file is watched and reloaded whenever it changes, so it may be truncated while we're
+    // uploading from it. Read it rather than mapping, where that would fault.
+    read_data = load_dds_from_file(f, false);
 
     if(read_data.subdata == NULL)
     {
@@ -727,22 +791,33 @@ void ImageViewer::RefreshFile()
 
   m_FrameRecord.frameInfo.compressedFileSize = m_FrameRecord.frameInfo.uncompressedFileSize;
 
-  // recreate proxy texture if necessary.
+  const bool sameShape =
+      m_TextureID != ResourceId() && m_TexDetails.width == texDetails.width &&
+      m_TexDetails.height == texDetails.height && m_TexDetails.depth == texDetails.depth &&
+      m_TexDetails.cubemap == texDetails.cubemap && m_TexDetails.mips == texDetails.mips &&
+      m_TexDetails.arraysize == texDetails.arraysize && m_TexDetails.format == texDetails.format;
+
+  if(dds)
+  {
+    // the subresources are contiguous in the DDS storage
+    hash = HashFileContents(read_data.subdata[0],
+                            (size_t)m_FrameRecord.frameInfo.uncompressedFileSize);
+    if(sameShape && hash == m_LoadedHash)
+    {
+      free_dds_data(read_data);
+      FileIO::fclose(f);
+      return;
+    }
+  }
+
+  // recreate proxy texture if necessary, otherwise only the contents are updated.
   // we rewrite the texture IDs so that the
   // outside world doesn't need to know about this
   // (we only ever have one texture in the image
   // viewer so we can just set all texture IDs
   // used to that).
-  if(m_TextureID != ResourceId())
-  {
-    if(m_TexDetails.width != texDetails.width || m_TexDetails.height != texDetails.height ||
-       m_TexDetails.depth != texDetails.depth || m_TexDetails.cubemap != texDetails.cubemap ||
-       m_TexDetails.mips != texDetails.mips || m_TexDetails.arraysize != texDetails.arraysize ||
-       m_TexDetails.width != texDetails.width || m_TexDetails.format != texDetails.format)
-    {
-      m_TextureID = ResourceId();
-    }
-  }
+  if(!sameShape)
+    m_TextureID = ResourceId();
 
   if(m_TextureID == ResourceId())
     m_TextureID = m_Proxy->CreateProxyTexture(texDetails);
@@ -757,7 +832,10 @@ void ImageViewer::RefreshFile()
   if(!dds)
   {
     m_Proxy->SetProxyTextureData(m_TextureID, Subresource(), data, datasize);
-    free(data);
+
+    // stb allocates its own results, the other decoders write into the reusable buffer
+    if(data != m_Decoded.data())
+      free(data);
   }
   else
   {
@@ -765,13 +843,12 @@ void ImageViewer::RefreshFile()
     {
       m_Proxy->SetProxyTextureData(m_TextureID, {i % texDetails.mips, i / texDetails.mips},
                                    read_data.subdata[i], (size_t)read_data.subsizes[i]);
-
-      delete[] read_data.subdata[i];
     }
 
-    delete[] read_data.subdata;
-    delete[] read_data.subsizes;
+    free_dds_data(read_data);
   }
 
+  m_LoadedHash = m_TextureID != ResourceId() ? hash : 0;
+
   FileIO::fclose(f);
 }
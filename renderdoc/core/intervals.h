@@ -23,10 +23,13 @@
 ******************************************************************************/
 #pragma once
 
+#include <algorithm>
+#include <initializer_list>
 #include <map>
+#include <vector>
 #include "common/common.h"
 
-template <typename T>
+template <typename T, typename Map = std::map<uint64_t, T>>
 struct Intervals;
 
 template <typename T, typename Map, typename Iter, typename Interval>
@@ -106,7 +109,8 @@ public:
 template <typename T, typename Map, typename Iter, typename Interval>
 class IntervalsIter
 {
-  friend struct Intervals<T>;
+  template <typename, typename>
+  friend struct Intervals;
 
 protected:
   Interval ref;
@@ -154,29 +158,194 @@ public:
   inline Interval *operator->() { return &ref; }
 };
 
-// Data structure to efficiently store values for disjoint intervals.
-template <typename T>
-struct Intervals
+// A sorted map with the subset of the std::map interface that Intervals uses. While it holds at
+// most MaxFlatSize elements they are stored contiguously in a sorted vector, so lookups and
+// iteration are much more cache friendly than walking map nodes, at the cost of insert and erase
+// moving the following elements. Once it grows past that it moves the elements into a std::map and
+// stays that way, so heavily fragmented ranges don't degrade to quadratic time.
+// Inserting or erasing invalidates iterators at or after that point while flat, and inserting
+// invalidates all iterators when switching to the map. That is fine for Intervals since it only
+// holds one iterator at a time and re-points it on every insert.
+template <typename K, typename V, size_t MaxFlatSize = 128>
+class SmallSortedMap
 {
-public:
-  typedef IntervalRef<T, std::map<uint64_t, T>, typename std::map<uint64_t, T>::iterator> interval;
-  typedef IntervalsIter<T, std::map<uint64_t, T>, typename std::map<uint64_t, T>::iterator, interval> iterator;
+  typedef std::vector<std::pair<K, V>> Flat;
+  typedef std::map<K, V> Tree;
 
-  typedef ConstIntervalRef<T, const std::map<uint64_t, T>, typename std::map<uint64_t, T>::const_iterator>
-      const_interval;
-  typedef IntervalsIter<T, const std::map<uint64_t, T>,
-                        typename std::map<uint64_t, T>::const_iterator, const_interval>
+  template <typename FlatIter, typename TreeIter, typename ValueRef>
+  class iterator_base
+  {
+    friend class SmallSortedMap;
+
+    bool flat;
+    FlatIter f;
+    TreeIter t;
+
+    iterator_base(FlatIter it) : flat(true), f(it), t() {}
+    iterator_base(TreeIter it) : flat(false), f(), t(it) {}
+  public:
+    // the element types differ between the vector and the map, so -> gives references to both
+    // halves of the element instead of a pointer to it.
+    struct pointer
+    {
+      const K &first;
+      ValueRef second;
+      const pointer *operator->() const { return this; }
+    };
+
+    iterator_base() : flat(true), f(), t() {}
+    pointer operator->() const
+    {
+      return flat ? pointer{f->first, f->second} : pointer{t->first, t->second};
+    }
+    iterator_base &operator++()
+    {
+      if(flat)
+        ++f;
+      else
+        ++t;
+      return *this;
+    }
+    iterator_base &operator--()
+    {
+      if(flat)
+        --f;
+      else
+        --t;
+      return *this;
+    }
+    iterator_base operator++(int)
+    {
+      iterator_base tmp(*this);
+      operator++();
+      return tmp;
+    }
+    iterator_base operator--(int)
+    {
+      iterator_base tmp(*this);
+      operator--();
+      return tmp;
+    }
+    bool operator==(const iterator_base &o) const
+    {
+      return flat == o.flat && (flat ? f == o.f : t == o.t);
+    }
+    bool operator!=(const iterator_base &o) const { return !(*this == o); }
+  };
+
+public:
+  typedef std::pair<K, V> value_type;
+  typedef iterator_base<typename Flat::iterator, typename Tree::iterator, V &> iterator;
+  typedef iterator_base<typename Flat::const_iterator, typename Tree::const_iterator, const V &>
       const_iterator;
+  typedef size_t size_type;
 
-private:
-  std::map<uint64_t, T> StartPoints;
+  SmallSortedMap() {}
+  SmallSortedMap(std::initializer_list<value_type> init)
+  {
+    for(const value_type &val : init)
+      insert(val);
+  }
 
-  iterator Wrap(typename std::map<uint64_t, T>::iterator iter)
+  inline iterator begin() { return flat ? iterator(elems.begin()) : iterator(tree.begin()); }
+  inline iterator end() { return flat ? iterator(elems.end()) : iterator(tree.end()); }
+  inline const_iterator begin() const
+  {
+    return flat ? const_iterator(elems.begin()) : const_iterator(tree.begin());
+  }
+  inline const_iterator end() const
   {
-    return iterator(&StartPoints, iter);
+    return flat ? const_iterator(elems.end()) : const_iterator(tree.end());
+  }
+  inline size_type size() const { return flat ? elems.size() : tree.size(); }
+  // true while the elements are still stored in the sorted vector
+  inline bool isFlat() const { return flat; }
+  iterator upper_bound(const K &key)
+  {
+    if(flat)
+      return iterator(std::upper_bound(elems.begin(), elems.end(), key, KeyGreater));
+    return iterator(tree.upper_bound(key));
   }
 
-  const_iterator Wrap(typename std::map<uint64_t, T>::const_iterator iter) const
+  const_iterator upper_bound(const K &key) const
+  {
+    if(flat)
+      return const_iterator(std::upper_bound(elems.begin(), elems.end(), key, KeyGreater));
+    return const_iterator(tree.upper_bound(key));
+  }
+
+  std::pair<iterator, bool> insert(const value_type &val)
+  {
+    if(!flat)
+    {
+      std::pair<typename Tree::iterator, bool> ret = tree.insert(val);
+      return std::make_pair(iterator(ret.first), ret.second);
+    }
+
+    // appending is by far the most common case when building intervals in order
+    if(elems.empty() || elems.back().first < val.first)
+    {
+      elems.push_back(val);
+    }
+    else
+    {
+      typename Flat::iterator it =
+          std::lower_bound(elems.begin(), elems.end(), val.first, KeyLessThan);
+      if(it != elems.end() && it->first == val.first)
+        return std::make_pair(iterator(it), false);
+
+      it = elems.insert(it, val);
+
+      if(elems.size() <= MaxFlatSize)
+        return std::make_pair(iterator(it), true);
+    }
+
+    if(elems.size() <= MaxFlatSize)
+      return std::make_pair(iterator(elems.end() - 1), true);
+
+    // too many elements for inserts to stay cheap, move everything into the map
+    for(const value_type &e : elems)
+      tree.insert(tree.end(), e);
+    Flat().swap(elems);
+    flat = false;
+
+    return std::make_pair(iterator(tree.find(val.first)), true);
+  }
+
+  iterator erase(iterator it)
+  {
+    if(flat)
+      return iterator(elems.erase(it.f));
+    return iterator(tree.erase(it.t));
+  }
+
+private:
+  static bool KeyLessThan(const value_type &a, const K &key) { return a.first < key; }
+  static bool KeyGreater(const K &key, const value_type &a) { return key < a.first; }
+  bool flat = true;
+  Flat elems;
+  Tree tree;
+};
+
+// Data structure to efficiently store values for disjoint intervals.
+// `Map` is the ordered container mapping each interval's start to its value. By default this is a
+// std::map, FlatIntervals below uses a SmallSortedMap instead which is much faster when there are
+// few intervals that get updated frequently.
+template <typename T, typename Map>
+struct Intervals
+{
+public:
+  typedef IntervalRef<T, Map, typename Map::iterator> interval;
+  typedef IntervalsIter<T, Map, typename Map::iterator, interval> iterator;
+
+  typedef ConstIntervalRef<T, const Map, typename Map::const_iterator> const_interval;
+  typedef IntervalsIter<T, const Map, typename Map::const_iterator, const_interval> const_iterator;
+
+private:
+  Map StartPoints;
+
+  iterator Wrap(typename Map::iterator iter) { return iterator(&StartPoints, iter); }
+  const_iterator Wrap(typename Map::const_iterator iter) const
   {
     return const_iterator(&StartPoints, iter);
   }
@@ -187,7 +356,7 @@ public:
   inline iterator begin() { return Wrap(StartPoints.begin()); }
   inline const_iterator begin() const { return Wrap(StartPoints.begin()); }
   inline const_iterator end() const { return Wrap(StartPoints.end()); }
-  typedef typename std::map<uint64_t, T>::size_type size_type;
+  typedef typename Map::size_type size_type;
   inline size_type size() const { return StartPoints.size(); }
   // Find the interval containing `x`.
   iterator find(uint64_t x)
@@ -288,3 +457,7 @@ public:
     }
   }
 };
+
+// Intervals stored in a sorted vector rather than a std::map, until there are too many of them.
+template <typename T>
+using FlatIntervals = Intervals<T, SmallSortedMap<uint64_t, T>>;
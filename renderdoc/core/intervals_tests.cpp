@@ -24,6 +24,7 @@
 
 #include "intervals.h"
 #include "common/globalconfig.h"
+#include "common/timing.h"
 
 #if ENABLED(ENABLE_UNIT_TESTS)
 
@@ -39,7 +40,8 @@ struct Interval
   uint64_t end;
 };
 
-void check_intervals(Intervals<uint64_t> &value, const std::vector<Interval> &expected)
+template <typename IntervalsType>
+void check_intervals(IntervalsType &value, const std::vector<Interval> &expected)
 {
   auto i = value.begin();
   auto j = expected.begin();
@@ -53,95 +55,104 @@ void check_intervals(Intervals<uint64_t> &value, const std::vector<Interval> &ex
   CHECK((j == expected.end()));
 }
 
-Intervals<uint64_t> make_intervals(const std::vector<Interval> &intervals)
+// builds whichever Intervals type it's assigned to, so the same tests run against every backend
+struct make_intervals
 {
-  Intervals<uint64_t> res;
-  for(auto i = intervals.begin(); i != intervals.end(); i++)
+  make_intervals(const std::vector<Interval> &intervals) : intervals(intervals) {}
+  template <typename IntervalsType>
+  operator IntervalsType() const
   {
-    auto j = res.end();
-    j--;
-    if(i->start > j->start())
-      j->split(i->start);
-    if(i->end < j->finish())
+    IntervalsType res;
+    for(auto i = intervals.begin(); i != intervals.end(); i++)
     {
-      j->split(i->end);
+      auto j = res.end();
       j--;
+      if(i->start > j->start())
+        j->split(i->start);
+      if(i->end < j->finish())
+      {
+        j->split(i->end);
+        j--;
+      }
+      j->setValue(i->value);
     }
-    j->setValue(i->value);
+    check_intervals(res, intervals);
+    return res;
   }
-  check_intervals(res, intervals);
-  return res;
-}
 
-TEST_CASE("Test Intervals type", "[intervals]")
+  std::vector<Interval> intervals;
+};
+
+template <typename IntervalsType>
+void test_intervals()
 {
   SECTION("update tests")
   {
     SECTION("empty Intervals")
     {
-      Intervals<uint64_t> test;
+      IntervalsType test;
       check_intervals(test, {{0, 0, UINT64_MAX}});
     };
 
     SECTION("update a sub-interval")
     {
-      Intervals<uint64_t> test;
+      IntervalsType test;
       test.update(5, 10, 1, [](uint64_t x, uint64_t y) -> uint64_t { return x + y; });
       check_intervals(test, {{0, 0, 5}, {5, 1, 10}, {10, 0, UINT64_MAX}});
     };
 
     SECTION("update a sub-interval matching on the left")
     {
-      Intervals<uint64_t> test = make_intervals({{0, 0, 5}, {5, 1, 10}, {10, 0, UINT64_MAX}});
+      IntervalsType test = make_intervals({{0, 0, 5}, {5, 1, 10}, {10, 0, UINT64_MAX}});
       test.update(5, 7, 1, [](uint64_t x, uint64_t y) -> uint64_t { return x + y; });
       check_intervals(test, {{0, 0, 5}, {5, 2, 7}, {7, 1, 10}, {10, 0, UINT64_MAX}});
     };
 
     SECTION("update a sub-interval matching on the right")
     {
-      Intervals<uint64_t> test = make_intervals({{0, 0, 5}, {5, 1, 10}, {10, 0, UINT64_MAX}});
+      IntervalsType test = make_intervals({{0, 0, 5}, {5, 1, 10}, {10, 0, UINT64_MAX}});
       test.update(7, 10, 1, [](uint64_t x, uint64_t y) -> uint64_t { return x + y; });
       check_intervals(test, {{0, 0, 5}, {5, 1, 7}, {7, 2, 10}, {10, 0, UINT64_MAX}});
     };
 
     SECTION("update an interval that exactly matches an existing interval")
     {
-      Intervals<uint64_t> test = make_intervals({{0, 0, 5}, {5, 1, 10}, {10, 0, UINT64_MAX}});
+      IntervalsType test = make_intervals({{0, 0, 5}, {5, 1, 10}, {10, 0, UINT64_MAX}});
       test.update(5, 10, 1, [](uint64_t x, uint64_t y) -> uint64_t { return x + y; });
       check_intervals(test, {{0, 0, 5}, {5, 2, 10}, {10, 0, UINT64_MAX}});
     };
 
     SECTION("update a properly overlapping interval")
     {
-      Intervals<uint64_t> test = make_intervals({{0, 0, 5}, {5, 1, 10}, {10, 0, UINT64_MAX}});
+      IntervalsType test = make_intervals({{0, 0, 5}, {5, 1, 10}, {10, 0, UINT64_MAX}});
       test.update(7, 15, 1, [](uint64_t x, uint64_t y) -> uint64_t { return x + y; });
       check_intervals(test, {{0, 0, 5}, {5, 1, 7}, {7, 2, 10}, {10, 1, 15}, {15, 0, UINT64_MAX}});
     };
 
     SECTION("update a super-interval")
     {
-      Intervals<uint64_t> test = make_intervals({{0, 0, 5}, {5, 1, 10}, {10, 0, UINT64_MAX}});
+      IntervalsType test = make_intervals({{0, 0, 5}, {5, 1, 10}, {10, 0, UINT64_MAX}});
       test.update(2, 15, 1, [](uint64_t x, uint64_t y) -> uint64_t { return x + y; });
       check_intervals(test, {{0, 0, 2}, {2, 1, 5}, {5, 2, 10}, {10, 1, 15}, {15, 0, UINT64_MAX}});
     };
 
     SECTION("update a super-interval matching on the left")
     {
-      Intervals<uint64_t> test = make_intervals({{0, 0, 5}, {5, 1, 10}, {10, 0, UINT64_MAX}});
+      IntervalsType test = make_intervals({{0, 0, 5}, {5, 1, 10}, {10, 0, UINT64_MAX}});
       test.update(5, 15, 1, [](uint64_t x, uint64_t y) -> uint64_t { return x + y; });
       check_intervals(test, {{0, 0, 5}, {5, 2, 10}, {10, 1, 15}, {15, 0, UINT64_MAX}});
     };
 
     SECTION("update a super-interval matching on the right")
     {
-      Intervals<uint64_t> test = make_intervals({{0, 0, 5}, {5, 1, 10}, {10, 0, UINT64_MAX}});
+      IntervalsType test = make_intervals({{0, 0, 5}, {5, 1, 10}, {10, 0, UINT64_MAX}});
       test.update(2, 10, 1, [](uint64_t x, uint64_t y) -> uint64_t { return x + y; });
       check_intervals(test, {{0, 0, 2}, {2, 1, 5}, {5, 2, 10}, {10, 0, UINT64_MAX}});
     };
 
     SECTION("update overlapping 2 intervals")
     {
-      Intervals<uint64_t> test =
+      IntervalsType test =
           make_intervals({{0, 0, 5}, {5, 1, 10}, {10, 0, 20}, {20, 10, 30}, {30, 0, UINT64_MAX}});
       test.update(7, 25, 1, [](uint64_t x, uint64_t y) -> uint64_t { return x + y; });
       check_intervals(test, {{0, 0, 5},
@@ -155,7 +166,7 @@ TEST_CASE("Test Intervals type", "[intervals]")
 
     SECTION("update overlapping 2 intervals matching on start of leftmost interval")
     {
-      Intervals<uint64_t> test =
+      IntervalsType test =
           make_intervals({{0, 0, 5}, {5, 1, 10}, {10, 0, 20}, {20, 10, 30}, {30, 0, UINT64_MAX}});
       test.update(5, 25, 1, [](uint64_t x, uint64_t y) -> uint64_t { return x + y; });
       check_intervals(
@@ -165,7 +176,7 @@ TEST_CASE("Test Intervals type", "[intervals]")
 
     SECTION("update overlapping 2 intervals matching on end of leftmost interval")
     {
-      Intervals<uint64_t> test =
+      IntervalsType test =
           make_intervals({{0, 0, 5}, {5, 5, 10}, {10, 0, 20}, {20, 10, 30}, {30, 0, UINT64_MAX}});
       test.update(10, 25, 1, [](uint64_t x, uint64_t y) -> uint64_t { return x + y; });
       check_intervals(
@@ -175,7 +186,7 @@ TEST_CASE("Test Intervals type", "[intervals]")
 
     SECTION("update overlapping 2 intervals matching on start of rightmost interval")
     {
-      Intervals<uint64_t> test =
+      IntervalsType test =
           make_intervals({{0, 0, 5}, {5, 1, 10}, {10, 0, 20}, {20, 10, 30}, {30, 0, UINT64_MAX}});
       test.update(7, 20, 1, [](uint64_t x, uint64_t y) -> uint64_t { return x + y; });
       check_intervals(
@@ -184,7 +195,7 @@ TEST_CASE("Test Intervals type", "[intervals]")
 
     SECTION("update overlapping 2 intervals matching on end of rightmost interval")
     {
-      Intervals<uint64_t> test =
+      IntervalsType test =
           make_intervals({{0, 0, 5}, {5, 1, 10}, {10, 0, 20}, {20, 10, 30}, {30, 0, UINT64_MAX}});
       test.update(7, 30, 1, [](uint64_t x, uint64_t y) -> uint64_t { return x + y; });
       check_intervals(
@@ -193,35 +204,35 @@ TEST_CASE("Test Intervals type", "[intervals]")
 
     SECTION("update triggering merge on left")
     {
-      Intervals<uint64_t> test = make_intervals({{0, 0, 5}, {5, 1, 10}, {10, 0, UINT64_MAX}});
+      IntervalsType test = make_intervals({{0, 0, 5}, {5, 1, 10}, {10, 0, UINT64_MAX}});
       test.update(10, 20, 1, [](uint64_t x, uint64_t y) -> uint64_t { return x + y; });
       check_intervals(test, {{0, 0, 5}, {5, 1, 20}, {20, 0, UINT64_MAX}});
     };
 
     SECTION("update triggering merge on right")
     {
-      Intervals<uint64_t> test = make_intervals({{0, 0, 5}, {5, 1, 10}, {10, 0, UINT64_MAX}});
+      IntervalsType test = make_intervals({{0, 0, 5}, {5, 1, 10}, {10, 0, UINT64_MAX}});
       test.update(2, 5, 1, [](uint64_t x, uint64_t y) -> uint64_t { return x + y; });
       check_intervals(test, {{0, 0, 2}, {2, 1, 10}, {10, 0, UINT64_MAX}});
     };
 
     SECTION("overlapping update triggering merge on left")
     {
-      Intervals<uint64_t> test = make_intervals({{0, 0, 5}, {5, 1, 10}, {10, 0, UINT64_MAX}});
+      IntervalsType test = make_intervals({{0, 0, 5}, {5, 1, 10}, {10, 0, UINT64_MAX}});
       test.update(7, 20, 1, [](uint64_t, uint64_t) -> uint64_t { return 1; });
       check_intervals(test, {{0, 0, 5}, {5, 1, 20}, {20, 0, UINT64_MAX}});
     };
 
     SECTION("overlapping update triggering merge on right")
     {
-      Intervals<uint64_t> test = make_intervals({{0, 0, 5}, {5, 1, 10}, {10, 0, UINT64_MAX}});
+      IntervalsType test = make_intervals({{0, 0, 5}, {5, 1, 10}, {10, 0, UINT64_MAX}});
       test.update(2, 7, 1, [](uint64_t, uint64_t) -> uint64_t { return 1; });
       check_intervals(test, {{0, 0, 2}, {2, 1, 10}, {10, 0, UINT64_MAX}});
     };
 
     SECTION("update triggering multiple merges")
     {
-      Intervals<uint64_t> test = make_intervals(
+      IntervalsType test = make_intervals(
           {{0, 0, 5}, {5, 1, 10}, {10, 0, 12}, {12, 5, 18}, {18, 0, 20}, {20, 1, 30}, {30, 0, UINT64_MAX}});
       test.update(7, 25, 1, [](uint64_t, uint64_t) -> uint64_t { return 1; });
       check_intervals(test, {{0, 0, 5}, {5, 1, 30}, {30, 0, UINT64_MAX}});
@@ -230,7 +241,7 @@ TEST_CASE("Test Intervals type", "[intervals]")
     SECTION(
         "update triggering multiple merges, including merge with non-overlapping interval on left")
     {
-      Intervals<uint64_t> test = make_intervals(
+      IntervalsType test = make_intervals(
           {{0, 0, 5}, {5, 1, 10}, {10, 0, 12}, {12, 5, 18}, {18, 0, 20}, {20, 1, 30}, {30, 0, UINT64_MAX}});
       test.update(10, 25, 1, [](uint64_t, uint64_t) -> uint64_t { return 1; });
       check_intervals(test, {{0, 0, 5}, {5, 1, 30}, {30, 0, UINT64_MAX}});
@@ -239,7 +250,7 @@ TEST_CASE("Test Intervals type", "[intervals]")
     SECTION(
         "update triggering multiple merges, including merge with non-overlapping interval on right")
     {
-      Intervals<uint64_t> test = make_intervals(
+      IntervalsType test = make_intervals(
           {{0, 0, 5}, {5, 1, 10}, {10, 0, 12}, {12, 5, 18}, {18, 0, 20}, {20, 1, 30}, {30, 0, UINT64_MAX}});
       test.update(7, 20, 1, [](uint64_t, uint64_t) -> uint64_t { return 1; });
       check_intervals(test, {{0, 0, 5}, {5, 1, 30}, {30, 0, UINT64_MAX}});
@@ -247,49 +258,49 @@ TEST_CASE("Test Intervals type", "[intervals]")
 
     SECTION("update a interval starting at 0")
     {
-      Intervals<uint64_t> test = make_intervals({{0, 0, 5}, {5, 1, 10}, {10, 0, UINT64_MAX}});
+      IntervalsType test = make_intervals({{0, 0, 5}, {5, 1, 10}, {10, 0, UINT64_MAX}});
       test.update(0, 10, 1, [](uint64_t x, uint64_t y) -> uint64_t { return x + y; });
       check_intervals(test, {{0, 1, 5}, {5, 2, 10}, {10, 0, UINT64_MAX}});
     };
 
     SECTION("update a interval finishing at UINT64_MAX")
     {
-      Intervals<uint64_t> test = make_intervals({{0, 0, 5}, {5, 1, 10}, {10, 0, UINT64_MAX}});
+      IntervalsType test = make_intervals({{0, 0, 5}, {5, 1, 10}, {10, 0, UINT64_MAX}});
       test.update(5, UINT64_MAX, 1, [](uint64_t x, uint64_t y) -> uint64_t { return x + y; });
       check_intervals(test, {{0, 0, 5}, {5, 2, 10}, {10, 1, UINT64_MAX}});
     };
 
     SECTION("update entire range")
     {
-      Intervals<uint64_t> test = make_intervals({{0, 0, 5}, {5, 1, 10}, {10, 0, UINT64_MAX}});
+      IntervalsType test = make_intervals({{0, 0, 5}, {5, 1, 10}, {10, 0, UINT64_MAX}});
       test.update(0, UINT64_MAX, 1, [](uint64_t x, uint64_t y) -> uint64_t { return x + y; });
       check_intervals(test, {{0, 1, 5}, {5, 2, 10}, {10, 1, UINT64_MAX}});
     };
 
     SECTION("update an empty interval in the interior of an interval")
     {
-      Intervals<uint64_t> test = make_intervals({{0, 0, 5}, {5, 1, 10}, {10, 0, UINT64_MAX}});
+      IntervalsType test = make_intervals({{0, 0, 5}, {5, 1, 10}, {10, 0, UINT64_MAX}});
       test.update(2, 2, 1, [](uint64_t x, uint64_t y) -> uint64_t { return x + y; });
       check_intervals(test, {{0, 0, 5}, {5, 1, 10}, {10, 0, UINT64_MAX}});
     };
 
     SECTION("update an empty interval on a boundary")
     {
-      Intervals<uint64_t> test = make_intervals({{0, 0, 5}, {5, 1, 10}, {10, 0, UINT64_MAX}});
+      IntervalsType test = make_intervals({{0, 0, 5}, {5, 1, 10}, {10, 0, UINT64_MAX}});
       test.update(5, 5, 1, [](uint64_t x, uint64_t y) -> uint64_t { return x + y; });
       check_intervals(test, {{0, 0, 5}, {5, 1, 10}, {10, 0, UINT64_MAX}});
     };
 
     SECTION("update an empty interval at 0")
     {
-      Intervals<uint64_t> test = make_intervals({{0, 0, 5}, {5, 1, 10}, {10, 0, UINT64_MAX}});
+      IntervalsType test = make_intervals({{0, 0, 5}, {5, 1, 10}, {10, 0, UINT64_MAX}});
       test.update(0, 0, 1, [](uint64_t x, uint64_t y) -> uint64_t { return x + y; });
       check_intervals(test, {{0, 0, 5}, {5, 1, 10}, {10, 0, UINT64_MAX}});
     };
 
     SECTION("update an empty interval at UINT64_MAX")
     {
-      Intervals<uint64_t> test = make_intervals({{0, 0, 5}, {5, 1, 10}, {10, 0, UINT64_MAX}});
+      IntervalsType test = make_intervals({{0, 0, 5}, {5, 1, 10}, {10, 0, UINT64_MAX}});
       test.update(UINT64_MAX, UINT64_MAX, 1,
                   [](uint64_t x, uint64_t y) -> uint64_t { return x + y; });
       check_intervals(test, {{0, 0, 5}, {5, 1, 10}, {10, 0, UINT64_MAX}});
@@ -300,9 +311,9 @@ TEST_CASE("Test Intervals type", "[intervals]")
   {
     SECTION("merge matching intervals")
     {
-      Intervals<uint64_t> test =
+      IntervalsType test =
           make_intervals({{0, 0, 10}, {10, 1, 20}, {20, 0, 30}, {30, 1, 40}, {40, 0, UINT64_MAX}});
-      Intervals<uint64_t> other =
+      IntervalsType other =
           make_intervals({{0, 0, 10}, {10, 1, 20}, {20, 0, 30}, {30, 1, 40}, {40, 0, UINT64_MAX}});
       test.merge(other, [](uint64_t x, uint64_t y) -> uint64_t { return x + y; });
       check_intervals(test, {{0, 0, 10}, {10, 2, 20}, {20, 0, 30}, {30, 2, 40}, {40, 0, UINT64_MAX}});
@@ -310,9 +321,9 @@ TEST_CASE("Test Intervals type", "[intervals]")
 
     SECTION("merge shifted intervals")
     {
-      Intervals<uint64_t> test =
+      IntervalsType test =
           make_intervals({{0, 0, 10}, {10, 1, 20}, {20, 0, 30}, {30, 1, 40}, {40, 0, UINT64_MAX}});
-      Intervals<uint64_t> other =
+      IntervalsType other =
           make_intervals({{0, 0, 5}, {5, 1, 15}, {15, 0, 25}, {25, 1, 35}, {35, 0, UINT64_MAX}});
       test.merge(other, [](uint64_t x, uint64_t y) -> uint64_t { return x + y; });
       check_intervals(test, {{0, 0, 5},
@@ -328,8 +339,8 @@ TEST_CASE("Test Intervals type", "[intervals]")
 
     SECTION("merge into empty intervals")
     {
-      Intervals<uint64_t> test = make_intervals({{0, 0, UINT64_MAX}});
-      Intervals<uint64_t> other =
+      IntervalsType test = make_intervals({{0, 0, UINT64_MAX}});
+      IntervalsType other =
           make_intervals({{0, 0, 5}, {5, 1, 15}, {15, 0, 25}, {25, 1, 35}, {35, 0, UINT64_MAX}});
       test.merge(other, [](uint64_t x, uint64_t y) -> uint64_t { return x + y; });
       check_intervals(test, {{0, 0, 5}, {5, 1, 15}, {15, 0, 25}, {25, 1, 35}, {35, 0, UINT64_MAX}});
@@ -337,17 +348,17 @@ TEST_CASE("Test Intervals type", "[intervals]")
 
     SECTION("merge with empty intervals")
     {
-      Intervals<uint64_t> test =
+      IntervalsType test =
           make_intervals({{0, 0, 5}, {5, 1, 15}, {15, 0, 25}, {25, 1, 35}, {35, 0, UINT64_MAX}});
-      Intervals<uint64_t> other = make_intervals({{0, 0, UINT64_MAX}});
+      IntervalsType other = make_intervals({{0, 0, UINT64_MAX}});
       test.merge(other, [](uint64_t x, uint64_t y) -> uint64_t { return x + y; });
       check_intervals(test, {{0, 0, 5}, {5, 1, 15}, {15, 0, 25}, {25, 1, 35}, {35, 0, UINT64_MAX}});
     };
 
     SECTION("merge into single interval")
     {
-      Intervals<uint64_t> test = make_intervals({{0, 0, 10}, {10, 1, 30}, {30, 0, UINT64_MAX}});
-      Intervals<uint64_t> other =
+      IntervalsType test = make_intervals({{0, 0, 10}, {10, 1, 30}, {30, 0, UINT64_MAX}});
+      IntervalsType other =
           make_intervals({{0, 0, 5}, {5, 1, 15}, {15, 0, 25}, {25, 1, 35}, {35, 0, UINT64_MAX}});
       test.merge(other, [](uint64_t x, uint64_t y) -> uint64_t { return x + y; });
       check_intervals(test, {{0, 0, 5},
@@ -361,9 +372,9 @@ TEST_CASE("Test Intervals type", "[intervals]")
 
     SECTION("merge with single interval")
     {
-      Intervals<uint64_t> test =
+      IntervalsType test =
           make_intervals({{0, 0, 5}, {5, 1, 15}, {15, 0, 25}, {25, 1, 35}, {35, 0, UINT64_MAX}});
-      Intervals<uint64_t> other = make_intervals({{0, 0, 10}, {10, 1, 30}, {30, 0, UINT64_MAX}});
+      IntervalsType other = make_intervals({{0, 0, 10}, {10, 1, 30}, {30, 0, UINT64_MAX}});
       test.merge(other, [](uint64_t x, uint64_t y) -> uint64_t { return x + y; });
       check_intervals(test, {{0, 0, 5},
                              {5, 1, 10},
@@ -376,9 +387,9 @@ TEST_CASE("Test Intervals type", "[intervals]")
 
     SECTION("merge disjoint before")
     {
-      Intervals<uint64_t> test =
+      IntervalsType test =
           make_intervals({{0, 0, 50}, {50, 1, 60}, {60, 0, 70}, {70, 1, 80}, {80, 0, UINT64_MAX}});
-      Intervals<uint64_t> other =
+      IntervalsType other =
           make_intervals({{0, 0, 10}, {10, 1, 20}, {20, 0, 30}, {30, 1, 40}, {40, 0, UINT64_MAX}});
       test.merge(other, [](uint64_t x, uint64_t y) -> uint64_t { return x + y; });
       check_intervals(test, {{0, 0, 10},
@@ -394,9 +405,9 @@ TEST_CASE("Test Intervals type", "[intervals]")
 
     SECTION("merge disjoint after")
     {
-      Intervals<uint64_t> test =
+      IntervalsType test =
           make_intervals({{0, 0, 10}, {10, 1, 20}, {20, 0, 30}, {30, 1, 40}, {40, 0, UINT64_MAX}});
-      Intervals<uint64_t> other =
+      IntervalsType other =
           make_intervals({{0, 0, 50}, {50, 1, 60}, {60, 0, 70}, {70, 1, 80}, {80, 0, UINT64_MAX}});
       test.merge(other, [](uint64_t x, uint64_t y) -> uint64_t { return x + y; });
       check_intervals(test, {{0, 0, 10},
@@ -412,9 +423,9 @@ TEST_CASE("Test Intervals type", "[intervals]")
 
     SECTION("merge disjoint interleaved")
     {
-      Intervals<uint64_t> test =
+      IntervalsType test =
           make_intervals({{0, 0, 10}, {10, 1, 20}, {20, 0, 50}, {50, 1, 60}, {60, 0, UINT64_MAX}});
-      Intervals<uint64_t> other =
+      IntervalsType other =
           make_intervals({{0, 0, 30}, {30, 1, 40}, {40, 0, 70}, {70, 1, 80}, {80, 0, UINT64_MAX}});
       test.merge(other, [](uint64_t x, uint64_t y) -> uint64_t { return x + y; });
       check_intervals(test, {{0, 0, 10},
@@ -430,9 +441,9 @@ TEST_CASE("Test Intervals type", "[intervals]")
 
     SECTION("merge disjoint interleaved touching")
     {
-      Intervals<uint64_t> test =
+      IntervalsType test =
           make_intervals({{0, 0, 10}, {10, 1, 20}, {20, 0, 30}, {30, 1, 40}, {40, 0, UINT64_MAX}});
-      Intervals<uint64_t> other =
+      IntervalsType other =
           make_intervals({{0, 0, 20}, {20, 1, 30}, {30, 0, 40}, {40, 1, 50}, {50, 0, UINT64_MAX}});
       test.merge(other, [](uint64_t x, uint64_t y) -> uint64_t { return x + y; });
       check_intervals(test, {{0, 0, 10}, {10, 1, 50}, {50, 0, UINT64_MAX}});
@@ -440,4 +451,116 @@ TEST_CASE("Test Intervals type", "[intervals]")
   };
 };
 
+TEST_CASE("Test Intervals type", "[intervals]")
+{
+  test_intervals<Intervals<uint64_t>>();
+};
+
+TEST_CASE("Test FlatIntervals type", "[intervals]")
+{
+  test_intervals<FlatIntervals<uint64_t>>();
+
+  SECTION("Small flat size")
+  {
+    // most of the tests go past two intervals, so this covers switching over to the map part way
+    // through an update or merge.
+    test_intervals<Intervals<uint64_t, SmallSortedMap<uint64_t, uint64_t, 2>>>();
+  };
+
+  SECTION("Many intervals match std::map")
+  {
+    Intervals<uint64_t> reference;
+    FlatIntervals<uint64_t> flat;
+
+    auto comp = [](uint64_t x, uint64_t y) -> uint64_t { return x | y; };
+
+    uint32_t seed = 1234;
+    for(int r = 0; r < 2000; r++)
+    {
+      seed = seed * 1103515245 + 12345;
+      uint64_t offset = (seed >> 4) % 100000;
+      seed = seed * 1103515245 + 12345;
+      uint64_t size = 1 + (seed >> 4) % 64;
+      uint64_t val = uint64_t(1) << ((seed >> 8) % 8);
+
+      reference.update(offset, offset + size, val, comp);
+      flat.update(offset, offset + size, val, comp);
+    }
+
+    CHECK(reference.size() > 1000);
+    CHECK(flat.size() == reference.size());
+
+    auto i = flat.begin();
+    auto j = reference.begin();
+    uint32_t mismatches = 0;
+    for(; i != flat.end() && j != reference.end(); i++, j++)
+    {
+      if(i->start() != j->start() || i->finish() != j->finish() || i->value() != j->value())
+        mismatches++;
+    }
+
+    CHECK(mismatches == 0);
+  };
+};
+
+template <typename IntervalsType>
+double benchmark_intervals(uint32_t seed, int numRanges, uint64_t maxSize)
+{
+  // simulate many buffer ranges being bound and referenced within a large memory allocation, then
+  // the per-command-buffer refs being merged into the frame refs
+  const uint64_t memSize = 256 * 1024 * 1024;
+  const int numMerges = 64;
+
+  auto comp = [](uint64_t x, uint64_t y) -> uint64_t { return x | y; };
+
+  PerformanceTimer timer;
+
+  IntervalsType frameRefs;
+  for(int m = 0; m < numMerges; m++)
+  {
+    IntervalsType cmdRefs;
+    for(int r = 0; r < numRanges / numMerges; r++)
+    {
+      seed = seed * 1103515245 + 12345;
+      uint64_t offset = (uint64_t(seed) << 8) % memSize;
+      seed = seed * 1103515245 + 12345;
+      uint64_t size = 256 + (seed % maxSize);
+      cmdRefs.update(offset, offset + size, uint64_t(1) << (seed % 4), comp);
+    }
+
+    frameRefs.merge(cmdRefs, comp);
+  }
+
+  return timer.GetMilliseconds();
+}
+
+// not run by default, run explicitly with the [benchmark] tag
+TEST_CASE("Benchmark Intervals backends", "[.][benchmark][intervals]")
+{
+  // a few large ranges that overlap and coalesce into a small number of intervals, and a heavily
+  // suballocated allocation with many small disjoint ranges that ends up with tens of thousands.
+  struct
+  {
+    const char *name;
+    int numRanges;
+    uint64_t maxSize;
+  } workloads[] = {
+      {"few large ranges", 4096, 1024 * 1024},
+      {"many small ranges", 64 * 1024, 4096},
+  };
+
+  for(const auto &w : workloads)
+  {
+    double mapTime = 0.0, flatTime = 0.0;
+
+    for(uint32_t i = 0; i < 10; i++)
+    {
+      mapTime += benchmark_intervals<Intervals<uint64_t>>(i, w.numRanges, w.maxSize);
+      flatTime += benchmark_intervals<FlatIntervals<uint64_t>>(i, w.numRanges, w.maxSize);
+    }
+
+    RDCLOG("%s: Intervals<std::map>: %.2f ms, FlatIntervals: %.2f ms", w.name, mapTime, flatTime);
+  }
+};
+
 #endif    // ENABLED(ENABLE_UNIT_TESTS)
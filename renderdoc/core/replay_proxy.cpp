@@ -86,6 +86,7 @@ rdcstr DoStringise(const ReplayProxyPacket &el)
     STRINGISE_ENUM_NAMED(eReplayProxy_RenderOverlay, "RenderOverlay");
 
     STRINGISE_ENUM_NAMED(eReplayProxy_PixelHistory, "PixelHistory");
+    STRINGISE_ENUM_NAMED(eReplayProxy_PickPixels, "PickPixels");
 
     STRINGISE_ENUM_NAMED(eReplayProxy_DisassembleShader, "DisassembleShader");
     STRINGISE_ENUM_NAMED(eReplayProxy_GetDisassemblyTargets, "GetDisassemblyTargets");
@@ -1445,6 +1446,55 @@ std::vector<PixelModification> ReplayProxy::PixelHistory(std::vector<EventUsage>
   PROXY_FUNCTION(PixelHistory, events, target, x, y, sub, typeCast);
 }
 
+template <typename ParamSerialiser, typename ReturnSerialiser>
+rdcarray<PixelValue> ReplayProxy::Proxied_PickPixels(ParamSerialiser &paramser,
+                                                     ReturnSerialiser &retser, ResourceId texture,
+                                                     const rdcarray<uint32_t> &coords,
+                                                     const Subresource &sub, CompType typeCast)
+{
+  const ReplayProxyPacket expectedPacket = eReplayProxy_PickPixels;
+  ReplayProxyPacket packet = eReplayProxy_PickPixels;
+  rdcarray<PixelValue> ret;
+
+  {
+    BEGIN_PARAMS();
+    SERIALISE_ELEMENT(texture);
+    SERIALISE_ELEMENT(coords);
+    SERIALISE_ELEMENT(sub);
+    SERIALISE_ELEMENT(typeCast);
+    END_PARAMS();
+  }
+
+  {
+    REMOTE_EXECUTION();
+    // the picks are done by the API on the remote side, so a batch costs one round trip
+    if(paramser.IsReading() && !paramser.IsErrored() && !m_IsErrored && m_Replay)
+      ret = m_Replay->PickPixels(texture, coords, sub, typeCast);
+  }
+
+  SERIALISE_RETURN(ret);
+
+  // if the remote server has no replay driver, pick each pixel from the locally cached texture
+  if(m_Proxy && ret.size() != coords.size() / 2)
+  {
+    ret.resize(coords.size() / 2);
+
+    for(size_t i = 0; i < ret.size(); i++)
+    {
+      RDCEraseEl(ret[i].floatValue);
+      PickPixel(texture, coords[i * 2 + 0], coords[i * 2 + 1], sub, typeCast, ret[i].floatValue);
+    }
+  }
+
+  return ret;
+}
+
+rdcarray<PixelValue> ReplayProxy::PickPixels(ResourceId texture, const rdcarray<uint32_t> &coords,
+                                             const Subresource &sub, CompType typeCast)
+{
+  PROXY_FUNCTION(PickPixels, texture, coords, sub, typeCast);
+}
+
 template <typename ParamSerialiser, typename ReturnSerialiser>
 ShaderDebugTrace ReplayProxy::Proxied_DebugVertex(ParamSerialiser &paramser,
                                                   ReturnSerialiser &retser, uint32_t eventId,
@@ -2719,6 +2769,9 @@ bool ReplayProxy::Tick(int type)
     case eReplayProxy_PixelHistory:
       PixelHistory(std::vector<EventUsage>(), ResourceId(), 0, 0, Subresource(), CompType::Typeless);
       break;
+    case eReplayProxy_PickPixels:
+      PickPixels(ResourceId(), rdcarray<uint32_t>(), Subresource(), CompType::Typeless);
+      break;
     case eReplayProxy_DisassembleShader: DisassembleShader(ResourceId(), NULL, ""); break;
     case eReplayProxy_GetDisassemblyTargets: GetDisassemblyTargets(); break;
     case eReplayProxy_GetTargetShaderEncodings: GetTargetShaderEncodings(); break;
@@ -93,6 +93,7 @@ enum ReplayProxyPacket
   eReplayProxy_RenderOverlay,
 
   eReplayProxy_PixelHistory,
+  eReplayProxy_PickPixels,
 
   eReplayProxy_DisassembleShader,
   eReplayProxy_GetDisassemblyTargets,
@@ -523,6 +524,9 @@ public:
   IMPLEMENT_FUNCTION_PROXIED(std::vector<PixelModification>, PixelHistory,
                              std::vector<EventUsage> events, ResourceId target, uint32_t x,
                              uint32_t y, const Subresource &sub, CompType typeCast);
+  IMPLEMENT_FUNCTION_PROXIED(rdcarray<PixelValue>, PickPixels, ResourceId texture,
+                             const rdcarray<uint32_t> &coords, const Subresource &sub,
+                             CompType typeCast);
   IMPLEMENT_FUNCTION_PROXIED(ShaderDebugTrace, DebugVertex, uint32_t eventId, uint32_t vertid,
                              uint32_t instid, uint32_t idx, uint32_t instOffset, uint32_t vertOffset);
   IMPLEMENT_FUNCTION_PROXIED(ShaderDebugTrace, DebugPixel, uint32_t eventId, uint32_t x, uint32_t y,
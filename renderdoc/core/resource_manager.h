@@ -30,6 +30,7 @@
 #include "api/replay/renderdoc_replay.h"
 #include "common/threading.h"
 #include "core/core.h"
+#include "core/intervals.h"
 #include "os/os_specific.h"
 #include "serialise/serialiser.h"
 
@@ -570,9 +571,18 @@ public:
   // of the frame.
   inline void MarkDirtyResource(ResourceId res);
 
+  // indicates only a range of this resource could have been modified by the GPU. The range is in
+  // whatever space the driver chooses for that resource type (e.g. bytes for memory, subresource
+  // indices for textures). Marking the whole resource dirty always takes precedence.
+  inline void MarkDirtyResourceRange(ResourceId res, uint64_t offset, uint64_t size);
+
   // returns if the resource has been marked as dirty
   bool IsResourceDirty(ResourceId res);
 
+  // returns true and fills out the dirty ranges if only part of the resource has been marked as
+  // dirty. Returns false if the whole resource is dirty, or if it isn't dirty at all.
+  bool GetResourceDirtyRanges(ResourceId res, std::vector<rdcpair<uint64_t, uint64_t>> &ranges);
+
   // call callbacks to prepare initial contents for dirty resources
   void PrepareInitialContents();
 
@@ -686,6 +696,10 @@ protected:
   // used during capture - holds resources marked as dirty, needing initial contents
   std::set<ResourceId> m_DirtyResources;
 
+  // used during capture - for resources in m_DirtyResources that are only partially dirty, the
+  // ranges that are dirty. Resources not in here are entirely dirty.
+  std::map<ResourceId, FlatIntervals<bool>> m_DirtyRanges;
+
   struct InitialContentDataOrChunk
   {
     Chunk *chunk = NULL;
@@ -823,6 +837,31 @@ void ResourceManager<Configuration>::MarkDirtyResource(ResourceId res)
     return;
 
   m_DirtyResources.insert(res);
+  m_DirtyRanges.erase(res);
+}
+
+template <typename Configuration>
+void ResourceManager<Configuration>::MarkDirtyResourceRange(ResourceId res, uint64_t offset,
+                                                            uint64_t size)
+{
+  SCOPED_LOCK(m_Lock);
+
+  if(res == ResourceId() || size == 0)
+    return;
+
+  auto ranges = m_DirtyRanges.find(res);
+
+  if(ranges == m_DirtyRanges.end())
+  {
+    // already entirely dirty, nothing to do
+    if(m_DirtyResources.find(res) != m_DirtyResources.end())
+      return;
+
+    m_DirtyResources.insert(res);
+    ranges = m_DirtyRanges.insert(std::make_pair(res, FlatIntervals<bool>())).first;
+  }
+
+  ranges->second.update(offset, offset + size, true, [](bool a, bool b) { return a || b; });
 }
 
 template <typename Configuration>
@@ -836,6 +875,28 @@ bool ResourceManager<Configuration>::IsResourceDirty(ResourceId res)
   return m_DirtyResources.find(res) != m_DirtyResources.end();
 }
 
+template <typename Configuration>
+bool ResourceManager<Configuration>::GetResourceDirtyRanges(
+    ResourceId res, std::vector<rdcpair<uint64_t, uint64_t>> &ranges)
+{
+  SCOPED_LOCK(m_Lock);
+
+  ranges.clear();
+
+  auto it = m_DirtyRanges.find(res);
+
+  if(it == m_DirtyRanges.end())
+    return false;
+
+  for(auto r = it->second.begin(); r != it->second.end(); r++)
+  {
+    if(r->value())
+      ranges.push_back(make_rdcpair(r->start(), r->finish() - r->start()));
+  }
+
+  return true;
+}
+
 template <typename Configuration>
 void ResourceManager<Configuration>::SetInitialContents(ResourceId id, InitialContentData contents)
 {
@@ -1620,6 +1681,7 @@ void ResourceManager<Configuration>::ReleaseCurrentResource(ResourceId id)
 
   m_CurrentResourceMap.erase(id);
   m_DirtyResources.erase(id);
+  m_DirtyRanges.erase(id);
   m_LastWriteTime.erase(id);
 }
 
@@ -1694,9 +1694,21 @@ void D3D11Replay::PickPixel(ResourceId texture, uint32_t x, uint32_t y, const Su
   m_pImmediateContext->Unmap(m_PixelPick.StageTexture, 0);
 }
 
+rdcarray<PixelValue> D3D11Replay::PickPixels(ResourceId texture, const rdcarray<uint32_t> &coords,
+                                             const Subresource &sub, CompType typeCast)
+{
+  return StandardPickPixels(this, texture, coords, sub, typeCast, true);
+}
+
 bool D3D11Replay::GetMinMax(ResourceId texid, const Subresource &sub, CompType typeCast,
                             float *minval, float *maxval)
 {
+  // WARP runs the reduction shaders far slower than reading back and processing the texture on the
+  // CPU
+  if(m_DriverInfo.vendor == GPUVendor::Software &&
+     GetMinMaxFromTextureData(this, texid, sub, typeCast, minval, maxval))
+    return true;
+
   TextureShaderDetails details = GetDebugManager()->GetShaderDetails(texid, typeCast, true);
 
   if(details.texFmt == DXGI_FORMAT_UNKNOWN)
@@ -1814,6 +1826,10 @@ bool D3D11Replay::GetHistogram(ResourceId texid, const Subresource &sub, CompTyp
   if(minval >= maxval)
     return false;
 
+  if(m_DriverInfo.vendor == GPUVendor::Software &&
+     GetHistogramFromTextureData(this, texid, sub, typeCast, minval, maxval, channels, histogram))
+    return true;
+
   TextureShaderDetails details = GetDebugManager()->GetShaderDetails(texid, typeCast, true);
 
   if(details.texFmt == DXGI_FORMAT_UNKNOWN)
@@ -3154,18 +3170,17 @@ uint32_t D3D11Replay::PickVertex(uint32_t eventId, int32_t width, int32_t height
     std::vector<FloatVector> vbData;
     vbData.resize(maxIndex + 1);
 
-    byte *data = &oldData[0];
-    byte *dataEnd = data + oldData.size();
-
-    bool valid;
+    // the vertices are decoded directly, without going through the index buffer
+    MeshFormat vertices = cfg.position;
+    vertices.indexByteStride = 0;
 
     // the index buffer may refer to vertices past the start of the vertex buffer, so we can't just
     // conver the first N vertices we'll need.
     // Instead we grab min and max above, and convert every vertex in that range. This might
     // slightly over-estimate but not as bad as 0-max or the whole buffer.
-    for(uint32_t idx = minIndex; idx <= maxIndex; idx++)
-      vbData[idx] = HighlightCache::InterpretVertex(data, idx, cfg.position.vertexByteStride,
-                                                    cfg.position.format, dataEnd, valid);
+    if(minIndex <= maxIndex)
+      DecodeMeshVertices(vertices, NULL, 0, oldData.data(), oldData.size(), minIndex,
+                         maxIndex - minIndex + 1, &vbData[minIndex], NULL);
 
     D3D11_BOX box;
     box.top = 0;
@@ -180,6 +180,8 @@ public:
 
   void PickPixel(ResourceId texture, uint32_t x, uint32_t y, const Subresource &sub,
                  CompType typeCast, float pixel[4]);
+  rdcarray<PixelValue> PickPixels(ResourceId texture, const rdcarray<uint32_t> &coords,
+                                  const Subresource &sub, CompType typeCast);
   bool GetMinMax(ResourceId texid, const Subresource &sub, CompType typeCast, float *minval,
                  float *maxval);
   bool GetHistogram(ResourceId texid, const Subresource &sub, CompType typeCast, float minval,
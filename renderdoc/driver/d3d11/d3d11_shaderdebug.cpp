@@ -1798,8 +1798,9 @@ ShaderDebugTrace D3D11Replay::DebugVertex(uint32_t eventId, uint32_t vertid, uin
 
   GlobalState global;
   GetDebugManager()->CreateShaderGlobalState(global, dxbc, 0, NULL, rs->VS.SRVs);
+  DecodedProgram decoded(dxbc->GetDXBCByteCode(), dxbc->GetReflection());
   State initialState;
-  CreateShaderDebugStateAndTrace(initialState, ret, -1, dxbc, refl, cbufData);
+  CreateShaderDebugStateAndTrace(initialState, ret, -1, dxbc, &decoded, refl, cbufData);
 
   for(size_t i = 0; i < ret.inputs.size(); i++)
   {
@@ -2049,24 +2050,27 @@ ShaderDebugTrace D3D11Replay::DebugVertex(uint32_t eventId, uint32_t vertid, uin
 
   State last;
 
-  std::vector<ShaderDebugState> states;
+  ShaderDebugStateEncoder states(ret);
 
   if(dxbc->GetDebugInfo())
     dxbc->GetDebugInfo()->GetLocals(0, dxbc->GetDXBCByteCode()->GetInstruction(0).offset,
                                     initialState.locals);
 
-  states.push_back((State)initialState);
+  states.AddState(initialState);
 
   D3D11MarkerRegion simloop("Simulation Loop");
 
   D3D11DebugAPIWrapper apiWrapper(m_pDevice, dxbc, global);
 
+  LaneGroup lane(&decoded, false);
+  const bool active = true;
+
   for(int cycleCounter = 0;; cycleCounter++)
   {
     if(initialState.Finished())
       break;
 
-    initialState = initialState.GetNext(global, &apiWrapper, NULL);
+    lane.Step(global, &apiWrapper, &initialState, 1, &active);
 
     if(dxbc->GetDebugInfo())
     {
@@ -2075,7 +2079,7 @@ ShaderDebugTrace D3D11Replay::DebugVertex(uint32_t eventId, uint32_t vertid, uin
       dxbc->GetDebugInfo()->GetLocals(initialState.nextInstruction, op.offset, initialState.locals);
     }
 
-    states.push_back((State)initialState);
+    states.AddState(initialState);
 
     if(cycleCounter == SHADER_DEBUG_WARN_THRESHOLD)
     {
@@ -2084,8 +2088,6 @@ ShaderDebugTrace D3D11Replay::DebugVertex(uint32_t eventId, uint32_t vertid, uin
     }
   }
 
-  ret.states = states;
-
   ret.hasLocals = dxbc->GetDebugInfo() && dxbc->GetDebugInfo()->HasLocals();
 
   ret.lineInfo.resize(dxbc->GetDXBCByteCode()->GetNumInstructions());
@@ -2716,11 +2718,14 @@ void ExtractInputsPS(PSInput IN, float4 debug_pixelPos : SV_Position, uint prim
 
   global.sampleEvalRegisterMask = sampleEvalRegisterMask;
 
+  DecodedProgram decoded(dxbc->GetDXBCByteCode(), dxbc->GetReflection());
+
   {
     DebugHit *hit = winner;
 
     State initialState;
-    CreateShaderDebugStateAndTrace(initialState, traces[destIdx], destIdx, dxbc, refl, cbufData);
+    CreateShaderDebugStateAndTrace(initialState, traces[destIdx], destIdx, dxbc, &decoded, refl,
+                                   cbufData);
 
     rdcarray<ShaderVariable> &ins = traces[destIdx].inputs;
     if(!ins.empty() && ins.back().name == "vCoverage")
@@ -2818,19 +2823,16 @@ void ExtractInputsPS(PSInput IN, float4 debug_pixelPos : SV_Position, uint prim
   SAFE_DELETE_ARRAY(initialData);
   SAFE_DELETE_ARRAY(evalData);
 
-  std::vector<ShaderDebugState> states;
+  ShaderDebugStateEncoder states(traces[destIdx]);
 
   if(dxbc->GetDebugInfo())
     dxbc->GetDebugInfo()->GetLocals(0, dxbc->GetDXBCByteCode()->GetInstruction(0).offset,
                                     quad[destIdx].locals);
 
-  states.push_back((State)quad[destIdx]);
+  states.AddState(quad[destIdx]);
 
-  // ping pong between so that we can have 'current' quad to update into new one
-  State quad2[4];
-
-  State *curquad = quad;
-  State *newquad = quad2;
+  // steps the whole quad at once, updating each state in place
+  LaneGroup lanes(&decoded, true);
 
   // marks any threads stalled waiting for others to catch up
   bool activeMask[4] = {true, true, true, true};
@@ -2845,22 +2847,12 @@ void ExtractInputsPS(PSInput IN, float4 debug_pixelPos : SV_Position, uint prim
   bool finished = true;
   do
   {
-    for(size_t i = 0; i < 4; i++)
-    {
-      if(activeMask[i])
-        newquad[i] = curquad[i].GetNext(global, &apiWrapper, curquad);
-      else
-        newquad[i] = curquad[i];
-    }
-
-    State *a = curquad;
-    curquad = newquad;
-    newquad = a;
+    lanes.Step(global, &apiWrapper, quad, 4, activeMask);
 
     // if our destination quad is paused don't record multiple identical states.
     if(activeMask[destIdx])
     {
-      State &s = curquad[destIdx];
+      State &s = quad[destIdx];
 
       if(dxbc->GetDebugInfo())
       {
@@ -2870,7 +2862,7 @@ void ExtractInputsPS(PSInput IN, float4 debug_pixelPos : SV_Position, uint prim
         dxbc->GetDebugInfo()->GetLocals(s.nextInstruction, op.offset, s.locals);
       }
 
-      states.push_back(s);
+      states.AddState(s);
     }
 
     // we need to make sure that control flow which converges stays in lockstep so that
@@ -2898,9 +2890,9 @@ void ExtractInputsPS(PSInput IN, float4 debug_pixelPos : SV_Position, uint prim
     // if we've converged, or we were never diverged, this keeps everything ticking
     activeMask[0] = activeMask[1] = activeMask[2] = activeMask[3] = true;
 
-    if(curquad[0].nextInstruction != curquad[1].nextInstruction ||
-       curquad[0].nextInstruction != curquad[2].nextInstruction ||
-       curquad[0].nextInstruction != curquad[3].nextInstruction)
+    if(quad[0].nextInstruction != quad[1].nextInstruction ||
+       quad[0].nextInstruction != quad[2].nextInstruction ||
+       quad[0].nextInstruction != quad[3].nextInstruction)
     {
       // this isn't *perfect* but it will still eventually continue. We look for the most
       // advanced thread, and check to see if it's just finished a control flow. If it has
@@ -2931,8 +2923,8 @@ void ExtractInputsPS(PSInput IN, float4 debug_pixelPos : SV_Position, uint prim
 
       // find which thread is most advanced
       for(size_t i = 0; i < 4; i++)
-        if(curquad[i].nextInstruction > convergencePoint)
-          convergencePoint = curquad[i].nextInstruction;
+        if(quad[i].nextInstruction > convergencePoint)
+          convergencePoint = quad[i].nextInstruction;
 
       if(convergencePoint > 0)
       {
@@ -2946,11 +2938,11 @@ void ExtractInputsPS(PSInput IN, float4 debug_pixelPos : SV_Position, uint prim
 
       // pause any threads at that instruction (could be none)
       for(size_t i = 0; i < 4; i++)
-        if(curquad[i].nextInstruction == convergencePoint)
+        if(quad[i].nextInstruction == convergencePoint)
           activeMask[i] = false;
     }
 
-    finished = curquad[destIdx].Finished();
+    finished = quad[destIdx].Finished();
 
     cycleCounter++;
 
@@ -2961,8 +2953,6 @@ void ExtractInputsPS(PSInput IN, float4 debug_pixelPos : SV_Position, uint prim
     }
   } while(!finished);
 
-  traces[destIdx].states = states;
-
   traces[destIdx].hasLocals = dxbc->GetDebugInfo() && dxbc->GetDebugInfo()->HasLocals();
 
   traces[destIdx].lineInfo.resize(dxbc->GetDXBCByteCode()->GetNumInstructions());
@@ -3020,8 +3010,9 @@ ShaderDebugTrace D3D11Replay::DebugThread(uint32_t eventId, const uint32_t group
 
   GlobalState global;
   GetDebugManager()->CreateShaderGlobalState(global, dxbc, 0, rs->CSUAVs, rs->CS.SRVs);
+  DecodedProgram decoded(dxbc->GetDXBCByteCode(), dxbc->GetReflection());
   State initialState;
-  CreateShaderDebugStateAndTrace(initialState, ret, -1, dxbc, refl, cbufData);
+  CreateShaderDebugStateAndTrace(initialState, ret, -1, dxbc, &decoded, refl, cbufData);
 
   for(int i = 0; i < 3; i++)
   {
@@ -3029,31 +3020,81 @@ ShaderDebugTrace D3D11Replay::DebugThread(uint32_t eventId, const uint32_t group
     initialState.semantics.ThreadID[i] = threadid[i];
   }
 
-  std::vector<ShaderDebugState> states;
+  ShaderDebugStateEncoder states(ret);
 
   if(dxbc->GetDebugInfo())
     dxbc->GetDebugInfo()->GetLocals(0, dxbc->GetDXBCByteCode()->GetInstruction(0).offset,
                                     initialState.locals);
 
-  states.push_back((State)initialState);
+  states.AddState(initialState);
 
   D3D11DebugAPIWrapper apiWrapper(m_pDevice, dxbc, global);
 
+  // if the threads share groupshared memory, what the debugged thread reads can depend on what the
+  // rest of the group wrote before a sync, so simulate every thread in the group together.
+  // Otherwise the thread can be debugged on its own.
+  std::vector<State> group;
+  size_t debugLane = 0;
+
+  if(!global.groupshared.empty())
+  {
+    const uint32_t *numthreads = decoded.GetThreadGroupSize();
+
+    group.resize(numthreads[0] * numthreads[1] * numthreads[2], initialState);
+
+    for(uint32_t z = 0; z < numthreads[2]; z++)
+    {
+      for(uint32_t y = 0; y < numthreads[1]; y++)
+      {
+        for(uint32_t x = 0; x < numthreads[0]; x++)
+        {
+          State &thread = group[(z * numthreads[1] + y) * numthreads[0] + x];
+          thread.semantics.ThreadID[0] = x;
+          thread.semantics.ThreadID[1] = y;
+          thread.semantics.ThreadID[2] = z;
+        }
+      }
+    }
+
+    debugLane = (threadid[2] * numthreads[1] + threadid[1]) * numthreads[0] + threadid[0];
+  }
+
+  // otherwise, or if the thread is outside the group, it's stepped by itself
+  if(debugLane >= group.size())
+  {
+    group.clear();
+    group.push_back(initialState);
+    debugLane = 0;
+  }
+
+  LaneGroup lanes(&decoded, false);
+  rdcarray<bool> active;
+  active.resize(group.size());
+
   for(int cycleCounter = 0;; cycleCounter++)
   {
-    if(initialState.Finished())
+    State &thread = group[debugLane];
+
+    if(thread.Finished())
       break;
 
-    initialState = initialState.GetNext(global, &apiWrapper, NULL);
+    for(size_t i = 0; i < group.size(); i++)
+      active[i] = !group[i].Finished();
 
-    if(dxbc->GetDebugInfo())
+    lanes.Step(global, &apiWrapper, group.data(), group.size(), active.data());
+
+    // the debugged thread may be waiting at a sync for the rest of the group
+    if(lanes.WasStepped(debugLane))
     {
-      const DXBCBytecode::Operation &op =
-          dxbc->GetDXBCByteCode()->GetInstruction((size_t)initialState.nextInstruction);
-      dxbc->GetDebugInfo()->GetLocals(initialState.nextInstruction, op.offset, initialState.locals);
-    }
+      if(dxbc->GetDebugInfo())
+      {
+        const DXBCBytecode::Operation &op =
+            dxbc->GetDXBCByteCode()->GetInstruction((size_t)thread.nextInstruction);
+        dxbc->GetDebugInfo()->GetLocals(thread.nextInstruction, op.offset, thread.locals);
+      }
 
-    states.push_back((State)initialState);
+      states.AddState(thread);
+    }
 
     if(cycleCounter == SHADER_DEBUG_WARN_THRESHOLD)
     {
@@ -3062,8 +3103,6 @@ ShaderDebugTrace D3D11Replay::DebugThread(uint32_t eventId, const uint32_t group
     }
   }
 
-  ret.states = states;
-
   ret.hasLocals = dxbc->GetDebugInfo() && dxbc->GetDebugInfo()->HasLocals();
 
   ret.lineInfo.resize(dxbc->GetDXBCByteCode()->GetNumInstructions());
@@ -2042,18 +2042,17 @@ uint32_t D3D12Replay::PickVertex(uint32_t eventId, int32_t width, int32_t height
     std::vector<FloatVector> vbData;
     vbData.resize(maxIndex + 1);
 
-    byte *data = &oldData[0];
-    byte *dataEnd = data + oldData.size();
-
-    bool valid = true;
+    // the vertices are decoded directly, without going through the index buffer
+    MeshFormat vertices = cfg.position;
+    vertices.indexByteStride = 0;
 
     // the index buffer may refer to vertices past the start of the vertex buffer, so we can't just
     // conver the first N vertices we'll need.
     // Instead we grab min and max above, and convert every vertex in that range. This might
     // slightly over-estimate but not as bad as 0-max or the whole buffer.
-    for(uint32_t idx = minIndex; idx <= maxIndex; idx++)
-      vbData[idx] = HighlightCache::InterpretVertex(data, idx, cfg.position.vertexByteStride,
-                                                    cfg.position.format, dataEnd, valid);
+    if(minIndex <= maxIndex)
+      DecodeMeshVertices(vertices, NULL, 0, oldData.data(), oldData.size(), minIndex,
+                         maxIndex - minIndex + 1, &vbData[minIndex], NULL);
 
     GetDebugManager()->FillBuffer(m_VertexPick.VB, 0, vbData.data(), sizeof(Vec4f) * (maxIndex + 1));
   }
@@ -2249,9 +2248,21 @@ void D3D12Replay::PickPixel(ResourceId texture, uint32_t x, uint32_t y, const Su
     m_General.ResultReadbackBuffer->Unmap(0, &range);
 }
 
+rdcarray<PixelValue> D3D12Replay::PickPixels(ResourceId texture, const rdcarray<uint32_t> &coords,
+                                             const Subresource &sub, CompType typeCast)
+{
+  return StandardPickPixels(this, texture, coords, sub, typeCast, true);
+}
+
 bool D3D12Replay::GetMinMax(ResourceId texid, const Subresource &sub, CompType typeCast,
                             float *minval, float *maxval)
 {
+  // WARP runs the reduction shaders far slower than reading back and processing the texture on the
+  // CPU
+  if(m_DriverInfo.vendor == GPUVendor::Software &&
+     GetMinMaxFromTextureData(this, texid, sub, typeCast, minval, maxval))
+    return true;
+
   ID3D12Resource *resource = m_pDevice->GetResourceList()[texid];
 
   if(resource == NULL)
@@ -2434,6 +2445,10 @@ bool D3D12Replay::GetHistogram(ResourceId texid, const Subresource &sub, CompTyp
   if(minval >= maxval)
     return false;
 
+  if(m_DriverInfo.vendor == GPUVendor::Software &&
+     GetHistogramFromTextureData(this, texid, sub, typeCast, minval, maxval, channels, histogram))
+    return true;
+
   ID3D12Resource *resource = m_pDevice->GetResourceList()[texid];
 
   if(resource == NULL)
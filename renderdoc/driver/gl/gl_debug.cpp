@@ -1378,9 +1378,25 @@ void GLReplay::PickPixel(ResourceId texture, uint32_t x, uint32_t y, const Subre
   }
 }
 
+rdcarray<PixelValue> GLReplay::PickPixels(ResourceId texture, const rdcarray<uint32_t> &coords,
+                                          const Subresource &sub, CompType typeCast)
+{
+  // texture data is read back bottom-up, which only the API's pick accounts for
+  return StandardPickPixels(this, texture, coords, sub, typeCast, false);
+}
+
 bool GLReplay::GetMinMax(ResourceId texid, const Subresource &sub, CompType typeCast, float *minval,
                          float *maxval)
 {
+  if(texid == ResourceId() || m_pDriver->m_Textures.find(texid) == m_pDriver->m_Textures.end())
+    return false;
+
+  // without compute shaders there's no GPU path at all, and software rasterizers run it far slower
+  // than reading back and processing the texture on the CPU
+  if((m_DriverInfo.vendor == GPUVendor::Software || !HasExt[ARB_compute_shader]) &&
+     GetMinMaxFromTextureData(this, texid, sub, typeCast, minval, maxval))
+    return true;
+
   auto &texDetails = m_pDriver->m_Textures[texid];
 
   if(!IsCompressedFormat(texDetails.internalFormat) &&
@@ -1657,6 +1673,10 @@ bool GLReplay::GetHistogram(ResourceId texid, const Subresource &sub, CompType t
   if(m_pDriver->m_Textures.find(texid) == m_pDriver->m_Textures.end())
     return false;
 
+  if((m_DriverInfo.vendor == GPUVendor::Software || !HasExt[ARB_compute_shader]) &&
+     GetHistogramFromTextureData(this, texid, sub, typeCast, minval, maxval, channels, histogram))
+    return true;
+
   if(!HasExt[ARB_compute_shader])
     return false;
 
@@ -2193,18 +2213,17 @@ uint32_t GLReplay::PickVertex(uint32_t eventId, int32_t width, int32_t height,
     std::vector<FloatVector> vbData;
     vbData.resize(maxIndex + 1);
 
-    byte *data = &oldData[0];
-    byte *dataEnd = data + oldData.size();
-
-    bool valid;
+    // the vertices are decoded directly, without going through the index buffer
+    MeshFormat vertices = cfg.position;
+    vertices.indexByteStride = 0;
 
     // the index buffer may refer to vertices past the start of the vertex buffer, so we can't just
     // conver the first N vertices we'll need.
     // Instead we grab min and max above, and convert every vertex in that range. This might
     // slightly over-estimate but not as bad as 0-max or the whole buffer.
-    for(uint32_t idx = minIndex; idx <= maxIndex; idx++)
-      vbData[idx] = HighlightCache::InterpretVertex(data, idx, cfg.position.vertexByteStride,
-                                                    cfg.position.format, dataEnd, valid);
+    if(minIndex <= maxIndex)
+      DecodeMeshVertices(vertices, NULL, 0, oldData.data(), oldData.size(), minIndex,
+                         maxIndex - minIndex + 1, &vbData[minIndex], NULL);
 
     drv.glBindBuffer(eGL_SHADER_STORAGE_BUFFER, DebugData.pickVBBuf);
     drv.glBufferSubData(eGL_SHADER_STORAGE_BUFFER, 0, (maxIndex + 1) * sizeof(Vec4f), vbData.data());
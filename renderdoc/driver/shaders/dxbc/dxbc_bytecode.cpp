@@ -417,6 +417,7 @@ DXBC::Reflection *Program::GuessReflection()
 
         break;
       }
+      default: break;
     }
   }
 
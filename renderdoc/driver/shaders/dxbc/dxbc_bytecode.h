@@ -28,7 +28,6 @@
 #include <vector>
 #include "api/replay/renderdoc_replay.h"
 #include "common/common.h"
-#include "driver/dx/official/d3dcommon.h"
 #include "dxbc_common.h"
 
 namespace DXBC
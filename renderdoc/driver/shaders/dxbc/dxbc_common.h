@@ -24,6 +24,116 @@
 
 #pragma once
 
+#include <map>
+#include <string>
+#include <vector>
+#include "api/replay/renderdoc_replay.h"
+#include "common/common.h"
+
+#if ENABLED(RDOC_WIN32)
+
+#include "driver/dx/official/d3dcommon.h"
+
+#else
+
+#include <stdint.h>
+#include <string.h>
+
+// the official D3D headers are only usable on windows. Elsewhere we declare the few definitions
+// that the DXBC code shares with them, with identical layout and values.
+
+struct GUID
+{
+  uint32_t Data1;
+  uint16_t Data2;
+  uint16_t Data3;
+  uint8_t Data4[8];
+};
+
+inline bool operator==(const GUID &a, const GUID &b)
+{
+  return memcmp(&a, &b, sizeof(GUID)) == 0;
+}
+
+inline bool operator!=(const GUID &a, const GUID &b)
+{
+  return !(a == b);
+}
+
+enum D3D_PRIMITIVE_TOPOLOGY
+{
+  D3D_PRIMITIVE_TOPOLOGY_UNDEFINED = 0,
+  D3D_PRIMITIVE_TOPOLOGY_POINTLIST = 1,
+  D3D_PRIMITIVE_TOPOLOGY_LINELIST = 2,
+  D3D_PRIMITIVE_TOPOLOGY_LINESTRIP = 3,
+  D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST = 4,
+  D3D_PRIMITIVE_TOPOLOGY_TRIANGLESTRIP = 5,
+  D3D_PRIMITIVE_TOPOLOGY_LINELIST_ADJ = 10,
+  D3D_PRIMITIVE_TOPOLOGY_LINESTRIP_ADJ = 11,
+  D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST_ADJ = 12,
+  D3D_PRIMITIVE_TOPOLOGY_TRIANGLESTRIP_ADJ = 13,
+  D3D_PRIMITIVE_TOPOLOGY_1_CONTROL_POINT_PATCHLIST = 33,
+  D3D_PRIMITIVE_TOPOLOGY_2_CONTROL_POINT_PATCHLIST = 34,
+  D3D_PRIMITIVE_TOPOLOGY_3_CONTROL_POINT_PATCHLIST = 35,
+  D3D_PRIMITIVE_TOPOLOGY_4_CONTROL_POINT_PATCHLIST = 36,
+  D3D_PRIMITIVE_TOPOLOGY_5_CONTROL_POINT_PATCHLIST = 37,
+  D3D_PRIMITIVE_TOPOLOGY_6_CONTROL_POINT_PATCHLIST = 38,
+  D3D_PRIMITIVE_TOPOLOGY_7_CONTROL_POINT_PATCHLIST = 39,
+  D3D_PRIMITIVE_TOPOLOGY_8_CONTROL_POINT_PATCHLIST = 40,
+  D3D_PRIMITIVE_TOPOLOGY_9_CONTROL_POINT_PATCHLIST = 41,
+  D3D_PRIMITIVE_TOPOLOGY_10_CONTROL_POINT_PATCHLIST = 42,
+  D3D_PRIMITIVE_TOPOLOGY_11_CONTROL_POINT_PATCHLIST = 43,
+  D3D_PRIMITIVE_TOPOLOGY_12_CONTROL_POINT_PATCHLIST = 44,
+  D3D_PRIMITIVE_TOPOLOGY_13_CONTROL_POINT_PATCHLIST = 45,
+  D3D_PRIMITIVE_TOPOLOGY_14_CONTROL_POINT_PATCHLIST = 46,
+  D3D_PRIMITIVE_TOPOLOGY_15_CONTROL_POINT_PATCHLIST = 47,
+  D3D_PRIMITIVE_TOPOLOGY_16_CONTROL_POINT_PATCHLIST = 48,
+  D3D_PRIMITIVE_TOPOLOGY_17_CONTROL_POINT_PATCHLIST = 49,
+  D3D_PRIMITIVE_TOPOLOGY_18_CONTROL_POINT_PATCHLIST = 50,
+  D3D_PRIMITIVE_TOPOLOGY_19_CONTROL_POINT_PATCHLIST = 51,
+  D3D_PRIMITIVE_TOPOLOGY_20_CONTROL_POINT_PATCHLIST = 52,
+  D3D_PRIMITIVE_TOPOLOGY_21_CONTROL_POINT_PATCHLIST = 53,
+  D3D_PRIMITIVE_TOPOLOGY_22_CONTROL_POINT_PATCHLIST = 54,
+  D3D_PRIMITIVE_TOPOLOGY_23_CONTROL_POINT_PATCHLIST = 55,
+  D3D_PRIMITIVE_TOPOLOGY_24_CONTROL_POINT_PATCHLIST = 56,
+  D3D_PRIMITIVE_TOPOLOGY_25_CONTROL_POINT_PATCHLIST = 57,
+  D3D_PRIMITIVE_TOPOLOGY_26_CONTROL_POINT_PATCHLIST = 58,
+  D3D_PRIMITIVE_TOPOLOGY_27_CONTROL_POINT_PATCHLIST = 59,
+  D3D_PRIMITIVE_TOPOLOGY_28_CONTROL_POINT_PATCHLIST = 60,
+  D3D_PRIMITIVE_TOPOLOGY_29_CONTROL_POINT_PATCHLIST = 61,
+  D3D_PRIMITIVE_TOPOLOGY_30_CONTROL_POINT_PATCHLIST = 62,
+  D3D_PRIMITIVE_TOPOLOGY_31_CONTROL_POINT_PATCHLIST = 63,
+  D3D_PRIMITIVE_TOPOLOGY_32_CONTROL_POINT_PATCHLIST = 64,
+};
+
+// from d3dcompiler.h
+#define D3DCOMPILE_DEBUG (1 << 0)
+#define D3DCOMPILE_SKIP_VALIDATION (1 << 1)
+#define D3DCOMPILE_SKIP_OPTIMIZATION (1 << 2)
+#define D3DCOMPILE_PACK_MATRIX_ROW_MAJOR (1 << 3)
+#define D3DCOMPILE_PACK_MATRIX_COLUMN_MAJOR (1 << 4)
+#define D3DCOMPILE_PARTIAL_PRECISION (1 << 5)
+#define D3DCOMPILE_FORCE_VS_SOFTWARE_NO_OPT (1 << 6)
+#define D3DCOMPILE_FORCE_PS_SOFTWARE_NO_OPT (1 << 7)
+#define D3DCOMPILE_NO_PRESHADER (1 << 8)
+#define D3DCOMPILE_AVOID_FLOW_CONTROL (1 << 9)
+#define D3DCOMPILE_PREFER_FLOW_CONTROL (1 << 10)
+#define D3DCOMPILE_ENABLE_STRICTNESS (1 << 11)
+#define D3DCOMPILE_ENABLE_BACKWARDS_COMPATIBILITY (1 << 12)
+#define D3DCOMPILE_IEEE_STRICTNESS (1 << 13)
+#define D3DCOMPILE_OPTIMIZATION_LEVEL0 (1 << 14)
+#define D3DCOMPILE_OPTIMIZATION_LEVEL1 0
+#define D3DCOMPILE_OPTIMIZATION_LEVEL2 ((1 << 14) | (1 << 15))
+#define D3DCOMPILE_OPTIMIZATION_LEVEL3 (1 << 15)
+#define D3DCOMPILE_WARNINGS_ARE_ERRORS (1 << 18)
+#define D3DCOMPILE_RESOURCES_MAY_ALIAS (1 << 19)
+#define D3DCOMPILE_ENABLE_UNBOUNDED_DESCRIPTOR_TABLES (1 << 20)
+#define D3DCOMPILE_ALL_RESOURCES_BOUND (1 << 21)
+#define D3DCOMPILE_DEBUG_NAME_FOR_SOURCE (1 << 22)
+#define D3DCOMPILE_DEBUG_NAME_FOR_BINARY (1 << 23)
+
+#endif
+
 namespace DXBC
 {
 struct CountOffset
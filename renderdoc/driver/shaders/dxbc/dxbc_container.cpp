@@ -27,12 +27,15 @@
 #include <algorithm>
 #include "api/app/renderdoc_app.h"
 #include "common/common.h"
-#include "driver/dx/official/d3dcompiler.h"
 #include "driver/shaders/dxil/dxil_bytecode.h"
 #include "serialise/serialiser.h"
 #include "strings/string_utils.h"
 #include "dxbc_bytecode.h"
 
+#if ENABLED(RDOC_WIN32)
+#include "driver/dx/official/d3dcompiler.h"
+#endif
+
 namespace DXBC
 {
 struct RDEFCBufferVariable
@@ -302,6 +305,7 @@ ShaderBuiltin GetSystemValue(SVSemantic systemValue)
     case SVNAME_COVERAGE: return ShaderBuiltin::MSAACoverage;
     case SVNAME_DEPTH_GREATER_EQUAL: return ShaderBuiltin::DepthOutputGreaterEqual;
     case SVNAME_DEPTH_LESS_EQUAL: return ShaderBuiltin::DepthOutputLessEqual;
+    default: break;
   }
 
   return ShaderBuiltin::Undefined;
@@ -311,7 +315,7 @@ std::string TypeName(CBufferVariableType::Descriptor desc)
 {
   std::string ret;
 
-  char *type = "";
+  const char *type = "";
   switch(desc.type)
   {
     case VARTYPE_BOOL: type = "bool"; break;
@@ -715,7 +719,7 @@ DXBCContainer::DXBCContainer(const void *ByteCode, size_t ByteCodeLength)
         desc.dimension = (ShaderInputBind::Dimension)res->dimension;
         desc.numSamples = res->sampleCount;
 
-        if(desc.numSamples == ~0 && desc.retType != RETURN_TYPE_MIXED &&
+        if(desc.numSamples == ~0U && desc.retType != RETURN_TYPE_MIXED &&
            desc.retType != RETURN_TYPE_UNKNOWN && desc.retType != RETURN_TYPE_CONTINUED)
         {
           // uint, uint2, uint3, uint4 seem to be in these bits of flags.
@@ -1104,53 +1108,55 @@ DXBCContainer::DXBCContainer(const void *ByteCode, size_t ByteCodeLength)
         // check system value semantics
         if(desc.systemValue == ShaderBuiltin::Undefined)
         {
-          if(!_stricmp(desc.semanticName.c_str(), "SV_Position"))
+          std::string semanticName = strlower(desc.semanticName.c_str());
+
+          if(semanticName == "sv_position")
             desc.systemValue = ShaderBuiltin::Position;
-          if(!_stricmp(desc.semanticName.c_str(), "SV_ClipDistance"))
+          if(semanticName == "sv_clipdistance")
             desc.systemValue = ShaderBuiltin::ClipDistance;
-          if(!_stricmp(desc.semanticName.c_str(), "SV_CullDistance"))
+          if(semanticName == "sv_culldistance")
             desc.systemValue = ShaderBuiltin::CullDistance;
-          if(!_stricmp(desc.semanticName.c_str(), "SV_RenderTargetArrayIndex"))
+          if(semanticName == "sv_rendertargetarrayindex")
             desc.systemValue = ShaderBuiltin::RTIndex;
-          if(!_stricmp(desc.semanticName.c_str(), "SV_ViewportArrayIndex"))
+          if(semanticName == "sv_viewportarrayindex")
             desc.systemValue = ShaderBuiltin::ViewportIndex;
-          if(!_stricmp(desc.semanticName.c_str(), "SV_VertexID"))
+          if(semanticName == "sv_vertexid")
             desc.systemValue = ShaderBuiltin::VertexIndex;
-          if(!_stricmp(desc.semanticName.c_str(), "SV_PrimitiveID"))
+          if(semanticName == "sv_primitiveid")
             desc.systemValue = ShaderBuiltin::PrimitiveIndex;
-          if(!_stricmp(desc.semanticName.c_str(), "SV_InstanceID"))
+          if(semanticName == "sv_instanceid")
             desc.systemValue = ShaderBuiltin::InstanceIndex;
-          if(!_stricmp(desc.semanticName.c_str(), "SV_DispatchThreadID"))
+          if(semanticName == "sv_dispatchthreadid")
             desc.systemValue = ShaderBuiltin::DispatchThreadIndex;
-          if(!_stricmp(desc.semanticName.c_str(), "SV_GroupID"))
+          if(semanticName == "sv_groupid")
             desc.systemValue = ShaderBuiltin::GroupIndex;
-          if(!_stricmp(desc.semanticName.c_str(), "SV_GroupIndex"))
+          if(semanticName == "sv_groupindex")
             desc.systemValue = ShaderBuiltin::GroupFlatIndex;
-          if(!_stricmp(desc.semanticName.c_str(), "SV_GroupThreadID"))
+          if(semanticName == "sv_groupthreadid")
             desc.systemValue = ShaderBuiltin::GroupThreadIndex;
-          if(!_stricmp(desc.semanticName.c_str(), "SV_GSInstanceID"))
+          if(semanticName == "sv_gsinstanceid")
             desc.systemValue = ShaderBuiltin::GSInstanceIndex;
-          if(!_stricmp(desc.semanticName.c_str(), "SV_OutputControlPointID"))
+          if(semanticName == "sv_outputcontrolpointid")
             desc.systemValue = ShaderBuiltin::OutputControlPointIndex;
-          if(!_stricmp(desc.semanticName.c_str(), "SV_DomainLocation"))
+          if(semanticName == "sv_domainlocation")
             desc.systemValue = ShaderBuiltin::DomainLocation;
-          if(!_stricmp(desc.semanticName.c_str(), "SV_IsFrontFace"))
+          if(semanticName == "sv_isfrontface")
             desc.systemValue = ShaderBuiltin::IsFrontFace;
-          if(!_stricmp(desc.semanticName.c_str(), "SV_SampleIndex"))
+          if(semanticName == "sv_sampleindex")
             desc.systemValue = ShaderBuiltin::MSAASampleIndex;
-          if(!_stricmp(desc.semanticName.c_str(), "SV_TessFactor"))
+          if(semanticName == "sv_tessfactor")
             desc.systemValue = ShaderBuiltin::OuterTessFactor;
-          if(!_stricmp(desc.semanticName.c_str(), "SV_InsideTessFactor"))
+          if(semanticName == "sv_insidetessfactor")
             desc.systemValue = ShaderBuiltin::InsideTessFactor;
-          if(!_stricmp(desc.semanticName.c_str(), "SV_Target"))
+          if(semanticName == "sv_target")
             desc.systemValue = ShaderBuiltin::ColorOutput;
-          if(!_stricmp(desc.semanticName.c_str(), "SV_Depth"))
+          if(semanticName == "sv_depth")
             desc.systemValue = ShaderBuiltin::DepthOutput;
-          if(!_stricmp(desc.semanticName.c_str(), "SV_Coverage"))
+          if(semanticName == "sv_coverage")
             desc.systemValue = ShaderBuiltin::MSAACoverage;
-          if(!_stricmp(desc.semanticName.c_str(), "SV_DepthGreaterEqual"))
+          if(semanticName == "sv_depthgreaterequal")
             desc.systemValue = ShaderBuiltin::DepthOutputGreaterEqual;
-          if(!_stricmp(desc.semanticName.c_str(), "SV_DepthLessEqual"))
+          if(semanticName == "sv_depthlessequal")
             desc.systemValue = ShaderBuiltin::DepthOutputLessEqual;
         }
 
@@ -1209,10 +1215,13 @@ DXBCContainer::DXBCContainer(const void *ByteCode, size_t ByteCodeLength)
     {
       m_DebugInfo = MakeSDBGChunk(fourcc);
     }
+#if ENABLED(RDOC_WIN32)
+    // the PDB parsing relies on the Windows-only CodeView definitions and LLP64 type sizes
     else if(*fourcc == FOURCC_SPDB)
     {
       m_DebugInfo = MakeSPDBChunk(m_Reflection, fourcc);
     }
+#endif
   }
 
   // we do a mini-preprocess of the files from the debug info to handle #line directives.
@@ -1466,7 +1475,7 @@ uint32_t DecodeFlags(const ShaderCompileFlags &compileFlags)
 {
   uint32_t ret = 0;
 
-  for(const ShaderCompileFlag flag : compileFlags.flags)
+  for(const ShaderCompileFlag &flag : compileFlags.flags)
   {
     if(flag.name == "@cmdline")
     {
@@ -1554,6 +1563,7 @@ ShaderCompileFlags EncodeFlags(const IDebugInfo *dbg)
 #if ENABLED(ENABLE_UNIT_TESTS)
 
 #include "3rdparty/catch/catch.hpp"
+#include "common/timing.h"
 
 #if 0
 
@@ -1666,4 +1676,52 @@ TEST_CASE("Check DXBC flag encoding/decoding", "[dxbc]")
     CHECK(flags == flags2);
   };
 }
+
+// not run by default, run explicitly with the [benchmark] tag. Point RENDERDOC_DXBC_CORPUS at a
+// directory of raw .dxbc containers, e.g. dumped out of a capture.
+TEST_CASE("Benchmark DXBC parsing and disassembly", "[.][benchmark][dxbc]")
+{
+  const char *corpus = Process::GetEnvVariable("RENDERDOC_DXBC_CORPUS");
+
+  if(corpus == NULL || corpus[0] == 0)
+  {
+    RDCWARN("RENDERDOC_DXBC_CORPUS not set, skipping DXBC benchmark");
+    return;
+  }
+
+  std::vector<std::vector<byte>> blobs;
+
+  for(const PathEntry &file : FileIO::GetFilesInDirectory(corpus))
+  {
+    if(file.flags & PathProperty::Directory)
+      continue;
+
+    std::vector<byte> buf;
+    if(FileIO::slurp((std::string(corpus) + "/" + file.filename).c_str(), buf) &&
+       DXBC::DXBCContainer::CheckForShaderCode(buf.data(), buf.size()))
+      blobs.push_back(buf);
+  }
+
+  RDCLOG("Loaded %zu DXBC containers from %s", blobs.size(), corpus);
+
+  if(blobs.empty())
+    return;
+
+  size_t disasmLength = 0;
+
+  PerformanceTimer timer;
+
+  for(const std::vector<byte> &blob : blobs)
+  {
+    DXBC::DXBCContainer container(blob.data(), blob.size());
+    disasmLength += container.GetDisassembly().size();
+  }
+
+  double ms = timer.GetMilliseconds();
+
+  RDCLOG("Parsed, reflected and disassembled %zu shaders (%zu bytes of disassembly) in %.2f ms "
+         "(%.3f ms per shader)",
+         blobs.size(), disasmLength, ms, ms / double(blobs.size()));
+};
+
 #endif
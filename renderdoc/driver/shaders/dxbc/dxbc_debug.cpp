@@ -25,19 +25,30 @@
 
 #include "dxbc_debug.h"
 #include <algorithm>
-#include "driver/dxgi/dxgi_common.h"
+#include <cmath>
 #include "maths/formatpacking.h"
 #include "replay/replay_driver.h"
 #include "dxbc_bytecode.h"
 #include "dxbc_container.h"
 
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define DXBC_DEBUG_SSE2 OPTION_ON
+#include <emmintrin.h>
+#else
+#define DXBC_DEBUG_SSE2 OPTION_OFF
+#endif
+
+#if ENABLED(RDOC_WIN32)
+#include "driver/dxgi/dxgi_common.h"
+#endif
+
 using namespace DXBCBytecode;
 
 namespace ShaderDebug
 {
 static float round_ne(float x)
 {
-  if(!_finite(x) || _isnan(x))
+  if(!std::isfinite(x))
     return x;
 
   float rem = remainderf(x, 1.0f);
@@ -61,7 +72,7 @@ static float flush_denorm(const float f)
   return ret;
 }
 
-VarType State::OperationType(const DXBCBytecode::OpcodeType &op) const
+VarType OperationType(const DXBCBytecode::OpcodeType &op)
 {
   switch(op)
   {
@@ -236,7 +247,7 @@ VarType State::OperationType(const DXBCBytecode::OpcodeType &op) const
   }
 }
 
-bool State::OperationFlushing(const DXBCBytecode::OpcodeType &op) const
+bool OperationFlushing(const DXBCBytecode::OpcodeType &op)
 {
   switch(op)
   {
@@ -428,6 +439,105 @@ bool State::OperationFlushing(const DXBCBytecode::OpcodeType &op) const
   return false;
 }
 
+DecodedOperand::DecodedOperand(const Operand &oper, const DXBC::Reflection *reflection)
+{
+  operand = &oper;
+
+  RDCASSERT(oper.indices.size() <= 4);
+
+  for(size_t i = 0; i < oper.indices.size() && i < 4; i++)
+  {
+    if(oper.indices[i].absolute)
+      indices[i] = (uint32_t)oper.indices[i].index;
+
+    if(oper.indices[i].relative)
+      relativeIndices |= 1U << i;
+  }
+
+  if(oper.type == TYPE_CONSTANT_BUFFER && reflection && (relativeIndices & 1) == 0)
+  {
+    for(size_t i = 0; i < reflection->CBuffers.size(); i++)
+    {
+      if(reflection->CBuffers[i].reg == indices[0])
+      {
+        cbuffer = (int32_t)i;
+        break;
+      }
+    }
+  }
+
+  for(uint8_t i = 0; i < 4; i++)
+    swizzle[i] = oper.comps[i] == 0xff ? i : oper.comps[i];
+
+  scalar = oper.comps[0] != 0xff && oper.comps[1] == 0xff && oper.comps[2] == 0xff &&
+           oper.comps[3] == 0xff;
+
+  abs = oper.modifier == OPERAND_MODIFIER_ABS || oper.modifier == OPERAND_MODIFIER_ABSNEG;
+  neg = oper.modifier == OPERAND_MODIFIER_NEG || oper.modifier == OPERAND_MODIFIER_ABSNEG;
+}
+
+const uint8_t DecodedOperand::NoRelativeOperand;
+
+// decodes the operands of any relative indices into the operation, recursing into the operands'
+// own relative indices
+static void DecodeRelativeOperands(DecodedOperand &decoded, DecodedOperation &op,
+                                   const DXBC::Reflection *reflection)
+{
+  for(size_t i = 0; i < 4; i++)
+  {
+    if((decoded.relativeIndices & (1U << i)) == 0)
+      continue;
+
+    DecodedOperand index(decoded.operand->indices[i].operand, reflection);
+    DecodeRelativeOperands(index, op, reflection);
+
+    RDCASSERT(op.relativeOperands.size() < DecodedOperand::NoRelativeOperand);
+    if(op.relativeOperands.size() >= DecodedOperand::NoRelativeOperand)
+      continue;
+
+    decoded.relativeOperands[i] = (uint8_t)op.relativeOperands.size();
+    op.relativeOperands.push_back(index);
+  }
+}
+
+DecodedProgram::DecodedProgram(const Program *program, const DXBC::Reflection *reflection,
+                               bool decodeRelative)
+    : m_Program(program), m_Reflection(reflection)
+{
+  for(size_t i = 0; i < program->GetNumDeclarations(); i++)
+  {
+    const Declaration &decl = program->GetDeclaration(i);
+
+    if(decl.declaration == OPCODE_DCL_THREAD_GROUP)
+    {
+      m_ThreadGroupSize[0] = decl.groupSize[0];
+      m_ThreadGroupSize[1] = decl.groupSize[1];
+      m_ThreadGroupSize[2] = decl.groupSize[2];
+    }
+  }
+
+  m_Operations.resize(program->GetNumInstructions());
+
+  for(size_t i = 0; i < m_Operations.size(); i++)
+  {
+    const Operation &op = program->GetInstruction(i);
+    DecodedOperation &decoded = m_Operations[i];
+
+    decoded.operation = &op;
+    decoded.type = OperationType(op.operation);
+    decoded.flushing = OperationFlushing(op.operation);
+
+    decoded.operands.reserve(op.operands.size());
+    for(const Operand &oper : op.operands)
+    {
+      decoded.operands.push_back(DecodedOperand(oper, reflection));
+
+      if(decodeRelative)
+        DecodeRelativeOperands(decoded.operands.back(), decoded, reflection);
+    }
+  }
+}
+
 void DoubleSet(ShaderVariable &var, const double in[2])
 {
   var.value.d.x = in[0];
@@ -721,10 +831,10 @@ ShaderVariable TypedUAVLoad(GlobalState::ViewFmt &fmt, const byte *d)
 
 float dxbc_min(float a, float b)
 {
-  if(_isnan(a))
+  if(std::isnan(a))
     return b;
 
-  if(_isnan(b))
+  if(std::isnan(b))
     return a;
 
   return a < b ? a : b;
@@ -732,10 +842,10 @@ float dxbc_min(float a, float b)
 
 double dxbc_min(double a, double b)
 {
-  if(_isnan(a))
+  if(std::isnan(a))
     return b;
 
-  if(_isnan(b))
+  if(std::isnan(b))
     return a;
 
   return a < b ? a : b;
@@ -743,10 +853,10 @@ double dxbc_min(double a, double b)
 
 float dxbc_max(float a, float b)
 {
-  if(_isnan(a))
+  if(std::isnan(a))
     return b;
 
-  if(_isnan(b))
+  if(std::isnan(b))
     return a;
 
   return a >= b ? a : b;
@@ -754,10 +864,10 @@ float dxbc_max(float a, float b)
 
 double dxbc_max(double a, double b)
 {
-  if(_isnan(a))
+  if(std::isnan(a))
     return b;
 
-  if(_isnan(b))
+  if(std::isnan(b))
     return a;
 
   return a >= b ? a : b;
@@ -1072,162 +1182,692 @@ ShaderVariable sub(const ShaderVariable &a, const ShaderVariable &b, const VarTy
   return add(a, neg(b, type), type);
 }
 
-void State::Init()
+static inline float LaneF(uint32_t u)
 {
-  std::vector<uint32_t> indexTempSizes;
+  float f;
+  memcpy(&f, &u, sizeof(f));
+  return f;
+}
 
-  for(size_t i = 0; i < program->GetNumDeclarations(); i++)
-  {
-    const DXBCBytecode::Declaration &decl = program->GetDeclaration(i);
+static inline uint32_t LaneU(float f)
+{
+  uint32_t u;
+  memcpy(&u, &f, sizeof(u));
+  return u;
+}
 
-    if(decl.declaration == OPCODE_DCL_TEMPS)
-    {
-      registers.reserve(decl.numTemps);
+// four lanes of one component. The batched operations are all written in terms of these, so the
+// same code runs with or without SSE2. Comparisons return all ones or all zeroes in each lane.
+#if ENABLED(DXBC_DEBUG_SSE2)
 
-      for(uint32_t t = 0; t < decl.numTemps; t++)
-      {
-        char buf[64] = {0};
+typedef __m128i LaneVec;
 
-        StringFormat::snprintf(buf, 63, "r%d", t);
+static inline __m128 AsFloat(LaneVec v)
+{
+  return _mm_castsi128_ps(v);
+}
 
-        registers.push_back(ShaderVariable(buf, 0l, 0l, 0l, 0l));
-      }
-    }
-    if(decl.declaration == OPCODE_DCL_INDEXABLE_TEMP)
-    {
-      uint32_t reg = decl.tempReg;
-      uint32_t size = decl.numTemps;
-      if(reg >= indexTempSizes.size())
-        indexTempSizes.resize(reg + 1);
+static inline LaneVec AsLane(__m128 v)
+{
+  return _mm_castps_si128(v);
+}
 
-      indexTempSizes[reg] = size;
-    }
-  }
+static inline LaneVec LaneLoad(const uint32_t *p)
+{
+  return _mm_loadu_si128((const __m128i *)p);
+}
 
-  if(indexTempSizes.size())
-  {
-    indexableTemps.resize(indexTempSizes.size());
+static inline void LaneStore(uint32_t *p, LaneVec v)
+{
+  _mm_storeu_si128((__m128i *)p, v);
+}
 
-    for(int32_t i = 0; i < (int32_t)indexTempSizes.size(); i++)
-    {
-      if(indexTempSizes[i] > 0)
-      {
-        indexableTemps[i].members.resize(indexTempSizes[i]);
-        for(uint32_t t = 0; t < indexTempSizes[i]; t++)
-        {
-          char buf[64] = {0};
+static inline LaneVec LaneSet(uint32_t u)
+{
+  return _mm_set1_epi32((int32_t)u);
+}
 
-          StringFormat::snprintf(buf, 63, "x%u[%u]", i, t);
+static inline LaneVec LaneAnd(LaneVec a, LaneVec b)
+{
+  return _mm_and_si128(a, b);
+}
 
-          indexableTemps[i].members[t] = ShaderVariable(buf, 0l, 0l, 0l, 0l);
-        }
-      }
-    }
-  }
+// ~a & b
+static inline LaneVec LaneAndNot(LaneVec a, LaneVec b)
+{
+  return _mm_andnot_si128(a, b);
 }
 
-bool State::Finished() const
+static inline LaneVec LaneOr(LaneVec a, LaneVec b)
 {
-  return program && (done || nextInstruction >= (int)program->GetNumInstructions());
+  return _mm_or_si128(a, b);
 }
 
-bool State::AssignValue(ShaderVariable &dst, uint32_t dstIndex, const ShaderVariable &src,
-                        uint32_t srcIndex, bool flushDenorm)
+static inline LaneVec LaneXor(LaneVec a, LaneVec b)
 {
-  if(src.type == VarType::Float)
-  {
-    float ft = src.value.fv[srcIndex];
-    if(!_finite(ft) || _isnan(ft))
-      flags |= ShaderEvents::GeneratedNanOrInf;
-  }
-  else if(src.type == VarType::Double)
-  {
-    double dt = src.value.dv[srcIndex];
-    if(!_finite(dt) || _isnan(dt))
-      flags |= ShaderEvents::GeneratedNanOrInf;
-  }
+  return _mm_xor_si128(a, b);
+}
 
-  bool ret = (dst.value.uv[dstIndex] != src.value.uv[srcIndex]);
+static inline LaneVec IAdd(LaneVec a, LaneVec b)
+{
+  return _mm_add_epi32(a, b);
+}
 
-  dst.value.uv[dstIndex] = src.value.uv[srcIndex];
+static inline LaneVec ISub(LaneVec a, LaneVec b)
+{
+  return _mm_sub_epi32(a, b);
+}
 
-  if(flushDenorm && src.type == VarType::Float)
-    dst.value.fv[dstIndex] = flush_denorm(dst.value.fv[dstIndex]);
+static inline LaneVec IMul(LaneVec a, LaneVec b)
+{
+  // SSE2 has no 32-bit multiply keeping the low half, so multiply the even and odd lanes to 64-bit
+  // results and pick the low halves back out
+  __m128i even = _mm_mul_epu32(a, b);
+  __m128i odd = _mm_mul_epu32(_mm_srli_si128(a, 4), _mm_srli_si128(b, 4));
+  return _mm_unpacklo_epi32(_mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 2, 0)),
+                            _mm_shuffle_epi32(odd, _MM_SHUFFLE(0, 0, 2, 0)));
+}
 
-  return ret;
+static inline LaneVec IEq(LaneVec a, LaneVec b)
+{
+  return _mm_cmpeq_epi32(a, b);
 }
 
-void State::SetDst(const Operand &dstoper, const Operation &op, const ShaderVariable &val)
+static inline LaneVec ILt(LaneVec a, LaneVec b)
 {
-  ShaderVariable *v = NULL;
+  return _mm_cmplt_epi32(a, b);
+}
 
-  uint32_t indices[4] = {0};
+static inline LaneVec ULt(LaneVec a, LaneVec b)
+{
+  // flip the sign bits so the signed comparison orders unsigned values
+  const __m128i bias = _mm_set1_epi32((int32_t)0x80000000U);
+  return _mm_cmplt_epi32(_mm_xor_si128(a, bias), _mm_xor_si128(b, bias));
+}
 
-  RDCASSERT(dstoper.indices.size() <= 4);
+static inline LaneVec IToF(LaneVec a)
+{
+  return AsLane(_mm_cvtepi32_ps(a));
+}
 
-  for(size_t i = 0; i < dstoper.indices.size(); i++)
-  {
-    if(dstoper.indices[i].absolute)
-      indices[i] = (uint32_t)dstoper.indices[i].index;
-    else
-      indices[i] = 0;
+static inline LaneVec FAdd(LaneVec a, LaneVec b)
+{
+  return AsLane(_mm_add_ps(AsFloat(a), AsFloat(b)));
+}
 
-    if(dstoper.indices[i].relative)
-    {
-      ShaderVariable idx = GetSrc(dstoper.indices[i].operand, op, false);
+static inline LaneVec FMul(LaneVec a, LaneVec b)
+{
+  return AsLane(_mm_mul_ps(AsFloat(a), AsFloat(b)));
+}
 
-      indices[i] += idx.value.i.x;
-    }
+static inline LaneVec FDiv(LaneVec a, LaneVec b)
+{
+  return AsLane(_mm_div_ps(AsFloat(a), AsFloat(b)));
+}
+
+static inline LaneVec FSqrt(LaneVec a)
+{
+  return AsLane(_mm_sqrt_ps(AsFloat(a)));
+}
+
+static inline LaneVec FEq(LaneVec a, LaneVec b)
+{
+  return AsLane(_mm_cmpeq_ps(AsFloat(a), AsFloat(b)));
+}
+
+static inline LaneVec FNe(LaneVec a, LaneVec b)
+{
+  return AsLane(_mm_cmpneq_ps(AsFloat(a), AsFloat(b)));
+}
+
+static inline LaneVec FLt(LaneVec a, LaneVec b)
+{
+  return AsLane(_mm_cmplt_ps(AsFloat(a), AsFloat(b)));
+}
+
+static inline LaneVec FGt(LaneVec a, LaneVec b)
+{
+  return AsLane(_mm_cmpgt_ps(AsFloat(a), AsFloat(b)));
+}
+
+static inline LaneVec FGe(LaneVec a, LaneVec b)
+{
+  return AsLane(_mm_cmpge_ps(AsFloat(a), AsFloat(b)));
+}
+
+static inline LaneVec FIsNaN(LaneVec a)
+{
+  return AsLane(_mm_cmpunord_ps(AsFloat(a), AsFloat(a)));
+}
+
+#else
+
+struct LaneVec
+{
+  uint32_t u[4];
+};
+
+static inline LaneVec LaneLoad(const uint32_t *p)
+{
+  LaneVec r;
+  memcpy(r.u, p, sizeof(r.u));
+  return r;
+}
+
+static inline void LaneStore(uint32_t *p, LaneVec v)
+{
+  memcpy(p, v.u, sizeof(v.u));
+}
+
+static inline LaneVec LaneSet(uint32_t u)
+{
+  LaneVec r = {{u, u, u, u}};
+  return r;
+}
+
+#define LANE_UNARY(name, expr)             \
+  static inline LaneVec name(LaneVec a)    \
+  {                                        \
+    LaneVec r;                             \
+    for(int i = 0; i < 4; i++)             \
+    {                                      \
+      uint32_t x = a.u[i];                 \
+      r.u[i] = (expr);                     \
+    }                                      \
+    return r;                              \
   }
 
-  RegisterRange range;
-  range.index = uint16_t(indices[0]);
+#define LANE_BINARY(name, expr)                    \
+  static inline LaneVec name(LaneVec a, LaneVec b) \
+  {                                                \
+    LaneVec r;                                     \
+    for(int i = 0; i < 4; i++)                     \
+    {                                              \
+      uint32_t x = a.u[i], y = b.u[i];             \
+      r.u[i] = (expr);                             \
+    }                                              \
+    return r;                                      \
+  }
 
-  switch(dstoper.type)
+LANE_BINARY(LaneAnd, x & y);
+LANE_BINARY(LaneAndNot, ~x & y);
+LANE_BINARY(LaneOr, x | y);
+LANE_BINARY(LaneXor, x ^ y);
+LANE_BINARY(IAdd, x + y);
+LANE_BINARY(ISub, x - y);
+LANE_BINARY(IMul, x * y);
+LANE_BINARY(IEq, x == y ? ~0U : 0U);
+LANE_BINARY(ILt, int32_t(x) < int32_t(y) ? ~0U : 0U);
+LANE_BINARY(ULt, x < y ? ~0U : 0U);
+LANE_UNARY(IToF, LaneU((float)int32_t(x)));
+LANE_BINARY(FAdd, LaneU(LaneF(x) + LaneF(y)));
+LANE_BINARY(FMul, LaneU(LaneF(x) * LaneF(y)));
+LANE_BINARY(FDiv, LaneU(LaneF(x) / LaneF(y)));
+LANE_UNARY(FSqrt, LaneU(sqrtf(LaneF(x))));
+LANE_BINARY(FEq, LaneF(x) == LaneF(y) ? ~0U : 0U);
+LANE_BINARY(FNe, LaneF(x) != LaneF(y) ? ~0U : 0U);
+LANE_BINARY(FLt, LaneF(x) < LaneF(y) ? ~0U : 0U);
+LANE_BINARY(FGt, LaneF(x) > LaneF(y) ? ~0U : 0U);
+LANE_BINARY(FGe, LaneF(x) >= LaneF(y) ? ~0U : 0U);
+LANE_UNARY(FIsNaN, std::isnan(LaneF(x)) ? ~0U : 0U);
+
+#undef LANE_UNARY
+#undef LANE_BINARY
+
+#endif
+
+// mask ? a : b
+static inline LaneVec LaneSelect(LaneVec mask, LaneVec a, LaneVec b)
+{
+  return LaneOr(LaneAnd(mask, a), LaneAndNot(mask, b));
+}
+
+static inline LaneVec LaneNot(LaneVec a)
+{
+  return LaneXor(a, LaneSet(~0U));
+}
+
+static inline LaneVec FNeg(LaneVec a)
+{
+  return LaneXor(a, LaneSet(0x80000000U));
+}
+
+// same as dxbc_min/dxbc_max - if only one side is NaN, the other is returned
+static inline LaneVec FMin(LaneVec a, LaneVec b)
+{
+  LaneVec ret = LaneSelect(FLt(a, b), a, b);
+  return LaneSelect(LaneAndNot(FIsNaN(a), FIsNaN(b)), a, ret);
+}
+
+static inline LaneVec FMax(LaneVec a, LaneVec b)
+{
+  LaneVec ret = LaneSelect(FGe(a, b), a, b);
+  return LaneSelect(LaneAndNot(FIsNaN(a), FIsNaN(b)), a, ret);
+}
+
+// same as flush_denorm
+static inline LaneVec FFlushDenorm(LaneVec a)
+{
+  LaneVec denorm = IEq(LaneAnd(a, LaneSet(0x7F800000U)), LaneSet(0));
+  return LaneSelect(denorm, LaneAnd(a, LaneSet(0x80000000U)), a);
+}
+
+// runs op on every component of every lane, four lanes at a time
+template <typename Op>
+static void ForEachLane(const LaneGroup::LaneData *src, size_t count, LaneGroup::LaneData &dst,
+                        Op op)
+{
+  for(int c = 0; c < 4; c++)
   {
-    case TYPE_TEMP:
+    for(size_t l = 0; l < count; l += 4)
     {
-      range.type = RegisterType::Temporary;
-      RDCASSERT(indices[0] < (uint32_t)registers.size());
-      if(indices[0] < (uint32_t)registers.size())
-        v = &registers[(size_t)indices[0]];
-      break;
+      LaneVec ret = op(LaneLoad(&src[0].u[c][l]), LaneLoad(&src[1].u[c][l]),
+                       LaneLoad(&src[2].u[c][l]));
+      LaneStore(&dst.u[c][l], ret);
     }
-    case TYPE_INDEXABLE_TEMP:
-    {
-      range.type = RegisterType::IndexedTemporary;
-      RDCASSERT(dstoper.indices.size() == 2);
+  }
+}
 
-      if(dstoper.indices.size() == 2)
-      {
-        RDCASSERT(indices[0] < (uint32_t)indexableTemps.size());
-        if(indices[0] < (uint32_t)indexableTemps.size())
-        {
-          RDCASSERT(indices[1] < (uint32_t)indexableTemps[indices[0]].members.size());
-          if(indices[1] < (uint32_t)indexableTemps[indices[0]].members.size())
-          {
-            v = &indexableTemps[indices[0]].members[indices[1]];
-          }
-        }
-      }
-      break;
-    }
-    case TYPE_OUTPUT:
-    {
-      range.type = RegisterType::Output;
-      RDCASSERT(indices[0] < (uint32_t)outputs.size());
-      if(indices[0] < (uint32_t)outputs.size())
-        v = &outputs[(size_t)indices[0]];
-      break;
-    }
-    case TYPE_INPUT:
-    case TYPE_CONSTANT_BUFFER:
-    {
-      RDCERR(
-          "Attempt to write to read-only operand (input, cbuffer, etc).\n"
-          "This is likely a bug in the asm extraction as such code isn't likely to be produced by "
-          "fxc.");
-      break;
+// for the few operations with no vector form, runs op on each value individually
+template <typename Op>
+static void ForEachValue(const LaneGroup::LaneData *src, size_t count, LaneGroup::LaneData &dst,
+                         Op op)
+{
+  for(int c = 0; c < 4; c++)
+    for(size_t l = 0; l < count; l++)
+      dst.u[c][l] = op(src[0].u[c][l]);
+}
+
+// like the add/mul/div/neg helpers, these only calculate as many components as the first source
+// has and pass through the rest unmodified. The result keeps the source's column count too, which
+// limits the components that saturation applies to.
+static bool KeepsSourceColumns(OpcodeType op)
+{
+  switch(op)
+  {
+    case OPCODE_MOV:
+    case OPCODE_ADD:
+    case OPCODE_IADD:
+    case OPCODE_MUL:
+    case OPCODE_DIV:
+    case OPCODE_MAD:
+    case OPCODE_IMAD:
+    case OPCODE_UMAD:
+    case OPCODE_INEG: return true;
+    default: return false;
+  }
+}
+
+VarType LaneGroup::Execute(const DecodedOperation &dop, const LaneData *src, uint32_t columns,
+                           size_t count, LaneData &dst)
+{
+  const Operation &op = *dop.operation;
+
+  count = AlignUp4(count);
+
+  VarType resultType = VarType::Float;
+
+  switch(op.operation)
+  {
+    case OPCODE_MOV:
+      ForEachLane(src, count, dst, [](LaneVec a, LaneVec, LaneVec) { return a; });
+      break;
+    case OPCODE_ADD:
+      ForEachLane(src, count, dst, [](LaneVec a, LaneVec b, LaneVec) { return FAdd(a, b); });
+      break;
+    case OPCODE_IADD:
+      ForEachLane(src, count, dst, [](LaneVec a, LaneVec b, LaneVec) { return IAdd(a, b); });
+      resultType = VarType::SInt;
+      break;
+    case OPCODE_MUL:
+      ForEachLane(src, count, dst, [](LaneVec a, LaneVec b, LaneVec) { return FMul(a, b); });
+      break;
+    case OPCODE_DIV:
+      ForEachLane(src, count, dst, [](LaneVec a, LaneVec b, LaneVec) { return FDiv(a, b); });
+      break;
+    case OPCODE_MAD:
+      // the multiply and add are separately rounded operations, not a fused multiply-add
+      ForEachLane(src, count, dst,
+                  [](LaneVec a, LaneVec b, LaneVec c) { return FAdd(FMul(a, b), c); });
+      break;
+    case OPCODE_IMAD:
+    case OPCODE_UMAD:
+      ForEachLane(src, count, dst,
+                  [](LaneVec a, LaneVec b, LaneVec c) { return IAdd(IMul(a, b), c); });
+      resultType = op.operation == OPCODE_IMAD ? VarType::SInt : VarType::UInt;
+      break;
+    case OPCODE_DP2:
+    case OPCODE_DP3:
+    case OPCODE_DP4:
+    {
+      const int numComps = op.operation == OPCODE_DP2 ? 2 : (op.operation == OPCODE_DP3 ? 3 : 4);
+
+      for(size_t l = 0; l < count; l += 4)
+      {
+        LaneVec sum = LaneSet(0);
+
+        for(int c = 0; c < numComps; c++)
+        {
+          // the multiply only covers the first source's columns, like mul()
+          LaneVec a = LaneLoad(&src[0].u[c][l]);
+          LaneVec prod = c < (int)columns ? FMul(a, LaneLoad(&src[1].u[c][l])) : a;
+
+          sum = c == 0 ? prod : FAdd(sum, prod);
+        }
+
+        for(int c = 0; c < 4; c++)
+          LaneStore(&dst.u[c][l], sum);
+      }
+      break;
+    }
+    case OPCODE_MIN:
+      ForEachLane(src, count, dst, [](LaneVec a, LaneVec b, LaneVec) { return FMin(a, b); });
+      break;
+    case OPCODE_MAX:
+      ForEachLane(src, count, dst, [](LaneVec a, LaneVec b, LaneVec) { return FMax(a, b); });
+      break;
+    case OPCODE_IMIN:
+      ForEachLane(src, count, dst,
+                  [](LaneVec a, LaneVec b, LaneVec) { return LaneSelect(ILt(a, b), a, b); });
+      resultType = VarType::SInt;
+      break;
+    case OPCODE_IMAX:
+      ForEachLane(src, count, dst,
+                  [](LaneVec a, LaneVec b, LaneVec) { return LaneSelect(ILt(a, b), b, a); });
+      resultType = VarType::SInt;
+      break;
+    case OPCODE_UMIN:
+      ForEachLane(src, count, dst,
+                  [](LaneVec a, LaneVec b, LaneVec) { return LaneSelect(ULt(a, b), a, b); });
+      resultType = VarType::UInt;
+      break;
+    case OPCODE_UMAX:
+      ForEachLane(src, count, dst,
+                  [](LaneVec a, LaneVec b, LaneVec) { return LaneSelect(ULt(a, b), b, a); });
+      resultType = VarType::UInt;
+      break;
+    case OPCODE_INEG:
+      ForEachLane(src, count, dst, [](LaneVec a, LaneVec, LaneVec) { return ISub(LaneSet(0), a); });
+      resultType = VarType::SInt;
+      break;
+    case OPCODE_AND:
+      ForEachLane(src, count, dst, [](LaneVec a, LaneVec b, LaneVec) { return LaneAnd(a, b); });
+      resultType = VarType::SInt;
+      break;
+    case OPCODE_OR:
+      ForEachLane(src, count, dst, [](LaneVec a, LaneVec b, LaneVec) { return LaneOr(a, b); });
+      resultType = VarType::SInt;
+      break;
+    case OPCODE_XOR:
+      ForEachLane(src, count, dst, [](LaneVec a, LaneVec b, LaneVec) { return LaneXor(a, b); });
+      resultType = VarType::UInt;
+      break;
+    case OPCODE_NOT:
+      ForEachLane(src, count, dst, [](LaneVec a, LaneVec, LaneVec) { return LaneNot(a); });
+      resultType = VarType::UInt;
+      break;
+    case OPCODE_ISHL:
+    case OPCODE_ISHR:
+    case OPCODE_USHR:
+    {
+      // if we were only given a single component, it's the form that shifts all components
+      // by the same amount
+      bool shiftAll = (op.operands[2].numComponents == NUMCOMPS_1 ||
+                       (op.operands[2].comps[2] < 4 && op.operands[2].comps[2] == 0xff));
+
+      // SSE2 can only shift every lane by the same amount, so these are done per-value
+      for(int c = 0; c < 4; c++)
+      {
+        for(size_t l = 0; l < count; l++)
+        {
+          uint32_t shift = src[1].u[shiftAll ? 0 : c][l] & 0x1f;
+
+          if(op.operation == OPCODE_ISHL)
+            dst.u[c][l] = src[0].u[c][l] << shift;
+          else if(op.operation == OPCODE_ISHR)
+            dst.i[c][l] = src[0].i[c][l] >> shift;
+          else
+            dst.u[c][l] = src[0].u[c][l] >> shift;
+        }
+      }
+
+      resultType = op.operation == OPCODE_USHR ? VarType::UInt : VarType::SInt;
+      break;
+    }
+    case OPCODE_EQ:
+      ForEachLane(src, count, dst, [](LaneVec a, LaneVec b, LaneVec) { return FEq(a, b); });
+      resultType = VarType::UInt;
+      break;
+    case OPCODE_NE:
+      ForEachLane(src, count, dst, [](LaneVec a, LaneVec b, LaneVec) { return FNe(a, b); });
+      resultType = VarType::UInt;
+      break;
+    case OPCODE_LT:
+      ForEachLane(src, count, dst, [](LaneVec a, LaneVec b, LaneVec) { return FLt(a, b); });
+      resultType = VarType::UInt;
+      break;
+    case OPCODE_GE:
+      ForEachLane(src, count, dst, [](LaneVec a, LaneVec b, LaneVec) { return FGe(a, b); });
+      resultType = VarType::UInt;
+      break;
+    case OPCODE_IEQ:
+      ForEachLane(src, count, dst, [](LaneVec a, LaneVec b, LaneVec) { return IEq(a, b); });
+      resultType = VarType::UInt;
+      break;
+    case OPCODE_INE:
+      ForEachLane(src, count, dst,
+                  [](LaneVec a, LaneVec b, LaneVec) { return LaneNot(IEq(a, b)); });
+      resultType = VarType::UInt;
+      break;
+    case OPCODE_IGE:
+      ForEachLane(src, count, dst,
+                  [](LaneVec a, LaneVec b, LaneVec) { return LaneNot(ILt(a, b)); });
+      resultType = VarType::UInt;
+      break;
+    case OPCODE_ILT:
+      ForEachLane(src, count, dst, [](LaneVec a, LaneVec b, LaneVec) { return ILt(a, b); });
+      resultType = VarType::UInt;
+      break;
+    case OPCODE_ULT:
+      ForEachLane(src, count, dst, [](LaneVec a, LaneVec b, LaneVec) { return ULt(a, b); });
+      resultType = VarType::UInt;
+      break;
+    case OPCODE_UGE:
+      ForEachLane(src, count, dst,
+                  [](LaneVec a, LaneVec b, LaneVec) { return LaneNot(ULt(a, b)); });
+      resultType = VarType::UInt;
+      break;
+    case OPCODE_MOVC:
+      ForEachLane(src, count, dst, [](LaneVec a, LaneVec b, LaneVec c) {
+        return LaneSelect(IEq(a, LaneSet(0)), c, b);
+      });
+      resultType = VarType::SInt;
+      break;
+    case OPCODE_SQRT:
+      ForEachLane(src, count, dst, [](LaneVec a, LaneVec, LaneVec) { return FSqrt(a); });
+      break;
+    case OPCODE_ITOF:
+      ForEachLane(src, count, dst, [](LaneVec a, LaneVec, LaneVec) { return IToF(a); });
+      break;
+    case OPCODE_UTOF:
+      ForEachValue(src, count, dst, [](uint32_t a) { return LaneU((float)a); });
+      break;
+    case OPCODE_FRC:
+      ForEachValue(src, count, dst, [](uint32_t a) { return LaneU(LaneF(a) - floorf(LaneF(a))); });
+      break;
+    // positive infinity
+    case OPCODE_ROUND_PI:
+      ForEachValue(src, count, dst, [](uint32_t a) { return LaneU(ceilf(LaneF(a))); });
+      break;
+    // negative infinity
+    case OPCODE_ROUND_NI:
+      ForEachValue(src, count, dst, [](uint32_t a) { return LaneU(floorf(LaneF(a))); });
+      break;
+    // towards zero
+    case OPCODE_ROUND_Z:
+      ForEachValue(src, count, dst, [](uint32_t a) {
+        float f = LaneF(a);
+        return LaneU(f < 0.f ? ceilf(f) : floorf(f));
+      });
+      break;
+    // to nearest even int (banker's rounding)
+    case OPCODE_ROUND_NE:
+      ForEachValue(src, count, dst, [](uint32_t a) { return LaneU(round_ne(LaneF(a))); });
+      break;
+    default: RDCERR("Unexpected operation %d in vectorised step", op.operation); break;
+  }
+
+  if(KeepsSourceColumns(op.operation))
+  {
+    for(uint32_t c = columns; c < 4; c++)
+      memcpy(dst.u[c], src[0].u[c], count * sizeof(uint32_t));
+  }
+
+  return resultType;
+}
+
+void State::Init()
+{
+  std::vector<uint32_t> indexTempSizes;
+
+  for(size_t i = 0; i < program->GetNumDeclarations(); i++)
+  {
+    const DXBCBytecode::Declaration &decl = program->GetDeclaration(i);
+
+    if(decl.declaration == OPCODE_DCL_TEMPS)
+    {
+      registers.reserve(decl.numTemps);
+
+      for(uint32_t t = 0; t < decl.numTemps; t++)
+      {
+        char buf[64] = {0};
+
+        StringFormat::snprintf(buf, 63, "r%d", t);
+
+        registers.push_back(ShaderVariable(buf, 0U, 0U, 0U, 0U));
+      }
+    }
+    if(decl.declaration == OPCODE_DCL_INDEXABLE_TEMP)
+    {
+      uint32_t reg = decl.tempReg;
+      uint32_t size = decl.numTemps;
+      if(reg >= indexTempSizes.size())
+        indexTempSizes.resize(reg + 1);
+
+      indexTempSizes[reg] = size;
+    }
+  }
+
+  if(indexTempSizes.size())
+  {
+    indexableTemps.resize(indexTempSizes.size());
+
+    for(int32_t i = 0; i < (int32_t)indexTempSizes.size(); i++)
+    {
+      if(indexTempSizes[i] > 0)
+      {
+        indexableTemps[i].members.resize(indexTempSizes[i]);
+        for(uint32_t t = 0; t < indexTempSizes[i]; t++)
+        {
+          char buf[64] = {0};
+
+          StringFormat::snprintf(buf, 63, "x%u[%u]", i, t);
+
+          indexableTemps[i].members[t] = ShaderVariable(buf, 0U, 0U, 0U, 0U);
+        }
+      }
+    }
+  }
+}
+
+bool State::Finished() const
+{
+  return program && (done || nextInstruction >= program->GetNumInstructions());
+}
+
+bool State::AssignValue(ShaderVariable &dst, uint32_t dstIndex, const ShaderVariable &src,
+                        uint32_t srcIndex, bool flushDenorm)
+{
+  if(src.type == VarType::Float)
+  {
+    float ft = src.value.fv[srcIndex];
+    if(!std::isfinite(ft))
+      flags |= ShaderEvents::GeneratedNanOrInf;
+  }
+  else if(src.type == VarType::Double)
+  {
+    double dt = src.value.dv[srcIndex];
+    if(!std::isfinite(dt))
+      flags |= ShaderEvents::GeneratedNanOrInf;
+  }
+
+  bool ret = (dst.value.uv[dstIndex] != src.value.uv[srcIndex]);
+
+  dst.value.uv[dstIndex] = src.value.uv[srcIndex];
+
+  if(flushDenorm && src.type == VarType::Float)
+    dst.value.fv[dstIndex] = flush_denorm(dst.value.fv[dstIndex]);
+
+  return ret;
+}
+
+void State::SetDst(const DecodedOperand &dst, const DecodedOperation &op, const ShaderVariable &val)
+{
+  const Operand &dstoper = *dst.operand;
+
+  ShaderVariable *v = NULL;
+
+  uint32_t indices[4];
+  GetIndices(dst, op, indices);
+
+  RegisterRange range;
+  range.index = uint16_t(indices[0]);
+
+  switch(dstoper.type)
+  {
+    case TYPE_TEMP:
+    {
+      range.type = RegisterType::Temporary;
+      RDCASSERT(indices[0] < (uint32_t)registers.size());
+      if(indices[0] < (uint32_t)registers.size())
+        v = &registers[(size_t)indices[0]];
+      break;
+    }
+    case TYPE_INDEXABLE_TEMP:
+    {
+      range.type = RegisterType::IndexedTemporary;
+      RDCASSERT(dstoper.indices.size() == 2);
+
+      if(dstoper.indices.size() == 2)
+      {
+        RDCASSERT(indices[0] < (uint32_t)indexableTemps.size());
+        if(indices[0] < (uint32_t)indexableTemps.size())
+        {
+          RDCASSERT(indices[1] < (uint32_t)indexableTemps[indices[0]].members.size());
+          if(indices[1] < (uint32_t)indexableTemps[indices[0]].members.size())
+          {
+            v = &indexableTemps[indices[0]].members[indices[1]];
+          }
+        }
+      }
+      break;
+    }
+    case TYPE_OUTPUT:
+    {
+      range.type = RegisterType::Output;
+      RDCASSERT(indices[0] < (uint32_t)outputs.size());
+      if(indices[0] < (uint32_t)outputs.size())
+        v = &outputs[(size_t)indices[0]];
+      break;
+    }
+    case TYPE_INPUT:
+    case TYPE_CONSTANT_BUFFER:
+    {
+      RDCERR(
+          "Attempt to write to read-only operand (input, cbuffer, etc).\n"
+          "This is likely a bug in the asm extraction as such code isn't likely to be produced by "
+          "fxc.");
+      break;
     }
     case TYPE_NULL:
     {
@@ -1309,12 +1949,17 @@ void State::SetDst(const Operand &dstoper, const Operation &op, const ShaderVari
 
   if(v)
   {
-    ShaderVariable right = val;
+    // only copy the value when saturating it
+    ShaderVariable saturated;
+    if(op.operation->saturate)
+      saturated = sat(val, op.type);
+
+    const ShaderVariable &right = op.operation->saturate ? saturated : val;
 
     RDCASSERT(v->rows == 1 && right.rows == 1);
     RDCASSERT(right.columns <= 4);
 
-    bool flushDenorm = OperationFlushing(op.operation);
+    bool flushDenorm = op.flushing;
 
     // behaviour for scalar and vector masks are slightly different.
     // in a scalar operation like r0.z = r4.x + r6.y
@@ -1323,11 +1968,7 @@ void State::SetDst(const Operand &dstoper, const Operation &op, const ShaderVari
     // in a vector operation like r0.zw = r4.xxxy + r6.yyyz
     // then we must write from matching component to matching component
 
-    if(op.saturate)
-      right = sat(right, OperationType(op.operation));
-
-    if(dstoper.comps[0] != 0xff && dstoper.comps[1] == 0xff && dstoper.comps[2] == 0xff &&
-       dstoper.comps[3] == 0xff)
+    if(dst.scalar)
     {
       RDCASSERT(dstoper.comps[0] != 0xff);
 
@@ -1373,12 +2014,12 @@ void State::SetDst(const Operand &dstoper, const Operation &op, const ShaderVari
   }
 }
 
-ShaderVariable State::DDX(bool fine, State quad[4], const DXBCBytecode::Operand &oper,
-                          const DXBCBytecode::Operation &op) const
+ShaderVariable State::DDX(bool fine, State quad[4], const DecodedOperand &oper,
+                          const DecodedOperation &op) const
 {
   ShaderVariable ret;
 
-  VarType optype = OperationType(op.operation);
+  VarType optype = op.type;
 
   if(!fine)
   {
@@ -1398,12 +2039,12 @@ ShaderVariable State::DDX(bool fine, State quad[4], const DXBCBytecode::Operand
   return ret;
 }
 
-ShaderVariable State::DDY(bool fine, State quad[4], const DXBCBytecode::Operand &oper,
-                          const DXBCBytecode::Operation &op) const
+ShaderVariable State::DDY(bool fine, State quad[4], const DecodedOperand &oper,
+                          const DecodedOperation &op) const
 {
   ShaderVariable ret;
 
-  VarType optype = OperationType(op.operation);
+  VarType optype = op.type;
 
   if(!fine)
   {
@@ -1423,28 +2064,39 @@ ShaderVariable State::DDY(bool fine, State quad[4], const DXBCBytecode::Operand
   return ret;
 }
 
-ShaderVariable State::GetSrc(const Operand &oper, const Operation &op, bool allowFlushing) const
+void State::GetIndices(const DecodedOperand &oper, const DecodedOperation &op,
+                       uint32_t indices[4]) const
 {
-  ShaderVariable v, s;
+  memcpy(indices, oper.indices, sizeof(oper.indices));
 
-  uint32_t indices[4] = {0};
-
-  RDCASSERT(oper.indices.size() <= 4);
+  if(oper.relativeIndices == 0)
+    return;
 
-  for(size_t i = 0; i < oper.indices.size(); i++)
+  for(size_t i = 0; i < 4; i++)
   {
-    if(oper.indices[i].absolute)
-      indices[i] = (uint32_t)oper.indices[i].index;
-    else
-      indices[i] = 0;
-
-    if(oper.indices[i].relative)
+    if(oper.relativeIndices & (1U << i))
     {
-      ShaderVariable idx = GetSrc(oper.indices[i].operand, op, false);
+      ShaderVariable idx;
+
+      if(oper.relativeOperands[i] < op.relativeOperands.size())
+        idx = GetSrc(op.relativeOperands[oper.relativeOperands[i]], op, false);
+      else
+        idx = GetSrc(DecodedOperand(oper.operand->indices[i].operand, reflection), op, false);
 
       indices[i] += idx.value.i.x;
     }
   }
+}
+
+ShaderVariable State::GetSrc(const DecodedOperand &dec, const DecodedOperation &op,
+                             bool allowFlushing) const
+{
+  const Operand &oper = *dec.operand;
+
+  ShaderVariable v;
+
+  uint32_t indices[4];
+  GetIndices(dec, op, indices);
 
   // is this type a flushable input (for float operations)
   bool flushable = allowFlushing;
@@ -1457,9 +2109,9 @@ ShaderVariable State::GetSrc(const Operand &oper, const Operation &op, bool allo
       RDCASSERT(indices[0] < (uint32_t)registers.size());
 
       if(indices[0] < (uint32_t)registers.size())
-        v = s = registers[indices[0]];
+        v = registers[indices[0]];
       else
-        v = s = ShaderVariable("", indices[0], indices[0], indices[0], indices[0]);
+        v = ShaderVariable("", indices[0], indices[0], indices[0], indices[0]);
 
       break;
     }
@@ -1475,7 +2127,7 @@ ShaderVariable State::GetSrc(const Operand &oper, const Operation &op, bool allo
           RDCASSERT(indices[1] < (uint32_t)indexableTemps[indices[0]].members.size());
           if(indices[1] < (uint32_t)indexableTemps[indices[0]].members.size())
           {
-            v = s = indexableTemps[indices[0]].members[indices[1]];
+            v = indexableTemps[indices[0]].members[indices[1]];
           }
         }
       }
@@ -1486,9 +2138,9 @@ ShaderVariable State::GetSrc(const Operand &oper, const Operation &op, bool allo
       RDCASSERT(indices[0] < (uint32_t)trace->inputs.size());
 
       if(indices[0] < (uint32_t)trace->inputs.size())
-        v = s = trace->inputs[indices[0]];
+        v = trace->inputs[indices[0]];
       else
-        v = s = ShaderVariable("", indices[0], indices[0], indices[0], indices[0]);
+        v = ShaderVariable("", indices[0], indices[0], indices[0], indices[0]);
 
       break;
     }
@@ -1497,9 +2149,9 @@ ShaderVariable State::GetSrc(const Operand &oper, const Operation &op, bool allo
       RDCASSERT(indices[0] < (uint32_t)outputs.size());
 
       if(indices[0] < (uint32_t)outputs.size())
-        v = s = outputs[indices[0]];
+        v = outputs[indices[0]];
       else
-        v = s = ShaderVariable("", indices[0], indices[0], indices[0], indices[0]);
+        v = ShaderVariable("", indices[0], indices[0], indices[0], indices[0]);
 
       break;
     }
@@ -1517,26 +2169,26 @@ ShaderVariable State::GetSrc(const Operand &oper, const Operation &op, bool allo
     {
       // should be handled specially by instructions that expect these types of
       // argument but let's be sane and include the index
-      v = s = ShaderVariable("", indices[0], indices[0], indices[0], indices[0]);
+      v = ShaderVariable("", indices[0], indices[0], indices[0], indices[0]);
       flushable = false;
       break;
     }
     case TYPE_IMMEDIATE32:
     case TYPE_IMMEDIATE64:
     {
-      s.name = "Immediate";
+      v.name = "Immediate";
 
       flushable = false;
 
       if(oper.numComponents == NUMCOMPS_1)
       {
-        s.rows = 1;
-        s.columns = 1;
+        v.rows = 1;
+        v.columns = 1;
       }
       else if(oper.numComponents == NUMCOMPS_4)
       {
-        s.rows = 1;
-        s.columns = 4;
+        v.rows = 1;
+        v.columns = 4;
       }
       else
       {
@@ -1545,9 +2197,9 @@ ShaderVariable State::GetSrc(const Operand &oper, const Operation &op, bool allo
 
       if(oper.type == TYPE_IMMEDIATE32)
       {
-        for(size_t i = 0; i < s.columns; i++)
+        for(size_t i = 0; i < v.columns; i++)
         {
-          s.value.iv[i] = (int32_t)oper.values[i];
+          v.value.iv[i] = (int32_t)oper.values[i];
         }
       }
       else
@@ -1556,20 +2208,22 @@ ShaderVariable State::GetSrc(const Operand &oper, const Operation &op, bool allo
             "Encountered immediate 64bit value!");    // need to figure out what to do here.
       }
 
-      v = s;
-
       break;
     }
     case TYPE_CONSTANT_BUFFER:
     {
-      int cb = -1;
+      int cb = dec.cbuffer;
 
-      for(size_t i = 0; i < reflection->CBuffers.size(); i++)
+      // with a relative buffer index we have to look it up now
+      if(dec.relativeIndices & 1)
       {
-        if(reflection->CBuffers[i].reg == indices[0])
+        for(size_t i = 0; i < reflection->CBuffers.size(); i++)
         {
-          cb = (int)i;
-          break;
+          if(reflection->CBuffers[i].reg == indices[0])
+          {
+            cb = (int)i;
+            break;
+          }
         }
       }
 
@@ -1583,27 +2237,27 @@ ShaderVariable State::GetSrc(const Operand &oper, const Operation &op, bool allo
                      trace->constantBlocks[cb].members.count());
 
         if(indices[1] < (uint32_t)trace->constantBlocks[cb].members.count())
-          v = s = trace->constantBlocks[cb].members[indices[1]];
+          v = trace->constantBlocks[cb].members[indices[1]];
         else
-          v = s = ShaderVariable("", 0U, 0U, 0U, 0U);
+          v = ShaderVariable("", 0U, 0U, 0U, 0U);
       }
       else
       {
-        v = s = ShaderVariable("", 0U, 0U, 0U, 0U);
+        v = ShaderVariable("", 0U, 0U, 0U, 0U);
       }
 
       break;
     }
     case TYPE_IMMEDIATE_CONSTANT_BUFFER:
     {
-      v = s = ShaderVariable("", 0, 0, 0, 0);
+      v = ShaderVariable("", 0, 0, 0, 0);
 
       const std::vector<uint32_t> &icb = program->GetImmediateConstantBuffer();
 
       // if this Vec4f is entirely in the ICB
       if(indices[0] <= icb.size() / 4 - 1)
       {
-        memcpy(s.value.uv, &icb[indices[0] * 4], sizeof(Vec4f));
+        memcpy(v.value.uv, &icb[indices[0] * 4], sizeof(Vec4f));
       }
       else
       {
@@ -1618,34 +2272,21 @@ ShaderVariable State::GetSrc(const Operand &oper, const Operation &op, bool allo
     }
     case TYPE_INPUT_THREAD_GROUP_ID:
     {
-      v = s = ShaderVariable("vThreadGroupID", semantics.GroupID[0], semantics.GroupID[1],
-                             semantics.GroupID[2], (uint32_t)0);
+      v = ShaderVariable("vThreadGroupID", semantics.GroupID[0], semantics.GroupID[1],
+                         semantics.GroupID[2], (uint32_t)0);
 
       break;
     }
     case TYPE_INPUT_THREAD_ID:
     {
-      uint32_t numthreads[3] = {0, 0, 0};
-
-      for(size_t i = 0; i < program->GetNumDeclarations(); i++)
-      {
-        const Declaration &decl = program->GetDeclaration(i);
-
-        if(decl.declaration == OPCODE_DCL_THREAD_GROUP)
-        {
-          numthreads[0] = decl.groupSize[0];
-          numthreads[1] = decl.groupSize[1];
-          numthreads[2] = decl.groupSize[2];
-        }
-      }
+      const uint32_t *numthreads = decoded->GetThreadGroupSize();
 
       RDCASSERT(numthreads[0] >= 1 && numthreads[0] <= 1024);
       RDCASSERT(numthreads[1] >= 1 && numthreads[1] <= 1024);
       RDCASSERT(numthreads[2] >= 1 && numthreads[2] <= 64);
       RDCASSERT(numthreads[0] * numthreads[1] * numthreads[2] <= 1024);
 
-      v = s =
-          ShaderVariable("vThreadID", semantics.GroupID[0] * numthreads[0] + semantics.ThreadID[0],
+      v = ShaderVariable("vThreadID", semantics.GroupID[0] * numthreads[0] + semantics.ThreadID[0],
                          semantics.GroupID[1] * numthreads[1] + semantics.ThreadID[1],
                          semantics.GroupID[2] * numthreads[2] + semantics.ThreadID[2], (uint32_t)0);
 
@@ -1653,26 +2294,14 @@ ShaderVariable State::GetSrc(const Operand &oper, const Operation &op, bool allo
     }
     case TYPE_INPUT_THREAD_ID_IN_GROUP:
     {
-      v = s = ShaderVariable("vThreadIDInGroup", semantics.ThreadID[0], semantics.ThreadID[1],
-                             semantics.ThreadID[2], (uint32_t)0);
+      v = ShaderVariable("vThreadIDInGroup", semantics.ThreadID[0], semantics.ThreadID[1],
+                         semantics.ThreadID[2], (uint32_t)0);
 
       break;
     }
     case TYPE_INPUT_THREAD_ID_IN_GROUP_FLATTENED:
     {
-      uint32_t numthreads[3] = {0, 0, 0};
-
-      for(size_t i = 0; i < program->GetNumDeclarations(); i++)
-      {
-        const Declaration &decl = program->GetDeclaration(i);
-
-        if(decl.declaration == OPCODE_DCL_THREAD_GROUP)
-        {
-          numthreads[0] = decl.groupSize[0];
-          numthreads[1] = decl.groupSize[1];
-          numthreads[2] = decl.groupSize[2];
-        }
-      }
+      const uint32_t *numthreads = decoded->GetThreadGroupSize();
 
       RDCASSERT(numthreads[0] >= 1 && numthreads[0] <= 1024);
       RDCASSERT(numthreads[1] >= 1 && numthreads[1] <= 1024);
@@ -1682,53 +2311,53 @@ ShaderVariable State::GetSrc(const Operand &oper, const Operation &op, bool allo
       uint32_t flattened = semantics.ThreadID[2] * numthreads[0] * numthreads[1] +
                            semantics.ThreadID[1] * numthreads[0] + semantics.ThreadID[0];
 
-      v = s = ShaderVariable("vThreadIDInGroupFlattened", flattened, flattened, flattened, flattened);
+      v = ShaderVariable("vThreadIDInGroupFlattened", flattened, flattened, flattened, flattened);
       break;
     }
     case TYPE_INPUT_COVERAGE_MASK:
     {
-      v = s = ShaderVariable("vCoverage", semantics.coverage, semantics.coverage,
-                             semantics.coverage, semantics.coverage);
+      v = ShaderVariable("vCoverage", semantics.coverage, semantics.coverage,
+                         semantics.coverage, semantics.coverage);
       break;
     }
     case TYPE_INPUT_PRIMITIVEID:
     {
-      v = s = ShaderVariable("vPrimitiveID", semantics.primID, semantics.primID, semantics.primID,
-                             semantics.primID);
+      v = ShaderVariable("vPrimitiveID", semantics.primID, semantics.primID, semantics.primID,
+                         semantics.primID);
       break;
     }
     default:
     {
       RDCERR("Currently unsupported operand type %d!", oper.type);
 
-      v = s = ShaderVariable("vUnsupported", (uint32_t)0, (uint32_t)0, (uint32_t)0, (uint32_t)0);
+      v = ShaderVariable("vUnsupported", (uint32_t)0, (uint32_t)0, (uint32_t)0, (uint32_t)0);
 
       break;
     }
   }
 
   // perform swizzling
-  v.value.uv[0] = s.value.uv[oper.comps[0] == 0xff ? 0 : oper.comps[0]];
-  v.value.uv[1] = s.value.uv[oper.comps[1] == 0xff ? 1 : oper.comps[1]];
-  v.value.uv[2] = s.value.uv[oper.comps[2] == 0xff ? 2 : oper.comps[2]];
-  v.value.uv[3] = s.value.uv[oper.comps[3] == 0xff ? 3 : oper.comps[3]];
+  uint32_t src[4];
+  memcpy(src, v.value.uv, sizeof(src));
 
-  if(oper.comps[0] != 0xff && oper.comps[1] == 0xff && oper.comps[2] == 0xff && oper.comps[3] == 0xff)
-    v.columns = 1;
-  else
-    v.columns = 4;
+  v.value.uv[0] = src[dec.swizzle[0]];
+  v.value.uv[1] = src[dec.swizzle[1]];
+  v.value.uv[2] = src[dec.swizzle[2]];
+  v.value.uv[3] = src[dec.swizzle[3]];
+
+  v.columns = dec.scalar ? 1 : 4;
 
-  if(oper.modifier == OPERAND_MODIFIER_ABS || oper.modifier == OPERAND_MODIFIER_ABSNEG)
+  if(dec.abs)
   {
-    v = abs(v, OperationType(op.operation));
+    v = abs(v, op.type);
   }
 
-  if(oper.modifier == OPERAND_MODIFIER_NEG || oper.modifier == OPERAND_MODIFIER_ABSNEG)
+  if(dec.neg)
   {
-    v = neg(v, OperationType(op.operation));
+    v = neg(v, op.type);
   }
 
-  if(OperationFlushing(op.operation) && flushable)
+  if(op.flushing && flushable)
   {
     for(int i = 0; i < 4; i++)
       v.value.fv[i] = flush_denorm(v.value.fv[i]);
@@ -1759,35 +2388,61 @@ static uint32_t PopCount(uint32_t x)
 State State::GetNext(GlobalState &global, DebugAPIWrapper *apiWrapper, State quad[4]) const
 {
   State s = *this;
+  s.StepNext(global, apiWrapper, quad);
+  return s;
+}
+
+void State::StepNext(GlobalState &global, DebugAPIWrapper *apiWrapper, State quad[4])
+{
+  // the sources are all read before anything is written, so the state can be updated in place
+  State &s = *this;
 
   s.modified.clear();
 
   if(s.nextInstruction >= s.program->GetNumInstructions())
-    return s;
+    return;
 
-  const Operation &op = s.program->GetInstruction((size_t)s.nextInstruction);
+  const DecodedOperation &dop = decoded->GetOperation((size_t)s.nextInstruction);
+  const Operation &op = *dop.operation;
 
   apiWrapper->SetCurrentInstruction(s.nextInstruction);
   s.nextInstruction++;
   s.flags = ShaderEvents::NoEvent;
 
   std::vector<ShaderVariable> srcOpers;
+  srcOpers.reserve(dop.operands.size());
 
-  VarType optype = OperationType(op.operation);
+  VarType optype = dop.type;
 
-  for(size_t i = 1; i < op.operands.size(); i++)
-    srcOpers.push_back(GetSrc(op.operands[i], op));
+  for(size_t i = 1; i < dop.operands.size(); i++)
+    srcOpers.push_back(GetSrc(dop.operands[i], dop));
+
+  // plain ALU operations share their implementation with the batched lanes in LaneGroup
+  if(LaneGroup::IsVectorisable(op))
+  {
+    LaneGroup::LaneData src[3] = {}, dst;
+
+    for(size_t i = 0; i < srcOpers.size(); i++)
+      for(int c = 0; c < 4; c++)
+        src[i].u[c][0] = srcOpers[i].value.uv[c];
+
+    VarType type = LaneGroup::Execute(dop, src, srcOpers[0].columns, 1, dst);
+
+    ShaderVariable result("", dst.u[0][0], dst.u[1][0], dst.u[2][0], dst.u[3][0]);
+    result.type = op.operation == OPCODE_MOV ? srcOpers[0].type : type;
+    result.columns = KeepsSourceColumns(op.operation) ? srcOpers[0].columns : 4;
+
+    s.SetDst(dop.operands[0], dop, result);
+    return;
+  }
 
   switch(op.operation)
   {
       /////////////////////////////////////////////////////////////////////////////////////////////////////
       // Math operations
 
-    case OPCODE_DADD:
-    case OPCODE_IADD:
-    case OPCODE_ADD: s.SetDst(op.operands[0], op, add(srcOpers[0], srcOpers[1], optype)); break;
-    case OPCODE_DDIV:
-    case OPCODE_DIV: s.SetDst(op.operands[0], op, div(srcOpers[0], srcOpers[1], optype)); break;
+    case OPCODE_DADD: s.SetDst(dop.operands[0], dop, add(srcOpers[0], srcOpers[1], optype)); break;
+    case OPCODE_DDIV: s.SetDst(dop.operands[0], dop, div(srcOpers[0], srcOpers[1], optype)); break;
     case OPCODE_UDIV:
     {
       ShaderVariable quot("", (uint32_t)0xffffffff, (uint32_t)0xffffffff, (uint32_t)0xffffffff,
@@ -1806,11 +2461,11 @@ State State::GetNext(GlobalState &global, DebugAPIWrapper *apiWrapper, State qua
 
       if(op.operands[0].type != TYPE_NULL)
       {
-        s.SetDst(op.operands[0], op, quot);
+        s.SetDst(dop.operands[0], dop, quot);
       }
       if(op.operands[1].type != TYPE_NULL)
       {
-        s.SetDst(op.operands[1], op, rem);
+        s.SetDst(dop.operands[1], dop, rem);
       }
       break;
     }
@@ -1823,7 +2478,7 @@ State State::GetNext(GlobalState &global, DebugAPIWrapper *apiWrapper, State qua
         ret.value.uv[i] = BitwiseReverseLSB16(srcOpers[0].value.uv[i]);
       }
 
-      s.SetDst(op.operands[0], op, ret);
+      s.SetDst(dop.operands[0], dop, ret);
 
       break;
     }
@@ -1836,7 +2491,7 @@ State State::GetNext(GlobalState &global, DebugAPIWrapper *apiWrapper, State qua
         ret.value.uv[i] = PopCount(srcOpers[0].value.uv[i]);
       }
 
-      s.SetDst(op.operands[0], op, ret);
+      s.SetDst(dop.operands[0], dop, ret);
       break;
     }
     case OPCODE_FIRSTBIT_HI:
@@ -1845,20 +2500,14 @@ State State::GetNext(GlobalState &global, DebugAPIWrapper *apiWrapper, State qua
 
       for(size_t i = 0; i < 4; i++)
       {
-        unsigned char found = BitScanReverse((DWORD *)&ret.value.uv[i], srcOpers[0].value.uv[i]);
-        if(found == 0)
-        {
+        // firstbit_hi counts index 0 as the MSB, which is the number of leading zeroes
+        if(srcOpers[0].value.uv[i] == 0)
           ret.value.uv[i] = ~0U;
-        }
         else
-        {
-          // firstbit_hi counts index 0 as the MSB, BitScanReverse counts index 0 as the LSB. So we
-          // need to invert
-          ret.value.uv[i] = 31 - ret.value.uv[i];
-        }
+          ret.value.uv[i] = Bits::CountLeadingZeroes(srcOpers[0].value.uv[i]);
       }
 
-      s.SetDst(op.operands[0], op, ret);
+      s.SetDst(dop.operands[0], dop, ret);
       break;
     }
     case OPCODE_FIRSTBIT_LO:
@@ -1867,12 +2516,13 @@ State State::GetNext(GlobalState &global, DebugAPIWrapper *apiWrapper, State qua
 
       for(size_t i = 0; i < 4; i++)
       {
-        unsigned char found = BitScanForward((DWORD *)&ret.value.uv[i], srcOpers[0].value.uv[i]);
-        if(found == 0)
+        if(srcOpers[0].value.uv[i] == 0)
           ret.value.uv[i] = ~0U;
+        else
+          ret.value.uv[i] = Bits::CountTrailingZeroes(srcOpers[0].value.uv[i]);
       }
 
-      s.SetDst(op.operands[0], op, ret);
+      s.SetDst(dop.operands[0], dop, ret);
       break;
     }
     case OPCODE_FIRSTBIT_SHI:
@@ -1885,21 +2535,14 @@ State State::GetNext(GlobalState &global, DebugAPIWrapper *apiWrapper, State qua
         if(srcOpers[0].value.iv[i] < 0)
           u = ~u;
 
-        unsigned char found = BitScanReverse((DWORD *)&ret.value.uv[i], u);
-
-        if(found == 0)
-        {
+        // firstbit_shi counts index 0 as the MSB, which is the number of leading zeroes
+        if(u == 0)
           ret.value.uv[i] = ~0U;
-        }
         else
-        {
-          // firstbit_shi counts index 0 as the MSB, BitScanReverse counts index 0 as the LSB. So we
-          // need to invert
-          ret.value.uv[i] = 31 - ret.value.uv[i];
-        }
+          ret.value.uv[i] = Bits::CountLeadingZeroes(u);
       }
 
-      s.SetDst(op.operands[0], op, ret);
+      s.SetDst(dop.operands[0], dop, ret);
       break;
     }
     case OPCODE_IMUL:
@@ -1928,16 +2571,15 @@ State State::GetNext(GlobalState &global, DebugAPIWrapper *apiWrapper, State qua
 
       if(op.operands[0].type != TYPE_NULL)
       {
-        s.SetDst(op.operands[0], op, hi);
+        s.SetDst(dop.operands[0], dop, hi);
       }
       if(op.operands[1].type != TYPE_NULL)
       {
-        s.SetDst(op.operands[1], op, lo);
+        s.SetDst(dop.operands[1], dop, lo);
       }
       break;
     }
-    case OPCODE_DMUL:
-    case OPCODE_MUL: s.SetDst(op.operands[0], op, mul(srcOpers[0], srcOpers[1], optype)); break;
+    case OPCODE_DMUL: s.SetDst(dop.operands[0], dop, mul(srcOpers[0], srcOpers[1], optype)); break;
     case OPCODE_UADDC:
     {
       uint64_t src[4];
@@ -1952,11 +2594,11 @@ State State::GetNext(GlobalState &global, DebugAPIWrapper *apiWrapper, State qua
       for(int i = 0; i < 4; i++)
         dst[i] = (uint32_t)(src[i] & 0xffffffff);
 
-      s.SetDst(op.operands[0], op, ShaderVariable("", dst[0], dst[1], dst[2], dst[3]));
+      s.SetDst(dop.operands[0], dop, ShaderVariable("", dst[0], dst[1], dst[2], dst[3]));
 
       // if not null, set the carry bits
       if(op.operands[1].type != TYPE_NULL)
-        s.SetDst(op.operands[1], op,
+        s.SetDst(dop.operands[1], dop,
                  ShaderVariable("", src[0] > 0xffffffff ? 1U : 0U, src[1] > 0xffffffff ? 1U : 0U,
                                 src[2] > 0xffffffff ? 1U : 0U, src[3] > 0xffffffff ? 1U : 0U));
 
@@ -1982,43 +2624,24 @@ State State::GetNext(GlobalState &global, DebugAPIWrapper *apiWrapper, State qua
       for(int i = 0; i < 4; i++)
         dst[i] = (uint32_t)(result[0] & 0xffffffff);
 
-      s.SetDst(op.operands[0], op, ShaderVariable("", dst[0], dst[1], dst[2], dst[3]));
+      s.SetDst(dop.operands[0], dop, ShaderVariable("", dst[0], dst[1], dst[2], dst[3]));
 
       // if not null, mark where the borrow bits were used
       if(op.operands[1].type != TYPE_NULL)
         s.SetDst(
-            op.operands[1], op,
+            dop.operands[1], dop,
             ShaderVariable("", result[0] <= 0xffffffff ? 1U : 0U, result[1] <= 0xffffffff ? 1U : 0U,
                            result[2] <= 0xffffffff ? 1U : 0U, result[3] <= 0xffffffff ? 1U : 0U));
 
       break;
     }
-    case OPCODE_IMAD:
-    case OPCODE_UMAD:
-    case OPCODE_MAD:
     case OPCODE_DFMA:
-      s.SetDst(op.operands[0], op, add(mul(srcOpers[0], srcOpers[1], optype), srcOpers[2], optype));
+      s.SetDst(dop.operands[0], dop,
+               add(mul(srcOpers[0], srcOpers[1], optype), srcOpers[2], optype));
       break;
-    case OPCODE_DP2:
-    case OPCODE_DP3:
-    case OPCODE_DP4:
-    {
-      ShaderVariable dot = mul(srcOpers[0], srcOpers[1], optype);
-
-      float sum = dot.value.f.x;
-      if(op.operation >= OPCODE_DP2)
-        sum += dot.value.f.y;
-      if(op.operation >= OPCODE_DP3)
-        sum += dot.value.f.z;
-      if(op.operation >= OPCODE_DP4)
-        sum += dot.value.f.w;
-
-      s.SetDst(op.operands[0], op, ShaderVariable("", sum, sum, sum, sum));
-      break;
-    }
     case OPCODE_F16TOF32:
     {
-      s.SetDst(op.operands[0], op,
+      s.SetDst(dop.operands[0], dop,
                ShaderVariable("", flush_denorm(ConvertFromHalf(srcOpers[0].value.u.x & 0xffff)),
                               flush_denorm(ConvertFromHalf(srcOpers[0].value.u.y & 0xffff)),
                               flush_denorm(ConvertFromHalf(srcOpers[0].value.u.z & 0xffff)),
@@ -2027,78 +2650,13 @@ State State::GetNext(GlobalState &global, DebugAPIWrapper *apiWrapper, State qua
     }
     case OPCODE_F32TOF16:
     {
-      s.SetDst(op.operands[0], op,
+      s.SetDst(dop.operands[0], dop,
                ShaderVariable("", (uint32_t)ConvertToHalf(flush_denorm(srcOpers[0].value.f.x)),
                               (uint32_t)ConvertToHalf(flush_denorm(srcOpers[0].value.f.y)),
                               (uint32_t)ConvertToHalf(flush_denorm(srcOpers[0].value.f.z)),
                               (uint32_t)ConvertToHalf(flush_denorm(srcOpers[0].value.f.w))));
       break;
     }
-    case OPCODE_FRC:
-      s.SetDst(op.operands[0], op,
-               ShaderVariable("", srcOpers[0].value.f.x - floorf(srcOpers[0].value.f.x),
-                              srcOpers[0].value.f.y - floorf(srcOpers[0].value.f.y),
-                              srcOpers[0].value.f.z - floorf(srcOpers[0].value.f.z),
-                              srcOpers[0].value.f.w - floorf(srcOpers[0].value.f.w)));
-      break;
-    // positive infinity
-    case OPCODE_ROUND_PI:
-      s.SetDst(op.operands[0], op,
-               ShaderVariable("", ceilf(srcOpers[0].value.f.x), ceilf(srcOpers[0].value.f.y),
-                              ceilf(srcOpers[0].value.f.z), ceilf(srcOpers[0].value.f.w)));
-      break;
-    // negative infinity
-    case OPCODE_ROUND_NI:
-      s.SetDst(op.operands[0], op,
-               ShaderVariable("", floorf(srcOpers[0].value.f.x), floorf(srcOpers[0].value.f.y),
-                              floorf(srcOpers[0].value.f.z), floorf(srcOpers[0].value.f.w)));
-      break;
-    // towards zero
-    case OPCODE_ROUND_Z:
-    {
-      s.SetDst(op.operands[0], op,
-               ShaderVariable("",
-                              srcOpers[0].value.f.x < 0.f ? ceilf(srcOpers[0].value.f.x)
-                                                          : floorf(srcOpers[0].value.f.x),
-                              srcOpers[0].value.f.y < 0.f ? ceilf(srcOpers[0].value.f.y)
-                                                          : floorf(srcOpers[0].value.f.y),
-                              srcOpers[0].value.f.z < 0.f ? ceilf(srcOpers[0].value.f.z)
-                                                          : floorf(srcOpers[0].value.f.z),
-                              srcOpers[0].value.f.w < 0.f ? ceilf(srcOpers[0].value.f.w)
-                                                          : floorf(srcOpers[0].value.f.w)));
-    }
-      break;
-    // to nearest even int (banker's rounding)
-    case OPCODE_ROUND_NE:
-      s.SetDst(op.operands[0], op,
-               ShaderVariable("", round_ne(srcOpers[0].value.f.x), round_ne(srcOpers[0].value.f.y),
-                              round_ne(srcOpers[0].value.f.z), round_ne(srcOpers[0].value.f.w)));
-      break;
-    case OPCODE_INEG: s.SetDst(op.operands[0], op, neg(srcOpers[0], optype)); break;
-    case OPCODE_IMIN:
-      s.SetDst(op.operands[0], op,
-               ShaderVariable("",
-                              srcOpers[0].value.i.x < srcOpers[1].value.i.x ? srcOpers[0].value.i.x
-                                                                            : srcOpers[1].value.i.x,
-                              srcOpers[0].value.i.y < srcOpers[1].value.i.y ? srcOpers[0].value.i.y
-                                                                            : srcOpers[1].value.i.y,
-                              srcOpers[0].value.i.z < srcOpers[1].value.i.z ? srcOpers[0].value.i.z
-                                                                            : srcOpers[1].value.i.z,
-                              srcOpers[0].value.i.w < srcOpers[1].value.i.w ? srcOpers[0].value.i.w
-                                                                            : srcOpers[1].value.i.w));
-      break;
-    case OPCODE_UMIN:
-      s.SetDst(op.operands[0], op,
-               ShaderVariable("",
-                              srcOpers[0].value.u.x < srcOpers[1].value.u.x ? srcOpers[0].value.u.x
-                                                                            : srcOpers[1].value.u.x,
-                              srcOpers[0].value.u.y < srcOpers[1].value.u.y ? srcOpers[0].value.u.y
-                                                                            : srcOpers[1].value.u.y,
-                              srcOpers[0].value.u.z < srcOpers[1].value.u.z ? srcOpers[0].value.u.z
-                                                                            : srcOpers[1].value.u.z,
-                              srcOpers[0].value.u.w < srcOpers[1].value.u.w ? srcOpers[0].value.u.w
-                                                                            : srcOpers[1].value.u.w));
-      break;
     case OPCODE_DMIN:
     {
       double src0[2], src1[2];
@@ -2112,42 +2670,9 @@ State State::GetNext(GlobalState &global, DebugAPIWrapper *apiWrapper, State qua
       ShaderVariable r("", 0U, 0U, 0U, 0U);
       DoubleSet(r, dst);
 
-      s.SetDst(op.operands[0], op, r);
+      s.SetDst(dop.operands[0], dop, r);
       break;
     }
-    case OPCODE_MIN:
-      s.SetDst(op.operands[0], op,
-               ShaderVariable("", dxbc_min(srcOpers[0].value.f.x, srcOpers[1].value.f.x),
-                              dxbc_min(srcOpers[0].value.f.y, srcOpers[1].value.f.y),
-                              dxbc_min(srcOpers[0].value.f.z, srcOpers[1].value.f.z),
-                              dxbc_min(srcOpers[0].value.f.w, srcOpers[1].value.f.w)));
-      break;
-    case OPCODE_UMAX:
-      s.SetDst(
-          op.operands[0], op,
-          ShaderVariable("",
-                         srcOpers[0].value.u.x >= srcOpers[1].value.u.x ? srcOpers[0].value.u.x
-                                                                        : srcOpers[1].value.u.x,
-                         srcOpers[0].value.u.y >= srcOpers[1].value.u.y ? srcOpers[0].value.u.y
-                                                                        : srcOpers[1].value.u.y,
-                         srcOpers[0].value.u.z >= srcOpers[1].value.u.z ? srcOpers[0].value.u.z
-                                                                        : srcOpers[1].value.u.z,
-                         srcOpers[0].value.u.w >= srcOpers[1].value.u.w ? srcOpers[0].value.u.w
-                                                                        : srcOpers[1].value.u.w));
-      break;
-    case OPCODE_IMAX:
-      s.SetDst(
-          op.operands[0], op,
-          ShaderVariable("",
-                         srcOpers[0].value.i.x >= srcOpers[1].value.i.x ? srcOpers[0].value.i.x
-                                                                        : srcOpers[1].value.i.x,
-                         srcOpers[0].value.i.y >= srcOpers[1].value.i.y ? srcOpers[0].value.i.y
-                                                                        : srcOpers[1].value.i.y,
-                         srcOpers[0].value.i.z >= srcOpers[1].value.i.z ? srcOpers[0].value.i.z
-                                                                        : srcOpers[1].value.i.z,
-                         srcOpers[0].value.i.w >= srcOpers[1].value.i.w ? srcOpers[0].value.i.w
-                                                                        : srcOpers[1].value.i.w));
-      break;
     case OPCODE_DMAX:
     {
       double src0[2], src1[2];
@@ -2161,21 +2686,9 @@ State State::GetNext(GlobalState &global, DebugAPIWrapper *apiWrapper, State qua
       ShaderVariable r("", 0U, 0U, 0U, 0U);
       DoubleSet(r, dst);
 
-      s.SetDst(op.operands[0], op, r);
+      s.SetDst(dop.operands[0], dop, r);
       break;
     }
-    case OPCODE_MAX:
-      s.SetDst(op.operands[0], op,
-               ShaderVariable("", dxbc_max(srcOpers[0].value.f.x, srcOpers[1].value.f.x),
-                              dxbc_max(srcOpers[0].value.f.y, srcOpers[1].value.f.y),
-                              dxbc_max(srcOpers[0].value.f.z, srcOpers[1].value.f.z),
-                              dxbc_max(srcOpers[0].value.f.w, srcOpers[1].value.f.w)));
-      break;
-    case OPCODE_SQRT:
-      s.SetDst(op.operands[0], op,
-               ShaderVariable("", sqrtf(srcOpers[0].value.f.x), sqrtf(srcOpers[0].value.f.y),
-                              sqrtf(srcOpers[0].value.f.z), sqrtf(srcOpers[0].value.f.w)));
-      break;
     case OPCODE_DRCP:
     {
       double ds[2] = {0.0, 0.0};
@@ -2186,7 +2699,7 @@ State State::GetNext(GlobalState &global, DebugAPIWrapper *apiWrapper, State qua
       ShaderVariable r("", 0U, 0U, 0U, 0U);
       DoubleSet(r, ds);
 
-      s.SetDst(op.operands[0], op, r);
+      s.SetDst(dop.operands[0], dop, r);
       break;
     }
 
@@ -2220,7 +2733,7 @@ State State::GetNext(GlobalState &global, DebugAPIWrapper *apiWrapper, State qua
         }
       }
 
-      s.SetDst(op.operands[0], op, dest);
+      s.SetDst(dop.operands[0], dop, dest);
       break;
     }
     case OPCODE_UBFE:
@@ -2253,7 +2766,7 @@ State State::GetNext(GlobalState &global, DebugAPIWrapper *apiWrapper, State qua
         }
       }
 
-      s.SetDst(op.operands[0], op, dest);
+      s.SetDst(dop.operands[0], dop, dest);
       break;
     }
     case OPCODE_BFI:
@@ -2263,111 +2776,22 @@ State State::GetNext(GlobalState &global, DebugAPIWrapper *apiWrapper, State qua
           "", (uint32_t)(srcOpers[0].value.u.x & 0x1f), (uint32_t)(srcOpers[0].value.u.y & 0x1f),
           (uint32_t)(srcOpers[0].value.u.z & 0x1f), (uint32_t)(srcOpers[0].value.u.w & 0x1f));
       ShaderVariable offset(
-          "", (uint32_t)(srcOpers[1].value.u.x & 0x1f), (uint32_t)(srcOpers[1].value.u.y & 0x1f),
-          (uint32_t)(srcOpers[1].value.u.z & 0x1f), (uint32_t)(srcOpers[1].value.u.w & 0x1f));
-
-      ShaderVariable dest("", (uint32_t)0, (uint32_t)0, (uint32_t)0, (uint32_t)0);
-
-      for(int comp = 0; comp < 4; comp++)
-      {
-        uint32_t bitmask = (((1 << width.value.uv[comp]) - 1) << offset.value.uv[comp]) & 0xffffffff;
-        dest.value.uv[comp] =
-            (uint32_t)(((srcOpers[2].value.uv[comp] << offset.value.uv[comp]) & bitmask) |
-                       (srcOpers[3].value.uv[comp] & ~bitmask));
-      }
-
-      s.SetDst(op.operands[0], op, dest);
-      break;
-    }
-    case OPCODE_ISHL:
-    {
-      uint32_t shifts[] = {
-          srcOpers[1].value.u.x & 0x1f,
-          srcOpers[1].value.u.y & 0x1f,
-          srcOpers[1].value.u.z & 0x1f,
-          srcOpers[1].value.u.w & 0x1f,
-      };
-
-      // if we were only given a single component, it's the form that shifts all components
-      // by the same amount
-      if(op.operands[2].numComponents == NUMCOMPS_1 ||
-         (op.operands[2].comps[2] < 4 && op.operands[2].comps[2] == 0xff))
-        shifts[3] = shifts[2] = shifts[1] = shifts[0];
-
-      s.SetDst(
-          op.operands[0], op,
-          ShaderVariable("", srcOpers[0].value.i.x << shifts[0], srcOpers[0].value.i.y << shifts[1],
-                         srcOpers[0].value.i.z << shifts[2], srcOpers[0].value.i.w << shifts[3]));
-      break;
-    }
-    case OPCODE_USHR:
-    {
-      uint32_t shifts[] = {
-          srcOpers[1].value.u.x & 0x1f,
-          srcOpers[1].value.u.y & 0x1f,
-          srcOpers[1].value.u.z & 0x1f,
-          srcOpers[1].value.u.w & 0x1f,
-      };
-
-      // if we were only given a single component, it's the form that shifts all components
-      // by the same amount
-      if(op.operands[2].numComponents == NUMCOMPS_1 ||
-         (op.operands[2].comps[2] < 4 && op.operands[2].comps[2] == 0xff))
-        shifts[3] = shifts[2] = shifts[1] = shifts[0];
-
-      s.SetDst(
-          op.operands[0], op,
-          ShaderVariable("", srcOpers[0].value.u.x >> shifts[0], srcOpers[0].value.u.y >> shifts[1],
-                         srcOpers[0].value.u.z >> shifts[2], srcOpers[0].value.u.w >> shifts[3]));
-      break;
-    }
-    case OPCODE_ISHR:
-    {
-      uint32_t shifts[] = {
-          srcOpers[1].value.u.x & 0x1f,
-          srcOpers[1].value.u.y & 0x1f,
-          srcOpers[1].value.u.z & 0x1f,
-          srcOpers[1].value.u.w & 0x1f,
-      };
+          "", (uint32_t)(srcOpers[1].value.u.x & 0x1f), (uint32_t)(srcOpers[1].value.u.y & 0x1f),
+          (uint32_t)(srcOpers[1].value.u.z & 0x1f), (uint32_t)(srcOpers[1].value.u.w & 0x1f));
 
-      // if we were only given a single component, it's the form that shifts all components
-      // by the same amount
-      if(op.operands[2].numComponents == NUMCOMPS_1 ||
-         (op.operands[2].comps[2] < 4 && op.operands[2].comps[2] == 0xff))
-        shifts[3] = shifts[2] = shifts[1] = shifts[0];
+      ShaderVariable dest("", (uint32_t)0, (uint32_t)0, (uint32_t)0, (uint32_t)0);
 
-      s.SetDst(
-          op.operands[0], op,
-          ShaderVariable("", srcOpers[0].value.i.x >> shifts[0], srcOpers[0].value.i.y >> shifts[1],
-                         srcOpers[0].value.i.z >> shifts[2], srcOpers[0].value.i.w >> shifts[3]));
+      for(int comp = 0; comp < 4; comp++)
+      {
+        uint32_t bitmask = (((1 << width.value.uv[comp]) - 1) << offset.value.uv[comp]) & 0xffffffff;
+        dest.value.uv[comp] =
+            (uint32_t)(((srcOpers[2].value.uv[comp] << offset.value.uv[comp]) & bitmask) |
+                       (srcOpers[3].value.uv[comp] & ~bitmask));
+      }
+
+      s.SetDst(dop.operands[0], dop, dest);
       break;
     }
-    case OPCODE_AND:
-      s.SetDst(op.operands[0], op,
-               ShaderVariable("", srcOpers[0].value.i.x & srcOpers[1].value.i.x,
-                              srcOpers[0].value.i.y & srcOpers[1].value.i.y,
-                              srcOpers[0].value.i.z & srcOpers[1].value.i.z,
-                              srcOpers[0].value.i.w & srcOpers[1].value.i.w));
-      break;
-    case OPCODE_OR:
-      s.SetDst(op.operands[0], op,
-               ShaderVariable("", srcOpers[0].value.i.x | srcOpers[1].value.i.x,
-                              srcOpers[0].value.i.y | srcOpers[1].value.i.y,
-                              srcOpers[0].value.i.z | srcOpers[1].value.i.z,
-                              srcOpers[0].value.i.w | srcOpers[1].value.i.w));
-      break;
-    case OPCODE_XOR:
-      s.SetDst(op.operands[0], op,
-               ShaderVariable("", srcOpers[0].value.u.x ^ srcOpers[1].value.u.x,
-                              srcOpers[0].value.u.y ^ srcOpers[1].value.u.y,
-                              srcOpers[0].value.u.z ^ srcOpers[1].value.u.z,
-                              srcOpers[0].value.u.w ^ srcOpers[1].value.u.w));
-      break;
-    case OPCODE_NOT:
-      s.SetDst(op.operands[0], op,
-               ShaderVariable("", ~srcOpers[0].value.u.x, ~srcOpers[0].value.u.y,
-                              ~srcOpers[0].value.u.z, ~srcOpers[0].value.u.w));
-      break;
 
       /////////////////////////////////////////////////////////////////////////////////////////////////////
       // transcendental functions with loose ULP requirements, so we pass them to the GPU to get
@@ -2382,11 +2806,11 @@ State State::GetNext(GlobalState &global, DebugAPIWrapper *apiWrapper, State qua
       ShaderVariable calcResultB("calcB", 0.0f, 0.0f, 0.0f, 0.0f);
       if(apiWrapper->CalculateMathIntrinsic(op.operation, srcOpers[0], calcResultA, calcResultB))
       {
-        s.SetDst(op.operands[0], op, calcResultA);
+        s.SetDst(dop.operands[0], dop, calcResultA);
       }
       else
       {
-        return s;
+        return;
       }
       break;
     }
@@ -2397,13 +2821,13 @@ State State::GetNext(GlobalState &global, DebugAPIWrapper *apiWrapper, State qua
       if(apiWrapper->CalculateMathIntrinsic(OPCODE_SINCOS, srcOpers[1], calcResultA, calcResultB))
       {
         if(op.operands[0].type != TYPE_NULL)
-          s.SetDst(op.operands[0], op, calcResultA);
+          s.SetDst(dop.operands[0], dop, calcResultA);
         if(op.operands[1].type != TYPE_NULL)
-          s.SetDst(op.operands[1], op, calcResultB);
+          s.SetDst(dop.operands[1], dop, calcResultB);
       }
       else
       {
-        return s;
+        return;
       }
       break;
     }
@@ -2415,56 +2839,37 @@ State State::GetNext(GlobalState &global, DebugAPIWrapper *apiWrapper, State qua
     case OPCODE_CUSTOMDATA:
     case OPCODE_SYNC:    // might never need to implement this. Who knows!
       break;
-    case OPCODE_DMOV:
-    case OPCODE_MOV: s.SetDst(op.operands[0], op, srcOpers[0]); break;
+    case OPCODE_DMOV: s.SetDst(dop.operands[0], dop, srcOpers[0]); break;
     case OPCODE_DMOVC:
       s.SetDst(
-          op.operands[0], op,
+          dop.operands[0], dop,
           ShaderVariable("", srcOpers[0].value.u.x ? srcOpers[1].value.u.x : srcOpers[2].value.u.x,
                          srcOpers[0].value.u.x ? srcOpers[1].value.u.y : srcOpers[2].value.u.y,
                          srcOpers[0].value.u.y ? srcOpers[1].value.u.z : srcOpers[2].value.u.z,
                          srcOpers[0].value.u.y ? srcOpers[1].value.u.w : srcOpers[2].value.u.w));
       break;
-    case OPCODE_MOVC:
-      s.SetDst(
-          op.operands[0], op,
-          ShaderVariable("", srcOpers[0].value.i.x ? srcOpers[1].value.i.x : srcOpers[2].value.i.x,
-                         srcOpers[0].value.i.y ? srcOpers[1].value.i.y : srcOpers[2].value.i.y,
-                         srcOpers[0].value.i.z ? srcOpers[1].value.i.z : srcOpers[2].value.i.z,
-                         srcOpers[0].value.i.w ? srcOpers[1].value.i.w : srcOpers[2].value.i.w));
-      break;
     case OPCODE_SWAPC:
       s.SetDst(
-          op.operands[0], op,
+          dop.operands[0], dop,
           ShaderVariable("", srcOpers[1].value.i.x ? srcOpers[3].value.i.x : srcOpers[2].value.i.x,
                          srcOpers[1].value.i.y ? srcOpers[3].value.i.y : srcOpers[2].value.i.y,
                          srcOpers[1].value.i.z ? srcOpers[3].value.i.z : srcOpers[2].value.i.z,
                          srcOpers[1].value.i.w ? srcOpers[3].value.i.w : srcOpers[2].value.i.w));
 
       s.SetDst(
-          op.operands[1], op,
+          dop.operands[1], dop,
           ShaderVariable("", srcOpers[1].value.i.x ? srcOpers[2].value.i.x : srcOpers[3].value.i.x,
                          srcOpers[1].value.i.y ? srcOpers[2].value.i.y : srcOpers[3].value.i.y,
                          srcOpers[1].value.i.z ? srcOpers[2].value.i.z : srcOpers[3].value.i.z,
                          srcOpers[1].value.i.w ? srcOpers[2].value.i.w : srcOpers[3].value.i.w));
       break;
-    case OPCODE_ITOF:
-      s.SetDst(op.operands[0], op,
-               ShaderVariable("", (float)srcOpers[0].value.i.x, (float)srcOpers[0].value.i.y,
-                              (float)srcOpers[0].value.i.z, (float)srcOpers[0].value.i.w));
-      break;
-    case OPCODE_UTOF:
-      s.SetDst(op.operands[0], op,
-               ShaderVariable("", (float)srcOpers[0].value.u.x, (float)srcOpers[0].value.u.y,
-                              (float)srcOpers[0].value.u.z, (float)srcOpers[0].value.u.w));
-      break;
     case OPCODE_FTOI:
-      s.SetDst(op.operands[0], op,
+      s.SetDst(dop.operands[0], dop,
                ShaderVariable("", (int)srcOpers[0].value.f.x, (int)srcOpers[0].value.f.y,
                               (int)srcOpers[0].value.f.z, (int)srcOpers[0].value.f.w));
       break;
     case OPCODE_FTOU:
-      s.SetDst(op.operands[0], op,
+      s.SetDst(dop.operands[0], dop,
                ShaderVariable("", (uint32_t)srcOpers[0].value.f.x, (uint32_t)srcOpers[0].value.f.y,
                               (uint32_t)srcOpers[0].value.f.z, (uint32_t)srcOpers[0].value.f.w));
       break;
@@ -2499,7 +2904,7 @@ State State::GetNext(GlobalState &global, DebugAPIWrapper *apiWrapper, State qua
       ShaderVariable r("", 0U, 0U, 0U, 0U);
       DoubleSet(r, res);
 
-      s.SetDst(op.operands[0], op, r);
+      s.SetDst(dop.operands[0], dop, r);
       break;
     }
     case OPCODE_DTOI:
@@ -2552,41 +2957,13 @@ State State::GetNext(GlobalState &global, DebugAPIWrapper *apiWrapper, State qua
         }
       }
 
-      s.SetDst(op.operands[0], op, r);
+      s.SetDst(dop.operands[0], dop, r);
       break;
     }
 
       /////////////////////////////////////////////////////////////////////////////////////////////////////
       // Comparison
 
-    case OPCODE_EQ:
-      s.SetDst(op.operands[0], op,
-               ShaderVariable("", (srcOpers[0].value.f.x == srcOpers[1].value.f.x ? ~0l : 0l),
-                              (srcOpers[0].value.f.y == srcOpers[1].value.f.y ? ~0l : 0l),
-                              (srcOpers[0].value.f.z == srcOpers[1].value.f.z ? ~0l : 0l),
-                              (srcOpers[0].value.f.w == srcOpers[1].value.f.w ? ~0l : 0l)));
-      break;
-    case OPCODE_NE:
-      s.SetDst(op.operands[0], op,
-               ShaderVariable("", (srcOpers[0].value.f.x != srcOpers[1].value.f.x ? ~0l : 0l),
-                              (srcOpers[0].value.f.y != srcOpers[1].value.f.y ? ~0l : 0l),
-                              (srcOpers[0].value.f.z != srcOpers[1].value.f.z ? ~0l : 0l),
-                              (srcOpers[0].value.f.w != srcOpers[1].value.f.w ? ~0l : 0l)));
-      break;
-    case OPCODE_LT:
-      s.SetDst(op.operands[0], op,
-               ShaderVariable("", (srcOpers[0].value.f.x < srcOpers[1].value.f.x ? ~0l : 0l),
-                              (srcOpers[0].value.f.y < srcOpers[1].value.f.y ? ~0l : 0l),
-                              (srcOpers[0].value.f.z < srcOpers[1].value.f.z ? ~0l : 0l),
-                              (srcOpers[0].value.f.w < srcOpers[1].value.f.w ? ~0l : 0l)));
-      break;
-    case OPCODE_GE:
-      s.SetDst(op.operands[0], op,
-               ShaderVariable("", (srcOpers[0].value.f.x >= srcOpers[1].value.f.x ? ~0l : 0l),
-                              (srcOpers[0].value.f.y >= srcOpers[1].value.f.y ? ~0l : 0l),
-                              (srcOpers[0].value.f.z >= srcOpers[1].value.f.z ? ~0l : 0l),
-                              (srcOpers[0].value.f.w >= srcOpers[1].value.f.w ? ~0l : 0l)));
-      break;
     case OPCODE_DEQ:
     case OPCODE_DNE:
     case OPCODE_DGE:
@@ -2602,21 +2979,22 @@ State State::GetNext(GlobalState &global, DebugAPIWrapper *apiWrapper, State qua
       switch(op.operation)
       {
         case OPCODE_DEQ:
-          cmp1 = (src0[0] == src1[0] ? ~0l : 0l);
-          cmp2 = (src0[1] == src1[1] ? ~0l : 0l);
+          cmp1 = (src0[0] == src1[0] ? ~0U : 0U);
+          cmp2 = (src0[1] == src1[1] ? ~0U : 0U);
           break;
         case OPCODE_DNE:
-          cmp1 = (src0[0] != src1[0] ? ~0l : 0l);
-          cmp2 = (src0[1] != src1[1] ? ~0l : 0l);
+          cmp1 = (src0[0] != src1[0] ? ~0U : 0U);
+          cmp2 = (src0[1] != src1[1] ? ~0U : 0U);
           break;
         case OPCODE_DGE:
-          cmp1 = (src0[0] >= src1[0] ? ~0l : 0l);
-          cmp2 = (src0[1] >= src1[1] ? ~0l : 0l);
+          cmp1 = (src0[0] >= src1[0] ? ~0U : 0U);
+          cmp2 = (src0[1] >= src1[1] ? ~0U : 0U);
           break;
         case OPCODE_DLT:
-          cmp1 = (src0[0] < src1[0] ? ~0l : 0l);
-          cmp2 = (src0[1] < src1[1] ? ~0l : 0l);
+          cmp1 = (src0[0] < src1[0] ? ~0U : 0U);
+          cmp2 = (src0[1] < src1[1] ? ~0U : 0U);
           break;
+        default: break;
       }
 
       // special behaviour for dest mask. if it's .xz then first comparison goes into .x, second
@@ -2636,51 +3014,9 @@ State State::GetNext(GlobalState &global, DebugAPIWrapper *apiWrapper, State qua
         r.value.uv[op.operands[0].comps[1]] = cmp2;
       }
 
-      s.SetDst(op.operands[0], op, r);
+      s.SetDst(dop.operands[0], dop, r);
       break;
     }
-    case OPCODE_IEQ:
-      s.SetDst(op.operands[0], op,
-               ShaderVariable("", (srcOpers[0].value.i.x == srcOpers[1].value.i.x ? ~0l : 0l),
-                              (srcOpers[0].value.i.y == srcOpers[1].value.i.y ? ~0l : 0l),
-                              (srcOpers[0].value.i.z == srcOpers[1].value.i.z ? ~0l : 0l),
-                              (srcOpers[0].value.i.w == srcOpers[1].value.i.w ? ~0l : 0l)));
-      break;
-    case OPCODE_INE:
-      s.SetDst(op.operands[0], op,
-               ShaderVariable("", (srcOpers[0].value.i.x != srcOpers[1].value.i.x ? ~0l : 0l),
-                              (srcOpers[0].value.i.y != srcOpers[1].value.i.y ? ~0l : 0l),
-                              (srcOpers[0].value.i.z != srcOpers[1].value.i.z ? ~0l : 0l),
-                              (srcOpers[0].value.i.w != srcOpers[1].value.i.w ? ~0l : 0l)));
-      break;
-    case OPCODE_IGE:
-      s.SetDst(op.operands[0], op,
-               ShaderVariable("", (srcOpers[0].value.i.x >= srcOpers[1].value.i.x ? ~0l : 0l),
-                              (srcOpers[0].value.i.y >= srcOpers[1].value.i.y ? ~0l : 0l),
-                              (srcOpers[0].value.i.z >= srcOpers[1].value.i.z ? ~0l : 0l),
-                              (srcOpers[0].value.i.w >= srcOpers[1].value.i.w ? ~0l : 0l)));
-      break;
-    case OPCODE_ILT:
-      s.SetDst(op.operands[0], op,
-               ShaderVariable("", (srcOpers[0].value.i.x < srcOpers[1].value.i.x ? ~0l : 0l),
-                              (srcOpers[0].value.i.y < srcOpers[1].value.i.y ? ~0l : 0l),
-                              (srcOpers[0].value.i.z < srcOpers[1].value.i.z ? ~0l : 0l),
-                              (srcOpers[0].value.i.w < srcOpers[1].value.i.w ? ~0l : 0l)));
-      break;
-    case OPCODE_ULT:
-      s.SetDst(op.operands[0], op,
-               ShaderVariable("", (srcOpers[0].value.u.x < srcOpers[1].value.u.x ? ~0l : 0l),
-                              (srcOpers[0].value.u.y < srcOpers[1].value.u.y ? ~0l : 0l),
-                              (srcOpers[0].value.u.z < srcOpers[1].value.u.z ? ~0l : 0l),
-                              (srcOpers[0].value.u.w < srcOpers[1].value.u.w ? ~0l : 0l)));
-      break;
-    case OPCODE_UGE:
-      s.SetDst(op.operands[0], op,
-               ShaderVariable("", (srcOpers[0].value.u.x >= srcOpers[1].value.u.x ? ~0l : 0l),
-                              (srcOpers[0].value.u.y >= srcOpers[1].value.u.y ? ~0l : 0l),
-                              (srcOpers[0].value.u.z >= srcOpers[1].value.u.z ? ~0l : 0l),
-                              (srcOpers[0].value.u.w >= srcOpers[1].value.u.w ? ~0l : 0l)));
-      break;
 
       /////////////////////////////////////////////////////////////////////////////////////////////////////
       // Atomic instructions
@@ -2688,14 +3024,14 @@ State State::GetNext(GlobalState &global, DebugAPIWrapper *apiWrapper, State qua
     case OPCODE_IMM_ATOMIC_ALLOC:
     {
       uint32_t count = global.uavs[srcOpers[0].value.u.x].hiddenCounter++;
-      s.SetDst(op.operands[0], op, ShaderVariable("", count, count, count, count));
+      s.SetDst(dop.operands[0], dop, ShaderVariable("", count, count, count, count));
       break;
     }
 
     case OPCODE_IMM_ATOMIC_CONSUME:
     {
       uint32_t count = --global.uavs[srcOpers[0].value.u.x].hiddenCounter;
-      s.SetDst(op.operands[0], op, ShaderVariable("", count, count, count, count));
+      s.SetDst(dop.operands[0], dop, ShaderVariable("", count, count, count, count));
       break;
     }
 
@@ -2711,8 +3047,8 @@ State State::GetNext(GlobalState &global, DebugAPIWrapper *apiWrapper, State qua
             "Attempt to use derivative instruction not in pixel shader. Undefined results will "
             "occur!");
       else
-        s.SetDst(op.operands[0], op,
-                 s.DDX(op.operation == OPCODE_DERIV_RTX_FINE, quad, op.operands[1], op));
+        s.SetDst(dop.operands[0], dop,
+                 s.DDX(op.operation == OPCODE_DERIV_RTX_FINE, quad, dop.operands[1], dop));
       break;
     case OPCODE_DERIV_RTY:
     case OPCODE_DERIV_RTY_COARSE:
@@ -2722,8 +3058,8 @@ State State::GetNext(GlobalState &global, DebugAPIWrapper *apiWrapper, State qua
             "Attempt to use derivative instruction not in pixel shader. Undefined results will "
             "occur!");
       else
-        s.SetDst(op.operands[0], op,
-                 s.DDY(op.operation == OPCODE_DERIV_RTY_FINE, quad, op.operands[1], op));
+        s.SetDst(dop.operands[0], dop,
+                 s.DDY(op.operation == OPCODE_DERIV_RTY_FINE, quad, dop.operands[1], dop));
       break;
 
     /////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -2750,7 +3086,7 @@ State State::GetNext(GlobalState &global, DebugAPIWrapper *apiWrapper, State qua
     case OPCODE_IMM_ATOMIC_UMAX:
     case OPCODE_IMM_ATOMIC_UMIN:
     {
-      Operand beforeResult;
+      const DecodedOperand *beforeResult = NULL;
       uint32_t resIndex = 0;
       ShaderVariable *dstAddress = NULL;
       ShaderVariable *src0 = NULL;
@@ -2763,7 +3099,7 @@ State State::GetNext(GlobalState &global, DebugAPIWrapper *apiWrapper, State qua
          op.operation == OPCODE_IMM_ATOMIC_EXCH || op.operation == OPCODE_IMM_ATOMIC_CMP_EXCH ||
          op.operation == OPCODE_IMM_ATOMIC_UMAX || op.operation == OPCODE_IMM_ATOMIC_UMIN)
       {
-        beforeResult = op.operands[0];
+        beforeResult = &dop.operands[0];
         resIndex = (uint32_t)op.operands[1].indices[0].index;
         gsm = (op.operands[1].type == TYPE_THREAD_GROUP_SHARED_MEMORY);
         dstAddress = &srcOpers[1];
@@ -2773,7 +3109,6 @@ State State::GetNext(GlobalState &global, DebugAPIWrapper *apiWrapper, State qua
       }
       else
       {
-        beforeResult.type = TYPE_NULL;
         resIndex = (uint32_t)op.operands[0].indices[0].index;
         gsm = (op.operands[0].type == TYPE_THREAD_GROUP_SHARED_MEMORY);
         dstAddress = &srcOpers[0];
@@ -2861,9 +3196,9 @@ State State::GetNext(GlobalState &global, DebugAPIWrapper *apiWrapper, State qua
         uint32_t *udst = (uint32_t *)data;
         int32_t *idst = (int32_t *)data;
 
-        if(beforeResult.type != TYPE_NULL)
+        if(beforeResult)
         {
-          s.SetDst(beforeResult, op, ShaderVariable("", *udst, *udst, *udst, *udst));
+          s.SetDst(*beforeResult, dop, ShaderVariable("", *udst, *udst, *udst, *udst));
         }
 
         // not verified below since by definition the operations that expect usrc1 will have it
@@ -2896,6 +3231,7 @@ State State::GetNext(GlobalState &global, DebugAPIWrapper *apiWrapper, State qua
           case OPCODE_ATOMIC_UMAX: *udst = std::max(*udst, *usrc0); break;
           case OPCODE_IMM_ATOMIC_UMIN:
           case OPCODE_ATOMIC_UMIN: *udst = std::min(*udst, *usrc0); break;
+          default: break;
         }
       }
 
@@ -3086,7 +3422,7 @@ State State::GetNext(GlobalState &global, DebugAPIWrapper *apiWrapper, State qua
          (texData && texOffset >= global.uavs[resIndex].data.size()))
       {
         if(load)
-          s.SetDst(op.operands[0], op, ShaderVariable("", 0U, 0U, 0U, 0U));
+          s.SetDst(dop.operands[0], dop, ShaderVariable("", 0U, 0U, 0U, 0U));
       }
       else
       {
@@ -3157,7 +3493,7 @@ State State::GetNext(GlobalState &global, DebugAPIWrapper *apiWrapper, State qua
               fetch.value.uv[0] = fetch.value.uv[op.operands[0].comps[0]];
           }
 
-          s.SetDst(op.operands[0], op, fetch);
+          s.SetDst(dop.operands[0], dop, fetch);
         }
         else if(!Finished())    // helper/inactive pixels can't modify UAVs
         {
@@ -3225,7 +3561,7 @@ State State::GetNext(GlobalState &global, DebugAPIWrapper *apiWrapper, State qua
           if(op.operands[1].comps[i] < 4)
             var.value.uv[i] = it->second.value.uv[op.operands[1].comps[i]];
 
-        s.SetDst(op.operands[0], op, var);
+        s.SetDst(dop.operands[0], dop, var);
       }
       else
       {
@@ -3243,7 +3579,7 @@ State State::GetNext(GlobalState &global, DebugAPIWrapper *apiWrapper, State qua
                   s.nextInstruction - 1, op.str.c_str()));
         }
 
-        s.SetDst(op.operands[0], op, srcOpers[0]);
+        s.SetDst(dop.operands[0], dop, srcOpers[0]);
       }
 
       break;
@@ -3255,7 +3591,7 @@ State State::GetNext(GlobalState &global, DebugAPIWrapper *apiWrapper, State qua
       bool isAbsoluteResource =
           (op.operands[1].indices.size() == 1 && op.operands[1].indices[0].absolute &&
            !op.operands[1].indices[0].relative);
-      UINT slot = (UINT)(op.operands[1].indices[0].index & 0xffffffff);
+      uint32_t slot = (uint32_t)(op.operands[1].indices[0].index & 0xffffffff);
       ShaderVariable result =
           apiWrapper->GetSampleInfo(op.operands[1].type, isAbsoluteResource, slot, op.str.c_str());
 
@@ -3398,7 +3734,7 @@ State State::GetNext(GlobalState &global, DebugAPIWrapper *apiWrapper, State qua
          op.operands[0].comps[2] == 0xff && op.operands[0].comps[3] == 0xff)
         result.value.uv[0] = result.value.uv[op.operands[0].comps[0]];
 
-      s.SetDst(op.operands[0], op, result);
+      s.SetDst(dop.operands[0], dop, result);
 
       break;
     }
@@ -3408,7 +3744,7 @@ State State::GetNext(GlobalState &global, DebugAPIWrapper *apiWrapper, State qua
       if(op.operands[1].indices.size() == 1 && op.operands[1].indices[0].absolute &&
          !op.operands[1].indices[0].relative)
       {
-        UINT slot = (UINT)(op.operands[1].indices[0].index & 0xffffffff);
+        uint32_t slot = (uint32_t)(op.operands[1].indices[0].index & 0xffffffff);
         ShaderVariable result = apiWrapper->GetBufferInfo(op.operands[1].type, slot, op.str.c_str());
 
         // apply swizzle
@@ -3432,12 +3768,12 @@ State State::GetNext(GlobalState &global, DebugAPIWrapper *apiWrapper, State qua
            op.operands[0].comps[2] == 0xff && op.operands[0].comps[3] == 0xff)
           result.value.uv[0] = result.value.uv[op.operands[0].comps[0]];
 
-        s.SetDst(op.operands[0], op, result);
+        s.SetDst(dop.operands[0], dop, result);
       }
       else
       {
         RDCERR("Unexpected relative addressing");
-        s.SetDst(op.operands[0], op, ShaderVariable("", 0.0f, 0.0f, 0.0f, 0.0f));
+        s.SetDst(dop.operands[0], dop, ShaderVariable("", 0.0f, 0.0f, 0.0f, 0.0f));
       }
 
       break;
@@ -3452,7 +3788,7 @@ State State::GetNext(GlobalState &global, DebugAPIWrapper *apiWrapper, State qua
          !op.operands[2].indices[0].relative)
       {
         int dim = 0;
-        UINT slot = (UINT)(op.operands[2].indices[0].index & 0xffffffff);
+        uint32_t slot = (uint32_t)(op.operands[2].indices[0].index & 0xffffffff);
         ShaderVariable result = apiWrapper->GetResourceInfo(op.operands[2].type, slot, mipLevel, dim);
 
         // need a valid dimension even if the resource was unbound, so
@@ -3481,6 +3817,7 @@ State State::GetNext(GlobalState &global, DebugAPIWrapper *apiWrapper, State qua
                 case RESOURCE_DIMENSION_TEXTURECUBE:
                 case RESOURCE_DIMENSION_TEXTURECUBEARRAY: dim = 2; break;
                 case RESOURCE_DIMENSION_TEXTURE3D: dim = 3; break;
+                default: break;
               }
               break;
             }
@@ -3542,12 +3879,12 @@ State State::GetNext(GlobalState &global, DebugAPIWrapper *apiWrapper, State qua
            op.operands[0].comps[2] == 0xff && op.operands[0].comps[3] == 0xff)
           result.value.uv[0] = result.value.uv[op.operands[0].comps[0]];
 
-        s.SetDst(op.operands[0], op, result);
+        s.SetDst(dop.operands[0], dop, result);
       }
       else
       {
         RDCERR("Unexpected relative addressing");
-        s.SetDst(op.operands[0], op, ShaderVariable("", 0.0f, 0.0f, 0.0f, 0.0f));
+        s.SetDst(dop.operands[0], dop, ShaderVariable("", 0.0f, 0.0f, 0.0f, 0.0f));
       }
 
       break;
@@ -3626,9 +3963,9 @@ State State::GetNext(GlobalState &global, DebugAPIWrapper *apiWrapper, State qua
              op.operands[0].comps[2] == 0xff && op.operands[0].comps[3] == 0xff)
             fetch.value.uv[0] = fetch.value.uv[op.operands[0].comps[0]];
 
-          s.SetDst(op.operands[0], op, fetch);
+          s.SetDst(dop.operands[0], dop, fetch);
 
-          return s;
+          return;
         }
         if(decl.declaration == OPCODE_DCL_RESOURCE && decl.operand.type == TYPE_RESOURCE &&
            decl.operand.indices.size() == 1 && decl.operand.indices[0] == op.operands[2].indices[0])
@@ -3658,7 +3995,7 @@ State State::GetNext(GlobalState &global, DebugAPIWrapper *apiWrapper, State qua
       {
         ShaderVariable invalidResult("tex", 0.0f, 0.0f, 0.0f, 0.0f);
 
-        s.SetDst(op.operands[0], op, invalidResult);
+        s.SetDst(dop.operands[0], dop, invalidResult);
         break;
       }
 
@@ -3679,8 +4016,8 @@ State State::GetNext(GlobalState &global, DebugAPIWrapper *apiWrapper, State qua
         else
         {
           // texture samples use coarse derivatives
-          ddxCalc = s.DDX(false, quad, op.operands[1], op);
-          ddyCalc = s.DDY(false, quad, op.operands[1], op);
+          ddxCalc = s.DDX(false, quad, dop.operands[1], dop);
+          ddyCalc = s.DDY(false, quad, dop.operands[1], dop);
         }
       }
       else if(op.operation == OPCODE_SAMPLE_D)
@@ -3689,14 +4026,14 @@ State State::GetNext(GlobalState &global, DebugAPIWrapper *apiWrapper, State qua
         ddyCalc = srcOpers[4];
       }
 
-      UINT texSlot = (UINT)op.operands[2].indices[0].index;
-      UINT samplerSlot = 0;
+      uint32_t texSlot = (uint32_t)op.operands[2].indices[0].index;
+      uint32_t samplerSlot = 0;
 
       for(size_t i = 0; i < op.operands.size(); i++)
       {
         const Operand &operand = op.operands[i];
         if(operand.type == OperandType::TYPE_SAMPLER)
-          samplerSlot = (UINT)operand.indices[0].index;
+          samplerSlot = (uint32_t)operand.indices[0].index;
       }
 
       int multisampleIndex = srcOpers[2].value.i.x;
@@ -3724,7 +4061,7 @@ State State::GetNext(GlobalState &global, DebugAPIWrapper *apiWrapper, State qua
       float samplerBias = 0.0f;
       if(op.operation == OPCODE_SAMPLE_B)
       {
-        samplerSlot = (UINT)srcOpers[2].value.u.x;
+        samplerSlot = (uint32_t)srcOpers[2].value.u.x;
         samplerBias = srcOpers[3].value.f.x;
       }
 
@@ -3749,11 +4086,11 @@ State State::GetNext(GlobalState &global, DebugAPIWrapper *apiWrapper, State qua
         if(op.operands[0].comps[1] == 0xff)
           lookupResult.value.iv[0] = lookupResult.value.iv[op.operands[0].comps[0]];
 
-        s.SetDst(op.operands[0], op, lookupResult);
+        s.SetDst(dop.operands[0], dop, lookupResult);
       }
       else
       {
-        return s;
+        return;
       }
       break;
     }
@@ -3763,7 +4100,7 @@ State State::GetNext(GlobalState &global, DebugAPIWrapper *apiWrapper, State qua
 
     case OPCODE_SWITCH:
     {
-      uint32_t switchValue = GetSrc(op.operands[0], op).value.u.x;
+      uint32_t switchValue = GetSrc(dop.operands[0], dop).value.u.x;
 
       int depth = 0;
 
@@ -3798,7 +4135,8 @@ State State::GetNext(GlobalState &global, DebugAPIWrapper *apiWrapper, State qua
 
           if(nextOp.operation == OPCODE_CASE)
           {
-            uint32_t caseValue = GetSrc(nextOp.operands[0], nextOp).value.u.x;
+            const DecodedOperation &caseOp = decoded->GetOperation((size_t)search);
+            uint32_t caseValue = GetSrc(caseOp.operands[0], caseOp).value.u.x;
 
             // comparison is defined to be bitwise
             if(caseValue == switchValue)
@@ -3849,7 +4187,7 @@ State State::GetNext(GlobalState &global, DebugAPIWrapper *apiWrapper, State qua
     {
       int depth = 0;
 
-      int32_t test = op.operation == OPCODE_CONTINUEC ? GetSrc(op.operands[0], op).value.i.x : 0;
+      int32_t test = op.operation == OPCODE_CONTINUEC ? GetSrc(dop.operands[0], dop).value.i.x : 0;
 
       if(op.operation == OPCODE_CONTINUE || op.operation == OPCODE_CONTINUEC)
         depth = 1;
@@ -3881,14 +4219,14 @@ State State::GetNext(GlobalState &global, DebugAPIWrapper *apiWrapper, State qua
     case OPCODE_BREAK:
     case OPCODE_BREAKC:
     {
-      int32_t test = op.operation == OPCODE_BREAKC ? GetSrc(op.operands[0], op).value.i.x : 0;
+      int32_t test = op.operation == OPCODE_BREAKC ? GetSrc(dop.operands[0], dop).value.i.x : 0;
 
       if((test == 0 && !op.nonzero) || (test != 0 && op.nonzero) || op.operation == OPCODE_BREAK)
       {
         // break out (jump to next endloop/endswitch)
         int depth = 1;
 
-        for(; s.nextInstruction < (int)program->GetNumInstructions(); s.nextInstruction++)
+        for(; s.nextInstruction < program->GetNumInstructions(); s.nextInstruction++)
         {
           if(s.program->GetInstruction(s.nextInstruction).operation == OPCODE_LOOP ||
              s.program->GetInstruction(s.nextInstruction).operation == OPCODE_SWITCH)
@@ -3914,7 +4252,7 @@ State State::GetNext(GlobalState &global, DebugAPIWrapper *apiWrapper, State qua
     }
     case OPCODE_IF:
     {
-      int32_t test = GetSrc(op.operands[0], op).value.i.x;
+      int32_t test = GetSrc(dop.operands[0], dop).value.i.x;
 
       if((test == 0 && !op.nonzero) || (test != 0 && op.nonzero))
       {
@@ -3928,7 +4266,7 @@ State State::GetNext(GlobalState &global, DebugAPIWrapper *apiWrapper, State qua
         // skip back one to the if that we're processing
         s.nextInstruction--;
 
-        for(; s.nextInstruction < (int)program->GetNumInstructions(); s.nextInstruction++)
+        for(; s.nextInstruction < program->GetNumInstructions(); s.nextInstruction++)
         {
           if(s.program->GetInstruction(s.nextInstruction).operation == OPCODE_IF)
             depth++;
@@ -3951,69 +4289,410 @@ State State::GetNext(GlobalState &global, DebugAPIWrapper *apiWrapper, State qua
         s.nextInstruction++;
       }
 
-      break;
-    }
-    case OPCODE_ELSE:
-    {
-      // if we hit an else then we've just processed the if() bracket and need to break out (jump to
-      // next endif)
-      int depth = 1;
+      break;
+    }
+    case OPCODE_ELSE:
+    {
+      // if we hit an else then we've just processed the if() bracket and need to break out (jump to
+      // next endif)
+      int depth = 1;
+
+      for(; s.nextInstruction < program->GetNumInstructions(); s.nextInstruction++)
+      {
+        if(s.program->GetInstruction(s.nextInstruction).operation == OPCODE_IF)
+          depth++;
+        if(s.program->GetInstruction(s.nextInstruction).operation == OPCODE_ENDIF)
+          depth--;
+
+        if(depth == 0)
+        {
+          break;
+        }
+      }
+
+      RDCASSERT(s.program->GetInstruction(s.nextInstruction).operation == OPCODE_ENDIF);
+
+      // step to next instruction after the else/endif (for consistency with handling in the if
+      // block)
+      s.nextInstruction++;
+
+      break;
+    }
+    case OPCODE_DISCARD:
+    {
+      int32_t test = GetSrc(dop.operands[0], dop).value.i.x;
+
+      if((test != 0 && !op.nonzero) || (test == 0 && op.nonzero))
+      {
+        // don't discard
+        break;
+      }
+
+      // discarding.
+      s.done = true;
+      break;
+    }
+    case OPCODE_RET:
+    case OPCODE_RETC:
+    {
+      int32_t test = op.operation == OPCODE_RETC ? GetSrc(dop.operands[0], dop).value.i.x : 0;
+
+      if((test == 0 && !op.nonzero) || (test != 0 && op.nonzero) || op.operation == OPCODE_RET)
+      {
+        // assumes not in a function call
+        s.done = true;
+      }
+      break;
+    }
+    default:
+    {
+      RDCERR("Unsupported operation %d in assembly debugging", op.operation);
+      break;
+    }
+  }
+}
+
+static bool ReadsQuad(OpcodeType op)
+{
+  switch(op)
+  {
+    case OPCODE_DERIV_RTX:
+    case OPCODE_DERIV_RTX_COARSE:
+    case OPCODE_DERIV_RTX_FINE:
+    case OPCODE_DERIV_RTY:
+    case OPCODE_DERIV_RTY_COARSE:
+    case OPCODE_DERIV_RTY_FINE:
+    case OPCODE_SAMPLE:
+    case OPCODE_SAMPLE_B:
+    case OPCODE_SAMPLE_C:
+    case OPCODE_LOD: return true;
+    default: return false;
+  }
+}
+
+bool LaneGroup::IsVectorisable(const Operation &op)
+{
+  switch(op.operation)
+  {
+    case OPCODE_MOV:
+    case OPCODE_INEG:
+    case OPCODE_NOT:
+    case OPCODE_FRC:
+    case OPCODE_ROUND_PI:
+    case OPCODE_ROUND_NI:
+    case OPCODE_ROUND_Z:
+    case OPCODE_ROUND_NE:
+    case OPCODE_SQRT:
+    case OPCODE_ITOF:
+    case OPCODE_UTOF: return op.operands.size() == 2;
+
+    case OPCODE_ADD:
+    case OPCODE_IADD:
+    case OPCODE_MUL:
+    case OPCODE_DIV:
+    case OPCODE_DP2:
+    case OPCODE_DP3:
+    case OPCODE_DP4:
+    case OPCODE_MIN:
+    case OPCODE_MAX:
+    case OPCODE_IMIN:
+    case OPCODE_IMAX:
+    case OPCODE_UMIN:
+    case OPCODE_UMAX:
+    case OPCODE_AND:
+    case OPCODE_OR:
+    case OPCODE_XOR:
+    case OPCODE_ISHL:
+    case OPCODE_ISHR:
+    case OPCODE_USHR:
+    case OPCODE_EQ:
+    case OPCODE_NE:
+    case OPCODE_LT:
+    case OPCODE_GE:
+    case OPCODE_IEQ:
+    case OPCODE_INE:
+    case OPCODE_IGE:
+    case OPCODE_ILT:
+    case OPCODE_ULT:
+    case OPCODE_UGE: return op.operands.size() == 3;
+
+    case OPCODE_MAD:
+    case OPCODE_IMAD:
+    case OPCODE_UMAD:
+    case OPCODE_MOVC: return op.operands.size() == 4;
+
+    default: return false;
+  }
+}
+
+bool LaneGroup::AtThreadSync(const State &lane) const
+{
+  if(lane.nextInstruction >= m_Program->GetNumOperations())
+    return false;
+
+  const Operation &op = *m_Program->GetOperation(lane.nextInstruction).operation;
+
+  // 0x1 is the flag to synchronise the threads in the group, as opposed to only memory
+  return op.operation == OPCODE_SYNC && (op.syncFlags & 0x1);
+}
+
+void LaneGroup::Step(GlobalState &global, DebugAPIWrapper *apiWrapper, State *lanes,
+                     size_t numLanes, const bool *activeMask)
+{
+  RDCASSERT(!m_PixelQuad || numLanes == 4);
+
+  const size_t numInstructions = m_Program->GetNumOperations();
+
+  // derivatives read the other lanes as they were before this step. Since we update in place, if
+  // any lane is about to do that we take a copy of the quad first.
+  State *quad = NULL;
+
+  if(m_PixelQuad)
+  {
+    quad = lanes;
+
+    for(size_t l = 0; l < numLanes; l++)
+    {
+      if(activeMask[l] && lanes[l].nextInstruction < numInstructions &&
+         ReadsQuad(m_Program->GetOperation(lanes[l].nextInstruction).operation->operation))
+      {
+        m_Snapshot.assign(lanes, lanes + numLanes);
+        quad = m_Snapshot.data();
+        break;
+      }
+    }
+  }
+
+  // lanes in a thread group wait at a sync until every lane that hasn't finished has reached one,
+  // so that groupshared memory writes before the sync are visible to all of them after it.
+  bool syncReleased = true;
+
+  if(!m_PixelQuad)
+  {
+    for(size_t l = 0; l < numLanes; l++)
+    {
+      if(!lanes[l].Finished() && !AtThreadSync(lanes[l]))
+      {
+        syncReleased = false;
+        break;
+      }
+    }
+  }
+
+  m_Stepped.assign(numLanes, false);
+  m_Batched.assign(numLanes, false);
+
+  for(size_t l = 0; l < numLanes; l++)
+  {
+    if(!activeMask[l] || m_Batched[l])
+      continue;
+
+    State &s = lanes[l];
+
+    if(s.nextInstruction >= numInstructions)
+    {
+      s.modified.clear();
+      m_Stepped[l] = true;
+      continue;
+    }
+
+    if(!syncReleased && AtThreadSync(s))
+      continue;
+
+    m_Stepped[l] = true;
+
+    const DecodedOperation &op = m_Program->GetOperation(s.nextInstruction);
+
+    if(!IsVectorisable(*op.operation))
+    {
+      s.StepNext(global, apiWrapper, quad);
+      continue;
+    }
+
+    // batch this lane with every other lane that's converged on the same instruction. None of the
+    // vectorised operations have side-effects outside of the lane, so running them ahead of any
+    // lanes in between that fall back to GetNext doesn't change anything.
+    m_Batch.clear();
+
+    for(size_t m = l; m < numLanes; m++)
+    {
+      if(activeMask[m] && !m_Batched[m] && lanes[m].nextInstruction == s.nextInstruction)
+      {
+        m_Batch.push_back((uint32_t)m);
+        m_Batched[m] = true;
+        m_Stepped[m] = true;
+      }
+    }
+
+    for(size_t b = 0; b < m_Batch.size(); b += LaneBlock)
+      ExecuteBatch(apiWrapper, op, lanes, m_Batch.data() + b,
+                   RDCMIN(m_Batch.size() - b, (size_t)LaneBlock));
+  }
+}
+
+bool LaneGroup::Gather(const DecodedOperand &oper, const DecodedOperation &op, const State *lanes,
+                       const uint32_t *laneIndices, size_t count, LaneData &data,
+                       VarType *types) const
+{
+  const Operand &operand = *oper.operand;
+
+  // anything indexed, or the modifiers on types other than these, goes through GetSrc
+  if(oper.relativeIndices != 0)
+    return false;
+
+  if((oper.abs || oper.neg) && op.type != VarType::Float && op.type != VarType::SInt &&
+     op.type != VarType::UInt)
+    return false;
+
+  bool flushable = true;
+
+  if(operand.type == TYPE_TEMP)
+  {
+    const uint32_t reg = oper.indices[0];
+
+    for(size_t l = 0; l < count; l++)
+    {
+      const State &s = lanes[laneIndices[l]];
+
+      if(reg >= s.registers.size())
+        return false;
+
+      const ShaderVariable &r = s.registers[reg];
+
+      for(int c = 0; c < 4; c++)
+        data.u[c][l] = r.value.uv[oper.swizzle[c]];
+
+      types[l] = r.type;
+    }
+  }
+  else if(operand.type == TYPE_IMMEDIATE32)
+  {
+    if(operand.numComponents != NUMCOMPS_1 && operand.numComponents != NUMCOMPS_4)
+      return false;
+
+    // immediates are never flushed
+    flushable = false;
+
+    uint32_t imm[4] = {};
+    for(int c = 0; c < (operand.numComponents == NUMCOMPS_1 ? 1 : 4); c++)
+      imm[c] = operand.values[c];
+
+    for(size_t l = 0; l < count; l++)
+    {
+      for(int c = 0; c < 4; c++)
+        data.u[c][l] = imm[oper.swizzle[c]];
+
+      types[l] = VarType::Float;
+    }
+  }
+  else
+  {
+    return false;
+  }
+
+  const size_t padded = AlignUp4(count);
+
+  if(oper.abs || oper.neg)
+  {
+    const uint32_t columns = oper.scalar ? 1 : 4;
 
-      for(; s.nextInstruction < (int)program->GetNumInstructions(); s.nextInstruction++)
+    for(uint32_t c = 0; c < columns; c++)
+    {
+      for(size_t l = 0; l < padded; l += 4)
       {
-        if(s.program->GetInstruction(s.nextInstruction).operation == OPCODE_IF)
-          depth++;
-        if(s.program->GetInstruction(s.nextInstruction).operation == OPCODE_ENDIF)
-          depth--;
+        LaneVec v = LaneLoad(&data.u[c][l]);
 
-        if(depth == 0)
+        // same as the abs() and neg() helpers, unsigned values are left alone
+        if(op.type == VarType::Float)
         {
-          break;
+          if(oper.abs)
+            v = LaneSelect(FGt(v, LaneSet(0)), v, FNeg(v));
+          if(oper.neg)
+            v = FNeg(v);
         }
+        else if(op.type == VarType::SInt)
+        {
+          if(oper.abs)
+            v = LaneSelect(ILt(LaneSet(0), v), v, ISub(LaneSet(0), v));
+          if(oper.neg)
+            v = ISub(LaneSet(0), v);
+        }
+
+        LaneStore(&data.u[c][l], v);
       }
+    }
 
-      RDCASSERT(s.program->GetInstruction(s.nextInstruction).operation == OPCODE_ENDIF);
+    for(size_t l = 0; l < count; l++)
+      types[l] = op.type;
+  }
 
-      // step to next instruction after the else/endif (for consistency with handling in the if
-      // block)
-      s.nextInstruction++;
+  if(op.flushing && flushable)
+  {
+    for(int c = 0; c < 4; c++)
+      for(size_t l = 0; l < padded; l += 4)
+        LaneStore(&data.u[c][l], FFlushDenorm(LaneLoad(&data.u[c][l])));
+  }
 
-      break;
-    }
-    case OPCODE_DISCARD:
-    {
-      int32_t test = GetSrc(op.operands[0], op).value.i.x;
+  return true;
+}
 
-      if((test != 0 && !op.nonzero) || (test == 0 && op.nonzero))
-      {
-        // don't discard
-        break;
-      }
+void LaneGroup::ExecuteBatch(DebugAPIWrapper *apiWrapper, const DecodedOperation &dop,
+                             State *lanes, const uint32_t *laneIndices, size_t count)
+{
+  const Operation &op = *dop.operation;
 
-      // discarding.
-      s.done = true;
-      break;
-    }
-    case OPCODE_RET:
-    case OPCODE_RETC:
-    {
-      int32_t test = op.operation == OPCODE_RETC ? GetSrc(op.operands[0], op).value.i.x : 0;
+  // per-component arrays of each lane's value. The padding up to the next vector is zeroed so
+  // the arithmetic on it is well defined, though it's never written back.
+  LaneData src[3] = {}, dst;
+  VarType srcType[LaneBlock], otherTypes[LaneBlock];
 
-      if((test == 0 && !op.nonzero) || (test != 0 && op.nonzero) || op.operation == OPCODE_RET)
-      {
-        // assumes not in a function call
-        s.done = true;
-      }
-      break;
-    }
-    default:
+  const size_t numSrcs = op.operands.size() - 1;
+  const uint32_t instruction = lanes[laneIndices[0]].nextInstruction;
+
+  for(size_t o = 0; o < numSrcs; o++)
+  {
+    const DecodedOperand &oper = dop.operands[o + 1];
+    VarType *types = o == 0 ? srcType : otherTypes;
+
+    if(Gather(oper, dop, lanes, laneIndices, count, src[o], types))
+      continue;
+
+    for(size_t l = 0; l < count; l++)
     {
-      RDCERR("Unsupported operation %d in assembly debugging", op.operation);
-      break;
+      ShaderVariable v = lanes[laneIndices[l]].GetSrc(oper, dop);
+
+      for(int c = 0; c < 4; c++)
+        src[o].u[c][l] = v.value.uv[c];
+
+      types[l] = v.type;
     }
   }
 
-  return s;
+  const uint32_t columns = dop.operands[1].scalar ? 1 : 4;
+
+  VarType resultType = Execute(dop, src, columns, count, dst);
+
+  ShaderVariable result("", 0U, 0U, 0U, 0U);
+  result.columns = KeepsSourceColumns(op.operation) ? columns : 4;
+
+  for(size_t l = 0; l < count; l++)
+  {
+    State &s = lanes[laneIndices[l]];
+
+    // same bookkeeping as GetNext does for each step
+    s.modified.clear();
+    apiWrapper->SetCurrentInstruction(instruction);
+    s.nextInstruction++;
+    s.flags = ShaderEvents::NoEvent;
+
+    for(int c = 0; c < 4; c++)
+      result.value.uv[c] = dst.u[c][l];
+
+    // a mov passes the source straight through, including its type
+    result.type = op.operation == OPCODE_MOV ? srcType[l] : resultType;
+
+    s.SetDst(dop.operands[0], dop, result);
+  }
 }
 
 void GlobalState::PopulateGroupshared(const DXBCBytecode::Program *pBytecode)
@@ -4050,9 +4729,10 @@ void GlobalState::PopulateGroupshared(const DXBCBytecode::Program *pBytecode)
 
 void CreateShaderDebugStateAndTrace(ShaderDebug::State &initialState, ShaderDebugTrace &trace,
                                     int quadIdx, DXBC::DXBCContainer *dxbc,
-                                    const ShaderReflection &refl, bytebuf *cbufData)
+                                    const DecodedProgram *decoded, const ShaderReflection &refl,
+                                    bytebuf *cbufData)
 {
-  initialState = ShaderDebug::State(quadIdx, &trace, dxbc->GetReflection(), dxbc->GetDXBCByteCode());
+  initialState = ShaderDebug::State(quadIdx, &trace, decoded);
 
   size_t numInputs = dxbc->GetReflection()->InputSig.size();
   size_t numOutputs = dxbc->GetReflection()->OutputSig.size();
@@ -4225,10 +4905,15 @@ bool PromptDebugTimeout(uint32_t cycleCounter)
       "minutes.",
       cycleCounter);
 
+#if ENABLED(RDOC_WIN32)
   int ret = MessageBoxA(NULL, msg.c_str(), "Shader debugging timeout", MB_YESNO | MB_ICONWARNING);
 
   if(ret == IDYES)
     return true;
+#else
+  // no way to prompt here, so keep going as if the user declined to abort
+  RDCWARN("%s", msg.c_str());
+#endif
 
   return false;
 }
@@ -4520,6 +5205,7 @@ void FlattenVariables(const rdcarray<ShaderConstant> &constants,
   FlattenVariables(constants, invars, outvars, "", 0);
 }
 
+#if ENABLED(RDOC_WIN32)
 void FillViewFmt(DXGI_FORMAT format, GlobalState::ViewFmt &viewFmt)
 {
   if(format != DXGI_FORMAT_UNKNOWN)
@@ -4536,6 +5222,7 @@ void FillViewFmt(DXGI_FORMAT format, GlobalState::ViewFmt &viewFmt)
       viewFmt.byteWidth = 10;
   }
 }
+#endif
 
 void LookupSRVFormatFromShaderReflection(const DXBC::Reflection &reflection,
                                          uint32_t shaderRegister, GlobalState::ViewFmt &viewFmt)
@@ -4876,6 +5563,7 @@ void GatherPSInputDataForInitialValues(const DXBC::Reflection &psDxbc,
 
 #include <limits>
 #include "3rdparty/catch/catch.hpp"
+#include "common/timing.h"
 
 using namespace ShaderDebug;
 
@@ -4904,7 +5592,7 @@ TEST_CASE("DXBC debugging helpers", "[program]")
     CHECK(dxbc_min(nan, neginf) == neginf);
     CHECK(dxbc_min(nan, a) == a);
     CHECK(dxbc_min(nan, posinf) == posinf);
-    CHECK(_isnan(dxbc_min(nan, nan)));
+    CHECK(std::isnan(dxbc_min(nan, nan)));
   };
 
   SECTION("dxbc_max")
@@ -4924,7 +5612,7 @@ TEST_CASE("DXBC debugging helpers", "[program]")
     CHECK(dxbc_max(nan, neginf) == neginf);
     CHECK(dxbc_max(nan, a) == a);
     CHECK(dxbc_max(nan, posinf) == posinf);
-    CHECK(_isnan(dxbc_max(nan, nan)));
+    CHECK(std::isnan(dxbc_max(nan, nan)));
   };
 
   SECTION("sat/abs/neg on NaNs")
@@ -4941,14 +5629,14 @@ TEST_CASE("DXBC debugging helpers", "[program]")
     v2 = neg(v, VarType::Float);
 
     CHECK(v2.value.f.x == -b);
-    CHECK(_isnan(v2.value.f.y));
+    CHECK(std::isnan(v2.value.f.y));
     CHECK(v2.value.f.z == posinf);
     CHECK(v2.value.f.w == neginf);
 
     v2 = abs(v, VarType::Float);
 
     CHECK(v2.value.f.x == b);
-    CHECK(_isnan(v2.value.f.y));
+    CHECK(std::isnan(v2.value.f.y));
     CHECK(v2.value.f.z == posinf);
     CHECK(v2.value.f.w == posinf);
   };
@@ -4963,7 +5651,7 @@ TEST_CASE("DXBC debugging helpers", "[program]")
     CHECK(flush_denorm(-foo) == -foo);
 
     // check NaN/inf values
-    CHECK(_isnan(flush_denorm(nan)));
+    CHECK(std::isnan(flush_denorm(nan)));
     CHECK(flush_denorm(neginf) == neginf);
     CHECK(flush_denorm(posinf) == posinf);
 
@@ -4985,4 +5673,716 @@ TEST_CASE("DXBC debugging helpers", "[program]")
   };
 };
 
+// an API wrapper for programs that only touch registers, nothing here should ever be called
+class RegisterOnlyAPIWrapper : public DebugAPIWrapper
+{
+public:
+  void SetCurrentInstruction(uint32_t instruction) {}
+  void AddDebugMessage(MessageCategory c, MessageSeverity sv, MessageSource src, std::string d) {}
+  bool CalculateMathIntrinsic(DXBCBytecode::OpcodeType opcode, const ShaderVariable &input,
+                              ShaderVariable &output1, ShaderVariable &output2)
+  {
+    return false;
+  }
+  ShaderVariable GetSampleInfo(DXBCBytecode::OperandType type, bool isAbsoluteResource,
+                               uint32_t slot, const char *opString)
+  {
+    return ShaderVariable();
+  }
+  ShaderVariable GetBufferInfo(DXBCBytecode::OperandType type, uint32_t slot, const char *opString)
+  {
+    return ShaderVariable();
+  }
+  ShaderVariable GetResourceInfo(DXBCBytecode::OperandType type, uint32_t slot, uint32_t mipLevel,
+                                 int &dim)
+  {
+    return ShaderVariable();
+  }
+  bool CalculateSampleGather(DXBCBytecode::OpcodeType opcode, SampleGatherResourceData resourceData,
+                             SampleGatherSamplerData samplerData, ShaderVariable uv,
+                             ShaderVariable ddxCalc, ShaderVariable ddyCalc,
+                             const int texelOffsets[3], int multisampleIndex,
+                             float lodOrCompareValue, const uint8_t swizzle[4],
+                             GatherChannel gatherChannel, const char *opString,
+                             ShaderVariable &output)
+  {
+    return false;
+  }
+};
+
+// values that exercise denormal flushing, signed zero, NaN/inf handling and integer edge cases
+static const uint32_t specialValues[] = {
+    0x00000000U, 0x80000000U, 0x00000001U, 0x807fffffU, 0x7f800000U, 0xff800000U,
+    0x7fc00000U, 0xffffffffU, 0x3f800000U, 0xbf800000U, 0x0000001fU, 0x00000021U,
+    0x7fffffffU, 0x40490fdbU, 0x4b800000U, 0x3effffffU,
+};
+
+static uint32_t TestRandom(uint32_t &rng)
+{
+  rng = rng * 1103515245 + 12345;
+  return rng >> 8;
+}
+
+static uint32_t TestValue(uint32_t &rng)
+{
+  if(TestRandom(rng) % 2)
+    return specialValues[TestRandom(rng) % ARRAY_COUNT(specialValues)];
+  return TestRandom(rng);
+}
+
+// encodes a temp register operand with a random write mask, or a source with a random swizzle and
+// modifier. Some sources are four-component immediates instead of the register.
+static void EncodeTestOperand(std::vector<uint32_t> &tokens, uint32_t &rng, uint32_t reg, bool dst)
+{
+  if(dst)
+  {
+    tokens.push_back(2 | (1 << 20) | ((TestRandom(rng) % 15 + 1) << 4));
+    tokens.push_back(reg);
+    return;
+  }
+
+  const bool immediate = TestRandom(rng) % 8 == 0;
+
+  uint32_t token = immediate ? 2 | (TYPE_IMMEDIATE32 << 12)
+                             : 2 | (1 << 20) | (1 << 2) | ((TestRandom(rng) & 0xff) << 4);
+
+  uint32_t modifier = TestRandom(rng) % 4;
+
+  if(modifier)
+  {
+    tokens.push_back(token | 0x80000000U);
+    tokens.push_back(1 | (modifier << 6));
+  }
+  else
+  {
+    tokens.push_back(token);
+  }
+
+  if(immediate)
+  {
+    for(int c = 0; c < 4; c++)
+      tokens.push_back(TestValue(rng));
+  }
+  else
+  {
+    tokens.push_back(reg);
+  }
+}
+
+static void EncodeTestInstruction(std::vector<uint32_t> &tokens, uint32_t &rng, OpcodeType opcode,
+                                  uint32_t numOperands)
+{
+  size_t start = tokens.size();
+  tokens.push_back(0);
+  for(uint32_t o = 0; o < numOperands; o++)
+    EncodeTestOperand(tokens, rng, TestRandom(rng) % 4, o == 0);
+  tokens[start] =
+      opcode | ((TestRandom(rng) % 4 == 0) ? 0x2000 : 0) | (uint32_t(tokens.size() - start) << 24);
+}
+
+static std::vector<uint32_t> EncodeTestProgram(const std::vector<uint32_t> &body)
+{
+  // ps_5_0, dcl_temps 4, the body, then ret
+  std::vector<uint32_t> tokens = {0x50, 0, OPCODE_DCL_TEMPS | (2 << 24), 4};
+  tokens.insert(tokens.end(), body.begin(), body.end());
+  tokens.push_back(OPCODE_RET | (1 << 24));
+  tokens[1] = (uint32_t)tokens.size();
+  return tokens;
+}
+
+// a loop that sums 0..N-1, storing each counter into an indexable temp and reading it back with a
+// relative index:
+//
+// dcl_temps 2
+// dcl_indexableTemp x0[8], 4
+// mov r0.x, l(0)
+// mov r1.x, l(0)
+// loop
+//   uge r0.y, r0.x, l(N)
+//   breakc_nz r0.y
+//   and r0.z, r0.x, l(7)
+//   mov x0[r0.z + 0].x, r0.x
+//   iadd r1.x, r1.x, x0[r0.z + 0].x
+//   iadd r0.x, r0.x, l(1)
+// endloop
+// ret
+static std::vector<uint32_t> EncodeLoopTestProgram(uint32_t N)
+{
+  const uint32_t dstX = 2 | (1 << 4) | (1 << 20);
+  const uint32_t dstY = 2 | (2 << 4) | (1 << 20);
+  const uint32_t dstZ = 2 | (4 << 4) | (1 << 20);
+  const uint32_t srcX = 2 | (2 << 2) | (0 << 4) | (1 << 20);
+  const uint32_t srcY = 2 | (2 << 2) | (1 << 4) | (1 << 20);
+  const uint32_t srcZ = 2 | (2 << 2) | (2 << 4) | (1 << 20);
+  const uint32_t imm = 2 | (TYPE_IMMEDIATE32 << 12);
+  // x0[r0.z + 0], with the array index immediate and the element immediate plus relative
+  const uint32_t indexable = (TYPE_INDEXABLE_TEMP << 12) | (2 << 20) | (3 << 25);
+
+  std::vector<uint32_t> tokens = {
+      0x50, 0,
+      OPCODE_DCL_TEMPS | (2 << 24), 2,
+      OPCODE_DCL_INDEXABLE_TEMP | (4 << 24), 0, 8, 4,
+      OPCODE_MOV | (8 << 24), dstX, 0, imm, 0, 0, 0, 0,
+      OPCODE_MOV | (8 << 24), dstX, 1, imm, 0, 0, 0, 0,
+      OPCODE_LOOP | (1 << 24),
+      OPCODE_UGE | (10 << 24), dstY, 0, srcX, 0, imm, N, N, N, N,
+      OPCODE_BREAKC | 0x40000 | (3 << 24), srcY, 0,
+      OPCODE_AND | (10 << 24), dstZ, 0, srcX, 0, imm, 7, 7, 7, 7,
+      OPCODE_MOV | (8 << 24), 2 | (1 << 4) | indexable, 0, 0, srcZ, 0, srcX, 0,
+      OPCODE_IADD | (10 << 24), dstX, 1, srcX, 1, 2 | (2 << 2) | indexable, 0, 0, srcZ, 0,
+      OPCODE_IADD | (10 << 24), dstX, 0, srcX, 0, imm, 1, 1, 1, 1,
+      OPCODE_ENDLOOP | (1 << 24),
+      OPCODE_RET | (1 << 24),
+  };
+  tokens[1] = (uint32_t)tokens.size();
+  return tokens;
+}
+
+static void RandomiseTestRegisters(State &state, uint32_t &rng)
+{
+  const VarType types[] = {VarType::Float, VarType::SInt, VarType::UInt};
+
+  for(ShaderVariable &r : state.registers)
+  {
+    r.type = types[TestRandom(rng) % ARRAY_COUNT(types)];
+    for(int c = 0; c < 4; c++)
+      r.value.uv[c] = TestValue(rng);
+  }
+}
+
+TEST_CASE("DXBC lane group stepping", "[program]")
+{
+  uint32_t rng = 0x2468ace;
+  auto random = [&rng]() { return TestRandom(rng); };
+
+  auto instruction = [&rng](std::vector<uint32_t> &tokens, OpcodeType opcode,
+                            uint32_t numOperands) {
+    EncodeTestInstruction(tokens, rng, opcode, numOperands);
+  };
+
+  auto program = EncodeTestProgram;
+
+  RegisterOnlyAPIWrapper apiWrapper;
+  GlobalState global;
+  ShaderDebugTrace trace;
+
+  // steps the lanes both ways and checks the results are identical down to the bit and the type.
+  // Four lanes are stepped as a pixel quad, any other number as a thread group.
+  auto compare = [&](const std::vector<uint32_t> &tokens, const std::vector<uint32_t> &startPCs) {
+    Program prog((const byte *)tokens.data(), tokens.size() * sizeof(uint32_t));
+    delete prog.GuessReflection();
+    DecodedProgram decoded(&prog, NULL);
+
+    const size_t numLanes = startPCs.size();
+    const bool pixelQuad = numLanes == 4;
+
+    std::vector<State> lanes(numLanes);
+    for(size_t l = 0; l < numLanes; l++)
+    {
+      lanes[l] = State((int)l, &trace, &decoded);
+      lanes[l].Init();
+      lanes[l].nextInstruction = startPCs[l];
+      RandomiseTestRegisters(lanes[l], rng);
+    }
+
+    std::vector<State> before = lanes;
+    std::vector<State> expected(numLanes);
+    for(size_t l = 0; l < numLanes; l++)
+      expected[l] = before[l].GetNext(global, &apiWrapper, pixelQuad ? before.data() : NULL);
+
+    rdcarray<bool> active;
+    active.resize(numLanes);
+    for(size_t l = 0; l < numLanes; l++)
+      active[l] = true;
+    LaneGroup group(&decoded, pixelQuad);
+    group.Step(global, &apiWrapper, lanes.data(), numLanes, active.data());
+
+    bool identical = true;
+    for(size_t l = 0; l < numLanes; l++)
+    {
+      identical &= group.WasStepped(l);
+      identical &= lanes[l].nextInstruction == expected[l].nextInstruction;
+      identical &= lanes[l].flags == expected[l].flags;
+      identical &= lanes[l].modified == expected[l].modified;
+      for(size_t r = 0; r < lanes[l].registers.size(); r++)
+      {
+        identical &= lanes[l].registers[r].type == expected[l].registers[r].type;
+        identical &= memcmp(lanes[l].registers[r].value.uv, expected[l].registers[r].value.uv,
+                            sizeof(uint32_t) * 4) == 0;
+      }
+    }
+
+    if(!identical)
+      RDCLOG("Mismatch stepping %s", prog.GetInstruction(startPCs[0]).str.c_str());
+
+    CHECK(identical);
+  };
+
+  const std::vector<uint32_t> converged(4, 0);
+
+  SECTION("Pre-decoded operands")
+  {
+    // mov_sat r1.xz, |r2.wzyx|
+    // mov r0.x, -r3.y
+    std::vector<uint32_t> tokens = program({
+        OPCODE_MOV | 0x2000 | (6 << 24), 2 | (0x5 << 4) | (1 << 20), 1,
+        2 | (1 << 2) | (0x1b << 4) | (1 << 20) | 0x80000000U, 1 | (2 << 6), 2,
+        OPCODE_MOV | (6 << 24), 2 | (0x1 << 4) | (1 << 20), 0,
+        2 | (2 << 2) | (0x1 << 4) | (1 << 20) | 0x80000000U, 1 | (1 << 6), 3,
+    });
+
+    Program prog((const byte *)tokens.data(), tokens.size() * sizeof(uint32_t));
+    delete prog.GuessReflection();
+    DecodedProgram decoded(&prog, NULL);
+
+    REQUIRE(decoded.GetNumOperations() == prog.GetNumInstructions());
+    REQUIRE(decoded.GetNumOperations() == 3);
+
+    const DecodedOperation &first = decoded.GetOperation(0);
+    CHECK(first.operation == &prog.GetInstruction(0));
+    CHECK(first.type == OperationType(OPCODE_MOV));
+    CHECK(first.flushing == OperationFlushing(OPCODE_MOV));
+    REQUIRE(first.operands.size() == 2);
+
+    CHECK(first.operands[0].indices[0] == 1);
+    CHECK(first.operands[0].relativeIndices == 0);
+    CHECK_FALSE(first.operands[0].scalar);
+
+    CHECK(first.operands[1].indices[0] == 2);
+    CHECK(first.operands[1].swizzle[0] == 3);
+    CHECK(first.operands[1].swizzle[1] == 2);
+    CHECK(first.operands[1].swizzle[2] == 1);
+    CHECK(first.operands[1].swizzle[3] == 0);
+    CHECK_FALSE(first.operands[1].scalar);
+    CHECK(first.operands[1].abs);
+    CHECK_FALSE(first.operands[1].neg);
+
+    const DecodedOperation &second = decoded.GetOperation(1);
+    REQUIRE(second.operands.size() == 2);
+
+    CHECK(second.operands[0].indices[0] == 0);
+    CHECK(second.operands[1].indices[0] == 3);
+    CHECK(second.operands[1].swizzle[0] == 1);
+    CHECK(second.operands[1].scalar);
+    CHECK_FALSE(second.operands[1].abs);
+    CHECK(second.operands[1].neg);
+
+    CHECK(decoded.GetOperation(2).operands.empty());
+  };
+
+  SECTION("Vectorised ALU operations")
+  {
+    const OpcodeType ops[] = {
+        OPCODE_MOV, OPCODE_INEG, OPCODE_NOT, OPCODE_FRC, OPCODE_ROUND_PI, OPCODE_ROUND_NI,
+        OPCODE_ROUND_Z, OPCODE_ROUND_NE, OPCODE_SQRT, OPCODE_ITOF, OPCODE_UTOF, OPCODE_ADD,
+        OPCODE_IADD, OPCODE_MUL, OPCODE_DIV, OPCODE_DP2, OPCODE_DP3, OPCODE_DP4, OPCODE_MIN,
+        OPCODE_MAX, OPCODE_IMIN, OPCODE_IMAX, OPCODE_UMIN, OPCODE_UMAX, OPCODE_AND, OPCODE_OR,
+        OPCODE_XOR, OPCODE_ISHL, OPCODE_ISHR, OPCODE_USHR, OPCODE_EQ, OPCODE_NE, OPCODE_LT,
+        OPCODE_GE, OPCODE_IEQ, OPCODE_INE, OPCODE_IGE, OPCODE_ILT, OPCODE_ULT, OPCODE_UGE,
+        OPCODE_MAD, OPCODE_IMAD, OPCODE_UMAD, OPCODE_MOVC,
+    };
+
+    for(OpcodeType op : ops)
+    {
+      for(int iter = 0; iter < 50; iter++)
+      {
+        std::vector<uint32_t> body;
+
+        uint32_t numOperands = 3;
+        if(op == OPCODE_MOV || op == OPCODE_INEG || op == OPCODE_NOT || op == OPCODE_FRC ||
+           (op >= OPCODE_ROUND_NE && op <= OPCODE_ROUND_Z) || op == OPCODE_SQRT ||
+           op == OPCODE_ITOF || op == OPCODE_UTOF)
+          numOperands = 2;
+        else if(op == OPCODE_MAD || op == OPCODE_IMAD || op == OPCODE_UMAD || op == OPCODE_MOVC)
+          numOperands = 4;
+
+        instruction(body, op, numOperands);
+
+        // alternate between a quad and a thread group that fills several blocks of lanes, with a
+        // partial block on the end
+        compare(program(body), iter % 2 ? std::vector<uint32_t>(37, 0) : converged);
+      }
+    }
+  };
+
+  SECTION("Vectorised arithmetic matches the scalar helpers")
+  {
+    const OpcodeType ops[] = {
+        OPCODE_ADD, OPCODE_IADD, OPCODE_MUL, OPCODE_DIV, OPCODE_MAD,
+        OPCODE_IMAD, OPCODE_UMAD, OPCODE_INEG, OPCODE_MIN, OPCODE_MAX,
+    };
+
+    for(OpcodeType opcode : ops)
+    {
+      Operation op;
+      op.operation = opcode;
+
+      DecodedOperation dop;
+      dop.operation = &op;
+      dop.type = OperationType(opcode);
+
+      // an odd number of lanes so the last block is only partly used
+      const size_t count = 13;
+
+      LaneGroup::LaneData src[3] = {}, dst;
+      for(int o = 0; o < 3; o++)
+        for(int c = 0; c < 4; c++)
+          for(size_t l = 0; l < count; l++)
+            src[o].u[c][l] = TestValue(rng);
+
+      VarType type = LaneGroup::Execute(dop, src, 4, count, dst);
+
+      CHECK(type == dop.type);
+
+      bool identical = true;
+      for(size_t l = 0; l < count; l++)
+      {
+        ShaderVariable a("", src[0].u[0][l], src[0].u[1][l], src[0].u[2][l], src[0].u[3][l]);
+        ShaderVariable b("", src[1].u[0][l], src[1].u[1][l], src[1].u[2][l], src[1].u[3][l]);
+        ShaderVariable c("", src[2].u[0][l], src[2].u[1][l], src[2].u[2][l], src[2].u[3][l]);
+
+        ShaderVariable ref;
+        switch(opcode)
+        {
+          case OPCODE_ADD:
+          case OPCODE_IADD: ref = add(a, b, dop.type); break;
+          case OPCODE_MUL: ref = mul(a, b, dop.type); break;
+          case OPCODE_DIV: ref = div(a, b, dop.type); break;
+          case OPCODE_MAD:
+          case OPCODE_IMAD:
+          case OPCODE_UMAD: ref = add(mul(a, b, dop.type), c, dop.type); break;
+          case OPCODE_INEG: ref = neg(a, dop.type); break;
+          case OPCODE_MIN:
+          case OPCODE_MAX:
+            for(int i = 0; i < 4; i++)
+              ref.value.fv[i] = opcode == OPCODE_MIN ? dxbc_min(a.value.fv[i], b.value.fv[i])
+                                                     : dxbc_max(a.value.fv[i], b.value.fv[i]);
+            break;
+          default: break;
+        }
+
+        for(int i = 0; i < 4; i++)
+        {
+          // when both sources are NaN, which one comes through depends on the order the compiler
+          // puts the operands in, so any NaN is a match
+          if(dop.type == VarType::Float && std::isnan(ref.value.fv[i]) && std::isnan(dst.f[i][l]))
+            continue;
+
+          identical &= ref.value.uv[i] == dst.u[i][l];
+        }
+      }
+
+      if(!identical)
+        RDCLOG("Mismatch executing opcode %d", opcode);
+
+      CHECK(identical);
+    }
+  };
+
+  SECTION("Thread group syncs and groupshared memory")
+  {
+    // store_raw g0.x, r0.x, r1.x
+    // sync_g_t
+    // ld_raw r2.x, r0.y, g0.xxxx
+    std::vector<uint32_t> tokens = program({
+        OPCODE_STORE_RAW | (7 << 24),
+        2 | (1 << 4) | (TYPE_THREAD_GROUP_SHARED_MEMORY << 12) | (1 << 20), 0,
+        2 | (2 << 2) | (0 << 4) | (1 << 20), 0,
+        2 | (2 << 2) | (0 << 4) | (1 << 20), 1,
+        OPCODE_SYNC | (3 << 11) | (1 << 24),
+        OPCODE_LD_RAW | (7 << 24),
+        2 | (1 << 4) | (1 << 20), 2,
+        2 | (2 << 2) | (1 << 4) | (1 << 20), 0,
+        2 | (1 << 2) | (TYPE_THREAD_GROUP_SHARED_MEMORY << 12) | (1 << 20), 0,
+    });
+
+    Program prog((const byte *)tokens.data(), tokens.size() * sizeof(uint32_t));
+    delete prog.GuessReflection();
+    DecodedProgram decoded(&prog, NULL);
+
+    GlobalState groupGlobal;
+    groupGlobal.groupshared.resize(1);
+    groupGlobal.groupshared[0].structured = false;
+    groupGlobal.groupshared[0].bytestride = 4;
+    groupGlobal.groupshared[0].count = 64;
+    groupGlobal.groupshared[0].data.resize(4 * 64);
+
+    // each lane stores its value, then loads the value its neighbour stored
+    State lanes[4];
+    for(uint32_t l = 0; l < 4; l++)
+    {
+      lanes[l] = State(l, &trace, &decoded);
+      lanes[l].Init();
+      lanes[l].registers[0].value.u.x = l * 4;
+      lanes[l].registers[0].value.u.y = ((l + 1) % 4) * 4;
+      lanes[l].registers[1].value.u.x = 100 + l;
+    }
+
+    bool active[4] = {true, true, true, false};
+    LaneGroup group(&decoded, false);
+
+    // the first three lanes store, then wait at the sync for the last one
+    for(int i = 0; i < 3; i++)
+      group.Step(groupGlobal, &apiWrapper, lanes, 4, active);
+
+    for(uint32_t l = 0; l < 3; l++)
+      CHECK(lanes[l].nextInstruction == 1);
+    CHECK(lanes[3].nextInstruction == 0);
+    CHECK_FALSE(group.WasStepped(0));
+
+    active[3] = true;
+    group.Step(groupGlobal, &apiWrapper, lanes, 4, active);
+
+    CHECK(lanes[0].nextInstruction == 1);
+    CHECK(lanes[3].nextInstruction == 1);
+    CHECK_FALSE(group.WasStepped(0));
+    CHECK(group.WasStepped(3));
+
+    // now the whole group is at the sync, they all continue together
+    group.Step(groupGlobal, &apiWrapper, lanes, 4, active);
+
+    for(uint32_t l = 0; l < 4; l++)
+    {
+      CHECK(group.WasStepped(l));
+      CHECK(lanes[l].nextInstruction == 2);
+    }
+
+    group.Step(groupGlobal, &apiWrapper, lanes, 4, active);
+
+    for(uint32_t l = 0; l < 4; l++)
+      CHECK(lanes[l].registers[2].value.u.x == 100 + (l + 1) % 4);
+  };
+
+  SECTION("Fallback and divergent lanes")
+  {
+    for(int iter = 0; iter < 200; iter++)
+    {
+      std::vector<uint32_t> body;
+
+      // a derivative that reads registers the vectorised op may overwrite, and an op that isn't
+      // vectorised at all
+      instruction(body, OPCODE_MAD, 4);
+      instruction(body, OPCODE_DERIV_RTX_FINE, 2);
+      instruction(body, OPCODE_ADD, 3);
+      instruction(body, OPCODE_BFREV, 2);
+
+      // 5 instructions including the ret, so some lanes may also be finished
+      std::vector<uint32_t> pcs(4);
+      for(uint32_t &pc : pcs)
+        pc = random() % 6;
+
+      compare(program(body), iter < 50 ? converged : pcs);
+    }
+  };
+};
+
+TEST_CASE("DXBC relative operand decoding", "[program]")
+{
+  const uint32_t N = 100;
+  std::vector<uint32_t> tokens = EncodeLoopTestProgram(N);
+
+  Program prog((const byte *)tokens.data(), tokens.size() * sizeof(uint32_t));
+  delete prog.GuessReflection();
+
+  DecodedProgram decoded(&prog, NULL);
+  DecodedProgram undecoded(&prog, NULL, false);
+
+  REQUIRE(decoded.GetNumOperations() == 11);
+
+  // mov x0[r0.z + 0].x, r0.x
+  const DecodedOperation &store = decoded.GetOperation(6);
+  REQUIRE(store.operands.size() == 2);
+  CHECK(store.operands[0].relativeIndices == 0x2);
+  REQUIRE(store.relativeOperands.size() == 1);
+  CHECK(store.operands[0].relativeOperands[0] == DecodedOperand::NoRelativeOperand);
+  CHECK(store.operands[0].relativeOperands[1] == 0);
+  CHECK(store.relativeOperands[0].indices[0] == 0);
+  CHECK(store.relativeOperands[0].scalar);
+
+  // iadd r1.x, r1.x, x0[r0.z + 0].x
+  const DecodedOperation &load = decoded.GetOperation(7);
+  REQUIRE(load.operands.size() == 3);
+  REQUIRE(load.relativeOperands.size() == 1);
+  CHECK(load.operands[2].relativeOperands[1] == 0);
+
+  CHECK(undecoded.GetOperation(6).relativeOperands.empty());
+  CHECK(undecoded.GetOperation(6).operands[0].relativeOperands[1] ==
+        DecodedOperand::NoRelativeOperand);
+
+  RegisterOnlyAPIWrapper apiWrapper;
+  GlobalState global;
+  ShaderDebugTrace trace;
+
+  State a(0, &trace, &decoded);
+  State b(0, &trace, &undecoded);
+  a.Init();
+  b.Init();
+
+  REQUIRE(a.indexableTemps.size() == 1);
+  REQUIRE(a.indexableTemps[0].members.size() == 8);
+
+  // step both and check every state in the trace is identical
+  bool identical = true;
+  uint32_t steps = 0;
+  while(!a.Finished() && steps < 10000)
+  {
+    a = a.GetNext(global, &apiWrapper, NULL);
+    b = b.GetNext(global, &apiWrapper, NULL);
+    steps++;
+
+    identical &= a.nextInstruction == b.nextInstruction;
+    identical &= a.modified == b.modified;
+    for(size_t r = 0; r < a.registers.size(); r++)
+    {
+      identical &= a.registers[r].type == b.registers[r].type;
+      identical &= memcmp(a.registers[r].value.uv, b.registers[r].value.uv,
+                          sizeof(uint32_t) * 4) == 0;
+    }
+    for(size_t t = 0; t < a.indexableTemps[0].members.size(); t++)
+      identical &= memcmp(a.indexableTemps[0].members[t].value.uv,
+                          b.indexableTemps[0].members[t].value.uv, sizeof(uint32_t) * 4) == 0;
+  }
+
+  CHECK(identical);
+  CHECK(a.Finished());
+  CHECK(b.Finished());
+  CHECK(a.registers[1].value.u.x == N * (N - 1) / 2);
+  for(uint32_t t = 0; t < 8; t++)
+    CHECK(a.indexableTemps[0].members[t].value.u.x == N - 8 + ((t - N) & 7));
+};
+
+// not run by default, run explicitly with the [benchmark] tag
+TEST_CASE("Benchmark DXBC lane group stepping", "[.][benchmark][dxbc]")
+{
+  uint32_t rng = 0x13579bd;
+
+  // a long run of plain ALU work, like the bulk of most shaders
+  const OpcodeType ops[] = {
+      OPCODE_ADD, OPCODE_MUL, OPCODE_MAD, OPCODE_DP4, OPCODE_MIN, OPCODE_MAX,
+      OPCODE_MOV, OPCODE_MOVC, OPCODE_IADD, OPCODE_AND, OPCODE_ISHL, OPCODE_LT,
+  };
+
+  std::vector<uint32_t> body;
+  const uint32_t numInstructions = 256;
+  for(uint32_t i = 0; i < numInstructions; i++)
+  {
+    OpcodeType op = ops[TestRandom(rng) % ARRAY_COUNT(ops)];
+    uint32_t numOperands = 3;
+    if(op == OPCODE_MOV)
+      numOperands = 2;
+    else if(op == OPCODE_MAD || op == OPCODE_MOVC)
+      numOperands = 4;
+    EncodeTestInstruction(body, rng, op, numOperands);
+  }
+
+  std::vector<uint32_t> tokens = EncodeTestProgram(body);
+
+  Program prog((const byte *)tokens.data(), tokens.size() * sizeof(uint32_t));
+  delete prog.GuessReflection();
+  DecodedProgram decoded(&prog, NULL);
+
+  RegisterOnlyAPIWrapper apiWrapper;
+  GlobalState global;
+  ShaderDebugTrace trace;
+
+  for(size_t numLanes : {(size_t)4, (size_t)64, (size_t)1024})
+  {
+    std::vector<State> initial(numLanes);
+    for(size_t l = 0; l < numLanes; l++)
+    {
+      initial[l] = State((int)l, &trace, &decoded);
+      initial[l].Init();
+      RandomiseTestRegisters(initial[l], rng);
+    }
+
+    // step roughly the same total number of instructions at every group size
+    const size_t repeats = RDCMAX((size_t)1, 4096 / numLanes);
+
+    std::vector<State> scalar, batched;
+    double scalarMS = 0.0, batchedMS = 0.0;
+
+    rdcarray<bool> active;
+    active.resize(numLanes);
+    for(size_t l = 0; l < numLanes; l++)
+      active[l] = true;
+
+    for(size_t r = 0; r < repeats; r++)
+    {
+      scalar = initial;
+
+      PerformanceTimer timer;
+      for(State &s : scalar)
+        while(!s.Finished())
+          s.StepNext(global, &apiWrapper, NULL);
+      scalarMS += timer.GetMilliseconds();
+
+      batched = initial;
+
+      timer.Restart();
+      LaneGroup group(&decoded, false);
+      while(!batched[0].Finished())
+        group.Step(global, &apiWrapper, batched.data(), numLanes, active.data());
+      batchedMS += timer.GetMilliseconds();
+    }
+
+    bool identical = true;
+    for(size_t l = 0; l < numLanes; l++)
+      for(size_t i = 0; i < scalar[l].registers.size(); i++)
+        identical &= memcmp(scalar[l].registers[i].value.uv, batched[l].registers[i].value.uv,
+                            sizeof(uint32_t) * 4) == 0;
+    CHECK(identical);
+
+    const double steps = double(repeats * numLanes * (numInstructions + 1));
+
+    RDCLOG("%u lanes: %.2f M steps/s per-lane, %.2f M steps/s lane group (%.2fx)",
+           (uint32_t)numLanes, steps / (scalarMS * 1000.0), steps / (batchedMS * 1000.0),
+           scalarMS / batchedMS);
+  }
+}
+
+// not run by default, run explicitly with the [benchmark] tag
+TEST_CASE("Benchmark DXBC relative operand decoding", "[.][benchmark][dxbc]")
+{
+  const uint32_t N = 20000;
+  std::vector<uint32_t> tokens = EncodeLoopTestProgram(N);
+
+  Program prog((const byte *)tokens.data(), tokens.size() * sizeof(uint32_t));
+  delete prog.GuessReflection();
+
+  DecodedProgram decoded(&prog, NULL);
+  DecodedProgram undecoded(&prog, NULL, false);
+
+  RegisterOnlyAPIWrapper apiWrapper;
+  GlobalState global;
+  ShaderDebugTrace trace;
+
+  double ms[2] = {};
+  uint32_t steps = 0;
+  uint32_t sums[2] = {};
+
+  for(int i = 0; i < 2; i++)
+  {
+    State s(0, &trace, i == 0 ? &undecoded : &decoded);
+    s.Init();
+
+    steps = 0;
+
+    PerformanceTimer timer;
+    while(!s.Finished())
+    {
+      s.StepNext(global, &apiWrapper, NULL);
+      steps++;
+    }
+    ms[i] = timer.GetMilliseconds();
+
+    sums[i] = s.registers[1].value.u.x;
+  }
+
+  CHECK(sums[0] == sums[1]);
+
+  RDCLOG("%u steps: %.2f M steps/s decoding relative operands on access, %.2f M steps/s "
+         "decoded up front (%.2fx)",
+         steps, steps / (ms[0] * 1000.0), steps / (ms[1] * 1000.0), ms[0] / ms[1]);
+}
+
 #endif    // ENABLED(ENABLE_UNIT_TESTS)
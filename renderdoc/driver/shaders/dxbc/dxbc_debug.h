@@ -37,7 +37,10 @@ struct CBufferVariable;
 }
 
 class WrappedID3D11Device;
+
+#if ENABLED(RDOC_WIN32)
 enum DXGI_FORMAT;
+#endif
 
 namespace ShaderDebug
 {
@@ -188,7 +191,9 @@ void FlattenVariables(const rdcarray<ShaderConstant> &constants,
 void FlattenVariables(const rdcarray<ShaderConstant> &constants,
                       const rdcarray<ShaderVariable> &invars, rdcarray<ShaderVariable> &outvars);
 
+#if ENABLED(RDOC_WIN32)
 void FillViewFmt(DXGI_FORMAT format, GlobalState::ViewFmt &viewFmt);
+#endif
 
 void LookupSRVFormatFromShaderReflection(const DXBC::Reflection &reflection,
                                          uint32_t shaderRegister, GlobalState::ViewFmt &viewFmt);
@@ -205,13 +210,13 @@ struct SampleGatherResourceData
   DXBCBytecode::ResourceDimension dim;
   DXBC::ResourceRetType retType;
   int sampleCount;
-  UINT slot;
+  uint32_t slot;
 };
 
 struct SampleGatherSamplerData
 {
   DXBCBytecode::SamplerMode mode;
-  UINT slot;
+  uint32_t slot;
   float bias;
 };
 
@@ -234,11 +239,11 @@ public:
                                       ShaderVariable &output1, ShaderVariable &output2) = 0;
 
   virtual ShaderVariable GetSampleInfo(DXBCBytecode::OperandType type, bool isAbsoluteResource,
-                                       UINT slot, const char *opString) = 0;
+                                       uint32_t slot, const char *opString) = 0;
 
-  virtual ShaderVariable GetBufferInfo(DXBCBytecode::OperandType type, UINT slot,
+  virtual ShaderVariable GetBufferInfo(DXBCBytecode::OperandType type, uint32_t slot,
                                        const char *opString) = 0;
-  virtual ShaderVariable GetResourceInfo(DXBCBytecode::OperandType type, UINT slot,
+  virtual ShaderVariable GetResourceInfo(DXBCBytecode::OperandType type, uint32_t slot,
                                          uint32_t mipLevel, int &dim) = 0;
 
   virtual bool CalculateSampleGather(DXBCBytecode::OpcodeType opcode,
@@ -251,8 +256,83 @@ public:
                                      ShaderVariable &output) = 0;
 };
 
+VarType OperationType(const DXBCBytecode::OpcodeType &op);
+bool OperationFlushing(const DXBCBytecode::OpcodeType &op);
+
+// an operand with everything that only depends on the bytecode worked out once, so stepping doesn't
+// have to walk the operand's structure each time it's read or written.
+struct DecodedOperand
+{
+  DecodedOperand() = default;
+  DecodedOperand(const DXBCBytecode::Operand &oper, const DXBC::Reflection *reflection);
+
+  const DXBCBytecode::Operand *operand = NULL;
+
+  // the absolute part of each index. Relative indices still need the register value added on
+  uint32_t indices[4] = {};
+  // bitmask of which indices are relative
+  uint32_t relativeIndices = 0;
+  // for each relative index, where the operand it adds on is in the operation's relativeOperands.
+  // NoRelativeOperand if it wasn't decoded up front, so it must be decoded on every access
+  static const uint8_t NoRelativeOperand = 0xff;
+  uint8_t relativeOperands[4] = {NoRelativeOperand, NoRelativeOperand, NoRelativeOperand,
+                                 NoRelativeOperand};
+
+  // for constant buffer reads with a non-relative buffer index, the index of the constant buffer
+  // in the reflection's list. -1 if not found or it needs to be looked up on access
+  int32_t cbuffer = -1;
+
+  // the swizzle with unused components selecting themselves
+  uint8_t swizzle[4] = {0, 1, 2, 3};
+  // if only one component is selected, so reads are scalar and writes go from the first component
+  bool scalar = false;
+
+  bool abs = false;
+  bool neg = false;
+};
+
+struct DecodedOperation
+{
+  const DXBCBytecode::Operation *operation = NULL;
+
+  // the results of OperationType() and OperationFlushing() for this operation
+  VarType type = VarType::Float;
+  bool flushing = false;
+
+  std::vector<DecodedOperand> operands;
+  // the operands used by relative indices, including any nested inside other relative indices
+  std::vector<DecodedOperand> relativeOperands;
+};
+
+// the program lowered once for debugging, with one DecodedOperation per instruction. This is shared
+// by every state debugging the same program and must outlive them.
+class DecodedProgram
+{
+public:
+  // the operands of relative indices are decoded up front unless decodeRelative is false, which is
+  // only useful to compare against.
+  DecodedProgram(const DXBCBytecode::Program *program, const DXBC::Reflection *reflection,
+                 bool decodeRelative = true);
+
+  const DXBCBytecode::Program *GetProgram() const { return m_Program; }
+  const DXBC::Reflection *GetReflection() const { return m_Reflection; }
+  size_t GetNumOperations() const { return m_Operations.size(); }
+  const DecodedOperation &GetOperation(size_t i) const { return m_Operations[i]; }
+  // the dimensions from dcl_thread_group, or 0 if there isn't one
+  const uint32_t *GetThreadGroupSize() const { return m_ThreadGroupSize; }
+private:
+  const DXBCBytecode::Program *m_Program;
+  const DXBC::Reflection *m_Reflection;
+  std::vector<DecodedOperation> m_Operations;
+  uint32_t m_ThreadGroupSize[3] = {};
+};
+
+class LaneGroup;
+
 class State : public ShaderDebugState
 {
+  friend class LaneGroup;
+
 public:
   State()
   {
@@ -261,20 +341,21 @@ public:
     flags = ShaderEvents::NoEvent;
     done = false;
     trace = NULL;
+    reflection = NULL;
     program = NULL;
-    program = NULL;
+    decoded = NULL;
     RDCEraseEl(semantics);
   }
-  State(int quadIdx, const ShaderDebugTrace *t, const DXBC::Reflection *r,
-        const DXBCBytecode::Program *p)
+  State(int quadIdx, const ShaderDebugTrace *t, const DecodedProgram *d)
   {
     quadIndex = quadIdx;
     nextInstruction = 0;
     flags = ShaderEvents::NoEvent;
     done = false;
     trace = t;
-    reflection = r;
-    program = p;
+    decoded = d;
+    reflection = d->GetReflection();
+    program = d->GetProgram();
     RDCEraseEl(semantics);
   }
 
@@ -298,6 +379,8 @@ public:
   bool Finished() const;
 
   State GetNext(GlobalState &global, DebugAPIWrapper *apiWrapper, State quad[4]) const;
+  // as GetNext, but executes the instruction in place rather than returning a modified copy
+  void StepNext(GlobalState &global, DebugAPIWrapper *apiWrapper, State quad[4]);
 
 private:
   // index in the pixel quad
@@ -310,30 +393,95 @@ private:
                    uint32_t srcIndex, bool flushDenorm);
   // sets the destination operand by looking up in the register
   // file and applying any masking or swizzling
-  void SetDst(const DXBCBytecode::Operand &dstoper, const DXBCBytecode::Operation &op,
-              const ShaderVariable &val);
+  void SetDst(const DecodedOperand &dstoper, const DecodedOperation &op, const ShaderVariable &val);
 
   // retrieves the value of the operand, by looking up
   // in the register file and performing any swizzling and
   // negation/abs functions
-  ShaderVariable GetSrc(const DXBCBytecode::Operand &oper, const DXBCBytecode::Operation &op,
+  ShaderVariable GetSrc(const DecodedOperand &oper, const DecodedOperation &op,
                         bool allowFlushing = true) const;
 
-  ShaderVariable DDX(bool fine, State quad[4], const DXBCBytecode::Operand &oper,
-                     const DXBCBytecode::Operation &op) const;
-  ShaderVariable DDY(bool fine, State quad[4], const DXBCBytecode::Operand &oper,
-                     const DXBCBytecode::Operation &op) const;
+  // resolves any relative indices in the operand
+  void GetIndices(const DecodedOperand &oper, const DecodedOperation &op,
+                  uint32_t indices[4]) const;
 
-  VarType OperationType(const DXBCBytecode::OpcodeType &op) const;
-  bool OperationFlushing(const DXBCBytecode::OpcodeType &op) const;
+  ShaderVariable DDX(bool fine, State quad[4], const DecodedOperand &oper,
+                     const DecodedOperation &op) const;
+  ShaderVariable DDY(bool fine, State quad[4], const DecodedOperand &oper,
+                     const DecodedOperation &op) const;
 
   const DXBC::Reflection *reflection;
   const DXBCBytecode::Program *program;
+  const DecodedProgram *decoded;
   const ShaderDebugTrace *trace;
 };
 
+// Steps several lanes of the same program together - a pixel quad, or a whole compute thread group.
+// Lanes that are converged on a plain ALU instruction are executed as one batch, with operands
+// gathered into SoA arrays and the arithmetic done with vector instructions across the lanes.
+// Anything else falls back to State::GetNext for each lane. The arithmetic itself is shared with
+// State::GetNext, so the results are bit-identical to stepping every lane individually.
+class LaneGroup
+{
+public:
+  // how many lanes' worth of SoA data are processed at once
+  static const size_t LaneBlock = 16;
+
+  // per-component arrays of each lane's value, so each operation is a flat loop over the lanes
+  union LaneData
+  {
+    uint32_t u[4][LaneBlock];
+    int32_t i[4][LaneBlock];
+    float f[4][LaneBlock];
+  };
+
+  LaneGroup(const DecodedProgram *program, bool pixelQuad)
+      : m_Program(program), m_PixelQuad(pixelQuad)
+  {
+  }
+
+  // steps every lane that is set in activeMask by one instruction. For a pixel quad there must be
+  // exactly 4 lanes, as derivatives read from the neighbouring lanes. Otherwise the lanes are
+  // treated as one thread group, and a lane at a thread sync waits until every lane that hasn't
+  // finished has reached one.
+  void Step(GlobalState &global, DebugAPIWrapper *apiWrapper, State *lanes, size_t numLanes,
+            const bool *activeMask);
+
+  // whether the given lane was stepped by the last call to Step, rather than waiting at a sync
+  bool WasStepped(size_t lane) const { return lane < m_Stepped.size() && m_Stepped[lane]; }
+
+  static bool IsVectorisable(const DXBCBytecode::Operation &op);
+
+  // runs a vectorisable operation on count lanes of data, with src holding one entry for each of up
+  // to three sources. Lanes past count up to the next multiple of 4 are computed too, so they must
+  // be initialised. Returns the type of the result,
+  // except for a mov where each lane keeps the type of its source.
+  static VarType Execute(const DecodedOperation &op, const LaneData *src, uint32_t columns,
+                         size_t count, LaneData &dst);
+
+private:
+  void ExecuteBatch(DebugAPIWrapper *apiWrapper, const DecodedOperation &op, State *lanes,
+                    const uint32_t *laneIndices, size_t count);
+
+  // reads a source operand for every lane in the batch straight from the register file, applying
+  // modifiers across all lanes at once. Returns false if the operand has to go through GetSrc.
+  bool Gather(const DecodedOperand &oper, const DecodedOperation &op, const State *lanes,
+              const uint32_t *laneIndices, size_t count, LaneData &data, VarType *types) const;
+
+  bool AtThreadSync(const State &lane) const;
+
+  const DecodedProgram *m_Program;
+  bool m_PixelQuad;
+
+  std::vector<State> m_Snapshot;
+  std::vector<uint32_t> m_Batch;
+  std::vector<bool> m_Stepped;
+  std::vector<bool> m_Batched;
+};
+
 void CreateShaderDebugStateAndTrace(ShaderDebug::State &initialState, ShaderDebugTrace &trace,
                                     int quadIdx, DXBC::DXBCContainer *dxbc,
-                                    const ShaderReflection &refl, bytebuf *cbufData);
+                                    const DecodedProgram *decoded, const ShaderReflection &refl,
+                                    bytebuf *cbufData);
 
 };    // namespace ShaderDebug
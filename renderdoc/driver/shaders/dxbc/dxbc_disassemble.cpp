@@ -43,10 +43,9 @@ class MaskedElement
 public:
   static T Get(uint32_t token)
   {
-    unsigned long shift = 0;
-    unsigned long mask = M;
-    byte hasBit = _BitScanForward(&shift, mask);
-    RDCASSERT(hasBit != 0);
+    const uint32_t mask = M;
+    RDCCOMPILE_ASSERT(M != 0, "Mask must have at least one bit set");
+    const uint32_t shift = Bits::CountTrailingZeroes(mask);
 
     T ret = (T)((token & mask) >> shift);
 
@@ -61,10 +60,9 @@ class MaskedElement<bool, M>
 public:
   static bool Get(uint32_t token)
   {
-    unsigned long shift = 0;
-    unsigned long mask = M;
-    byte hasBit = _BitScanForward(&shift, mask);
-    RDCASSERT(hasBit != 0);
+    const uint32_t mask = M;
+    RDCCOMPILE_ASSERT(M != 0, "Mask must have at least one bit set");
+    const uint32_t shift = Bits::CountTrailingZeroes(mask);
 
     bool ret = ((token & mask) >> shift) != 0;
 
@@ -251,12 +249,12 @@ static MaskedElement<bool, 0x00020000> NonUniform;
 
 size_t NumOperands(OpcodeType op);
 std::string toString(const uint32_t values[], uint32_t numComps);
-char *toString(OpcodeType op);
-char *toString(ResourceDimension dim);
-char *toString(DXBC::ResourceRetType type);
-char *toString(ResinfoRetType type);
-char *toString(InterpolationMode type);
-char *SystemValueToString(DXBC::SVSemantic type);
+const char *toString(OpcodeType op);
+const char *toString(ResourceDimension dim);
+const char *toString(DXBC::ResourceRetType type);
+const char *toString(ResinfoRetType type);
+const char *toString(InterpolationMode type);
+const char *SystemValueToString(DXBC::SVSemantic type);
 bool IsDeclaration(OpcodeType op);
 
 bool Operand::operator==(const Operand &o) const
@@ -363,6 +361,7 @@ void Program::FetchComputeProperties(DXBC::Reflection *reflection)
           param.semanticIdxName = param.semanticName = "vThreadIDInGroupFlattened";
           reflection->InputSig.push_back(param);
           break;
+        default: break;
       }
     }
 
@@ -2668,7 +2667,7 @@ std::string toString(const uint32_t values[], uint32_t numComps)
   return str;
 }
 
-char *toString(OpcodeType op)
+const char *toString(OpcodeType op)
 {
   switch(op)
   {
@@ -2917,7 +2916,7 @@ char *toString(OpcodeType op)
   return "";
 }
 
-char *toString(ResourceDimension dim)
+const char *toString(ResourceDimension dim)
 {
   switch(dim)
   {
@@ -2941,7 +2940,7 @@ char *toString(ResourceDimension dim)
   return "";
 }
 
-char *toString(DXBC::ResourceRetType type)
+const char *toString(DXBC::ResourceRetType type)
 {
   switch(type)
   {
@@ -2961,7 +2960,7 @@ char *toString(DXBC::ResourceRetType type)
   return "";
 }
 
-char *toString(ResinfoRetType type)
+const char *toString(ResinfoRetType type)
 {
   switch(type)
   {
@@ -2975,7 +2974,7 @@ char *toString(ResinfoRetType type)
   return "";
 }
 
-char *toString(InterpolationMode interp)
+const char *toString(InterpolationMode interp)
 {
   switch(interp)
   {
@@ -2994,7 +2993,7 @@ char *toString(InterpolationMode interp)
   return "";
 }
 
-char *SystemValueToString(DXBC::SVSemantic name)
+const char *SystemValueToString(DXBC::SVSemantic name)
 {
   switch(name)
   {
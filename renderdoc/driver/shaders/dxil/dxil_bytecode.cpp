@@ -425,6 +425,7 @@ static std::string getName(uint32_t parentBlock, const LLVMBC::BlockOrRecord &bl
         }
         break;
       }
+      default: break;
     }
   }
 
@@ -510,6 +511,14 @@ static void dumpBlock(const LLVMBC::BlockOrRecord &block, int indent)
 {
   std::string line(indent, ' ');
 
+  if(block.lazy)
+  {
+    line += StringFormat::Fmt("<%s NumWords=%u (not decoded)/>", getName(0, block).c_str(),
+                              block.blockDwordLength);
+    RDCLOG("%s", line.c_str());
+    return;
+  }
+
   if(block.children.empty() || KnownBlocks(block.id) == KnownBlocks::BLOCKINFO)
   {
     line += StringFormat::Fmt("<%s/>", getName(0, block).c_str());
@@ -542,15 +551,30 @@ Program::Program(const byte *bytes, size_t length)
   const byte *bitcode = ((const byte *)&header->DxilMagic) + header->BitcodeOffset;
   RDCASSERT(bitcode + header->BitcodeSize == ptr + length);
 
-  LLVMBC::BitcodeReader reader(bitcode, header->BitcodeSize);
+  m_Bitcode.assign(bitcode, header->BitcodeSize);
+
+  m_Reader = new LLVMBC::BitcodeReader(m_Bitcode.data(), m_Bitcode.size());
+
+  // nothing we reflect needs the function bodies, which are the bulk of a large library, so only
+  // index them for now. They're decoded if they're fetched with GetFunctionBlock.
+  m_Reader->SetLazyBlock(uint32_t(KnownBlocks::FUNCTION_BLOCK));
 
-  LLVMBC::BlockOrRecord root = reader.ReadToplevelBlock();
+  m_Root = new LLVMBC::BlockOrRecord(m_Reader->ReadToplevelBlock());
+
+  const LLVMBC::BlockOrRecord &root = *m_Root;
 
   // the top-level block should be MODULE_BLOCK
   RDCASSERT(KnownBlocks(root.id) == KnownBlocks::MODULE_BLOCK);
 
   // we should have consumed all bits, only one top-level block
-  RDCASSERT(reader.AtEndOfStream());
+  RDCASSERT(m_Reader->AtEndOfStream());
+
+  for(size_t i = 0; i < root.children.size(); i++)
+  {
+    const LLVMBC::BlockOrRecord &block = root.children[i];
+    if(block.IsBlock() && KnownBlocks(block.id) == KnownBlocks::FUNCTION_BLOCK)
+      m_FunctionBlocks.push_back(i);
+  }
 
   m_Type = DXBC::ShaderType(header->ProgramType);
   m_Major = (header->ProgramVersion & 0xf0) >> 4;
@@ -758,6 +782,22 @@ Program::Program(const byte *bytes, size_t length)
   dumpBlock(root, 0);
 }
 
+Program::~Program()
+{
+  SAFE_DELETE(m_Root);
+  SAFE_DELETE(m_Reader);
+}
+
+const LLVMBC::BlockOrRecord &Program::GetFunctionBlock(size_t idx)
+{
+  LLVMBC::BlockOrRecord &block = m_Root->children[m_FunctionBlocks[idx]];
+
+  if(block.lazy)
+    m_Reader->ReadLazyBlock(block);
+
+  return block;
+}
+
 void Program::FetchComputeProperties(DXBC::Reflection *reflection)
 {
   RDCERR("Unimplemented DXIL::Program::FetchComputeProperties()");
@@ -26,15 +26,21 @@
 
 #include <stdint.h>
 
-#include "driver/dx/official/d3dcommon.h"
 #include "driver/shaders/dxbc/dxbc_common.h"
 
+namespace LLVMBC
+{
+struct BlockOrRecord;
+class BitcodeReader;
+};
+
 namespace DXIL
 {
 class Program
 {
 public:
   Program(const byte *bytes, size_t length);
+  ~Program();
 
   void FetchComputeProperties(DXBC::Reflection *reflection);
   DXBC::Reflection *GetReflection();
@@ -43,6 +49,11 @@ public:
   uint32_t GetMajorVersion() { return m_Major; }
   uint32_t GetMinorVersion() { return m_Minor; }
   D3D_PRIMITIVE_TOPOLOGY GetOutputTopology();
+
+  // function bodies are only indexed when the program is created. Fetching one decodes it the
+  // first time.
+  size_t GetNumFunctionBlocks() const { return m_FunctionBlocks.size(); }
+  const LLVMBC::BlockOrRecord &GetFunctionBlock(size_t idx);
   const std::string &GetDisassembly()
   {
     if(m_Disassembly.empty())
@@ -51,6 +62,9 @@ public:
   }
 
 private:
+  Program(const Program &) = delete;
+  Program &operator=(const Program &) = delete;
+
   void MakeDisassemblyString();
 
   DXBC::ShaderType m_Type;
@@ -58,6 +72,13 @@ private:
 
   rdcstr m_Triple, m_Datalayout;
 
+  // our own copy of the bitcode, which the reader and any blobs in the blocks point into
+  bytebuf m_Bitcode;
+  LLVMBC::BitcodeReader *m_Reader = NULL;
+  LLVMBC::BlockOrRecord *m_Root = NULL;
+  // the indices in m_Root's children of each FUNCTION_BLOCK
+  rdcarray<size_t> m_FunctionBlocks;
+
   std::string m_Disassembly;
 };
 
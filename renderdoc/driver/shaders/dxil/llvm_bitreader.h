@@ -52,8 +52,7 @@ public:
   }
   char c6()
   {
-    byte c = 0;
-    ReadBits(6, &c);
+    byte c = fixed<byte>(6);
 
     if(c >= 0 && c <= 25)
       return char('a' + c);
@@ -78,6 +77,21 @@ public:
 
     RDCASSERT(bitWidth <= 64);
 
+    // fast path, if the whole value is inside the next 64-bit window we can shift and mask it out
+    // directly instead of assembling it byte by byte.
+    uint64_t window;
+    if(m_Offset + bitWidth <= 64 && PeekWindow(window))
+    {
+      if(bitWidth < 64)
+        window &= (1ULL << bitWidth) - 1;
+
+      Skip(bitWidth);
+
+      T ret;
+      memcpy(&ret, &window, sizeof(T));
+      return ret;
+    }
+
     ReadBits(bitWidth, scratch);
 
     T ret;
@@ -98,6 +112,38 @@ public:
     const byte lobits = hibit - 1;
 
     uint64_t shift = 0;
+
+    // fast path, decode as many groups as fit in the next 64-bit window without going back to
+    // memory. Most values are a couple of groups, so they're decoded entirely here.
+    uint64_t window;
+    if(PeekWindow(window))
+    {
+      const uint64_t groupMask = (1ULL << groupBitSize) - 1;
+      size_t consumed = 0;
+
+      while(m_Offset + consumed + groupBitSize <= 64)
+      {
+        scratch = byte(window & groupMask);
+        window >>= groupBitSize;
+        consumed += groupBitSize;
+
+        RDCASSERT(shift <= 63);
+
+        ret += (uint64_t(scratch & lobits) << shift);
+
+        shift += uint64_t(groupBitSize - 1);
+
+        if((scratch & hibit) == 0)
+        {
+          Skip(consumed);
+          return CheckVBRRange<T>(ret);
+        }
+      }
+
+      // the value continues past the window, skip what we read and continue below
+      Skip(consumed);
+    }
+
     do
     {
       ReadBits(groupBitSize, &scratch);
@@ -109,11 +155,7 @@ public:
       shift += uint64_t(groupBitSize - 1);
     } while(scratch & hibit);
 
-    // check for overflow of the return type
-    const uint64_t mask = ((1ULL << (sizeof(T) * 8 - 1)) - 1) << 1 | 1;
-    RDCASSERT((ret & mask) == ret);
-
-    return T(ret);
+    return CheckVBRRange<T>(ret);
   }
 
   template <typename T>
@@ -179,6 +221,36 @@ private:
   const byte *m_Bits, *m_Start, *m_End;
   size_t m_Offset;
 
+  // fetch the next 64 bits of the stream, shifted down so the current bit is the LSB. Only the top
+  // m_Offset bits are invalid (zero). Fails if there aren't 8 whole bytes left in the stream.
+  bool PeekWindow(uint64_t &window) const
+  {
+    if(m_End - m_Bits < (ptrdiff_t)sizeof(uint64_t))
+      return false;
+
+    memcpy(&window, m_Bits, sizeof(uint64_t));
+    window >>= m_Offset;
+    return true;
+  }
+
+  // skip any number of bits, which must already have been bounds checked
+  void Skip(size_t N)
+  {
+    m_Offset += N;
+    m_Bits += m_Offset / 8;
+    m_Offset %= 8;
+  }
+
+  template <typename T>
+  static T CheckVBRRange(uint64_t ret)
+  {
+    // check for overflow of the return type
+    const uint64_t mask = ((1ULL << (sizeof(T) * 8 - 1)) - 1) << 1 | 1;
+    RDCASSERT((ret & mask) == ret);
+
+    return T(ret);
+  }
+
   void Advance(size_t N)
   {
     m_Offset += N;
@@ -107,6 +107,25 @@ BlockOrRecord BitcodeReader::ReadToplevelBlock()
   return ret;
 }
 
+void BitcodeReader::ReadLazyBlock(BlockOrRecord &block)
+{
+  if(!block.lazy)
+    return;
+
+  const size_t resumeOffset = b.BitOffset();
+  const size_t blockOffset = block.bitOffset;
+
+  // blocks don't inherit abbrevs from their parents, only from BLOCKINFO which we've already read,
+  // so with an empty stack this decodes exactly as it would have in place.
+  RDCASSERT(blockStack.empty());
+
+  block = BlockOrRecord();
+  b.SeekBit(blockOffset);
+  ReadBlockContents(block);
+
+  b.SeekBit(resumeOffset);
+}
+
 bool BitcodeReader::AtEndOfStream()
 {
   return b.AtEndOfStream();
@@ -114,6 +133,7 @@ bool BitcodeReader::AtEndOfStream()
 
 void BitcodeReader::ReadBlockContents(BlockOrRecord &block)
 {
+  block.bitOffset = b.BitOffset();
   block.id = b.vbr<uint32_t>(8);
 
   blockStack.push_back(new BlockContext(b.vbr<size_t>(4)));
@@ -121,6 +141,25 @@ void BitcodeReader::ReadBlockContents(BlockOrRecord &block)
   b.align32bits();
   block.blockDwordLength = b.Read<uint32_t>();
 
+  // the top-level block is never skipped, and neither is a lazy block we're now decoding
+  if(blockStack.size() > 1 && lazyBlocks.contains(block.id))
+  {
+    size_t endOffset = b.ByteOffset() + block.blockDwordLength * sizeof(uint32_t);
+
+    if(endOffset > b.ByteLength())
+    {
+      RDCERR("Block %u runs off the end of the bitstream", block.id);
+      endOffset = b.ByteLength();
+    }
+
+    block.lazy = true;
+    b.SeekByte(endOffset);
+
+    delete blockStack.back();
+    blockStack.erase(blockStack.size() - 1);
+    return;
+  }
+
   // used for blockinfo only
   BlockInfo *curBlockInfo = NULL;
 
@@ -135,11 +174,10 @@ void BitcodeReader::ReadBlockContents(BlockOrRecord &block)
     }
     else if(abbrevID == ENTER_SUBBLOCK)
     {
-      BlockOrRecord sub;
+      // decode in place rather than copying the whole sub-tree in afterwards
+      block.children.push_back(BlockOrRecord());
 
-      ReadBlockContents(sub);
-
-      block.children.push_back(sub);
+      ReadBlockContents(block.children.back());
     }
     else if(abbrevID == DEFINE_ABBREV)
     {
@@ -178,7 +216,9 @@ void BitcodeReader::ReadBlockContents(BlockOrRecord &block)
     }
     else if(abbrevID == UNABBREV_RECORD)
     {
-      BlockOrRecord r;
+      block.children.push_back(BlockOrRecord());
+      BlockOrRecord &r = block.children.back();
+
       r.id = b.vbr<uint32_t>(6);
       uint32_t numops = b.vbr<uint32_t>(6);
       r.ops.resize(numops);
@@ -220,14 +260,13 @@ void BitcodeReader::ReadBlockContents(BlockOrRecord &block)
           }
         }
       }
-
-      block.children.push_back(r);
     }
     else
     {
       const AbbrevDesc &a = getAbbrev(block.id, abbrevID);
 
-      BlockOrRecord r;
+      block.children.push_back(BlockOrRecord());
+      BlockOrRecord &r = block.children.back();
 
       // should have at least one param for the code itself
       RDCASSERT(!a.params.empty());
@@ -268,8 +307,6 @@ void BitcodeReader::ReadBlockContents(BlockOrRecord &block)
           r.ops.push_back(decodeAbbrevParam(param));
         }
       }
-
-      block.children.push_back(r);
     }
   } while(abbrevID != END_BLOCK);
 
@@ -338,7 +375,74 @@ rdcstr BlockOrRecord::getString(size_t startOffset) const
 
 #if ENABLED(ENABLE_UNIT_TESTS)
 
+#include <functional>
 #include "3rdparty/catch/catch.hpp"
+#include "dxil_bytecode.h"
+
+// naive bit-at-a-time writer to generate streams to read back
+struct TestBitWriter
+{
+  bytebuf bytes;
+  size_t bit = 0;
+
+  void fixed(uint64_t val, size_t width)
+  {
+    for(size_t i = 0; i < width; i++, bit++)
+    {
+      if(bit / 8 >= bytes.size())
+        bytes.push_back(0);
+      bytes[bit / 8] |= byte(((val >> i) & 1) << (bit % 8));
+    }
+  }
+
+  void vbr(uint64_t val, size_t width)
+  {
+    const uint64_t hibit = 1ULL << (width - 1);
+    do
+    {
+      uint64_t chunk = val & (hibit - 1);
+      val >>= width - 1;
+      if(val)
+        chunk |= hibit;
+      fixed(chunk, width);
+    } while(val);
+  }
+
+  void align32()
+  {
+    while(bit % 32)
+      fixed(0, 1);
+  }
+
+  // begins a block, returning the word index of its length to pass to endBlock
+  size_t enterBlock(uint32_t id, size_t abbrevWidth, size_t outerWidth)
+  {
+    fixed(1, outerWidth);    // ENTER_SUBBLOCK
+    vbr(id, 8);
+    vbr(abbrevWidth, 4);
+    align32();
+    size_t lengthWord = bit / 32;
+    fixed(0, 32);
+    return lengthWord;
+  }
+
+  void endBlock(size_t lengthWord, size_t width)
+  {
+    fixed(0, width);    // END_BLOCK
+    align32();
+    uint32_t length = uint32_t(bit / 32 - lengthWord - 1);
+    memcpy(&bytes[lengthWord * 4], &length, sizeof(length));
+  }
+
+  void record(uint32_t id, std::initializer_list<uint64_t> ops, size_t width)
+  {
+    fixed(3, width);    // UNABBREV_RECORD
+    vbr(id, 6);
+    vbr(ops.size(), 6);
+    for(uint64_t op : ops)
+      vbr(op, 6);
+  }
+};
 
 TEST_CASE("Check LLVM bitreader", "[llvm]")
 {
@@ -934,6 +1038,255 @@ TEST_CASE("Check LLVM bitreader", "[llvm]")
     CHECK(b.ByteOffset() == sizeof(bits));
     CHECK(b.BitOffset() == sizeof(bits) * 8);
   }
+
+  SECTION("Check word-at-a-time reads")
+  {
+    struct Value
+    {
+      uint64_t val;
+      size_t width;
+      bool vbr;
+    };
+
+    uint64_t seed = 0x2545F4914F6CDD1DULL;
+    auto random = [&seed]() {
+      seed ^= seed << 13;
+      seed ^= seed >> 7;
+      seed ^= seed << 17;
+      return seed;
+    };
+
+    // mix fixed and vbr values of every width, so reads start at every bit offset, span words and
+    // hit the end of the stream where the slow path takes over.
+    rdcarray<Value> values;
+    TestBitWriter w;
+    for(int i = 0; i < 2000; i++)
+    {
+      Value v;
+      v.vbr = (random() % 2) == 0;
+      if(v.vbr)
+      {
+        v.width = size_t(random() % 7) + 2;
+        v.val = random() >> (random() % 64);
+        w.vbr(v.val, v.width);
+      }
+      else
+      {
+        v.width = size_t(random() % 64) + 1;
+        v.val = random();
+        if(v.width < 64)
+          v.val &= (1ULL << v.width) - 1;
+        w.fixed(v.val, v.width);
+      }
+      values.push_back(v);
+    }
+
+    LLVMBC::BitReader b(w.bytes.data(), w.bytes.size());
+
+    size_t mismatches = 0;
+    for(const Value &v : values)
+    {
+      uint64_t val = v.vbr ? b.vbr<uint64_t>(v.width) : b.fixed<uint64_t>(v.width);
+      if(val != v.val)
+        mismatches++;
+    }
+
+    CHECK(mismatches == 0);
+    CHECK(b.BitOffset() == w.bit);
+  }
+}
+
+TEST_CASE("Check LLVM bitcode lazy block decoding", "[llvm]")
+{
+  TestBitWriter w;
+
+  w.fixed(MAKE_FOURCC('B', 'C', 0xC0, 0xDE), 32);
+
+  const uint32_t functionBlock = 12;
+
+  size_t module = w.enterBlock(8, 3, 2);
+  {
+    // BLOCKINFO defining abbrev 4 for function blocks as [literal 7, fixed(4), vbr(6)]
+    size_t blockinfo = w.enterBlock(0, 2, 3);
+    w.record(1, {functionBlock}, 2);
+    w.fixed(2, 2);    // DEFINE_ABBREV
+    w.vbr(3, 5);
+    w.fixed(1, 1);
+    w.vbr(7, 8);
+    w.fixed(0, 1);
+    w.fixed(1, 3);
+    w.vbr(4, 5);
+    w.fixed(0, 1);
+    w.fixed(2, 3);
+    w.vbr(6, 5);
+    w.endBlock(blockinfo, 2);
+
+    w.record(2, {1, 2, 3}, 3);
+
+    size_t func = w.enterBlock(functionBlock, 4, 3);
+    {
+      // block-local abbrev 5 as [literal 9, array of char6]
+      w.fixed(2, 4);
+      w.vbr(3, 5);
+      w.fixed(1, 1);
+      w.vbr(9, 8);
+      w.fixed(0, 1);
+      w.fixed(3, 3);
+      w.fixed(0, 1);
+      w.fixed(4, 3);
+
+      w.fixed(4, 4);
+      w.fixed(0xb, 4);
+      w.vbr(123456, 6);
+
+      w.fixed(5, 4);
+      w.vbr(3, 6);
+      w.fixed(0, 6);
+      w.fixed(1, 6);
+      w.fixed(63, 6);
+
+      w.record(20, {100000}, 4);
+
+      size_t constants = w.enterBlock(11, 3, 4);
+      w.record(1, {5}, 3);
+      w.endBlock(constants, 3);
+    }
+    w.endBlock(func, 4);
+
+    w.record(3, {42}, 3);
+
+    func = w.enterBlock(functionBlock, 3, 3);
+    w.record(21, {7}, 3);
+    w.endBlock(func, 3);
+  }
+  w.endBlock(module, 3);
+
+  std::function<bool(const LLVMBC::BlockOrRecord &, const LLVMBC::BlockOrRecord &)> same =
+      [&same](const LLVMBC::BlockOrRecord &a, const LLVMBC::BlockOrRecord &b) {
+        if(a.id != b.id || a.blockDwordLength != b.blockDwordLength || a.lazy != b.lazy ||
+           a.bitOffset != b.bitOffset || !(a.ops == b.ops) ||
+           a.children.size() != b.children.size())
+          return false;
+
+        for(size_t i = 0; i < a.children.size(); i++)
+          if(!same(a.children[i], b.children[i]))
+            return false;
+
+        return true;
+      };
+
+  LLVMBC::BitcodeReader eager(w.bytes.data(), w.bytes.size());
+  LLVMBC::BlockOrRecord expected = eager.ReadToplevelBlock();
+  CHECK(eager.AtEndOfStream());
+
+  REQUIRE(expected.children.size() == 5);
+
+  const LLVMBC::BlockOrRecord &expectedFunc = expected.children[2];
+  REQUIRE(expectedFunc.children.size() == 4);
+  CHECK(expectedFunc.children[0].id == 7);
+  CHECK((expectedFunc.children[0].ops == rdcarray<uint64_t>({0xb, 123456})));
+  CHECK(expectedFunc.children[1].id == 9);
+  CHECK(expectedFunc.children[1].getString() == "ab_");
+  CHECK(expectedFunc.children[3].IsBlock());
+
+  LLVMBC::BitcodeReader reader(w.bytes.data(), w.bytes.size());
+  reader.SetLazyBlock(functionBlock);
+  LLVMBC::BlockOrRecord root = reader.ReadToplevelBlock();
+  CHECK(reader.AtEndOfStream());
+
+  REQUIRE(root.children.size() == 5);
+
+  // everything outside the function blocks is identical
+  CHECK(same(root.children[0], expected.children[0]));
+  CHECK(same(root.children[1], expected.children[1]));
+  CHECK(same(root.children[3], expected.children[3]));
+
+  for(size_t i : {2, 4})
+  {
+    LLVMBC::BlockOrRecord &func = root.children[i];
+
+    CHECK(func.lazy);
+    CHECK(func.children.empty());
+    CHECK(func.id == functionBlock);
+    CHECK(func.blockDwordLength == expected.children[i].blockDwordLength);
+    CHECK(func.bitOffset == expected.children[i].bitOffset);
+  }
+
+  // decode out of order, to check nothing depends on the stream position
+  reader.ReadLazyBlock(root.children[4]);
+  reader.ReadLazyBlock(root.children[2]);
+
+  CHECK(same(root, expected));
+  CHECK(reader.AtEndOfStream());
+}
+
+TEST_CASE("Check DXIL function blocks are decoded on demand", "[llvm]")
+{
+  TestBitWriter w;
+
+  // DXIL program header, with the bitcode straight after it. The sizes are patched at the end
+  w.fixed(0x60, 16);    // ps_6_0
+  w.fixed(0, 16);
+  w.fixed(0, 32);
+  w.fixed(MAKE_FOURCC('D', 'X', 'I', 'L'), 32);
+  w.fixed(0x100, 32);
+  w.fixed(16, 32);    // bitcode offset from the DXIL magic
+  w.fixed(0, 32);
+
+  const size_t headerSize = w.bytes.size();
+
+  w.fixed(MAKE_FOURCC('B', 'C', 0xC0, 0xDE), 32);
+
+  const uint32_t moduleBlock = 8, functionBlock = 12;
+
+  size_t module = w.enterBlock(moduleBlock, 3, 2);
+  {
+    w.record(1, {1}, 3);
+
+    size_t func = w.enterBlock(functionBlock, 4, 3);
+    w.record(1, {2}, 4);
+    w.record(20, {100000, 5}, 4);
+    w.endBlock(func, 4);
+
+    func = w.enterBlock(functionBlock, 3, 3);
+    w.record(21, {7}, 3);
+    w.endBlock(func, 3);
+  }
+  w.endBlock(module, 3);
+
+  uint32_t sizeInWords = uint32_t(w.bytes.size() / 4);
+  uint32_t bitcodeSize = uint32_t(w.bytes.size() - headerSize);
+  memcpy(&w.bytes[4], &sizeInWords, sizeof(sizeInWords));
+  memcpy(&w.bytes[20], &bitcodeSize, sizeof(bitcodeSize));
+
+  DXIL::Program program(w.bytes.data(), w.bytes.size());
+
+  // the program has its own copy of the bitcode, so the source can go away before the function
+  // bodies are decoded
+  memset(w.bytes.data(), 0xfe, w.bytes.size());
+
+  REQUIRE(program.GetNumFunctionBlocks() == 2);
+
+  // decode out of order, to check nothing depends on the stream position
+  const LLVMBC::BlockOrRecord &second = program.GetFunctionBlock(1);
+  CHECK_FALSE(second.lazy);
+  CHECK(second.id == functionBlock);
+  REQUIRE(second.children.size() == 1);
+  CHECK(second.children[0].id == 21);
+  CHECK((second.children[0].ops == rdcarray<uint64_t>({7})));
+
+  const LLVMBC::BlockOrRecord &first = program.GetFunctionBlock(0);
+  CHECK_FALSE(first.lazy);
+  CHECK(first.id == functionBlock);
+  REQUIRE(first.children.size() == 2);
+  CHECK(first.children[0].id == 1);
+  CHECK((first.children[0].ops == rdcarray<uint64_t>({2})));
+  CHECK(first.children[1].id == 20);
+  CHECK((first.children[1].ops == rdcarray<uint64_t>({100000, 5})));
+
+  // fetching again returns the same decoded block
+  CHECK(&program.GetFunctionBlock(0) == &first);
+  CHECK(program.GetFunctionBlock(0).children.size() == 2);
 }
 
 #endif
@@ -39,6 +39,11 @@ struct BlockOrRecord
   // if a block, the child blocks/records
   rdcarray<BlockOrRecord> children;
 
+  // if a block, the bit offset in the stream of its header (just after the ENTER_SUBBLOCK)
+  size_t bitOffset = 0;
+  // if a block that was skipped over, children is empty until it's decoded with ReadLazyBlock
+  bool lazy = false;
+
   rdcstr getString(size_t startOffset = 0) const;
 
   // if a record, the ops
@@ -59,7 +64,11 @@ class BitcodeReader
 public:
   BitcodeReader(const byte *bitcode, size_t length);
   ~BitcodeReader();
+  // blocks with this ID below the top-level block are only indexed, not decoded, until they are
+  // passed to ReadLazyBlock. The reader must stay alive until then.
+  void SetLazyBlock(uint32_t blockId) { lazyBlocks.push_back(blockId); }
   BlockOrRecord ReadToplevelBlock();
+  void ReadLazyBlock(BlockOrRecord &block);
   bool AtEndOfStream();
 
 private:
@@ -72,6 +81,7 @@ private:
 
   rdcarray<BlockContext *> blockStack;
   std::map<uint32_t, BlockInfo *> blockInfo;
+  rdcarray<uint32_t> lazyBlocks;
 };
 
 };    // namespace LLVMBC
@@ -24,6 +24,7 @@
 
 #include "glslang_compile.h"
 #include "common/common.h"
+#include "common/threading.h"
 
 #undef min
 #undef max
@@ -31,6 +32,9 @@
 #include "3rdparty/glslang/glslang/Include/Types.h"
 #include "3rdparty/glslang/glslang/Public/ShaderLang.h"
 
+// Init() can be called from several threads at once, e.g. while compiling built-in shaders in
+// parallel, so guard process initialisation and the allocation lists.
+static Threading::CriticalSection glslang_lock;
 static bool glslang_inited = false;
 std::vector<glslang::TShader *> *allocatedShaders = NULL;
 std::vector<glslang::TProgram *> *allocatedPrograms = NULL;
@@ -150,18 +154,23 @@ TBuiltInResource *GetDefaultResources()
 
 void rdcspv::Init()
 {
+  SCOPED_LOCK(glslang_lock);
+
   if(!glslang_inited)
   {
     glslang::InitializeProcess();
-    glslang_inited = true;
 
     allocatedPrograms = new std::vector<glslang::TProgram *>;
     allocatedShaders = new std::vector<glslang::TShader *>;
+
+    glslang_inited = true;
   }
 }
 
 void rdcspv::Shutdown()
 {
+  SCOPED_LOCK(glslang_lock);
+
   if(glslang_inited)
   {
     // programs must be deleted before shaders
@@ -178,6 +187,8 @@ void rdcspv::Shutdown()
     SAFE_DELETE(allocatedShaders);
 
     glslang::FinalizeProcess();
+
+    glslang_inited = false;
   }
 }
 
@@ -201,6 +212,7 @@ glslang::TShader *CompileShaderForReflection(rdcspv::ShaderStage stage,
 
   if(success)
   {
+    SCOPED_LOCK(glslang_lock);
     allocatedShaders->push_back(shader);
     return shader;
   }
@@ -227,6 +239,7 @@ glslang::TProgram *LinkProgramForReflection(const std::vector<glslang::TShader *
     program->buildReflection(EShReflectionStrictArraySuffix | EShReflectionBasicArraySuffix |
                              EShReflectionIntermediateIO | EShReflectionSeparateBuffers |
                              EShReflectionAllBlockVariables | EShReflectionUnwrapIOBlocks);
+    SCOPED_LOCK(glslang_lock);
     allocatedPrograms->push_back(program);
     return program;
   }
@@ -108,25 +108,39 @@ void Editor::Prepare()
 
 Editor::~Editor()
 {
+  if(m_Batching)
+    EndBatch();
+
+  // strip out all the nops in one pass. Nothing looks at the offsets after this so we don't need to
+  // update them
+  size_t dst = FirstRealWord;
+
   for(size_t i = FirstRealWord; i < m_SPIRV.size();)
   {
-    while(m_SPIRV[i] == OpNopWord)
+    if(m_SPIRV[i] == OpNopWord)
     {
-      m_SPIRV.erase(m_SPIRV.begin() + i);
-      addWords(i, -1);
+      i++;
+      continue;
     }
 
     uint32_t len = m_SPIRV[i] >> WordCountShift;
 
-    if(len == 0)
+    if(len == 0 || i + len > m_SPIRV.size())
     {
       RDCERR("Malformed SPIR-V");
-      break;
+      // keep the remainder as-is
+      len = uint32_t(m_SPIRV.size() - i);
     }
 
+    if(dst != i)
+      memmove(&m_SPIRV[dst], &m_SPIRV[i], len * sizeof(uint32_t));
+
+    dst += len;
     i += len;
   }
 
+  m_SPIRV.resize(dst);
+
   m_ExternalSPIRV.swap(m_SPIRV);
 }
 
@@ -158,16 +172,16 @@ void Editor::SetName(Id id, const char *name)
   }
 
   op.insertInto(m_SPIRV, it.offs());
-  RegisterOp(Iter(m_SPIRV, it.offs()));
   addWords(it.offs(), op.size());
+  RegisterOp(Iter(m_SPIRV, it.offs()));
 }
 
 void Editor::AddDecoration(const Operation &op)
 {
   size_t offset = m_Sections[Section::Annotations].endOffset;
   op.insertInto(m_SPIRV, offset);
-  RegisterOp(Iter(m_SPIRV, offset));
   addWords(offset, op.size());
+  RegisterOp(Iter(m_SPIRV, offset));
 }
 
 void Editor::AddCapability(Capability cap)
@@ -179,8 +193,8 @@ void Editor::AddCapability(Capability cap)
   // insert the operation at the very start
   Operation op(Op::Capability, {(uint32_t)cap});
   op.insertInto(m_SPIRV, FirstRealWord);
-  RegisterOp(Iter(m_SPIRV, FirstRealWord));
   addWords(FirstRealWord, op.size());
+  RegisterOp(Iter(m_SPIRV, FirstRealWord));
 }
 
 void Editor::AddExtension(const rdcstr &extension)
@@ -203,8 +217,8 @@ void Editor::AddExtension(const rdcstr &extension)
 
   Operation op(Op::Extension, uintName);
   op.insertInto(m_SPIRV, it.offs());
-  RegisterOp(it);
   addWords(it.offs(), op.size());
+  RegisterOp(it);
 }
 
 void Editor::AddExecutionMode(const Operation &mode)
@@ -212,8 +226,8 @@ void Editor::AddExecutionMode(const Operation &mode)
   size_t offset = m_Sections[Section::ExecutionMode].endOffset;
 
   mode.insertInto(m_SPIRV, offset);
-  RegisterOp(Iter(m_SPIRV, offset));
   addWords(offset, mode.size());
+  RegisterOp(Iter(m_SPIRV, offset));
 }
 
 Id Editor::ImportExtInst(const char *setname)
@@ -242,8 +256,8 @@ Id Editor::ImportExtInst(const char *setname)
 
   Operation op(Op::ExtInstImport, uintName);
   op.insertInto(m_SPIRV, it.offs());
-  RegisterOp(it);
   addWords(it.offs(), op.size());
+  RegisterOp(it);
 
   extSets[ret] = setname;
 
@@ -256,8 +270,8 @@ Id Editor::AddType(const Operation &op)
 
   Id id = Id::fromWord(op[1]);
   op.insertInto(m_SPIRV, offset);
-  RegisterOp(Iter(m_SPIRV, offset));
   addWords(offset, op.size());
+  RegisterOp(Iter(m_SPIRV, offset));
   return id;
 }
 
@@ -267,8 +281,8 @@ Id Editor::AddVariable(const Operation &op)
 
   Id id = Id::fromWord(op[2]);
   op.insertInto(m_SPIRV, offset);
-  RegisterOp(Iter(m_SPIRV, offset));
   addWords(offset, op.size());
+  RegisterOp(Iter(m_SPIRV, offset));
   return id;
 }
 
@@ -278,8 +292,8 @@ Id Editor::AddConstant(const Operation &op)
 
   Id id = Id::fromWord(op[2]);
   op.insertInto(m_SPIRV, offset);
-  RegisterOp(Iter(m_SPIRV, offset));
   addWords(offset, op.size());
+  RegisterOp(Iter(m_SPIRV, offset));
   return id;
 }
 
@@ -332,6 +346,17 @@ void Editor::AddOperation(Iter iter, const Operation &op)
   if(!iter)
     return;
 
+  if(m_Batching)
+  {
+    PendingInsert insert = {iter.offs(), m_PendingWords.size(), op.size()};
+
+    for(size_t i = 0; i < op.size(); i++)
+      m_PendingWords.push_back(op[i]);
+
+    m_PendingInserts.push_back(insert);
+    return;
+  }
+
   // add op
   op.insertInto(m_SPIRV, iter.offs());
 
@@ -339,6 +364,70 @@ void Editor::AddOperation(Iter iter, const Operation &op)
   addWords(iter.offs(), op.size());
 }
 
+void Editor::BeginBatch()
+{
+  RDCASSERT(!m_Batching);
+  m_Batching = true;
+}
+
+void Editor::EndBatch()
+{
+  RDCASSERT(m_Batching);
+  m_Batching = false;
+
+  if(m_PendingInserts.empty())
+    return;
+
+  // stable so that inserts at the same offset keep the order they were added in
+  std::stable_sort(
+      m_PendingInserts.begin(), m_PendingInserts.end(),
+      [](const PendingInsert &a, const PendingInsert &b) { return a.offset < b.offset; });
+
+  // insertedBefore[i] is the number of words inserted by the first i inserts
+  std::vector<size_t> insertedBefore;
+  insertedBefore.resize(m_PendingInserts.size() + 1);
+  insertedBefore[0] = 0;
+  for(size_t i = 0; i < m_PendingInserts.size(); i++)
+    insertedBefore[i + 1] = insertedBefore[i] + m_PendingInserts[i].wordCount;
+
+  std::vector<uint32_t> spirv;
+  spirv.reserve(m_SPIRV.size() + insertedBefore.back());
+
+  size_t cursor = 0;
+  for(const PendingInsert &insert : m_PendingInserts)
+  {
+    spirv.insert(spirv.end(), m_SPIRV.begin() + cursor, m_SPIRV.begin() + insert.offset);
+    spirv.insert(spirv.end(), m_PendingWords.begin() + insert.firstWord,
+                 m_PendingWords.begin() + insert.firstWord + insert.wordCount);
+    cursor = insert.offset;
+  }
+  spirv.insert(spirv.end(), m_SPIRV.begin() + cursor, m_SPIRV.end());
+
+  m_SPIRV.swap(spirv);
+
+  // this matches addWords() applied for each insert in turn: anything at or after an insert's
+  // offset moves forward, and inserting at a section's start appends to the previous section.
+  auto shift = [this, &insertedBefore](size_t o) {
+    auto it = std::upper_bound(
+        m_PendingInserts.begin(), m_PendingInserts.end(), o,
+        [](size_t offs, const PendingInsert &insert) { return offs < insert.offset; });
+    return o + insertedBefore[it - m_PendingInserts.begin()];
+  };
+
+  for(LogicalSection &section : m_Sections)
+  {
+    section.startOffset = shift(section.startOffset);
+    section.endOffset = shift(section.endOffset);
+  }
+
+  for(size_t &o : idOffsets)
+    if(o)
+      o = shift(o);
+
+  m_PendingInserts.clear();
+  m_PendingWords.clear();
+}
+
 void Editor::RegisterOp(Iter it)
 {
   Processor::RegisterOp(it);
@@ -498,6 +587,11 @@ void Editor::addWords(size_t offs, int32_t num)
   for(size_t &o : idOffsets)
     if(o >= offs)
       o += num;
+
+  // any queued inserts also refer to offsets in the module
+  for(PendingInsert &insert : m_PendingInserts)
+    if(insert.offset >= offs)
+      insert.offset += num;
 }
 
 Operation Editor::MakeDeclaration(const Scalar &s)
@@ -576,6 +670,7 @@ TYPETABLE(FunctionType, functionTypeToId);
 #if ENABLED(ENABLE_UNIT_TESTS)
 
 #include "3rdparty/catch/catch.hpp"
+#include "common/timing.h"
 #include "core/core.h"
 #include "spirv_common.h"
 #include "spirv_compile.h"
@@ -624,6 +719,181 @@ static void CheckSPIRV(rdcspv::Editor &ed, size_t offsets[rdcspv::Section::Count
   CHECK(ed.GetID(entryId).offs() == ed.Begin(rdcspv::Section::Functions).offs());
 }
 
+static std::vector<uint32_t> CompileArithmeticShader(uint32_t numStatements)
+{
+  rdcspv::CompilationSettings settings;
+  settings.entryPoint = "main";
+  settings.lang = rdcspv::InputLanguage::VulkanGLSL;
+  settings.stage = rdcspv::ShaderStage::Fragment;
+
+  std::string src = R"(#version 450 core
+
+layout(location = 0) out vec4 col;
+
+void main() {
+  vec4 v = gl_FragCoord;
+)";
+
+  for(uint32_t i = 0; i < numStatements; i++)
+    src += StringFormat::Fmt("  v = v * vec4(%u.5) + vec4(%u.25);\n", i, i + 1);
+
+  src += "  col = v;\n}\n";
+
+  std::vector<uint32_t> spirv;
+  std::string errors = rdcspv::Compile(settings, {src}, spirv);
+
+  INFO("SPIR-V compilation - " << errors);
+
+  REQUIRE(spirv.size() > 0);
+
+  return spirv;
+}
+
+// insert a copy of the result after every multiply, either directly or batched. Returns how many
+// were inserted.
+static uint32_t InsertCopiesAfterMultiplies(std::vector<uint32_t> &spirv, bool batch)
+{
+  rdcspv::Editor ed(spirv);
+
+  ed.Prepare();
+
+  if(batch)
+    ed.BeginBatch();
+
+  uint32_t count = 0;
+
+  for(rdcspv::Iter it = ed.Begin(rdcspv::Section::Functions); it; ++it)
+  {
+    if(it.opcode() != rdcspv::Op::FMul)
+      continue;
+
+    rdcspv::OpFMul mul(it);
+
+    rdcspv::Iter next = it;
+    ++next;
+
+    ed.AddOperation(next, rdcspv::OpCopyObject(mul.resultType, ed.MakeId(), mul.result));
+    count++;
+
+    // when inserting directly, skip over the operation we just added
+    if(!batch)
+      it = next;
+  }
+
+  if(batch)
+    ed.EndBatch();
+
+  // every id's offset must still point at the operation declaring it
+  for(rdcspv::Iter it = ed.Begin(rdcspv::Section::Functions); it; ++it)
+  {
+    if(it.opcode() == rdcspv::Op::FMul)
+    {
+      rdcspv::OpFMul mul(it);
+      CHECK(ed.GetID(mul.result).offs() == it.offs());
+    }
+  }
+
+  CHECK(ed.GetID(ed.GetEntries()[0].id).offs() == ed.Begin(rdcspv::Section::Functions).offs());
+
+  return count;
+}
+
+TEST_CASE("Test SPIR-V editor batched insertion", "[spirv]")
+{
+  rdcspv::Init();
+  RenderDoc::Inst().RegisterShutdownFunction(&rdcspv::Shutdown);
+
+  std::vector<uint32_t> direct = CompileArithmeticShader(64);
+  std::vector<uint32_t> batched = direct;
+
+  uint32_t numDirect = InsertCopiesAfterMultiplies(direct, false);
+  uint32_t numBatched = InsertCopiesAfterMultiplies(batched, true);
+
+  CHECK(numDirect == 64);
+  CHECK(numBatched == numDirect);
+
+  // both ways of editing must produce exactly the same module
+  CHECK(direct == batched);
+
+  SECTION("Types added during a batch")
+  {
+    std::vector<uint32_t> spirv = CompileArithmeticShader(4);
+
+    rdcspv::Editor ed(spirv);
+    ed.Prepare();
+    ed.BeginBatch();
+
+    rdcspv::Iter it = ed.Begin(rdcspv::Section::Functions);
+    while(it.opcode() != rdcspv::Op::FMul)
+      ++it;
+
+    rdcspv::OpFMul mul(it);
+    ++it;
+    ed.AddOperation(it, rdcspv::OpCopyObject(mul.resultType, ed.MakeId(), mul.result));
+
+    // declaring a new type moves the functions section, and the queued insert with it
+    rdcspv::Id uint64Type = ed.DeclareType(rdcspv::scalar<uint64_t>());
+    CHECK(ed.GetID(uint64Type).opcode() == rdcspv::Op::TypeInt);
+
+    ed.EndBatch();
+
+    it = ed.GetID(mul.result);
+    REQUIRE(it.opcode() == rdcspv::Op::FMul);
+    ++it;
+    CHECK(it.opcode() == rdcspv::Op::CopyObject);
+    CHECK(ed.GetID(uint64Type).opcode() == rdcspv::Op::TypeInt);
+  };
+}
+
+TEST_CASE("Test SPIR-V editor ids of added declarations", "[spirv]")
+{
+  rdcspv::Init();
+  RenderDoc::Inst().RegisterShutdownFunction(&rdcspv::Shutdown);
+
+  std::vector<uint32_t> spirv = CompileArithmeticShader(4);
+
+  rdcspv::Editor ed(spirv);
+  ed.Prepare();
+
+  // each declaration is registered after the offsets are moved for it, so its own id points at the
+  // new operation rather than at whatever follows it
+  rdcspv::Id uint64Type = ed.DeclareType(rdcspv::scalar<uint64_t>());
+  rdcspv::Id ptrType = ed.DeclareType(rdcspv::Pointer(uint64Type, rdcspv::StorageClass::Private));
+  rdcspv::Id constant = ed.AddConstantImmediate<uint64_t>(1234);
+  rdcspv::Id var =
+      ed.AddVariable(rdcspv::OpVariable(ptrType, ed.MakeId(), rdcspv::StorageClass::Private));
+
+  CHECK(ed.GetID(uint64Type).opcode() == rdcspv::Op::TypeInt);
+  CHECK(ed.GetID(ptrType).opcode() == rdcspv::Op::TypePointer);
+  CHECK(ed.GetID(constant).opcode() == rdcspv::Op::Constant);
+  CHECK(ed.GetID(var).opcode() == rdcspv::Op::Variable);
+}
+
+// not run by default, run explicitly with the [benchmark] tag
+TEST_CASE("Benchmark SPIR-V editor insertion", "[.][benchmark][spirv]")
+{
+  rdcspv::Init();
+  RenderDoc::Inst().RegisterShutdownFunction(&rdcspv::Shutdown);
+
+  // roughly 1MB of SPIR-V
+  std::vector<uint32_t> direct = CompileArithmeticShader(6500);
+  std::vector<uint32_t> batched = direct;
+
+  RDCLOG("Editing %zu KB SPIR-V module", direct.size() * sizeof(uint32_t) / 1024);
+
+  PerformanceTimer timer;
+  uint32_t count = InsertCopiesAfterMultiplies(direct, false);
+  double directMS = timer.GetMilliseconds();
+
+  timer.Restart();
+  InsertCopiesAfterMultiplies(batched, true);
+  double batchedMS = timer.GetMilliseconds();
+
+  RDCLOG("%u inserts: %.2f ms direct, %.2f ms batched", count, directMS, batchedMS);
+
+  CHECK(direct == batched);
+}
+
 TEST_CASE("Test SPIR-V editor section handling", "[spirv]")
 {
   rdcspv::Init();
@@ -75,6 +75,12 @@ public:
 
   void AddOperation(Iter iter, const Operation &op);
 
+  // between these calls AddOperation queues operations instead of inserting them, so nothing moves
+  // and iterators into the module stay valid. EndBatch() then inserts everything queued in a single
+  // pass. Operations queued at the same iterator are inserted in the order they were added.
+  void BeginBatch();
+  void EndBatch();
+
   // callbacks to allow us to update our internal structures over changes
 
   // called before any modifications are made. Removes the operation from internal structures.
@@ -187,6 +193,17 @@ private:
   inline void addWords(size_t offs, size_t num) { addWords(offs, (int32_t)num); }
   void addWords(size_t offs, int32_t num);
 
+  struct PendingInsert
+  {
+    size_t offset;
+    size_t firstWord;
+    size_t wordCount;
+  };
+
+  bool m_Batching = false;
+  std::vector<PendingInsert> m_PendingInserts;
+  std::vector<uint32_t> m_PendingWords;
+
   Operation MakeDeclaration(const Scalar &s);
   Operation MakeDeclaration(const Vector &v);
   Operation MakeDeclaration(const Matrix &m);
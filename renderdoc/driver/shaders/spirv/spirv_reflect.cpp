@@ -25,6 +25,8 @@
 #include "spirv_reflect.h"
 #include <limits.h>
 #include <algorithm>
+#include "common/shader_cache.h"
+#include "common/threading.h"
 #include "maths/half_convert.h"
 #include "replay/replay_driver.h"
 #include "spirv_editor.h"
@@ -401,6 +403,67 @@ void Reflector::Parse(const std::vector<uint32_t> &spirvWords)
   Processor::Parse(spirvWords);
 }
 
+static Threading::CriticalSection sharedReflectorLock;
+static std::map<ShaderCacheKey, std::weak_ptr<const Reflector>> sharedReflectors;
+// when the map grows to this size we sweep out any entries that are no longer referenced
+static size_t sharedReflectorSweepSize = 64;
+
+std::shared_ptr<const Reflector> GetEmptyReflector()
+{
+  static std::shared_ptr<const Reflector> empty(new Reflector);
+  return empty;
+}
+
+std::shared_ptr<const Reflector> GetSharedReflector(const std::vector<uint32_t> &spirvWords)
+{
+  ShaderCacheHasher hasher;
+  hasher.Add(spirvWords.data(), spirvWords.size() * sizeof(uint32_t));
+  ShaderCacheKey key = hasher.Finish();
+
+  {
+    SCOPED_LOCK(sharedReflectorLock);
+
+    auto it = sharedReflectors.find(key);
+    if(it != sharedReflectors.end())
+    {
+      std::shared_ptr<const Reflector> ret = it->second.lock();
+      if(ret)
+        return ret;
+    }
+  }
+
+  // parse outside the lock so different modules can be parsed concurrently. If another thread
+  // parses the same module at the same time, whichever finishes first is shared.
+  Reflector *reflector = new Reflector;
+  reflector->Parse(spirvWords);
+  std::shared_ptr<const Reflector> parsed(reflector);
+
+  SCOPED_LOCK(sharedReflectorLock);
+
+  std::weak_ptr<const Reflector> &entry = sharedReflectors[key];
+
+  std::shared_ptr<const Reflector> existing = entry.lock();
+  if(existing)
+    return existing;
+
+  entry = parsed;
+
+  if(sharedReflectors.size() >= sharedReflectorSweepSize)
+  {
+    for(auto it = sharedReflectors.begin(); it != sharedReflectors.end();)
+    {
+      if(it->second.expired())
+        it = sharedReflectors.erase(it);
+      else
+        ++it;
+    }
+
+    sharedReflectorSweepSize = RDCMAX((size_t)64, sharedReflectors.size() * 2);
+  }
+
+  return parsed;
+}
+
 void Reflector::PreParse(uint32_t maxId)
 {
   Processor::PreParse(maxId);
@@ -640,7 +703,8 @@ void Reflector::PostParse()
 
 std::vector<std::string> Reflector::EntryPoints() const
 {
-  std::vector<std::string> ret(entries.size());
+  std::vector<std::string> ret;
+  ret.reserve(entries.size());
   for(const EntryPoint &e : entries)
     ret.push_back(e.name);
   return ret;
@@ -2283,4 +2347,47 @@ TEST_CASE("Validate SPIR-V reflection", "[spirv][reflection]")
   };
 }
 
+TEST_CASE("Check shared SPIR-V reflectors", "[spirv][reflection]")
+{
+  rdcspv::Init();
+  RenderDoc::Inst().RegisterShutdownFunction(&rdcspv::Shutdown);
+
+  rdcspv::CompilationSettings settings(rdcspv::InputLanguage::VulkanGLSL,
+                                       rdcspv::ShaderStage::Fragment);
+
+  std::vector<uint32_t> spirvA, spirvB;
+  rdcspv::Compile(settings, {"#version 450 core\nlayout(location = 0) out vec4 col;\n"
+                             "void main() { col = vec4(1); }\n"},
+                  spirvA);
+  rdcspv::Compile(settings, {"#version 450 core\nlayout(location = 0) out vec4 col;\n"
+                             "void main() { col = vec4(0); }\n"},
+                  spirvB);
+
+  REQUIRE(!spirvA.empty());
+  REQUIRE(!spirvB.empty());
+
+  std::shared_ptr<const rdcspv::Reflector> a1 = rdcspv::GetSharedReflector(spirvA);
+  std::shared_ptr<const rdcspv::Reflector> a2 = rdcspv::GetSharedReflector(spirvA);
+  std::shared_ptr<const rdcspv::Reflector> b = rdcspv::GetSharedReflector(spirvB);
+
+  // identical modules share one parse, different modules don't
+  CHECK(a1.get() == a2.get());
+  CHECK(a1.get() != b.get());
+
+  CHECK(a1->GetSPIRV() == spirvA);
+  CHECK(b->GetSPIRV() == spirvB);
+  CHECK(a1->EntryPoints() == std::vector<std::string>({"main"}));
+
+  // once every reference is gone the module is parsed again on the next request
+  a1.reset();
+  a2.reset();
+
+  std::shared_ptr<const rdcspv::Reflector> a3 = rdcspv::GetSharedReflector(spirvA);
+  CHECK(a3->GetSPIRV() == spirvA);
+
+  // modules that haven't been parsed all share one empty reflector
+  CHECK(rdcspv::GetEmptyReflector().get() == rdcspv::GetEmptyReflector().get());
+  CHECK(rdcspv::GetEmptyReflector()->EntryPoints().empty());
+}
+
 #endif
@@ -24,6 +24,7 @@
 
 #pragma once
 
+#include <memory>
 #include <vector>
 #include "api/replay/renderdoc_replay.h"
 #include "spirv_common.h"
@@ -140,6 +141,14 @@ private:
 
   rdcarray<MemberName> memberNames;
 };
+
+// returns a parsed reflector for this module. Modules with identical contents share the same
+// immutable parse results for as long as anything holds a reference to them, so the same module
+// created many times is only parsed once.
+std::shared_ptr<const Reflector> GetSharedReflector(const std::vector<uint32_t> &spirvWords);
+
+// returns a single empty reflector, for anything that doesn't have a parsed module (yet)
+std::shared_ptr<const Reflector> GetEmptyReflector();
 };
 
 static const uint32_t SpecializationConstantBindSet = 1234567;
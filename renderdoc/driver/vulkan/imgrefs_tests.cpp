@@ -257,6 +257,42 @@ TEST_CASE("Test ImgRefs type", "[imgrefs]")
     std::vector<FrameRefType> expected = {eFrameRef_Read};
     CHECK(imgRefs.rangeRefs == expected);
   }
+  SECTION("written subresources")
+  {
+    ImgRefs imgRefs(ImageInfo(VK_FORMAT_D16_UNORM_S8_UINT, {100, 100, 1}, 4, 3, 1));
+    ImageRange range;
+    range.aspectMask = VK_IMAGE_ASPECT_STENCIL_BIT;
+    range.baseMipLevel = 1;
+    range.levelCount = 2;
+    range.baseArrayLayer = 1;
+    range.layerCount = 1;
+    imgRefs.Update(range, eFrameRef_PartialWrite);
+
+    range.aspectMask = VK_IMAGE_ASPECT_DEPTH_BIT;
+    range.baseArrayLayer = 2;
+    imgRefs.Update(range, eFrameRef_Read);
+
+    FlatIntervals<bool> written;
+    CHECK(imgRefs.GetWrittenSubresources(written));
+
+    // only layer 1, levels 1 and 2 were written
+    std::vector<rdcpair<uint64_t, uint64_t>> ranges;
+    for(auto it = written.begin(); it != written.end(); it++)
+      if(it->value())
+        ranges.push_back(make_rdcpair(it->start(), it->finish()));
+
+    std::vector<rdcpair<uint64_t, uint64_t>> expected = {{4 + 1, 4 + 3}};
+    CHECK((ranges == expected));
+  }
+  SECTION("written subresources 3D image")
+  {
+    ImgRefs imgRefs(ImageInfo(VK_FORMAT_D16_UNORM_S8_UINT, {100, 100, 5}, 11, 1, 1));
+    ImageRange range;
+    imgRefs.Update(range, eFrameRef_PartialWrite);
+
+    FlatIntervals<bool> written;
+    CHECK_FALSE(imgRefs.GetWrittenSubresources(written));
+  }
 };
 
 #endif    // ENABLED(ENABLE_UNIT_TESTS)
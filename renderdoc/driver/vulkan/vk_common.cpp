@@ -292,6 +292,10 @@ bool VkInitParams::IsSupportedVersion(uint64_t ver)
   if(ver == CurrentVersion)
     return true;
 
+  // 0x10 -> 0x11 - memory and image initial contents serialise only their dirty regions
+  if(ver == 0x10)
+    return true;
+
   // 0xF -> 0x10 - added serialisation of VkPhysicalDeviceDriverPropertiesKHR into enumerated
   // physical devices
   if(ver == 0xF)
@@ -166,6 +166,10 @@ WrappedVulkan::WrappedVulkan() : m_RenderState(this, &m_CreationInfo)
 
 WrappedVulkan::~WrappedVulkan()
 {
+  // make sure any captures are on disk before we go away, the application may exit right after
+  if(IsCaptureMode(m_State))
+    RenderDoc::Inst().FlushCaptureWrites();
+
   // records must be deleted before resource manager shutdown
   if(m_FrameCaptureRecord)
   {
@@ -1508,10 +1512,21 @@ bool WrappedVulkan::Serialise_BeginCaptureFrame(SerialiserType &ser)
 
 void WrappedVulkan::StartFrameCapture(void *dev, void *wnd)
 {
+  // if the application starts a capture while we're capturing this frame for the capture ring,
+  // take it over. It began at the start of the frame so it covers everything the application wants
+  if(IsActiveCapturing(m_State) && m_RingCapture)
+  {
+    m_RingCapture = false;
+    m_AppControlledCapture = true;
+    m_CapturedFrames.back().frameNumber = ~0U;
+    return;
+  }
+
   if(!IsBackgroundCapturing(m_State))
     return;
 
   m_AppControlledCapture = true;
+  m_RingCapture = false;
 
   m_SubmitCounter = 0;
 
@@ -1675,7 +1690,11 @@ bool WrappedVulkan::EndFrameCapture(void *dev, void *wnd)
 
     // m_SuccessfulCapture = false;
 
-    ObjDisp(GetDev())->DeviceWaitIdle(Unwrap(GetDev()));
+    // ring frames are captured continuously so don't stall the application by waiting for idle.
+    // Initial contents were already synchronised when the capture began, nothing the GPU is still
+    // executing uses anything freed below.
+    if(!m_RingCapture)
+      ObjDisp(GetDev())->DeviceWaitIdle(Unwrap(GetDev()));
 
     {
       SCOPED_LOCK(m_CoherentMapsLock);
@@ -1692,7 +1711,8 @@ bool WrappedVulkan::EndFrameCapture(void *dev, void *wnd)
   const uint32_t maxSize = 2048;
   RenderDoc::FramePixels fp;
 
-  if(swaprecord != NULL)
+  // ring frames skip the thumbnail, reading back the backbuffer needs a full wait-idle every frame
+  if(swaprecord != NULL && !m_RingCapture)
   {
     VkDevice device = GetDev();
     VkCommandBuffer cmd = GetNextCmd();
@@ -1881,29 +1901,12 @@ bool WrappedVulkan::EndFrameCapture(void *dev, void *wnd)
     }
   }
 
-  RDCFile *rdc =
-      RenderDoc::Inst().CreateRDC(RDCDriver::Vulkan, m_CapturedFrames.back().frameNumber, fp);
-
-  StreamWriter *captureWriter = NULL;
-
-  if(rdc)
-  {
-    SectionProperties props;
-
-    // Compress with LZ4 so that it's fast
-    props.flags = SectionFlags::LZ4Compressed;
-    props.version = m_SectionVersion;
-    props.type = SectionType::FrameCapture;
-
-    captureWriter = rdc->WriteSection(props);
-  }
-  else
-  {
-    captureWriter = new StreamWriter(StreamWriter::InvalidStream);
-  }
+  // serialise the frame into memory, then hand it off to be compressed and written to disk on a
+  // background thread so the application isn't stalled for the file write.
+  StreamWriter *captureWriter = new StreamWriter(16 * 1024 * 1024);
 
   {
-    WriteSerialiser ser(captureWriter, Ownership::Stream);
+    WriteSerialiser ser(captureWriter, Ownership::Nothing);
 
     ser.SetChunkMetadataRecording(GetThreadSerialiser().GetChunkMetadataRecording());
 
@@ -1974,7 +1977,30 @@ bool WrappedVulkan::EndFrameCapture(void *dev, void *wnd)
     }
   }
 
-  RenderDoc::Inst().FinishCaptureWriting(rdc, m_CapturedFrames.back().frameNumber);
+  {
+    SectionProperties props;
+
+    // Compress with LZ4 so that it's fast
+    props.flags = SectionFlags::LZ4Compressed;
+    props.version = m_SectionVersion;
+    props.type = SectionType::FrameCapture;
+
+    if(m_RingCapture)
+    {
+      RenderDoc::Inst().AddRingCapture(RDCDriver::Vulkan, m_CapturedFrames.back().frameNumber, fp,
+                                       props, captureWriter);
+
+      // ring frames aren't written unless saved later, so don't keep a record of them
+      m_CapturedFrames.pop_back();
+    }
+    else
+    {
+      RenderDoc::Inst().QueueCaptureWrite(RDCDriver::Vulkan, m_CapturedFrames.back().frameNumber,
+                                          fp, props, captureWriter);
+    }
+  }
+
+  m_RingCapture = false;
 
   SAFE_DELETE(m_HeaderChunk);
 
@@ -2008,6 +2034,8 @@ bool WrappedVulkan::DiscardFrameCapture(void *dev, void *wnd)
 
   m_CapturedFrames.pop_back();
 
+  m_RingCapture = false;
+
   // transition back to IDLE atomically
   {
     SCOPED_WRITELOCK(m_CapTransitionLock);
@@ -2066,13 +2094,31 @@ void WrappedVulkan::Present(void *dev, void *wnd)
     return;
 
   if(IsActiveCapturing(m_State) && !m_AppControlledCapture)
+  {
+    bool ring = m_RingCapture;
+
+    PerformanceTimer timer;
     RenderDoc::Inst().EndFrameCapture(dev, wnd);
 
-  if(RenderDoc::Inst().ShouldTriggerCapture(m_FrameCounter) && IsBackgroundCapturing(m_State))
+    if(ring)
+      RenderDoc::Inst().AddRingFrameCost(m_RingCaptureStartCost + timer.GetMilliseconds());
+  }
+
+  bool trigger = RenderDoc::Inst().ShouldTriggerCapture(m_FrameCounter);
+
+  // in ring capture mode we capture frames continuously, keeping the most recent in memory. Frames
+  // are skipped when needed to keep the overhead within the ring's per-frame budget
+  bool ring = !trigger && IsBackgroundCapturing(m_State) &&
+              RenderDoc::Inst().IsCaptureRingActive() && RenderDoc::Inst().ShouldCaptureRingFrame();
+
+  if((trigger || ring) && IsBackgroundCapturing(m_State))
   {
+    PerformanceTimer timer;
     RenderDoc::Inst().StartFrameCapture(dev, wnd);
+    m_RingCaptureStartCost = timer.GetMilliseconds();
 
     m_AppControlledCapture = false;
+    m_RingCapture = ring;
     m_CapturedFrames.back().frameNumber = m_FrameCounter;
   }
 }
@@ -2157,6 +2203,11 @@ ReplayStatus WrappedVulkan::ReadLogInitialisation(RDCFile *rdc, bool storeStruct
   if(m_ReplayOptions.apiValidation)
     sink = new ScopedDebugMessageSink(this);
 
+  // shader modules and pipelines are only recorded while reading the creation chunks, and are
+  // parsed and reflected in bulk before the frame is replayed.
+  if(IsReplayMode(m_State))
+    m_CreationInfo.m_DeferShaders = true;
+
   for(;;)
   {
     PerformanceTimer timer;
@@ -2201,6 +2252,8 @@ ReplayStatus WrappedVulkan::ReadLogInitialisation(RDCFile *rdc, bool storeStruct
 
       m_FrameReader = new StreamReader(reader, frameDataSize);
 
+      m_CreationInfo.FlushPendingShaders();
+
       ReplayStatus status = ContextReplayLog(m_State, 0, 0, false);
 
       if(status != ReplayStatus::Succeeded)
@@ -2217,6 +2270,8 @@ ReplayStatus WrappedVulkan::ReadLogInitialisation(RDCFile *rdc, bool storeStruct
 
   SAFE_DELETE(sink);
 
+  m_CreationInfo.FlushPendingShaders();
+
 #if ENABLED(RDOC_DEVEL)
   for(auto it = chunkInfos.begin(); it != chunkInfos.end(); ++it)
   {
@@ -53,7 +53,7 @@ struct VkInitParams
   uint64_t GetSerialiseSize();
 
   // check if a frame capture section version is supported
-  static const uint64_t CurrentVersion = 0x10;
+  static const uint64_t CurrentVersion = 0x11;
   static bool IsSupportedVersion(uint64_t ver);
 };
 
@@ -279,6 +279,10 @@ private:
 
   CaptureState m_State;
   bool m_AppControlledCapture = false;
+  // the current capture was started only to feed the capture ring
+  bool m_RingCapture = false;
+  // how long starting the current ring capture stalled the application for, in milliseconds
+  double m_RingCaptureStartCost = 0.0;
 
   bool m_MarkedActive = false;
   uint32_t m_SubmitCounter = 0;
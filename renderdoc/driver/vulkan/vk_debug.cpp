@@ -1214,10 +1214,9 @@ uint32_t VulkanReplay::PickVertex(uint32_t eventId, int32_t w, int32_t h, const
       m_VertexPick.VBUpload.Create(m_pDriver, dev, m_VertexPick.VBSize, 1, 0);
     }
 
-    byte *data = &oldData[0];
-    byte *dataEnd = data + oldData.size();
-
-    bool valid = true;
+    // the vertices are decoded directly, without going through the index buffer
+    MeshFormat vertices = cfg.position;
+    vertices.indexByteStride = 0;
 
     FloatVector *vbData = (FloatVector *)m_VertexPick.VBUpload.Map();
 
@@ -1225,9 +1224,9 @@ uint32_t VulkanReplay::PickVertex(uint32_t eventId, int32_t w, int32_t h, const
     // conver the first N vertices we'll need.
     // Instead we grab min and max above, and convert every vertex in that range. This might
     // slightly over-estimate but not as bad as 0-max or the whole buffer.
-    for(uint32_t idx = minIndex; idx <= maxIndex; idx++)
-      vbData[idx] = HighlightCache::InterpretVertex(data, idx, cfg.position.vertexByteStride,
-                                                    cfg.position.format, dataEnd, valid);
+    if(minIndex <= maxIndex)
+      DecodeMeshVertices(vertices, NULL, 0, oldData.data(), oldData.size(), minIndex,
+                         maxIndex - minIndex + 1, &vbData[minIndex], NULL);
 
     m_VertexPick.VBUpload.Unmap();
   }
@@ -23,6 +23,7 @@
  ******************************************************************************/
 
 #include "vk_info.h"
+#include "common/timing.h"
 
 VkDynamicState ConvertDynamicState(VulkanDynamicStateIndex idx)
 {
@@ -257,7 +258,7 @@ void VulkanCreationInfo::Pipeline::Init(VulkanResourceManager *resourceMan,
 
     ShaderModuleReflection &reflData = info.m_ShaderModule[shadid].m_Reflections[key];
 
-    reflData.Init(resourceMan, shadid, info.m_ShaderModule[shadid].spirv, shad.entryPoint,
+    reflData.Init(resourceMan, info, shadid, info.m_ShaderModule[shadid], shad.entryPoint,
                   pCreateInfo->pStages[i].stage, shad.specialization);
 
     shad.refl = &reflData.refl;
@@ -588,7 +589,7 @@ void VulkanCreationInfo::Pipeline::Init(VulkanResourceManager *resourceMan, Vulk
 
     ShaderModuleReflection &reflData = info.m_ShaderModule[shadid].m_Reflections[key];
 
-    reflData.Init(resourceMan, shadid, info.m_ShaderModule[shadid].spirv, shad.entryPoint,
+    reflData.Init(resourceMan, info, shadid, info.m_ShaderModule[shadid], shad.entryPoint,
                   pCreateInfo->stage.stage, shad.specialization);
 
     shad.refl = &reflData.refl;
@@ -1050,14 +1051,25 @@ void VulkanCreationInfo::ShaderModule::Init(VulkanResourceManager *resourceMan,
   else
   {
     RDCASSERT(pCreateInfo->codeSize % sizeof(uint32_t) == 0);
-    spirv.Parse(std::vector<uint32_t>(
-        (uint32_t *)(pCreateInfo->pCode),
-        (uint32_t *)(pCreateInfo->pCode + pCreateInfo->codeSize / sizeof(uint32_t))));
+    std::vector<uint32_t> words((uint32_t *)(pCreateInfo->pCode),
+                                (uint32_t *)(pCreateInfo->pCode +
+                                             pCreateInfo->codeSize / sizeof(uint32_t)));
+
+    if(info.m_DeferShaders)
+    {
+      pendingSPIRV.swap(words);
+      info.m_PendingModules.push_back(this);
+    }
+    else
+    {
+      spirv = rdcspv::GetSharedReflector(words);
+    }
   }
 }
 
 void VulkanCreationInfo::ShaderModuleReflection::Init(VulkanResourceManager *resourceMan,
-                                                      ResourceId id, const rdcspv::Reflector &spv,
+                                                      VulkanCreationInfo &info, ResourceId id,
+                                                      const ShaderModule &module,
                                                       const std::string &entry,
                                                       VkShaderStageFlagBits stage,
                                                       const std::vector<SpecConstant> &specInfo)
@@ -1067,13 +1079,60 @@ void VulkanCreationInfo::ShaderModuleReflection::Init(VulkanResourceManager *res
     entryPoint = entry;
     stageIndex = StageIndex(stage);
 
-    spv.MakeReflection(GraphicsAPI::Vulkan, ShaderStage(stageIndex), entryPoint, specInfo, refl,
-                       mapping, patchData);
-
     refl.resourceId = resourceMan->GetOriginalID(id);
+
+    // the module may not even be parsed yet, so the reflection itself happens later
+    if(info.m_DeferShaders)
+    {
+      info.m_PendingReflections.push_back({&module, this, specInfo});
+      return;
+    }
+
+    Reflect(*module.spirv, specInfo);
   }
 }
 
+void VulkanCreationInfo::ShaderModuleReflection::Reflect(const rdcspv::Reflector &spv,
+                                                         const std::vector<SpecConstant> &specInfo)
+{
+  spv.MakeReflection(GraphicsAPI::Vulkan, ShaderStage(stageIndex), entryPoint, specInfo, refl,
+                     mapping, patchData);
+}
+
+void VulkanCreationInfo::FlushPendingShaders()
+{
+  m_DeferShaders = false;
+
+  if(m_PendingModules.empty() && m_PendingReflections.empty())
+    return;
+
+  PerformanceTimer timer;
+
+  // parse every module first, since reflections need their module. Identical modules end up sharing
+  // the same reflector.
+  Threading::ParallelFor((uint32_t)m_PendingModules.size(), [this](uint32_t i) {
+    ShaderModule *module = m_PendingModules[i];
+    module->spirv = rdcspv::GetSharedReflector(module->pendingSPIRV);
+    std::vector<uint32_t>().swap(module->pendingSPIRV);
+  });
+
+  double parseTime = timer.GetMilliseconds();
+
+  // each reflection is written to a separate object and only reads the shared const module, so
+  // these can all be processed independently.
+  Threading::ParallelFor((uint32_t)m_PendingReflections.size(), [this](uint32_t i) {
+    PendingReflection &pending = m_PendingReflections[i];
+    pending.reflection->Reflect(*pending.module->spirv, pending.specInfo);
+  });
+
+  RDCLOG("Parsed %zu shader modules in %.2f ms and made %zu reflections in %.2f ms",
+         m_PendingModules.size(), parseTime, m_PendingReflections.size(),
+         timer.GetMilliseconds() - parseTime);
+
+  m_PendingModules.clear();
+  m_PendingReflections.clear();
+}
+
 void VulkanCreationInfo::DescSetPool::Init(VulkanResourceManager *resourceMan,
                                            VulkanCreationInfo &info,
                                            const VkDescriptorPoolCreateInfo *pCreateInfo)
@@ -165,6 +165,8 @@ struct VulkanCreationInfo
     ResourceId specialisingPipe;
   };
 
+  struct ShaderModule;
+
   struct ShaderModuleReflection
   {
     uint32_t stageIndex;
@@ -174,9 +176,10 @@ struct VulkanCreationInfo
     ShaderBindpointMapping mapping;
     SPIRVPatchData patchData;
 
-    void Init(VulkanResourceManager *resourceMan, ResourceId id, const rdcspv::Reflector &spv,
-              const std::string &entry, VkShaderStageFlagBits stage,
+    void Init(VulkanResourceManager *resourceMan, VulkanCreationInfo &info, ResourceId id,
+              const ShaderModule &module, const std::string &entry, VkShaderStageFlagBits stage,
               const std::vector<SpecConstant> &specInfo);
+    void Reflect(const rdcspv::Reflector &spv, const std::vector<SpecConstant> &specInfo);
   };
 
   struct Pipeline
@@ -525,14 +528,25 @@ struct VulkanCreationInfo
       return m_Reflections[{entry, ResourceId()}];
     }
 
-    rdcspv::Reflector spirv;
+    // parsed module, shared with any other modules that have identical SPIR-V. Until then (or if
+    // the module isn't SPIR-V) this is the one shared empty reflector, so nothing is allocated
+    std::shared_ptr<const rdcspv::Reflector> spirv = rdcspv::GetEmptyReflector();
 
     std::string unstrippedPath;
 
     std::map<ShaderModuleReflectionKey, ShaderModuleReflection> m_Reflections;
+
+    // the module's words, only until it's parsed when shader work is deferred
+    std::vector<uint32_t> pendingSPIRV;
   };
   std::map<ResourceId, ShaderModule> m_ShaderModule;
 
+  // while loading a capture, parsing and reflecting shader modules is deferred so that it can all
+  // be done in parallel before the frame is first replayed. Anything that needs the results before
+  // then must call FlushPendingShaders() first, which is a no-op once everything is processed.
+  bool m_DeferShaders = false;
+  void FlushPendingShaders();
+
   struct DescSetPool
   {
     void Init(VulkanResourceManager *resourceMan, VulkanCreationInfo &info,
@@ -557,6 +571,13 @@ struct VulkanCreationInfo
 
   void erase(ResourceId id)
   {
+    // don't free a module out from under pending work
+    if(!m_PendingModules.empty() || !m_PendingReflections.empty())
+    {
+      if(m_ShaderModule.find(id) != m_ShaderModule.end())
+        FlushPendingShaders();
+    }
+
     m_Pipeline.erase(id);
     m_PipelineLayout.erase(id);
     m_RenderPass.erase(id);
@@ -576,4 +597,15 @@ struct VulkanCreationInfo
     m_DescUpdateTemplate.erase(id);
     m_Queue.erase(id);
   }
+
+private:
+  struct PendingReflection
+  {
+    const ShaderModule *module;
+    ShaderModuleReflection *reflection;
+    std::vector<SpecConstant> specInfo;
+  };
+
+  std::vector<ShaderModule *> m_PendingModules;
+  std::vector<PendingReflection> m_PendingReflections;
 };
@@ -394,6 +394,26 @@ bool WrappedVulkan::Prepare_InitialState(WrappedVkRes *res)
 
     VkDeviceSize bufOffset = 0;
 
+    VkInitialContents initialContents(type, readbackmem);
+
+    // if only some subresources have ever been written, only copy those. Dirty ranges are indexed
+    // by layer * levelCount + level, the same order the subresources are laid out in the buffer
+    std::vector<bool> dirtySubresources;
+    std::vector<VkBufferCopy> dirtyRegions;
+    {
+      std::vector<rdcpair<uint64_t, uint64_t>> dirtyRanges;
+      if(arrayIm == VK_NULL_HANDLE && GetResourceManager()->GetResourceDirtyRanges(id, dirtyRanges))
+      {
+        dirtySubresources.resize(numLayers * imageInfo.levelCount);
+        for(const rdcpair<uint64_t, uint64_t> &range : dirtyRanges)
+        {
+          for(uint64_t i = range.first;
+              i < dirtySubresources.size() && i - range.first < range.second; i++)
+            dirtySubresources[(size_t)i] = true;
+        }
+      }
+    }
+
     // loop over every slice/mip, copying it to the appropriate point in the buffer
     for(int a = 0; a < numLayers; a++)
     {
@@ -401,6 +421,10 @@ bool WrappedVulkan::Prepare_InitialState(WrappedVkRes *res)
 
       for(int m = 0; m < imageInfo.levelCount; m++)
       {
+        bool copySubresource =
+            dirtySubresources.empty() || dirtySubresources[a * imageInfo.levelCount + m];
+        VkDeviceSize subresourceOffset = AlignUp(bufOffset, bufAlignment);
+
         VkBufferImageCopy region = {
             0,
             0,
@@ -432,9 +456,10 @@ bool WrappedVulkan::Prepare_InitialState(WrappedVkRes *res)
             bufOffset += GetPlaneByteSize(imageInfo.extent.width, imageInfo.extent.height,
                                           imageInfo.extent.depth, sizeFormat, m, i);
 
-            ObjDisp(d)->CmdCopyImageToBuffer(Unwrap(cmd), realim,
-                                             VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, Unwrap(dstBuf),
-                                             1, &region);
+            if(copySubresource)
+              ObjDisp(d)->CmdCopyImageToBuffer(Unwrap(cmd), realim,
+                                               VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                                               Unwrap(dstBuf), 1, &region);
           }
         }
         else
@@ -446,8 +471,10 @@ bool WrappedVulkan::Prepare_InitialState(WrappedVkRes *res)
           bufOffset += GetByteSize(imageInfo.extent.width, imageInfo.extent.height,
                                    imageInfo.extent.depth, sizeFormat, m);
 
-          ObjDisp(d)->CmdCopyImageToBuffer(
-              Unwrap(cmd), realim, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, Unwrap(dstBuf), 1, &region);
+          if(copySubresource)
+            ObjDisp(d)->CmdCopyImageToBuffer(Unwrap(cmd), realim,
+                                             VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, Unwrap(dstBuf),
+                                             1, &region);
 
           if(sizeFormat != imageInfo.format)
           {
@@ -460,12 +487,25 @@ bool WrappedVulkan::Prepare_InitialState(WrappedVkRes *res)
             bufOffset += GetByteSize(imageInfo.extent.width, imageInfo.extent.height,
                                      imageInfo.extent.depth, VK_FORMAT_S8_UINT, m);
 
-            ObjDisp(d)->CmdCopyImageToBuffer(Unwrap(cmd), realim,
-                                             VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, Unwrap(dstBuf),
-                                             1, &region);
+            if(copySubresource)
+              ObjDisp(d)->CmdCopyImageToBuffer(Unwrap(cmd), realim,
+                                               VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                                               Unwrap(dstBuf), 1, &region);
           }
         }
 
+        if(!dirtySubresources.empty() && copySubresource)
+        {
+          // merge with the previous subresource if it was also copied, including any padding
+          if(!dirtyRegions.empty() &&
+             dirtyRegions.back().srcOffset + dirtyRegions.back().size + bufAlignment >
+                 subresourceOffset)
+            dirtyRegions.back().size = bufOffset - dirtyRegions.back().srcOffset;
+          else
+            dirtyRegions.push_back({subresourceOffset, subresourceOffset,
+                                    bufOffset - subresourceOffset});
+        }
+
         // update the extent for the next mip
         extent.width = RDCMAX(extent.width >> 1, 1U);
         extent.height = RDCMAX(extent.height >> 1, 1U);
@@ -477,6 +517,14 @@ bool WrappedVulkan::Prepare_InitialState(WrappedVkRes *res)
                  readbackmem.size, imageInfo.extent, imageInfo.format, numLayers,
                  imageInfo.levelCount);
 
+    if(!dirtySubresources.empty())
+    {
+      initialContents.numDirtyRegions = (uint32_t)dirtyRegions.size();
+      initialContents.dirtyRegions = new VkBufferCopy[dirtyRegions.size()];
+      memcpy(initialContents.dirtyRegions, dirtyRegions.data(),
+             sizeof(VkBufferCopy) * dirtyRegions.size());
+    }
+
     // transfer back to whatever it was
     srcimBarrier.oldLayout = srcimBarrier.newLayout;
 
@@ -530,7 +578,7 @@ bool WrappedVulkan::Prepare_InitialState(WrappedVkRes *res)
       GetResourceManager()->ReleaseWrappedResource(arrayIm);
     }
 
-    GetResourceManager()->SetInitialContents(id, VkInitialContents(type, readbackmem));
+    GetResourceManager()->SetInitialContents(id, initialContents);
 
     return true;
   }
@@ -609,9 +657,36 @@ bool WrappedVulkan::Prepare_InitialState(WrappedVkRes *res)
     vkr = ObjDisp(d)->BeginCommandBuffer(Unwrap(cmd), &beginInfo);
     RDCASSERTEQUAL(vkr, VK_SUCCESS);
 
-    VkBufferCopy region = {0, 0, datasize};
+    VkInitialContents initialContents(type, readbackmem);
+
+    // if only some ranges of the memory have ever been written, only copy those
+    std::vector<rdcpair<uint64_t, uint64_t>> dirtyRanges;
+    if(GetResourceManager()->GetResourceDirtyRanges(id, dirtyRanges))
+    {
+      std::vector<VkBufferCopy> regions;
+      for(const rdcpair<uint64_t, uint64_t> &range : dirtyRanges)
+      {
+        if(range.first >= datasize)
+          break;
+
+        VkDeviceSize size = RDCMIN(range.second, datasize - range.first);
+        regions.push_back({range.first, range.first, size});
+      }
+
+      initialContents.numDirtyRegions = (uint32_t)regions.size();
+      initialContents.dirtyRegions = new VkBufferCopy[regions.size()];
+      memcpy(initialContents.dirtyRegions, regions.data(), sizeof(VkBufferCopy) * regions.size());
 
-    ObjDisp(d)->CmdCopyBuffer(Unwrap(cmd), Unwrap(srcBuf), Unwrap(dstBuf), 1, &region);
+      if(!regions.empty())
+        ObjDisp(d)->CmdCopyBuffer(Unwrap(cmd), Unwrap(srcBuf), Unwrap(dstBuf),
+                                  (uint32_t)regions.size(), regions.data());
+    }
+    else
+    {
+      VkBufferCopy region = {0, 0, datasize};
+
+      ObjDisp(d)->CmdCopyBuffer(Unwrap(cmd), Unwrap(srcBuf), Unwrap(dstBuf), 1, &region);
+    }
 
     vkr = ObjDisp(d)->EndCommandBuffer(Unwrap(cmd));
     RDCASSERTEQUAL(vkr, VK_SUCCESS);
@@ -625,7 +700,7 @@ bool WrappedVulkan::Prepare_InitialState(WrappedVkRes *res)
     GetResourceManager()->ReleaseWrappedResource(srcBuf);
     GetResourceManager()->ReleaseWrappedResource(dstBuf);
 
-    GetResourceManager()->SetInitialContents(id, VkInitialContents(type, readbackmem));
+    GetResourceManager()->SetInitialContents(id, initialContents);
 
     return true;
   }
@@ -663,6 +738,15 @@ uint64_t WrappedVulkan::GetSize_InitialState(ResourceId id, const VkInitialConte
     if(initial.tag == VkInitialContents::Sparse)
       return GetSize_SparseInitialState(id, initial);
 
+    // if only part of the resource is dirty, only those regions are serialised
+    if(initial.dirtyRegions)
+    {
+      uint64_t size = 128 + initial.numDirtyRegions * sizeof(VkBufferCopy);
+      for(uint32_t i = 0; i < initial.numDirtyRegions; i++)
+        size += initial.dirtyRegions[i].size + WriteSerialiser::GetChunkAlignment();
+      return size;
+    }
+
     // the size primarily comes from the buffer, the size of which we conveniently have stored.
     return uint64_t(128 + initial.mem.size + WriteSerialiser::GetChunkAlignment());
   }
@@ -1049,9 +1133,65 @@ bool WrappedVulkan::Serialise_InitialState(SerialiserType &ser, ResourceId id,
                             (void **)&Contents);
     }
 
-    // not using SERIALISE_ELEMENT_ARRAY so we can deliberately avoid allocation - we serialise
-    // directly into upload memory
-    ser.Serialise("Contents"_lit, Contents, ContentsSize, SerialiserFlags::NoFlags);
+    if(ser.VersionAtLeast(0x11))
+    {
+      // only the regions of the contents that were ever dirtied are serialised, each into its own
+      // place in the upload memory. Untouched ranges in between are left zeroed.
+      VkBufferCopy wholeRegion = {0, 0, ContentsSize};
+      VkBufferCopy *DirtyRegions = NULL;
+      uint32_t NumDirtyRegions = 0;
+
+      if(ser.IsWriting())
+      {
+        if(initial && initial->dirtyRegions)
+        {
+          DirtyRegions = initial->dirtyRegions;
+          NumDirtyRegions = initial->numDirtyRegions;
+        }
+        else if(ContentsSize > 0)
+        {
+          DirtyRegions = &wholeRegion;
+          NumDirtyRegions = 1;
+        }
+      }
+
+      SERIALISE_ELEMENT_ARRAY(DirtyRegions, NumDirtyRegions);
+      SERIALISE_ELEMENT(NumDirtyRegions);
+
+      if(ser.IsReading() && Contents && !ser.IsErrored())
+      {
+        VkDeviceSize zeroed = 0;
+        for(uint32_t i = 0; i < NumDirtyRegions; i++)
+        {
+          if(DirtyRegions[i].srcOffset > zeroed && DirtyRegions[i].srcOffset <= ContentsSize)
+            memset(Contents + zeroed, 0, size_t(DirtyRegions[i].srcOffset - zeroed));
+          zeroed = RDCMAX(zeroed, DirtyRegions[i].srcOffset + DirtyRegions[i].size);
+        }
+        if(zeroed < ContentsSize)
+          memset(Contents + zeroed, 0, size_t(ContentsSize - zeroed));
+      }
+
+      for(uint32_t i = 0; i < NumDirtyRegions && !ser.IsErrored(); i++)
+      {
+        byte *RegionContents = NULL;
+
+        if(Contents && DirtyRegions[i].srcOffset + DirtyRegions[i].size <= ContentsSize)
+          RegionContents = Contents + DirtyRegions[i].srcOffset;
+        else if(Contents)
+          RDCERR("Invalid dirty region %llu -> %llu in initial contents of size %llu",
+                 DirtyRegions[i].srcOffset, DirtyRegions[i].srcOffset + DirtyRegions[i].size,
+                 ContentsSize);
+
+        ser.Serialise("Contents"_lit, RegionContents, DirtyRegions[i].size,
+                      SerialiserFlags::NoFlags);
+      }
+    }
+    else
+    {
+      // not using SERIALISE_ELEMENT_ARRAY so we can deliberately avoid allocation - we serialise
+      // directly into upload memory
+      ser.Serialise("Contents"_lit, Contents, ContentsSize, SerialiserFlags::NoFlags);
+    }
 
     // unmap the resource we mapped before - we need to do this on read and on write.
     if(!IsStructuredExporting(m_State) && mappedMem.mem != VK_NULL_HANDLE)
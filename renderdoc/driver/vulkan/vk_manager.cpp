@@ -440,7 +440,7 @@ bool VulkanResourceManager::Serialise_DeviceMemoryRefs(SerialiserType &ser,
 
       auto res = m_MemFrameRefs.insert(std::pair<ResourceId, MemRefs>(mem, MemRefs()));
       RDCASSERTMSG("MemRefIntervals for each memory resource must be contiguous", res.second);
-      Intervals<FrameRefType> &rangeRefs = res.first->second.rangeRefs;
+      FlatIntervals<FrameRefType> &rangeRefs = res.first->second.rangeRefs;
 
       auto it_ints = rangeRefs.begin();
       uint64_t last = 0;
@@ -539,7 +539,7 @@ void VulkanResourceManager::InsertDeviceMemoryRefs(WriteSerialiser &ser)
   for(auto it = m_MemFrameRefs.begin(); it != m_MemFrameRefs.end(); it++)
   {
     ResourceId mem = it->first;
-    Intervals<FrameRefType> &rangeRefs = it->second.rangeRefs;
+    FlatIntervals<FrameRefType> &rangeRefs = it->second.rangeRefs;
     for(auto jt = rangeRefs.begin(); jt != rangeRefs.end(); jt++)
       data.push_back({mem, jt->start(), jt->value()});
   }
@@ -855,6 +855,55 @@ void VulkanResourceManager::AddImageFrameRefs(ResourceId img, const ImageInfo &i
   m_ImgFrameRefs.insert({img, ImgRefs(imageInfo)});
 }
 
+void VulkanResourceManager::MarkDirtyWrittenRanges(
+    ResourceId id, const std::vector<CmdBufferRecordingInfo *> &cmdInfos)
+{
+  FlatIntervals<bool> written;
+  bool found = false;
+
+  for(CmdBufferRecordingInfo *cmdInfo : cmdInfos)
+  {
+    auto mem = cmdInfo->memFrameRefs.find(id);
+    if(mem != cmdInfo->memFrameRefs.end())
+    {
+      for(auto it = mem->second.rangeRefs.begin(); it != mem->second.rangeRefs.end(); it++)
+      {
+        if(IsDirtyFrameRef(it->value()))
+        {
+          written.update(it->start(), it->finish(), true, [](bool a, bool b) { return a || b; });
+          found = true;
+        }
+      }
+    }
+
+    auto img = cmdInfo->imgFrameRefs.find(id);
+    if(img != cmdInfo->imgFrameRefs.end())
+    {
+      if(!img->second.GetWrittenSubresources(written))
+      {
+        MarkDirtyResource(id);
+        return;
+      }
+
+      found = true;
+    }
+  }
+
+  // the resource was dirtied some other way than through a tracked reference, e.g. a direct
+  // dirtying of the whole image by a clear
+  if(!found || (written.size() == 1 && !written.begin()->value()))
+  {
+    MarkDirtyResource(id);
+    return;
+  }
+
+  for(auto it = written.begin(); it != written.end(); it++)
+  {
+    if(it->value())
+      MarkDirtyResourceRange(id, it->start(), it->finish() - it->start());
+  }
+}
+
 void VulkanResourceManager::MergeReferencedImages(std::map<ResourceId, ImgRefs> &imgRefs)
 {
   for(auto j = imgRefs.begin(); j != imgRefs.end(); j++)
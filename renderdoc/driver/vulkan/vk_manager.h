@@ -117,6 +117,7 @@ struct VkInitialContents
     SAFE_DELETE_ARRAY(descriptorSlots);
     SAFE_DELETE_ARRAY(descriptorWrites);
     SAFE_DELETE_ARRAY(descriptorInfo);
+    SAFE_DELETE_ARRAY(dirtyRegions);
 
     rm->ResourceTypeRelease(GetWrapped(buf));
     rm->ResourceTypeRelease(GetWrapped(img));
@@ -156,6 +157,11 @@ struct VkInitialContents
   MemoryAllocation mem;
   Tag tag;
 
+  // if only part of the resource was dirty, the regions of mem that contain valid data, with
+  // identical srcOffset and dstOffset. If NULL, all of mem is valid.
+  VkBufferCopy *dirtyRegions;
+  uint32_t numDirtyRegions;
+
   // sparse resources need extra information. Which one is valid, depends on the value of type above
   union
   {
@@ -439,6 +445,10 @@ public:
   void AddMemoryFrameRefs(ResourceId mem);
   void AddImageFrameRefs(ResourceId img, const ImageInfo &imageInfo);
 
+  // marks only the memory ranges or image subresources of `id` that were written by any of the
+  // given baked command buffers as dirty, or the whole resource if they aren't known.
+  void MarkDirtyWrittenRanges(ResourceId id, const std::vector<CmdBufferRecordingInfo *> &cmdInfos);
+
   void MergeReferencedMemory(std::map<ResourceId, MemRefs> &memRefs);
   void MergeReferencedImages(std::map<ResourceId, ImgRefs> &imgRefs);
   void ClearReferencedImages();
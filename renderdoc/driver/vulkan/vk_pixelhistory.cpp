@@ -533,7 +533,7 @@ struct VulkanPixelHistoryCallback : public VulkanDrawcallCallback
     // Check if we processed this shader before.
     if(it != m_ShaderCache.end())
       return it->second;
-    std::vector<uint32_t> modSpirv = moduleInfo.spirv.GetSPIRV();
+    std::vector<uint32_t> modSpirv = moduleInfo.spirv->GetSPIRV();
     bool modified = StripSideEffects(*shader.patchData, shader.entryPoint.c_str(), modSpirv);
     // In some cases a shader might just be binding a RW resource but not writing to it.
     // If there are no writes (shader was not modified), no need to replace the shader,
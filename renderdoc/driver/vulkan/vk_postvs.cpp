@@ -1887,7 +1887,7 @@ void VulkanReplay::FetchVSOut(uint32_t eventId)
   }
 
   uint32_t bufStride = 0;
-  std::vector<uint32_t> modSpirv = moduleInfo.spirv.GetSPIRV();
+  std::vector<uint32_t> modSpirv = moduleInfo.spirv->GetSPIRV();
 
   struct CompactedAttrBuffer
   {
@@ -2718,7 +2718,7 @@ void VulkanReplay::FetchTessGSOut(uint32_t eventId)
   const VulkanCreationInfo::ShaderModule &moduleInfo =
       creationInfo.m_ShaderModule[pipeInfo.shaders[stageIndex].module];
 
-  std::vector<uint32_t> modSpirv = moduleInfo.spirv.GetSPIRV();
+  std::vector<uint32_t> modSpirv = moduleInfo.spirv->GetSPIRV();
 
   uint32_t xfbStride = 0;
 
@@ -411,17 +411,19 @@ BufferDescription VulkanReplay::GetBuffer(ResourceId id)
 
 rdcarray<ShaderEntryPoint> VulkanReplay::GetShaderEntryPoints(ResourceId shader)
 {
+  m_pDriver->m_CreationInfo.FlushPendingShaders();
+
   auto shad = m_pDriver->m_CreationInfo.m_ShaderModule.find(shader);
 
   if(shad == m_pDriver->m_CreationInfo.m_ShaderModule.end())
     return {};
 
-  std::vector<std::string> entries = shad->second.spirv.EntryPoints();
+  std::vector<std::string> entries = shad->second.spirv->EntryPoints();
 
   rdcarray<ShaderEntryPoint> ret;
 
   for(const std::string &e : entries)
-    ret.push_back({e, shad->second.spirv.StageForEntry(e)});
+    ret.push_back({e, shad->second.spirv->StageForEntry(e)});
 
   return ret;
 }
@@ -429,6 +431,9 @@ rdcarray<ShaderEntryPoint> VulkanReplay::GetShaderEntryPoints(ResourceId shader)
 ShaderReflection *VulkanReplay::GetShader(ResourceId pipeline, ResourceId shader,
                                           ShaderEntryPoint entry)
 {
+  // wait for any shader work still outstanding from loading
+  m_pDriver->m_CreationInfo.FlushPendingShaders();
+
   auto shad = m_pDriver->m_CreationInfo.m_ShaderModule.find(shader);
 
   if(shad == m_pDriver->m_CreationInfo.m_ShaderModule.end())
@@ -440,7 +445,7 @@ ShaderReflection *VulkanReplay::GetShader(ResourceId pipeline, ResourceId shader
   // if this shader was never used in a pipeline the reflection won't be prepared. Do that now -
   // this will be ignored if it was already prepared.
   shad->second.GetReflection(entry.name, pipeline)
-      .Init(GetResourceManager(), shader, shad->second.spirv, entry.name,
+      .Init(GetResourceManager(), m_pDriver->m_CreationInfo, shader, shad->second, entry.name,
             VkShaderStageFlagBits(1 << uint32_t(entry.stage)), {});
 
   return &shad->second.GetReflection(entry.name, pipeline).refl;
@@ -552,7 +557,7 @@ std::string VulkanReplay::DisassembleShader(ResourceId pipeline, const ShaderRef
     std::string &disasm = it->second.GetReflection(refl->entryPoint, pipeline).disassembly;
 
     if(disasm.empty())
-      disasm = it->second.spirv.Disassemble(refl->entryPoint.c_str());
+      disasm = it->second.spirv->Disassemble(refl->entryPoint.c_str());
 
     return disasm;
   }
@@ -2121,9 +2126,21 @@ void VulkanReplay::PickPixel(ResourceId texture, uint32_t x, uint32_t y, const S
   m_DebugHeight = oldH;
 }
 
+rdcarray<PixelValue> VulkanReplay::PickPixels(ResourceId texture, const rdcarray<uint32_t> &coords,
+                                              const Subresource &sub, CompType typeCast)
+{
+  return StandardPickPixels(this, texture, coords, sub, typeCast, true);
+}
+
 bool VulkanReplay::GetMinMax(ResourceId texid, const Subresource &sub, CompType typeCast,
                              float *minval, float *maxval)
 {
+  // software rasterizers run the reduction shaders far slower than reading back and processing
+  // the texture on the CPU
+  if(m_DriverInfo.vendor == GPUVendor::Software &&
+     GetMinMaxFromTextureData(this, texid, sub, typeCast, minval, maxval))
+    return true;
+
   ImageLayouts &layouts = m_pDriver->m_ImageLayouts[texid];
 
   if(IsDepthAndStencilFormat(layouts.imageInfo.format))
@@ -2484,6 +2501,10 @@ bool VulkanReplay::GetHistogram(ResourceId texid, const Subresource &sub, CompTy
   if(minval >= maxval)
     return false;
 
+  if(m_DriverInfo.vendor == GPUVendor::Software &&
+     GetHistogramFromTextureData(this, texid, sub, typeCast, minval, maxval, channels, histogram))
+    return true;
+
   VkDevice dev = m_pDriver->GetDev();
   VkCommandBuffer cmd = m_pDriver->GetNextCmd();
   const VkDevDispatchTable *vt = ObjDisp(dev);
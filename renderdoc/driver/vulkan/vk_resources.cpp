@@ -3250,6 +3250,34 @@ int ImgRefs::SubresourceIndex(int aspectIndex, int level, int layer) const
   return (aspectIndex * splitLevelCount + level) * splitLayerCount + layer;
 }
 
+bool ImgRefs::GetWrittenSubresources(FlatIntervals<bool> &written) const
+{
+  // depth slices and samples are stored inline in each subresource's initial contents, so we can't
+  // track them separately
+  if(imageInfo.extent.depth > 1 || imageInfo.sampleCount > 1)
+    return false;
+
+  int aspectCount = areAspectsSplit ? GetAspectCount() : 1;
+
+  for(int layer = 0; layer < imageInfo.layerCount; layer++)
+  {
+    for(int level = 0; level < imageInfo.levelCount; level++)
+    {
+      for(int aspectIndex = 0; aspectIndex < aspectCount; aspectIndex++)
+      {
+        if(IsDirtyFrameRef(SubresourceRef(aspectIndex, level, layer)))
+        {
+          uint64_t idx = uint64_t(layer) * imageInfo.levelCount + level;
+          written.update(idx, idx + 1, true, [](bool a, bool b) { return a || b; });
+          break;
+        }
+      }
+    }
+  }
+
+  return true;
+}
+
 InitReqType ImgRefs::SubresourceRangeMaxInitReq(VkImageSubresourceRange range, InitPolicy policy,
                                                 bool initialized) const
 {
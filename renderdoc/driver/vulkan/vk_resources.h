@@ -1151,6 +1151,10 @@ struct ImgRefs
   std::vector<rdcpair<VkImageSubresourceRange, InitReqType> > SubresourceRangeInitReqs(
       VkImageSubresourceRange range, InitPolicy policy, bool initialized) const;
   void Split(bool splitAspects, bool splitLevels, bool splitLayers);
+  // adds the layer/level subresources that were written in any aspect to `written`, indexed by
+  // layer * levelCount + level to match the layout of image initial contents. Returns false if
+  // that isn't possible (3D or MSAA images) and the whole image must be treated as written.
+  bool GetWrittenSubresources(FlatIntervals<bool> &written) const;
   template <typename Compose>
   FrameRefType Update(ImageRange range, FrameRefType refType, Compose comp);
   inline FrameRefType Update(const ImageRange &range, FrameRefType refType)
@@ -1323,7 +1327,7 @@ FrameRefType ImgRefs::Merge(const ImgRefs &other, Compose comp)
 
 struct MemRefs
 {
-  Intervals<FrameRefType> rangeRefs;
+  FlatIntervals<FrameRefType> rangeRefs;
   WrappedVkRes *initializedLiveRes;
   inline MemRefs() : initializedLiveRes(NULL) {}
   inline MemRefs(VkDeviceSize offset, VkDeviceSize size, FrameRefType refType)
@@ -23,7 +23,11 @@
  ******************************************************************************/
 
 #include "vk_shader_cache.h"
+#include "3rdparty/glslang/glslang/Include/revision.h"
+#include "api/replay/version.h"
 #include "common/shader_cache.h"
+#include "common/threading.h"
+#include "common/timing.h"
 #include "data/glsl_shaders.h"
 #include "strings/string_utils.h"
 
@@ -96,36 +100,30 @@ static const BuiltinShaderConfig builtinShaders[] = {
 RDCCOMPILE_ASSERT(ARRAY_COUNT(builtinShaders) == arraydim<BuiltinShader>(),
                   "Missing built-in shader config");
 
-struct VulkanBlobShaderCallbacks
+// everything that can affect the compiled SPIR-V goes into the key. The built-in compiler changes
+// between builds, so the build's commit hash is included as its version.
+static ShaderCacheKey GetShaderKey(const rdcspv::CompilationSettings &settings,
+                                   const std::string &src)
 {
-  bool Create(uint32_t size, byte *data, SPIRVBlob *ret) const
-  {
-    RDCASSERT(ret);
-
-    SPIRVBlob blob = new std::vector<uint32_t>();
-
-    blob->resize(size / sizeof(uint32_t));
-
-    memcpy(&(*blob)[0], data, size);
-
-    *ret = blob;
-
-    return true;
-  }
-
-  void Destroy(SPIRVBlob blob) const { delete blob; }
-  uint32_t GetSize(SPIRVBlob blob) const { return (uint32_t)(blob->size() * sizeof(uint32_t)); }
-  const byte *GetData(SPIRVBlob blob) const { return (const byte *)blob->data(); }
-} VulkanShaderCacheCallbacks;
+  ShaderCacheHasher hasher;
+  hasher.Add(GitVersionHash);
+  hasher.Add((uint32_t)GLSLANG_PATCH_LEVEL);
+  hasher.Add((uint32_t)settings.stage);
+  hasher.Add((uint32_t)settings.lang);
+  hasher.Add((uint32_t)settings.debugInfo);
+  hasher.Add(settings.entryPoint);
+  hasher.Add(src);
+  return hasher.Finish();
+}
 
 VulkanShaderCache::VulkanShaderCache(WrappedVulkan *driver)
+    : m_DiskCache(FileIO::GetAppFolderFilename("shadercache/vulkan"), m_ShaderCacheVersion,
+                  m_ShaderCacheMaxSize)
 {
-  // Load shader cache, if present
-  bool success = LoadShaderCache("vkshaders.cache", m_ShaderCacheMagic, m_ShaderCacheVersion,
-                                 m_ShaderCache, VulkanShaderCacheCallbacks);
-
-  // if we failed to load from the cache
-  m_ShaderCacheDirty = !success;
+  // the single-file cache used by older builds is superseded by the disk cache
+  std::string legacyCache = FileIO::GetAppFolderFilename("vkshaders.cache");
+  if(FileIO::exists(legacyCache.c_str()))
+    FileIO::Delete(legacyCache.c_str());
 
   m_pDriver = driver;
   m_Device = driver->GetDev();
@@ -141,9 +139,20 @@ VulkanShaderCache::VulkanShaderCache(WrappedVulkan *driver)
   if(driverVersion.RunningOnMetal())
     m_GlobalDefines += "#define METAL_BACKEND\n";
 
-  std::string src;
-  rdcspv::CompilationSettings compileSettings;
-  compileSettings.lang = rdcspv::InputLanguage::VulkanGLSL;
+  // shaders that are enabled and weren't found in the cache, to be compiled in parallel below
+  struct BuiltinCompile
+  {
+    BuiltinShader builtin;
+    rdcspv::CompilationSettings settings;
+    std::string src;
+    ShaderCacheKey key;
+    SPIRVBlob blob;
+    std::string errors;
+    double compileMS;
+  };
+
+  std::vector<BuiltinShader> enabledShaders;
+  std::vector<BuiltinCompile> compiles;
 
   for(auto i : indices<BuiltinShader>())
   {
@@ -194,69 +203,137 @@ VulkanShaderCache::VulkanShaderCache(WrappedVulkan *driver)
     else if(config.builtin == BuiltinShader::TexRemapSInt)
       defines += std::string("#define UINT_TEX 0\n#define SINT_TEX 1\n");
 
-    src = GenerateGLSLShader(GetDynamicEmbeddedResource(config.resource), ShaderType::Vulkan, 430,
-                             defines);
+    enabledShaders.push_back(config.builtin);
 
-    compileSettings.stage = config.stage;
-    std::string err = GetSPIRVBlob(compileSettings, src, m_BuiltinShaderBlobs[i]);
+    BuiltinCompile compile = {};
+    compile.builtin = config.builtin;
+    compile.settings.lang = rdcspv::InputLanguage::VulkanGLSL;
+    compile.settings.stage = config.stage;
+    compile.src = GenerateGLSLShader(GetDynamicEmbeddedResource(config.resource),
+                                     ShaderType::Vulkan, 430, defines);
+    compile.key = GetShaderKey(compile.settings, compile.src);
 
-    if(!err.empty() || m_BuiltinShaderBlobs[i] == VK_NULL_HANDLE)
-    {
-      RDCERR("Error compiling builtin %u: %s", (uint32_t)i, err.c_str());
-    }
-    else
+    m_BuiltinShaderBlobs[i] = FindCachedBlob(compile.key);
+    if(m_BuiltinShaderBlobs[i] == NULL)
+      compiles.push_back(compile);
+  }
+
+  if(!compiles.empty())
+  {
+    PerformanceTimer timer;
+
+    // glslang compiles are independent of each other so spread them over all cores. Everything
+    // touching the cache or the device stays on this thread.
+    Threading::ParallelFor((uint32_t)compiles.size(), [&compiles](uint32_t c) {
+      BuiltinCompile &compile = compiles[c];
+
+      PerformanceTimer compileTimer;
+
+      SPIRVBlob spirv = new std::vector<uint32_t>();
+      compile.errors = rdcspv::Compile(compile.settings, {compile.src}, *spirv);
+
+      if(compile.errors.empty())
+        compile.blob = spirv;
+      else
+        delete spirv;
+
+      compile.compileMS = compileTimer.GetMilliseconds();
+    });
+
+    RDCLOG("Compiled %zu built-in shaders in %.2f ms", compiles.size(), timer.GetMilliseconds());
+
+    for(BuiltinCompile &compile : compiles)
     {
-      VkShaderModuleCreateInfo modinfo = {
-          VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO,
-          NULL,
-          0,
-          m_BuiltinShaderBlobs[i]->size() * sizeof(uint32_t),
-          m_BuiltinShaderBlobs[i]->data(),
-      };
-
-      VkResult vkr =
-          driver->vkCreateShaderModule(m_Device, &modinfo, NULL, &m_BuiltinShaderModules[i]);
-      RDCASSERTEQUAL(vkr, VK_SUCCESS);
-
-      driver->GetResourceManager()->SetInternalResource(GetResID(m_BuiltinShaderModules[i]));
+      RDCDEBUG("Built-in shader %u compiled in %.2f ms", (uint32_t)compile.builtin,
+               compile.compileMS);
+
+      if(!compile.errors.empty())
+      {
+        std::string logerror = compile.errors;
+        if(logerror.length() > 1024)
+          logerror = logerror.substr(0, 1024) + "...";
+
+        RDCERR("Error compiling builtin %u: %s", (uint32_t)compile.builtin, logerror.c_str());
+        continue;
+      }
+
+      m_BuiltinShaderBlobs[(size_t)compile.builtin] = compile.blob;
+      AddCachedBlob(compile.key, compile.blob);
     }
   }
 
+  for(BuiltinShader builtin : enabledShaders)
+  {
+    size_t i = (size_t)builtin;
+
+    if(m_BuiltinShaderBlobs[i] == VK_NULL_HANDLE)
+      continue;
+
+    VkShaderModuleCreateInfo modinfo = {
+        VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO,
+        NULL,
+        0,
+        m_BuiltinShaderBlobs[i]->size() * sizeof(uint32_t),
+        m_BuiltinShaderBlobs[i]->data(),
+    };
+
+    VkResult vkr =
+        driver->vkCreateShaderModule(m_Device, &modinfo, NULL, &m_BuiltinShaderModules[i]);
+    RDCASSERTEQUAL(vkr, VK_SUCCESS);
+
+    driver->GetResourceManager()->SetInternalResource(GetResID(m_BuiltinShaderModules[i]));
+  }
+
   SetCaching(false);
 }
 
 VulkanShaderCache::~VulkanShaderCache()
 {
-  if(m_ShaderCacheDirty)
-  {
-    SaveShaderCache("vkshaders.cache", m_ShaderCacheMagic, m_ShaderCacheVersion, m_ShaderCache,
-                    VulkanShaderCacheCallbacks);
-  }
-  else
-  {
-    for(auto it = m_ShaderCache.begin(); it != m_ShaderCache.end(); ++it)
-      VulkanShaderCacheCallbacks.Destroy(it->second);
-  }
+  for(auto it = m_ShaderCache.begin(); it != m_ShaderCache.end(); ++it)
+    delete it->second;
+
+  m_DiskCache.Trim();
 
   for(size_t i = 0; i < ARRAY_COUNT(m_BuiltinShaderModules); i++)
     m_pDriver->vkDestroyShaderModule(m_Device, m_BuiltinShaderModules[i], NULL);
 }
 
+SPIRVBlob VulkanShaderCache::FindCachedBlob(const ShaderCacheKey &key)
+{
+  auto it = m_ShaderCache.find(key);
+  if(it != m_ShaderCache.end())
+    return it->second;
+
+  std::vector<byte> data;
+  if(!m_DiskCache.Load(key, data) || data.empty() || (data.size() % sizeof(uint32_t)) != 0)
+    return NULL;
+
+  SPIRVBlob blob = new std::vector<uint32_t>();
+  blob->resize(data.size() / sizeof(uint32_t));
+  memcpy(blob->data(), data.data(), data.size());
+
+  m_ShaderCache[key] = blob;
+
+  return blob;
+}
+
+void VulkanShaderCache::AddCachedBlob(const ShaderCacheKey &key, SPIRVBlob blob)
+{
+  m_ShaderCache[key] = blob;
+  m_DiskCache.Store(key, blob->data(), blob->size() * sizeof(uint32_t));
+}
+
 std::string VulkanShaderCache::GetSPIRVBlob(const rdcspv::CompilationSettings &settings,
                                             const std::string &src, SPIRVBlob &outBlob)
 {
   RDCASSERT(!src.empty());
 
-  uint32_t hash = strhash(src.c_str());
+  ShaderCacheKey key = GetShaderKey(settings, src);
 
-  char typestr[3] = {'a', 'a', 0};
-  typestr[0] += (char)settings.stage;
-  typestr[1] += (char)settings.lang;
-  hash = strhash(typestr, hash);
-
-  if(m_ShaderCache.find(hash) != m_ShaderCache.end())
+  SPIRVBlob cached = FindCachedBlob(key);
+  if(cached)
   {
-    outBlob = m_ShaderCache[hash];
+    outBlob = cached;
     return "";
   }
 
@@ -279,10 +356,7 @@ std::string VulkanShaderCache::GetSPIRVBlob(const rdcspv::CompilationSettings &s
   outBlob = spirv;
 
   if(m_CacheShaders)
-  {
-    m_ShaderCache[hash] = spirv;
-    m_ShaderCacheDirty = true;
-  }
+    AddCachedBlob(key, spirv);
 
   return errors;
 }
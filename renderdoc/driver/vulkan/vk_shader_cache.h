@@ -25,6 +25,7 @@
 #pragma once
 
 #include "api/replay/renderdoc_replay.h"
+#include "common/shader_cache.h"
 #include "core/core.h"
 #include "driver/shaders/spirv/spirv_compile.h"
 #include "vk_core.h"
@@ -81,16 +82,20 @@ public:
   std::string GetGlobalDefines() { return m_GlobalDefines; }
   void SetCaching(bool enabled) { m_CacheShaders = enabled; }
 private:
-  static const uint32_t m_ShaderCacheMagic = 0xf00d00d5;
-  static const uint32_t m_ShaderCacheVersion = 1;
+  static const uint32_t m_ShaderCacheVersion = 2;
+  static const uint64_t m_ShaderCacheMaxSize = 64 * 1024 * 1024;
+
+  SPIRVBlob FindCachedBlob(const ShaderCacheKey &key);
+  void AddCachedBlob(const ShaderCacheKey &key, SPIRVBlob blob);
 
   WrappedVulkan *m_pDriver = NULL;
   VkDevice m_Device = VK_NULL_HANDLE;
 
   std::string m_GlobalDefines;
 
-  bool m_ShaderCacheDirty = false, m_CacheShaders = false;
-  std::map<uint32_t, SPIRVBlob> m_ShaderCache;
+  bool m_CacheShaders = false;
+  ShaderDiskCache m_DiskCache;
+  std::map<ShaderCacheKey, SPIRVBlob> m_ShaderCache;
 
   SPIRVBlob m_BuiltinShaderBlobs[arraydim<BuiltinShader>()] = {NULL};
   VkShaderModule m_BuiltinShaderModules[arraydim<BuiltinShader>()] = {VK_NULL_HANDLE};
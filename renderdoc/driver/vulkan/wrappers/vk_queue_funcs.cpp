@@ -841,11 +841,18 @@ VkResult WrappedVulkan::vkQueueSubmit(VkQueue queue, uint32_t submitCount,
                                               m_ImageLayouts);
         }
 
+        // only mark the ranges that were actually written by this command buffer, or any secondary
+        // command buffers it executes, as dirty
+        std::vector<CmdBufferRecordingInfo *> dirtyingCmds;
+        dirtyingCmds.push_back(record->bakedCommands->cmdInfo);
+        for(VkResourceRecord *sub : record->bakedCommands->cmdInfo->subcmds)
+          dirtyingCmds.push_back(sub->bakedCommands->cmdInfo);
+
         for(auto it = record->bakedCommands->cmdInfo->dirtied.begin();
             it != record->bakedCommands->cmdInfo->dirtied.end(); ++it)
         {
           if(GetResourceManager()->HasCurrentResource(*it))
-            GetResourceManager()->MarkDirtyResource(*it);
+            GetResourceManager()->MarkDirtyWrittenRanges(*it, dirtyingCmds);
         }
 
         // with EXT_descriptor_indexing a binding might have been updated after
@@ -142,11 +142,524 @@ uint32_t ConvertToR11G11B10(Vec3f data)
          uint32_t(exponents[0]) << 6 | uint32_t(exponents[1]) << 17 | uint32_t(exponents[2]) << 27;
 }
 
+float ConvertComponent(const ResourceFormat &fmt, const byte *data)
+{
+  if(fmt.compByteWidth == 8)
+  {
+    // we just downcast
+    const uint64_t *u64 = (const uint64_t *)data;
+    const int64_t *i64 = (const int64_t *)data;
+
+    if(fmt.compType == CompType::Double || fmt.compType == CompType::Float)
+    {
+      return float(*(const double *)u64);
+    }
+    else if(fmt.compType == CompType::UInt || fmt.compType == CompType::UScaled)
+    {
+      return float(*u64);
+    }
+    else if(fmt.compType == CompType::SInt || fmt.compType == CompType::SScaled)
+    {
+      return float(*i64);
+    }
+  }
+  else if(fmt.compByteWidth == 4)
+  {
+    const uint32_t *u32 = (const uint32_t *)data;
+    const int32_t *i32 = (const int32_t *)data;
+
+    if(fmt.compType == CompType::Float || fmt.compType == CompType::Depth)
+    {
+      return *(const float *)u32;
+    }
+    else if(fmt.compType == CompType::UInt || fmt.compType == CompType::UScaled)
+    {
+      return float(*u32);
+    }
+    else if(fmt.compType == CompType::SInt || fmt.compType == CompType::SScaled)
+    {
+      return float(*i32);
+    }
+  }
+  else if(fmt.compByteWidth == 3 && fmt.compType == CompType::Depth)
+  {
+    // 24-bit depth is a weird edge case we need to assemble it by hand
+    const uint8_t *u8 = (const uint8_t *)data;
+
+    uint32_t depth = 0;
+    depth |= uint32_t(u8[1]);
+    depth |= uint32_t(u8[2]) << 8;
+    depth |= uint32_t(u8[3]) << 16;
+
+    return float(depth) / float(16777215.0f);
+  }
+  else if(fmt.compByteWidth == 2)
+  {
+    const uint16_t *u16 = (const uint16_t *)data;
+    const int16_t *i16 = (const int16_t *)data;
+
+    if(fmt.compType == CompType::Float)
+    {
+      return ConvertFromHalf(*u16);
+    }
+    else if(fmt.compType == CompType::UInt || fmt.compType == CompType::UScaled)
+    {
+      return float(*u16);
+    }
+    else if(fmt.compType == CompType::SInt || fmt.compType == CompType::SScaled)
+    {
+      return float(*i16);
+    }
+    // 16-bit depth is UNORM
+    else if(fmt.compType == CompType::UNorm || fmt.compType == CompType::Depth)
+    {
+      return float(*u16) / 65535.0f;
+    }
+    else if(fmt.compType == CompType::SNorm)
+    {
+      float f = -1.0f;
+
+      if(*i16 == -32768)
+        f = -1.0f;
+      else
+        f = ((float)*i16) / 32767.0f;
+
+      return f;
+    }
+  }
+  else if(fmt.compByteWidth == 1)
+  {
+    const uint8_t *u8 = (const uint8_t *)data;
+    const int8_t *i8 = (const int8_t *)data;
+
+    if(fmt.compType == CompType::UInt || fmt.compType == CompType::UScaled)
+    {
+      return float(*u8);
+    }
+    else if(fmt.compType == CompType::SInt || fmt.compType == CompType::SScaled)
+    {
+      return float(*i8);
+    }
+    else if(fmt.compType == CompType::UNormSRGB)
+    {
+      return SRGB8_lookuptable[*u8];
+    }
+    else if(fmt.compType == CompType::UNorm)
+    {
+      return float(*u8) / 255.0f;
+    }
+    else if(fmt.compType == CompType::SNorm)
+    {
+      float f = -1.0f;
+
+      if(*i8 == -128)
+        f = -1.0f;
+      else
+        f = ((float)*i8) / 127.0f;
+
+      return f;
+    }
+  }
+
+  RDCERR("Unexpected format to convert from %u %u", fmt.compByteWidth, fmt.compType);
+
+  return 0.0f;
+}
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define FORMAT_SSE2 OPTION_ON
+#include <emmintrin.h>
+#else
+#define FORMAT_SSE2 OPTION_OFF
+#endif
+
+void ConvertFromHalf(const uint16_t *src, float *dst, size_t count)
+{
+  size_t i = 0;
+
+#if ENABLED(FORMAT_SSE2)
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i signMask = _mm_set1_epi32(0x8000);
+  const __m128i expMantMask = _mm_set1_epi32(0x7fff);
+  const __m128i rebias = _mm_set1_epi32((127 - 15) << 23);
+  const __m128i floatInf = _mm_set1_epi32(0x7f800000);
+  const __m128i floatNaN = _mm_set1_epi32(0x7f800001);
+  const __m128i lastSubnormal = _mm_set1_epi32(0x03ff);
+  const __m128i lastFinite = _mm_set1_epi32(0x7bff);
+  const __m128i halfInf = _mm_set1_epi32(0x7c00);
+  const __m128 subnormalScale = _mm_set1_ps(1.0f / float(1 << 24));
+
+  // must match the scalar ConvertFromHalf exactly, including flushing -0 to +0 and returning the
+  // same NaN for every NaN input.
+  for(; i + 4 <= count; i += 4)
+  {
+    __m128i h = _mm_unpacklo_epi16(_mm_loadl_epi64((const __m128i *)(src + i)), zero);
+
+    __m128i expMant = _mm_and_si128(h, expMantMask);
+    __m128i sign = _mm_slli_epi32(_mm_and_si128(h, signMask), 16);
+
+    // normal values just need the exponent rebased
+    __m128i normal = _mm_add_epi32(_mm_slli_epi32(expMant, 13), rebias);
+
+    // subnormals are the mantissa as an integer, scaled by 2^-24. This is exact, and doesn't
+    // depend on denormal handling in the FPU
+    __m128i subnormal =
+        _mm_castps_si128(_mm_mul_ps(_mm_cvtepi32_ps(expMant), subnormalScale));
+
+    __m128i isSubnormal = _mm_cmpgt_epi32(_mm_add_epi32(lastSubnormal, _mm_set1_epi32(1)), expMant);
+    __m128i isInfNaN = _mm_cmpgt_epi32(expMant, lastFinite);
+    __m128i isNaN = _mm_cmpgt_epi32(expMant, halfInf);
+    __m128i isZero = _mm_cmpeq_epi32(expMant, zero);
+
+    __m128i ret = _mm_or_si128(_mm_and_si128(isSubnormal, subnormal),
+                               _mm_andnot_si128(isSubnormal, normal));
+    ret = _mm_or_si128(_mm_and_si128(isInfNaN, floatInf), _mm_andnot_si128(isInfNaN, ret));
+
+    // zeroes lose their sign, NaNs are replaced entirely
+    ret = _mm_or_si128(ret, _mm_andnot_si128(isZero, sign));
+    ret = _mm_or_si128(_mm_and_si128(isNaN, floatNaN), _mm_andnot_si128(isNaN, ret));
+
+    _mm_storeu_ps(dst + i, _mm_castsi128_ps(ret));
+  }
+#endif
+
+  for(; i < count; i++)
+    dst[i] = ConvertFromHalf(src[i]);
+}
+
+void ConvertHalfLinearToSRGB8(const uint16_t *src, byte *dst, size_t count)
+{
+  // every half value maps to one byte, so a full table is only 64kB and is exact
+  static byte table[0x10000];
+  static bool tableInit = []() {
+    for(uint32_t i = 0; i < 0x10000; i++)
+    {
+      float linear = RDCCLAMP(ConvertFromHalf(uint16_t(i)), 0.0f, 1.0f);
+
+      if(linear < 0.0031308f)
+        table[i] = byte(255.0f * (12.92f * linear));
+      else
+        table[i] = byte(255.0f * (1.055f * powf(linear, 1.0f / 2.4f) - 0.055f));
+    }
+    return true;
+  }();
+  (void)tableInit;
+
+  for(size_t i = 0; i < count; i++)
+    dst[i] = table[src[i]];
+}
+
+namespace
+{
+// each of these decodes one component for a span of texels into a Vec4f array, identically to
+// ConvertComponent but without re-checking the format for every component.
+template <typename T>
+void DecodeComponents(const byte *src, size_t stride, size_t count, float *dst)
+{
+  for(size_t i = 0; i < count; i++)
+  {
+    T val;
+    memcpy(&val, src + i * stride, sizeof(T));
+    dst[i * 4] = float(val);
+  }
+}
+
+template <typename T>
+void DecodeUNormComponents(const byte *src, size_t stride, size_t count, float *dst, float divisor)
+{
+  for(size_t i = 0; i < count; i++)
+  {
+    T val;
+    memcpy(&val, src + i * stride, sizeof(T));
+    dst[i * 4] = float(val) / divisor;
+  }
+}
+
+template <typename T>
+void DecodeSNormComponents(const byte *src, size_t stride, size_t count, float *dst, float divisor)
+{
+  for(size_t i = 0; i < count; i++)
+  {
+    T val;
+    memcpy(&val, src + i * stride, sizeof(T));
+    dst[i * 4] = RDCMAX(-1.0f, float(val) / divisor);
+  }
+}
+
+void DecodeHalfComponents(const byte *src, size_t stride, size_t count, float *dst)
+{
+  // gather into contiguous chunks so they can be converted together
+  uint16_t halves[256];
+  float floats[256];
+
+  for(size_t base = 0; base < count; base += 256)
+  {
+    size_t num = RDCMIN(count - base, (size_t)256);
+
+    for(size_t i = 0; i < num; i++)
+      memcpy(&halves[i], src + (base + i) * stride, sizeof(uint16_t));
+
+    ConvertFromHalf(halves, floats, num);
+
+    for(size_t i = 0; i < num; i++)
+      dst[(base + i) * 4] = floats[i];
+  }
+}
+
+bool DecodeRegularComponents(const ResourceFormat &fmt, const byte *src, size_t stride,
+                             size_t count, float *dst)
+{
+  const CompType compType = fmt.compType;
+
+  if(fmt.compByteWidth == 8)
+  {
+    if(compType == CompType::Double || compType == CompType::Float)
+      DecodeComponents<double>(src, stride, count, dst);
+    else if(compType == CompType::UInt || compType == CompType::UScaled)
+      DecodeComponents<uint64_t>(src, stride, count, dst);
+    else if(compType == CompType::SInt || compType == CompType::SScaled)
+      DecodeComponents<int64_t>(src, stride, count, dst);
+    else
+      return false;
+  }
+  else if(fmt.compByteWidth == 4)
+  {
+    if(compType == CompType::Float || compType == CompType::Depth)
+      DecodeComponents<float>(src, stride, count, dst);
+    else if(compType == CompType::UInt || compType == CompType::UScaled)
+      DecodeComponents<uint32_t>(src, stride, count, dst);
+    else if(compType == CompType::SInt || compType == CompType::SScaled)
+      DecodeComponents<int32_t>(src, stride, count, dst);
+    else
+      return false;
+  }
+  else if(fmt.compByteWidth == 3 && compType == CompType::Depth)
+  {
+    for(size_t i = 0; i < count; i++)
+    {
+      const byte *u8 = src + i * stride;
+      uint32_t depth = uint32_t(u8[1]) | uint32_t(u8[2]) << 8 | uint32_t(u8[3]) << 16;
+      dst[i * 4] = float(depth) / float(16777215.0f);
+    }
+  }
+  else if(fmt.compByteWidth == 2)
+  {
+    if(compType == CompType::Float)
+      DecodeHalfComponents(src, stride, count, dst);
+    else if(compType == CompType::UInt || compType == CompType::UScaled)
+      DecodeComponents<uint16_t>(src, stride, count, dst);
+    else if(compType == CompType::SInt || compType == CompType::SScaled)
+      DecodeComponents<int16_t>(src, stride, count, dst);
+    else if(compType == CompType::UNorm || compType == CompType::Depth)
+      DecodeUNormComponents<uint16_t>(src, stride, count, dst, 65535.0f);
+    else if(compType == CompType::SNorm)
+      DecodeSNormComponents<int16_t>(src, stride, count, dst, 32767.0f);
+    else
+      return false;
+  }
+  else if(fmt.compByteWidth == 1)
+  {
+    if(compType == CompType::UInt || compType == CompType::UScaled)
+    {
+      DecodeComponents<uint8_t>(src, stride, count, dst);
+    }
+    else if(compType == CompType::SInt || compType == CompType::SScaled)
+    {
+      DecodeComponents<int8_t>(src, stride, count, dst);
+    }
+    else if(compType == CompType::UNormSRGB)
+    {
+      for(size_t i = 0; i < count; i++)
+        dst[i * 4] = SRGB8_lookuptable[src[i * stride]];
+    }
+    else if(compType == CompType::UNorm)
+    {
+      DecodeUNormComponents<uint8_t>(src, stride, count, dst, 255.0f);
+    }
+    else if(compType == CompType::SNorm)
+    {
+      DecodeSNormComponents<int8_t>(src, stride, count, dst, 127.0f);
+    }
+    else
+    {
+      return false;
+    }
+  }
+  else
+  {
+    return false;
+  }
+
+  return true;
+}
+
+template <typename T, typename F>
+void DecodePacked(const byte *src, size_t count, Vec4f *dst, F decode)
+{
+  for(size_t i = 0; i < count; i++)
+  {
+    T val;
+    memcpy(&val, src + i * sizeof(T), sizeof(T));
+    decode(val, dst[i]);
+  }
+}
+};
+
+bool DecodeFormattedPixels(const ResourceFormat &fmt, const byte *src, size_t count, Vec4f *dst)
+{
+  switch(fmt.type)
+  {
+    case ResourceFormatType::Regular:
+    {
+      const uint32_t numComps = RDCMIN(4U, (uint32_t)fmt.compCount);
+
+      size_t stride = fmt.ElementSize();
+
+      // 24-bit depth still has a stride of 4 bytes.
+      if(fmt.compType == CompType::Depth && fmt.compByteWidth == 3)
+        stride = 4;
+
+      for(size_t i = 0; i < count; i++)
+        dst[i] = Vec4f(0.0f, 0.0f, 0.0f, 1.0f);
+
+      // sRGB only applies to the colour channels, alpha is always stored linearly
+      ResourceFormat alphaFmt = fmt;
+      if(alphaFmt.compType == CompType::UNormSRGB)
+        alphaFmt.compType = CompType::UNorm;
+
+      for(uint32_t c = 0; c < numComps; c++)
+      {
+        if(!DecodeRegularComponents(c == 3 ? alphaFmt : fmt, src + fmt.compByteWidth * c, stride,
+                                    count, &dst[0].x + c))
+        {
+          RDCERR("Unexpected format to convert from %u %u", fmt.compByteWidth, fmt.compType);
+
+          // same as ConvertComponent, any unsupported components are 0
+          for(size_t i = 0; i < count; i++)
+            (&dst[i].x)[c] = 0.0f;
+        }
+      }
+
+      break;
+    }
+    case ResourceFormatType::R10G10B10A2:
+    {
+      if(fmt.compType == CompType::SNorm)
+      {
+        DecodePacked<uint32_t>(src, count, dst, [](uint32_t data, Vec4f &out) {
+          out = ConvertFromR10G10B10A2SNorm(data);
+        });
+      }
+      else if(fmt.compType == CompType::UInt)
+      {
+        DecodePacked<uint32_t>(src, count, dst, [](uint32_t data, Vec4f &out) {
+          out = Vec4f(float((data >> 0) & 0x3ff), float((data >> 10) & 0x3ff),
+                      float((data >> 20) & 0x3ff), float((data >> 30) & 0x003));
+        });
+      }
+      else
+      {
+        DecodePacked<uint32_t>(src, count, dst, [](uint32_t data, Vec4f &out) {
+          out = ConvertFromR10G10B10A2(data);
+        });
+      }
+      break;
+    }
+    case ResourceFormatType::R11G11B10:
+      DecodePacked<uint32_t>(src, count, dst, [](uint32_t data, Vec4f &out) {
+        Vec3f v = ConvertFromR11G11B10(data);
+        out = Vec4f(v.x, v.y, v.z, 1.0f);
+      });
+      break;
+    case ResourceFormatType::R9G9B9E5:
+      DecodePacked<uint32_t>(src, count, dst, [](uint32_t data, Vec4f &out) {
+        Vec3f v = ConvertFromR9G9B9E5(data);
+        out = Vec4f(v.x, v.y, v.z, 1.0f);
+      });
+      break;
+    case ResourceFormatType::R5G6B5:
+      DecodePacked<uint16_t>(src, count, dst, [](uint16_t data, Vec4f &out) {
+        Vec3f v = ConvertFromB5G6R5(data);
+        out = Vec4f(v.x, v.y, v.z, 1.0f);
+      });
+      break;
+    case ResourceFormatType::R5G5B5A1:
+      DecodePacked<uint16_t>(src, count, dst, [](uint16_t data, Vec4f &out) {
+        out = ConvertFromB5G5R5A1(data);
+      });
+      break;
+    case ResourceFormatType::R4G4B4A4:
+      DecodePacked<uint16_t>(src, count, dst, [](uint16_t data, Vec4f &out) {
+        out = ConvertFromB4G4R4A4(data);
+      });
+      break;
+    case ResourceFormatType::R4G4:
+      DecodePacked<uint8_t>(src, count, dst, [](uint8_t data, Vec4f &out) {
+        out = Vec4f(float(data & 0xf) / 15.0f, float(data >> 4) / 15.0f, 0.0f, 1.0f);
+      });
+      break;
+    case ResourceFormatType::D16S8:
+      for(size_t i = 0; i < count; i++)
+      {
+        uint16_t depth;
+        memcpy(&depth, src + i * 3, sizeof(depth));
+        dst[i] = Vec4f(float(depth) / 65535.0f, float(src[i * 3 + 2]), 0.0f, 1.0f);
+      }
+      break;
+    case ResourceFormatType::D24S8:
+      DecodePacked<uint32_t>(src, count, dst, [](uint32_t data, Vec4f &out) {
+        out = Vec4f(float(data & 0xffffff) / float(16777215.0f), float(data >> 24), 0.0f, 1.0f);
+      });
+      break;
+    case ResourceFormatType::D32S8:
+      for(size_t i = 0; i < count; i++)
+      {
+        float depth;
+        memcpy(&depth, src + i * 5, sizeof(depth));
+        dst[i] = Vec4f(depth, float(src[i * 5 + 4]), 0.0f, 1.0f);
+      }
+      break;
+    case ResourceFormatType::S8:
+      for(size_t i = 0; i < count; i++)
+        dst[i] = Vec4f(float(src[i]), 0.0f, 0.0f, 1.0f);
+      break;
+    case ResourceFormatType::A8:
+      for(size_t i = 0; i < count; i++)
+        dst[i] = Vec4f(0.0f, 0.0f, 0.0f, float(src[i]) / 255.0f);
+      break;
+    case ResourceFormatType::Undefined:
+    case ResourceFormatType::BC1:
+    case ResourceFormatType::BC2:
+    case ResourceFormatType::BC3:
+    case ResourceFormatType::BC4:
+    case ResourceFormatType::BC5:
+    case ResourceFormatType::BC6:
+    case ResourceFormatType::BC7:
+    case ResourceFormatType::ETC2:
+    case ResourceFormatType::EAC:
+    case ResourceFormatType::ASTC:
+    case ResourceFormatType::YUV8:
+    case ResourceFormatType::YUV10:
+    case ResourceFormatType::YUV12:
+    case ResourceFormatType::YUV16:
+    case ResourceFormatType::PVRTC: return false;
+  }
+
+  if(fmt.BGRAOrder())
+  {
+    for(size_t i = 0; i < count; i++)
+      std::swap(dst[i].x, dst[i].z);
+  }
+
+  return true;
+}
+
 #if ENABLED(ENABLE_UNIT_TESTS)
 
 #undef None
 
 #include "3rdparty/catch/catch.hpp"
+#include "common/timing.h"
 
 TEST_CASE("Check format conversion", "[format]")
 {
@@ -389,6 +902,20 @@ TEST_CASE("Check format conversion", "[format]")
     }
   };
 
+  SECTION("Spot test ConvertFromR9G9B9E5")
+  {
+    // 256 * 2^(16 - 15 - 9) = 1.0
+    Vec3f v = ConvertFromR9G9B9E5((16U << 27) | (0x100U << 18) | (0x80U << 9) | 0x1ffU);
+    CHECK(v.x == float(0x1ff) / 256.0f);
+    CHECK(v.y == 0.5f);
+    CHECK(v.z == 1.0f);
+
+    // smallest representable value
+    v = ConvertFromR9G9B9E5(1U);
+    CHECK(v.x == 1.0f / float(1 << 24));
+    CHECK(v.y == 0.0f);
+  };
+
   SECTION("Spot test ConvertToR11G11B10")
   {
 #undef TEST11
@@ -456,4 +983,214 @@ TEST_CASE("Check format conversion", "[format]")
   };
 }
 
+TEST_CASE("Check bulk format conversion", "[format]")
+{
+  uint32_t seed = 0x12345678U;
+  auto random = [&seed]() {
+    seed = seed * 1103515245U + 12345U;
+    return byte(seed >> 16);
+  };
+
+  SECTION("Bulk half conversion matches scalar")
+  {
+    std::vector<uint16_t> halves(0x10001);
+    for(uint32_t i = 0; i < 0x10000; i++)
+      halves[i + 1] = uint16_t(i);
+
+    std::vector<float> floats(halves.size());
+
+    // convert from an odd offset too so the vector loads are unaligned and there's a tail
+    for(size_t offset : {0, 1})
+    {
+      ConvertFromHalf(halves.data() + offset, floats.data(), halves.size() - offset);
+
+      size_t mismatches = 0;
+      for(size_t i = 0; i < halves.size() - offset; i++)
+      {
+        float expected = ConvertFromHalf(halves[i + offset]);
+        if(memcmp(&expected, &floats[i], sizeof(float)) != 0)
+          mismatches++;
+      }
+
+      CHECK(mismatches == 0);
+    }
+  };
+
+  SECTION("Half to sRGB8 matches direct conversion")
+  {
+    std::vector<uint16_t> halves(0x10000);
+    for(uint32_t i = 0; i < 0x10000; i++)
+      halves[i] = uint16_t(i);
+
+    std::vector<byte> srgb(halves.size());
+    ConvertHalfLinearToSRGB8(halves.data(), srgb.data(), halves.size());
+
+    size_t mismatches = 0;
+    for(uint32_t i = 0; i < 0x10000; i++)
+    {
+      float linear = RDCCLAMP(ConvertFromHalf(uint16_t(i)), 0.0f, 1.0f);
+      byte expected = linear < 0.0031308f
+                          ? byte(255.0f * (12.92f * linear))
+                          : byte(255.0f * (1.055f * powf(linear, 1.0f / 2.4f) - 0.055f));
+      if(srgb[i] != expected)
+        mismatches++;
+    }
+
+    CHECK(mismatches == 0);
+  };
+
+  SECTION("Decoding regular formats matches per-component conversion")
+  {
+    const rdcpair<uint8_t, CompType> types[] = {
+        {8, CompType::Double}, {8, CompType::UInt},  {8, CompType::SInt},
+        {4, CompType::Float},  {4, CompType::UInt},  {4, CompType::SInt},
+        {4, CompType::Depth},  {3, CompType::Depth}, {2, CompType::Float},
+        {2, CompType::UInt},   {2, CompType::SInt},  {2, CompType::UNorm},
+        {2, CompType::SNorm},  {2, CompType::Depth}, {1, CompType::UInt},
+        {1, CompType::SInt},   {1, CompType::UNorm}, {1, CompType::UNormSRGB},
+        {1, CompType::SNorm},
+    };
+
+    const size_t count = 67;
+
+    for(const rdcpair<uint8_t, CompType> &type : types)
+    {
+      for(uint8_t compCount = 1; compCount <= 4; compCount++)
+      {
+        // 24-bit depth is only single component
+        if(type.first == 3 && compCount > 1)
+          continue;
+
+        for(bool bgra : {false, true})
+        {
+          if(bgra && compCount != 4)
+            continue;
+
+          ResourceFormat fmt;
+          fmt.type = ResourceFormatType::Regular;
+          fmt.compByteWidth = type.first;
+          fmt.compType = type.second;
+          fmt.compCount = compCount;
+          fmt.SetBGRAOrder(bgra);
+
+          const size_t stride = type.first == 3 ? 4 : type.first * compCount;
+
+          bytebuf data;
+          data.resize(stride * count);
+          for(byte &b : data)
+            b = random();
+
+          std::vector<Vec4f> decoded(count);
+          REQUIRE(DecodeFormattedPixels(fmt, data.data(), count, decoded.data()));
+
+          size_t mismatches = 0;
+          for(size_t i = 0; i < count; i++)
+          {
+            float expected[4] = {0.0f, 0.0f, 0.0f, 1.0f};
+            for(uint8_t c = 0; c < compCount; c++)
+              expected[c] = ConvertComponent(fmt, data.data() + i * stride + c * type.first);
+            // alpha is never sRGB encoded
+            if(compCount == 4 && type.second == CompType::UNormSRGB)
+              expected[3] = float(data[i * stride + 3]) / 255.0f;
+            if(bgra)
+              std::swap(expected[0], expected[2]);
+
+            if(memcmp(expected, &decoded[i], sizeof(expected)) != 0)
+              mismatches++;
+          }
+
+          INFO("Format: " << fmt.Name().c_str());
+          CHECK(mismatches == 0);
+        }
+      }
+    }
+  };
+
+  SECTION("Decoding packed formats matches per-texel conversion")
+  {
+    const size_t count = 33;
+
+    uint32_t data[count];
+    for(uint32_t &d : data)
+      d = uint32_t(random()) | uint32_t(random()) << 8 | uint32_t(random()) << 16 |
+          uint32_t(random()) << 24;
+
+    ResourceFormat fmt;
+    fmt.compType = CompType::UNorm;
+    fmt.compCount = 4;
+    fmt.compByteWidth = 1;
+
+    Vec4f decoded[count];
+
+    fmt.type = ResourceFormatType::R10G10B10A2;
+    REQUIRE(DecodeFormattedPixels(fmt, (const byte *)data, count, decoded));
+    for(size_t i = 0; i < count; i++)
+    {
+      Vec4f expected = ConvertFromR10G10B10A2(data[i]);
+      CHECK(memcmp(&expected, &decoded[i], sizeof(Vec4f)) == 0);
+    }
+
+    fmt.type = ResourceFormatType::R11G11B10;
+    fmt.compType = CompType::Float;
+    fmt.compCount = 3;
+    REQUIRE(DecodeFormattedPixels(fmt, (const byte *)data, count, decoded));
+    for(size_t i = 0; i < count; i++)
+    {
+      Vec3f expected = ConvertFromR11G11B10(data[i]);
+      CHECK(memcmp(&expected, &decoded[i], sizeof(Vec3f)) == 0);
+      CHECK(decoded[i].w == 1.0f);
+    }
+
+    fmt.type = ResourceFormatType::BC1;
+    CHECK_FALSE(DecodeFormattedPixels(fmt, (const byte *)data, count, decoded));
+  };
+}
+
+// not run by default, run explicitly with the [benchmark] tag
+TEST_CASE("Benchmark bulk format conversion", "[.][benchmark][format]")
+{
+  const uint32_t width = 4096, height = 1024;
+
+  bytebuf data;
+  data.resize(width * height * 16);
+  for(size_t i = 0; i < data.size(); i++)
+    data[i] = byte((i * 2654435761U) >> 13);
+
+  std::vector<Vec4f> row(width);
+
+  const rdcpair<uint8_t, CompType> types[] = {
+      {2, CompType::Float}, {1, CompType::UNorm}, {4, CompType::Float},
+  };
+
+  for(const rdcpair<uint8_t, CompType> &type : types)
+  {
+    ResourceFormat fmt;
+    fmt.type = ResourceFormatType::Regular;
+    fmt.compByteWidth = type.first;
+    fmt.compType = type.second;
+    fmt.compCount = 4;
+
+    const uint32_t stride = fmt.compByteWidth * 4;
+    const double megabytes = double(width * height * stride) / (1024.0 * 1024.0);
+
+    PerformanceTimer timer;
+    for(uint32_t y = 0; y < height; y++)
+    {
+      const byte *src = data.data() + y * width * stride;
+      for(uint32_t x = 0; x < width; x++)
+        for(uint32_t c = 0; c < 4; c++)
+          (&row[x].x)[c] = ConvertComponent(fmt, src + x * stride + c * fmt.compByteWidth);
+    }
+    double scalarMS = timer.GetMilliseconds();
+
+    timer.Restart();
+    for(uint32_t y = 0; y < height; y++)
+      DecodeFormattedPixels(fmt, data.data() + y * width * stride, width, row.data());
+    double bulkMS = timer.GetMilliseconds();
+
+    RDCLOG("%s: %.2f MB/s per-component, %.2f MB/s bulk", fmt.Name().c_str(),
+           megabytes / (scalarMS / 1000.0), megabytes / (bulkMS / 1000.0));
+  }
+}
+
 #endif
@@ -96,6 +96,15 @@ inline Vec4f ConvertFromB4G4R4A4(uint16_t data)
                (float)((data >> 8) & 0xf) / 15.0f, (float)((data >> 12) & 0xf) / 15.0f);
 }
 
+inline Vec3f ConvertFromR9G9B9E5(uint32_t data)
+{
+  // the shared exponent has a bias of 15, and the mantissas have no implicit leading 1
+  float scale = ldexpf(1.0f, int(data >> 27) - 15 - 9);
+
+  return Vec3f(float((data >> 0) & 0x1ff) * scale, float((data >> 9) & 0x1ff) * scale,
+               float((data >> 18) & 0x1ff) * scale);
+}
+
 extern float SRGB8_lookuptable[256];
 
 inline float ConvertFromSRGB8(uint8_t comp)
@@ -139,3 +148,15 @@ typedef uint8_t byte;
 
 struct ResourceFormat;
 float ConvertComponent(const ResourceFormat &fmt, const byte *data);
+
+// bulk conversions over whole spans at a time, which give identical results to calling the single
+// value functions above on each element but use SIMD where possible.
+void ConvertFromHalf(const uint16_t *src, float *dst, size_t count);
+// converts linear half floats to 8-bit sRGB, clamping to [0, 1] first.
+void ConvertHalfLinearToSRGB8(const uint16_t *src, byte *dst, size_t count);
+
+// decodes count tightly packed texels in fmt to RGBA. Missing components are filled from
+// (0, 0, 0, 1) and BGRA ordered formats are swizzled to RGBA. Alpha in sRGB formats is linear, as
+// the GPU decodes it, so it is converted as UNorm. Returns false and leaves dst
+// untouched for formats that can't be decoded per-texel like block compressed and YUV formats.
+bool DecodeFormattedPixels(const ResourceFormat &fmt, const byte *src, size_t count, Vec4f *dst);
@@ -379,6 +379,15 @@ TEST_CASE("Test OS-specific functions", "[osspecific]")
       }
     };
 
+    SECTION("32-bits trailing")
+    {
+      CHECK(Bits::CountTrailingZeroes(0U) == 32);
+      CHECK(Bits::CountTrailingZeroes(1U) == 0);
+      CHECK(Bits::CountTrailingZeroes(0x80000000U) == 31);
+      CHECK(Bits::CountTrailingZeroes(0x0001F800U) == 11);
+      CHECK(Bits::CountTrailingZeroes(0xFFFFFFF0U) == 4);
+    };
+
 #if ENABLED(RDOC_X64)
     SECTION("64-bits")
     {
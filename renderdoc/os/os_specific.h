@@ -130,6 +130,25 @@ public:
   data m_Data;
 };
 
+// a counting semaphore. Wait() blocks until the count is non-zero then decrements it, Wake()
+// increments it by count and releases that many waiters.
+template <class data>
+class SemaphoreTemplate
+{
+public:
+  SemaphoreTemplate();
+  ~SemaphoreTemplate();
+
+  void Wait();
+  void Wake(uint32_t count);
+
+  // no copying
+  SemaphoreTemplate &operator=(const SemaphoreTemplate &other) = delete;
+  SemaphoreTemplate(const SemaphoreTemplate &other) = delete;
+
+  data m_Data;
+};
+
 void Init();
 void Shutdown();
 uint64_t AllocateTLSSlot();
@@ -137,7 +156,8 @@ uint64_t AllocateTLSSlot();
 void *GetTLSValue(uint64_t slot);
 void SetTLSValue(uint64_t slot, void *value);
 
-// must typedef CriticalSectionTemplate<X> CriticalSection
+// must typedef CriticalSectionTemplate<X> CriticalSection, RWLockTemplate<X> RWLock and
+// SemaphoreTemplate<X> Semaphore
 
 typedef uint64_t ThreadHandle;
 ThreadHandle CreateThread(std::function<void()> entryFunc);
@@ -147,6 +167,9 @@ void DetachThread(ThreadHandle handle);
 void CloseThread(ThreadHandle handle);
 void Sleep(uint32_t milliseconds);
 
+// returns the number of logical processors available, always at least 1
+uint32_t GetNumberOfCores();
+
 // kind of windows specific, to handle this case:
 // http://blogs.msdn.com/b/oldnewthing/archive/2013/11/05/10463645.aspx
 void KeepModuleAlive();
@@ -221,6 +244,8 @@ int64_t Inc64(volatile int64_t *i);
 int64_t Dec64(volatile int64_t *i);
 int64_t ExchAdd64(volatile int64_t *i, int64_t a);
 int32_t CmpExch32(volatile int32_t *dest, int32_t oldVal, int32_t newVal);
+int64_t CmpExch64(volatile int64_t *dest, int64_t oldVal, int64_t newVal);
+void *CmpExchPtr(void *volatile *dest, void *oldVal, void *newVal);
 };
 
 namespace Callstack
@@ -281,6 +306,7 @@ void GetExecutableFilename(std::string &selfName);
 void GetLibraryFilename(std::string &selfName);
 
 uint64_t GetModifiedTimestamp(const std::string &filename);
+void UpdateModifiedTimestamp(const std::string &filename);
 
 bool Copy(const char *from, const char *to, bool allowOverwrite);
 bool Move(const char *from, const char *to, bool allowOverwrite);
@@ -303,6 +329,17 @@ void fseek64(FILE *f, uint64_t offset, int origin);
 
 void ftruncateat(FILE *f, uint64_t length);
 
+// maps the whole of an open file into memory. The mapping is copy-on-write, so it can be modified
+// without changing the file. Returns NULL if the file can't be mapped, in which case callers should
+// fall back to reading it.
+void *fmap(FILE *f, uint64_t &size);
+void funmap(void *ptr, uint64_t size);
+
+// writes to an absolute offset in an open file, bypassing the stream's buffer and position. Several
+// threads can write disjoint ranges of the same file at once. The stream must be flushed first, and
+// its position is unspecified afterwards so callers should seek before using it again.
+bool fwriteat(const void *buf, size_t byteCount, FILE *f, uint64_t offset);
+
 bool fflush(FILE *f);
 
 bool feof(FILE *f);
@@ -444,6 +481,7 @@ inline uint32_t CountLeadingZeroes(uint32_t value);
 #if ENABLED(RDOC_X64)
 inline uint64_t CountLeadingZeroes(uint64_t value);
 #endif
+inline uint32_t CountTrailingZeroes(uint32_t value);
 };
 
 // must #define:
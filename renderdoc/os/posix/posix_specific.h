@@ -109,6 +109,15 @@ struct pthreadRWLockData
   pthread_rwlockattr_t attr;
 };
 typedef RWLockTemplate<pthreadRWLockData> RWLock;
+
+// unnamed POSIX semaphores aren't available everywhere, so this is built on a condition variable
+struct pthreadSemaphoreData
+{
+  pthread_mutex_t lock;
+  pthread_cond_t cond;
+  uint32_t count;
+};
+typedef SemaphoreTemplate<pthreadSemaphoreData> Semaphore;
 };
 
 namespace Bits
@@ -124,4 +133,9 @@ inline uint64_t CountLeadingZeroes(uint64_t value)
   return value == 0 ? 64 : __builtin_clzl(value);
 }
 #endif
+
+inline uint32_t CountTrailingZeroes(uint32_t value)
+{
+  return value == 0 ? 32 : __builtin_ctz(value);
+}
 };
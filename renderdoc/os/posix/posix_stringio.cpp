@@ -32,10 +32,12 @@
 #include <stdlib.h>
 #include <string.h>
 #include <sys/file.h>
+#include <sys/mman.h>
 #include <sys/stat.h>
 #include <sys/types.h>
 #include <time.h>
 #include <unistd.h>
+#include <utime.h>
 #include "api/app/renderdoc_app.h"
 #include "common/threading.h"
 #include "os/os_specific.h"
@@ -253,6 +255,11 @@ uint64_t GetModifiedTimestamp(const std::string &filename)
   return 0;
 }
 
+void UpdateModifiedTimestamp(const std::string &filename)
+{
+  utime(filename.c_str(), NULL);
+}
+
 bool Copy(const char *from, const char *to, bool allowOverwrite)
 {
   if(from[0] == 0 || to[0] == 0)
@@ -453,6 +460,51 @@ void ftruncateat(FILE *f, uint64_t length)
   ::ftruncate(fd, (off_t)length);
 }
 
+void *fmap(FILE *f, uint64_t &size)
+{
+  struct ::stat st;
+  if(::fstat(::fileno(f), &st) != 0 || st.st_size <= 0 || uint64_t(st.st_size) > SIZE_MAX)
+    return NULL;
+
+  size = (uint64_t)st.st_size;
+
+  void *ret = ::mmap(NULL, (size_t)size, PROT_READ | PROT_WRITE, MAP_PRIVATE, ::fileno(f), 0);
+
+  if(ret == MAP_FAILED)
+    return NULL;
+
+  return ret;
+}
+
+void funmap(void *ptr, uint64_t size)
+{
+  if(ptr)
+    ::munmap(ptr, (size_t)size);
+}
+
+bool fwriteat(const void *buf, size_t byteCount, FILE *f, uint64_t offset)
+{
+  int fd = ::fileno(f);
+  const char *src = (const char *)buf;
+
+  while(byteCount > 0)
+  {
+    ssize_t written = ::pwrite(fd, src, byteCount, (off_t)offset);
+
+    if(written < 0 && errno == EINTR)
+      continue;
+
+    if(written <= 0)
+      return false;
+
+    src += written;
+    offset += (uint64_t)written;
+    byteCount -= (size_t)written;
+  }
+
+  return true;
+}
+
 bool fflush(FILE *f)
 {
   return ::fflush(f) == 0;
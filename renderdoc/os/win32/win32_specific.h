@@ -73,6 +73,7 @@ namespace Threading
 {
 typedef CriticalSectionTemplate<CRITICAL_SECTION> CriticalSection;
 typedef RWLockTemplate<SRWLOCK> RWLock;
+typedef SemaphoreTemplate<HANDLE> Semaphore;
 };
 
 namespace Bits
@@ -92,4 +93,11 @@ inline uint64_t CountLeadingZeroes(uint64_t value)
   return (result == TRUE) ? (index ^ 63) : 64;
 }
 #endif
+
+inline uint32_t CountTrailingZeroes(uint32_t value)
+{
+  DWORD index;
+  BOOLEAN result = _BitScanForward(&index, value);
+  return (result == TRUE) ? index : 32;
+}
 };
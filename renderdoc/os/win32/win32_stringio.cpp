@@ -432,6 +432,23 @@ uint64_t GetModifiedTimestamp(const std::string &filename)
   return 0;
 }
 
+void UpdateModifiedTimestamp(const std::string &filename)
+{
+  std::wstring wfn = StringFormat::UTF82Wide(filename);
+
+  HANDLE h = CreateFileW(wfn.c_str(), FILE_WRITE_ATTRIBUTES, FILE_SHARE_READ | FILE_SHARE_WRITE,
+                         NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+
+  if(h == INVALID_HANDLE_VALUE)
+    return;
+
+  FILETIME now;
+  GetSystemTimeAsFileTime(&now);
+  SetFileTime(h, NULL, &now, &now);
+
+  CloseHandle(h);
+}
+
 bool Copy(const char *from, const char *to, bool allowOverwrite)
 {
   std::wstring wfrom = StringFormat::UTF82Wide(std::string(from));
@@ -652,6 +669,66 @@ void ftruncateat(FILE *f, uint64_t length)
   ::_chsize_s(fd, (int64_t)length);
 }
 
+void *fmap(FILE *f, uint64_t &size)
+{
+  HANDLE file = (HANDLE)::_get_osfhandle(::_fileno(f));
+
+  LARGE_INTEGER fileSize = {};
+  if(file == INVALID_HANDLE_VALUE || !GetFileSizeEx(file, &fileSize) || fileSize.QuadPart <= 0 ||
+     uint64_t(fileSize.QuadPart) > SIZE_MAX)
+    return NULL;
+
+  HANDLE mapping = CreateFileMappingW(file, NULL, PAGE_WRITECOPY, 0, 0, NULL);
+  if(mapping == NULL)
+    return NULL;
+
+  void *ret = MapViewOfFile(mapping, FILE_MAP_COPY, 0, 0, 0);
+
+  // the view keeps the mapping alive
+  CloseHandle(mapping);
+
+  if(ret)
+    size = (uint64_t)fileSize.QuadPart;
+
+  return ret;
+}
+
+void funmap(void *ptr, uint64_t size)
+{
+  if(ptr)
+    UnmapViewOfFile(ptr);
+}
+
+bool fwriteat(const void *buf, size_t byteCount, FILE *f, uint64_t offset)
+{
+  HANDLE file = (HANDLE)::_get_osfhandle(::_fileno(f));
+
+  if(file == INVALID_HANDLE_VALUE)
+    return false;
+
+  const char *src = (const char *)buf;
+
+  while(byteCount > 0)
+  {
+    // the offset in the OVERLAPPED makes this a positional write even on a synchronous handle
+    OVERLAPPED overlapped = {};
+    overlapped.Offset = DWORD(offset & 0xffffffff);
+    overlapped.OffsetHigh = DWORD(offset >> 32);
+
+    DWORD chunk = (DWORD)RDCMIN(byteCount, (size_t)0x40000000);
+    DWORD written = 0;
+
+    if(!WriteFile(file, src, chunk, &written, &overlapped) || written == 0)
+      return false;
+
+    src += written;
+    offset += written;
+    byteCount -= written;
+  }
+
+  return true;
+}
+
 bool fflush(FILE *f)
 {
   return ::fflush(f) == 0;
@@ -82,6 +82,16 @@ int32_t CmpExch32(volatile int32_t *dest, int32_t oldVal, int32_t newVal)
 {
   return (int32_t)InterlockedCompareExchange((volatile LONG *)dest, newVal, oldVal);
 }
+
+int64_t CmpExch64(volatile int64_t *dest, int64_t oldVal, int64_t newVal)
+{
+  return (int64_t)InterlockedCompareExchange64((volatile LONG64 *)dest, newVal, oldVal);
+}
+
+void *CmpExchPtr(void *volatile *dest, void *oldVal, void *newVal)
+{
+  return InterlockedCompareExchangePointer((PVOID volatile *)dest, newVal, oldVal);
+}
 };
 
 namespace Threading
@@ -150,6 +160,27 @@ void RWLock::ReadUnlock()
   ReleaseSRWLockShared(&m_Data);
 }
 
+Semaphore::SemaphoreTemplate()
+{
+  m_Data = CreateSemaphore(NULL, 0, MAXLONG, NULL);
+}
+
+Semaphore::~SemaphoreTemplate()
+{
+  CloseHandle(m_Data);
+}
+
+void Semaphore::Wait()
+{
+  WaitForSingleObject(m_Data, INFINITE);
+}
+
+void Semaphore::Wake(uint32_t count)
+{
+  if(count > 0)
+    ReleaseSemaphore(m_Data, (LONG)count, NULL);
+}
+
 struct ThreadInitData
 {
   std::function<void()> entryFunc;
@@ -305,4 +336,11 @@ void Sleep(uint32_t milliseconds)
 {
   ::Sleep((DWORD)milliseconds);
 }
+
+uint32_t GetNumberOfCores()
+{
+  SYSTEM_INFO info = {};
+  GetSystemInfo(&info);
+  return info.dwNumberOfProcessors > 0 ? (uint32_t)info.dwNumberOfProcessors : 1;
+}
 };
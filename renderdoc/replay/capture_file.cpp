@@ -552,7 +552,21 @@ Thumbnail CaptureFile::GetThumbnail(FileType type, uint32_t maxsize)
   if(m_RDC == NULL)
     return ret;
 
-  const RDCThumb &thumb = m_RDC->GetThumbnail();
+  const RDCThumb *source = &m_RDC->GetThumbnail();
+
+  // if a smaller thumbnail is requested, start from the smallest pre-scaled copy that is still at
+  // least as big as requested. That's much cheaper to decode and often doesn't need resampling.
+  if(maxsize != 0 && source->pixels)
+  {
+    for(const RDCThumb &scaled : m_RDC->GetScaledThumbnails())
+    {
+      if(RDCMAX(scaled.width, scaled.height) >= maxsize &&
+         RDCMAX(scaled.width, scaled.height) < RDCMAX(source->width, source->height))
+        source = &scaled;
+    }
+  }
+
+  const RDCThumb &thumb = *source;
 
   const byte *thumbbuf = thumb.pixels;
   size_t thumblen = thumb.len;
@@ -565,7 +579,7 @@ Thumbnail CaptureFile::GetThumbnail(FileType type, uint32_t maxsize)
 
   // if the desired output is the format of stored thumbnail and either there's no max size or it's
   // already satisfied, return the data directly
-  if(type == thumb.format && (maxsize == 0 || (maxsize > thumbwidth && maxsize > thumbheight)))
+  if(type == thumb.format && (maxsize == 0 || (maxsize >= thumbwidth && maxsize >= thumbheight)))
   {
     buf.assign(thumbbuf, thumblen);
   }
@@ -31,6 +31,7 @@
 #include "maths/camera.h"
 #include "maths/formatpacking.h"
 #include "miniz/miniz.h"
+#include "replay/replay_driver.h"
 #include "strings/string_utils.h"
 
 // these entry points are for the replay/analysis side - not for the application.
@@ -190,6 +191,51 @@ extern "C" RENDERDOC_API uint64_t RENDERDOC_CC RENDERDOC_GetCurrentProcessMemory
   return Process::GetMemoryUsage();
 }
 
+extern "C" RENDERDOC_API void RENDERDOC_CC RENDERDOC_CalcTextureMinMax(
+    const ResourceFormat &format, const bytebuf &data, rdcpair<PixelValue, PixelValue> *minmax)
+{
+  PixelValue minval = {{0.0f, 0.0f, 0.0f, 0.0f}};
+  PixelValue maxval = {{1.0f, 1.0f, 1.0f, 1.0f}};
+
+  const size_t stride = GetTextureStatsStride(format);
+
+  if(stride > 0)
+    CalcTextureMinMax(format, data.data(), data.size() / stride, &minval.floatValue[0],
+                      &maxval.floatValue[0]);
+
+  *minmax = make_rdcpair(minval, maxval);
+}
+
+extern "C" RENDERDOC_API void RENDERDOC_CC RENDERDOC_CalcTextureHistogram(
+    const ResourceFormat &format, const bytebuf &data, float minval, float maxval,
+    bool channels[4], rdcarray<uint32_t> *histogram)
+{
+  std::vector<uint32_t> hist;
+
+  const size_t stride = GetTextureStatsStride(format);
+
+  if(stride > 0)
+    CalcTextureHistogram(format, data.data(), data.size() / stride, minval, maxval, channels, hist);
+
+  *histogram = hist;
+}
+
+extern "C" RENDERDOC_API void RENDERDOC_CC
+RENDERDOC_DecodeMeshVertices(const MeshFormat &mesh, const bytebuf &indexData,
+                             const bytebuf &vertexData, uint32_t first, uint32_t count,
+                             rdcarray<FloatVector> *positions)
+{
+  positions->resize(count);
+
+  // an offset past the end leaves no data, so every vertex is decoded as invalid
+  const size_t idxOffset = (size_t)RDCMIN(mesh.indexByteOffset, (uint64_t)indexData.size());
+  const size_t vertOffset = (size_t)RDCMIN(mesh.vertexByteOffset, (uint64_t)vertexData.size());
+
+  DecodeMeshVertices(mesh, indexData.data() + idxOffset, indexData.size() - idxOffset,
+                     vertexData.data() + vertOffset, vertexData.size() - vertOffset, first, count,
+                     positions->data(), NULL);
+}
+
 extern "C" RENDERDOC_API const char *RENDERDOC_CC RENDERDOC_GetConfigSetting(const char *name)
 {
   return RenderDoc::Inst().GetConfigSetting(name).c_str();
@@ -392,16 +392,42 @@ void DoSerialise(SerialiserType &ser, ShaderDebugState &el)
   SIZE_CHECK(128);
 }
 
+template <typename SerialiserType>
+void DoSerialise(SerialiserType &ser, ShaderVariableChange &el)
+{
+  SERIALISE_MEMBER(index);
+  SERIALISE_MEMBER(value);
+
+  SIZE_CHECK(200);
+}
+
+template <typename SerialiserType>
+void DoSerialise(SerialiserType &ser, ShaderDebugStateDelta &el)
+{
+  SERIALISE_MEMBER(keyframe);
+  SERIALISE_MEMBER(registers);
+  SERIALISE_MEMBER(outputs);
+  SERIALISE_MEMBER(indexableTemps);
+  SERIALISE_MEMBER(localsChanged);
+  SERIALISE_MEMBER(locals);
+  SERIALISE_MEMBER(modified);
+  SERIALISE_MEMBER(nextInstruction);
+  SERIALISE_MEMBER(flags);
+
+  SIZE_CHECK(144);
+}
+
 template <typename SerialiserType>
 void DoSerialise(SerialiserType &ser, ShaderDebugTrace &el)
 {
   SERIALISE_MEMBER(inputs);
   SERIALISE_MEMBER(constantBlocks);
-  SERIALISE_MEMBER(states);
+  SERIALISE_MEMBER(steps);
+  SERIALISE_MEMBER(keyframes);
   SERIALISE_MEMBER(hasLocals);
   SERIALISE_MEMBER(lineInfo);
 
-  SIZE_CHECK(104);
+  SIZE_CHECK(128);
 }
 
 template <typename SerialiserType>
@@ -2253,6 +2279,8 @@ INSTANTIATE_SERIALISE_TYPE(ShaderReflection)
 INSTANTIATE_SERIALISE_TYPE(ShaderVariable)
 INSTANTIATE_SERIALISE_TYPE(LocalVariableMapping);
 INSTANTIATE_SERIALISE_TYPE(ShaderDebugState)
+INSTANTIATE_SERIALISE_TYPE(ShaderVariableChange)
+INSTANTIATE_SERIALISE_TYPE(ShaderDebugStateDelta)
 INSTANTIATE_SERIALISE_TYPE(ShaderDebugTrace)
 INSTANTIATE_SERIALISE_TYPE(ResourceDescription)
 INSTANTIATE_SERIALISE_TYPE(TextureDescription)
@@ -27,6 +27,9 @@
 #include <string.h>
 #include <time.h>
 #include "common/dds_readwrite.h"
+#include "common/exr_readwrite.h"
+#include "common/image_write.h"
+#include "common/threading.h"
 #include "driver/ihv/amd/amd_isa.h"
 #include "driver/ihv/amd/amd_rgp.h"
 #include "jpeg-compressor/jpgd.h"
@@ -38,135 +41,34 @@
 #include "stb/stb_image.h"
 #include "stb/stb_image_write.h"
 #include "strings/string_utils.h"
-#include "tinyexr/tinyexr.h"
 
-float ConvertComponent(const ResourceFormat &fmt, const byte *data)
+static void fileWriteFunc(void *context, void *data, int size)
 {
-  if(fmt.compByteWidth == 8)
-  {
-    // we just downcast
-    const uint64_t *u64 = (const uint64_t *)data;
-    const int64_t *i64 = (const int64_t *)data;
-
-    if(fmt.compType == CompType::Double || fmt.compType == CompType::Float)
-    {
-      return float(*(const double *)u64);
-    }
-    else if(fmt.compType == CompType::UInt || fmt.compType == CompType::UScaled)
-    {
-      return float(*u64);
-    }
-    else if(fmt.compType == CompType::SInt || fmt.compType == CompType::SScaled)
-    {
-      return float(*i64);
-    }
-  }
-  else if(fmt.compByteWidth == 4)
-  {
-    const uint32_t *u32 = (const uint32_t *)data;
-    const int32_t *i32 = (const int32_t *)data;
-
-    if(fmt.compType == CompType::Float || fmt.compType == CompType::Depth)
-    {
-      return *(const float *)u32;
-    }
-    else if(fmt.compType == CompType::UInt || fmt.compType == CompType::UScaled)
-    {
-      return float(*u32);
-    }
-    else if(fmt.compType == CompType::SInt || fmt.compType == CompType::SScaled)
-    {
-      return float(*i32);
-    }
-  }
-  else if(fmt.compByteWidth == 3 && fmt.compType == CompType::Depth)
-  {
-    // 24-bit depth is a weird edge case we need to assemble it by hand
-    const uint8_t *u8 = (const uint8_t *)data;
-
-    uint32_t depth = 0;
-    depth |= uint32_t(u8[1]);
-    depth |= uint32_t(u8[2]) << 8;
-    depth |= uint32_t(u8[3]) << 16;
-
-    return float(depth) / float(16777215.0f);
-  }
-  else if(fmt.compByteWidth == 2)
-  {
-    const uint16_t *u16 = (const uint16_t *)data;
-    const int16_t *i16 = (const int16_t *)data;
-
-    if(fmt.compType == CompType::Float)
-    {
-      return ConvertFromHalf(*u16);
-    }
-    else if(fmt.compType == CompType::UInt || fmt.compType == CompType::UScaled)
-    {
-      return float(*u16);
-    }
-    else if(fmt.compType == CompType::SInt || fmt.compType == CompType::SScaled)
-    {
-      return float(*i16);
-    }
-    // 16-bit depth is UNORM
-    else if(fmt.compType == CompType::UNorm || fmt.compType == CompType::Depth)
-    {
-      return float(*u16) / 65535.0f;
-    }
-    else if(fmt.compType == CompType::SNorm)
-    {
-      float f = -1.0f;
-
-      if(*i16 == -32768)
-        f = -1.0f;
-      else
-        f = ((float)*i16) / 32767.0f;
-
-      return f;
-    }
-  }
-  else if(fmt.compByteWidth == 1)
-  {
-    const uint8_t *u8 = (const uint8_t *)data;
-    const int8_t *i8 = (const int8_t *)data;
-
-    if(fmt.compType == CompType::UInt || fmt.compType == CompType::UScaled)
-    {
-      return float(*u8);
-    }
-    else if(fmt.compType == CompType::SInt || fmt.compType == CompType::SScaled)
-    {
-      return float(*i8);
-    }
-    else if(fmt.compType == CompType::UNormSRGB)
-    {
-      return SRGB8_lookuptable[*u8];
-    }
-    else if(fmt.compType == CompType::UNorm)
-    {
-      return float(*u8) / 255.0f;
-    }
-    else if(fmt.compType == CompType::SNorm)
-    {
-      float f = -1.0f;
+  FileIO::fwrite(data, 1, size, (FILE *)context);
+}
 
-      if(*i8 == -128)
-        f = -1.0f;
-      else
-        f = ((float)*i8) / 127.0f;
+// below this many pixels a copy or conversion isn't worth handing to other threads
+static const uint64_t minParallelPixels = 64 * 1024;
 
-      return f;
-    }
-  }
+// the largest region PickPixelRegion will pick, e.g. a whole 4096x4096 texture, to bound the memory
+// the co-ordinates and results take up
+static const uint32_t maxPickRegionPixels = 4096 * 4096;
 
-  RDCERR("Unexpected format to convert from %u %u", fmt.compByteWidth, fmt.compType);
+// calls process(firstRow, endRow) over bands of rows covering [0, height), spread across threads.
+// Small images are processed in a single band inline.
+static void ParallelRows(uint32_t width, uint32_t height,
+                         std::function<void(uint32_t, uint32_t)> process)
+{
+  uint64_t numBands = uint64_t(width) * height / minParallelPixels;
+  numBands = RDCCLAMP(numBands, uint64_t(1), uint64_t(height));
 
-  return 0.0f;
-}
+  uint32_t rowsPerBand = uint32_t((height + numBands - 1) / numBands);
+  numBands = (height + rowsPerBand - 1) / rowsPerBand;
 
-static void fileWriteFunc(void *context, void *data, int size)
-{
-  FileIO::fwrite(data, 1, size, (FILE *)context);
+  Threading::ParallelFor((uint32_t)numBands, [&](uint32_t band) {
+    uint32_t firstRow = band * rowsPerBand;
+    process(firstRow, RDCMIN(height, firstRow + rowsPerBand));
+  });
 }
 
 ReplayController::ReplayController()
@@ -1054,28 +956,25 @@ bool ReplayController::SaveTexture(const TextureSave &saveData, const char *path
 
     memset(combinedData, 0, td.width * td.height * pixelStride);
 
-    for(size_t i = 0; i < subdata.size(); i++)
-    {
-      uint32_t gridx = (uint32_t)i % sd.slice.sliceGridWidth;
-      uint32_t gridy = (uint32_t)i / sd.slice.sliceGridWidth;
+    // each slice lands in its own cell of the grid, so they can be copied independently
+    auto copySlice = [&](uint32_t i) {
+      uint32_t gridx = i % sd.slice.sliceGridWidth;
+      uint32_t gridy = i / sd.slice.sliceGridWidth;
 
       uint32_t yoffs = gridy * sliceHeight;
       uint32_t xoffs = gridx * sliceWidth;
 
       for(uint32_t y = 0; y < sliceHeight; y++)
-      {
-        for(uint32_t x = 0; x < sliceWidth; x++)
-        {
-          uint32_t *srcpix = (uint32_t *)&subdata[i][(y * sliceWidth + x) * pixelStride + 0];
-          uint32_t *dstpix =
-              (uint32_t *)&combinedData[((y + yoffs) * td.width + x + xoffs) * pixelStride + 0];
+        memcpy(&combinedData[((y + yoffs) * td.width + xoffs) * pixelStride],
+               &subdata[i][y * sliceWidth * pixelStride], sliceWidth * pixelStride);
+    };
 
-          memcpy(dstpix, srcpix, pixelStride);
-        }
-      }
+    // small textures are copied inline
+    Threading::ParallelFor((uint32_t)subdata.size(), copySlice,
+                           uint64_t(td.width) * td.height < minParallelPixels ? 1 : 0);
 
+    for(size_t i = 0; i < subdata.size(); i++)
       delete[] subdata[i];
-    }
 
     subdata.resize(1);
     subdata[0] = combinedData;
@@ -1116,25 +1015,21 @@ bool ReplayController::SaveTexture(const TextureSave &saveData, const char *path
     uint32_t gridx[6] = {2, 0, 1, 1, 1, 3};
     uint32_t gridy[6] = {1, 1, 0, 2, 1, 1};
 
-    for(size_t i = 0; i < subdata.size(); i++)
-    {
+    auto copySlice = [&](uint32_t i) {
       uint32_t yoffs = gridy[i] * sliceHeight;
       uint32_t xoffs = gridx[i] * sliceWidth;
 
       for(uint32_t y = 0; y < sliceHeight; y++)
-      {
-        for(uint32_t x = 0; x < sliceWidth; x++)
-        {
-          uint32_t *srcpix = (uint32_t *)&subdata[i][(y * sliceWidth + x) * pixelStride + 0];
-          uint32_t *dstpix =
-              (uint32_t *)&combinedData[((y + yoffs) * td.width + x + xoffs) * pixelStride + 0];
+        memcpy(&combinedData[((y + yoffs) * td.width + xoffs) * pixelStride],
+               &subdata[i][y * sliceWidth * pixelStride], sliceWidth * pixelStride);
+    };
 
-          memcpy(dstpix, srcpix, pixelStride);
-        }
-      }
+    // small textures are copied inline
+    Threading::ParallelFor((uint32_t)subdata.size(), copySlice,
+                           uint64_t(td.width) * td.height < minParallelPixels ? 1 : 0);
 
+    for(size_t i = 0; i < subdata.size(); i++)
       delete[] subdata[i];
-    }
 
     subdata.resize(1);
     subdata[0] = combinedData;
@@ -1153,37 +1048,29 @@ bool ReplayController::SaveTexture(const TextureSave &saveData, const char *path
     uint32_t compWidth = td.format.compByteWidth;
     uint32_t compCount = td.format.compCount;
 
-    uint32_t val = 0;
-    uint32_t max = ~0U;
+    const uint32_t max = ~0U;
 
-    for(uint32_t y = 0; y < td.height; y++)
-    {
-      for(uint32_t x = 0; x < td.width; x++)
-      {
-        memcpy(&val, &subdata[0][(y * td.width + x) * pixelStride + sd.channelExtract * compWidth],
-               td.format.compByteWidth);
+    ParallelRows(td.width, td.height, [&](uint32_t firstRow, uint32_t endRow) {
+      uint32_t val = 0;
 
-        switch(compCount)
+      for(uint32_t y = firstRow; y < endRow; y++)
+      {
+        for(uint32_t x = 0; x < td.width; x++)
         {
-          case 4:
-            memcpy(&subdata[0][(y * td.width + x) * pixelStride + 3 * compWidth], &max,
-                   td.format.compByteWidth);
-            DELIBERATE_FALLTHROUGH();
-          case 3:
-            memcpy(&subdata[0][(y * td.width + x) * pixelStride + 2 * compWidth], &val,
-                   td.format.compByteWidth);
-            DELIBERATE_FALLTHROUGH();
-          case 2:
-            memcpy(&subdata[0][(y * td.width + x) * pixelStride + 1 * compWidth], &val,
-                   td.format.compByteWidth);
-            DELIBERATE_FALLTHROUGH();
-          case 1:
-            memcpy(&subdata[0][(y * td.width + x) * pixelStride + 0 * compWidth], &val,
-                   td.format.compByteWidth);
-            break;
+          byte *pixel = &subdata[0][(y * td.width + x) * pixelStride];
+
+          memcpy(&val, pixel + sd.channelExtract * compWidth, compWidth);
+
+          switch(compCount)
+          {
+            case 4: memcpy(pixel + 3 * compWidth, &max, compWidth); DELIBERATE_FALLTHROUGH();
+            case 3: memcpy(pixel + 2 * compWidth, &val, compWidth); DELIBERATE_FALLTHROUGH();
+            case 2: memcpy(pixel + 1 * compWidth, &val, compWidth); DELIBERATE_FALLTHROUGH();
+            case 1: memcpy(pixel + 0 * compWidth, &val, compWidth); break;
+          }
         }
       }
-    }
+    });
   }
 
   // handle formats that don't support alpha
@@ -1191,46 +1078,55 @@ bool ReplayController::SaveTexture(const TextureSave &saveData, const char *path
   {
     byte *nonalpha = new byte[td.width * td.height * 3];
 
-    for(uint32_t y = 0; y < td.height; y++)
+    // the background colours are constant, so gamma correct them once up front
+    Vec4f solidCol = Vec4f(sd.alphaCol.x, sd.alphaCol.y, sd.alphaCol.z);
+    Vec4f lightCol = RenderDoc::Inst().LightCheckerboardColor();
+    Vec4f darkCol = RenderDoc::Inst().DarkCheckerboardColor();
+
+    for(Vec4f *col : {&solidCol, &lightCol, &darkCol})
     {
-      for(uint32_t x = 0; x < td.width; x++)
-      {
-        byte r = subdata[0][(y * td.width + x) * 4 + 0];
-        byte g = subdata[0][(y * td.width + x) * 4 + 1];
-        byte b = subdata[0][(y * td.width + x) * 4 + 2];
-        byte a = subdata[0][(y * td.width + x) * 4 + 3];
+      col->x = powf(col->x, 1.0f / 2.2f);
+      col->y = powf(col->y, 1.0f / 2.2f);
+      col->z = powf(col->z, 1.0f / 2.2f);
+    }
 
-        if(sd.alpha != AlphaMapping::Discard)
+    ParallelRows(td.width, td.height, [&](uint32_t firstRow, uint32_t endRow) {
+      for(uint32_t y = firstRow; y < endRow; y++)
+      {
+        for(uint32_t x = 0; x < td.width; x++)
         {
-          Vec4f col = Vec4f(sd.alphaCol.x, sd.alphaCol.y, sd.alphaCol.z);
-          if(sd.alpha == AlphaMapping::BlendToCheckerboard)
+          byte r = subdata[0][(y * td.width + x) * 4 + 0];
+          byte g = subdata[0][(y * td.width + x) * 4 + 1];
+          byte b = subdata[0][(y * td.width + x) * 4 + 2];
+          byte a = subdata[0][(y * td.width + x) * 4 + 3];
+
+          if(sd.alpha != AlphaMapping::Discard)
           {
-            bool lightSquare = ((x / 64) % 2) == ((y / 64) % 2);
-            col = lightSquare ? RenderDoc::Inst().LightCheckerboardColor()
-                              : RenderDoc::Inst().DarkCheckerboardColor();
+            Vec4f col = solidCol;
+            if(sd.alpha == AlphaMapping::BlendToCheckerboard)
+            {
+              bool lightSquare = ((x / 64) % 2) == ((y / 64) % 2);
+              col = lightSquare ? lightCol : darkCol;
+            }
+
+            FloatVector pixel = FloatVector(float(r) / 255.0f, float(g) / 255.0f,
+                                            float(b) / 255.0f, float(a) / 255.0f);
+
+            pixel.x = pixel.x * pixel.w + col.x * (1.0f - pixel.w);
+            pixel.y = pixel.y * pixel.w + col.y * (1.0f - pixel.w);
+            pixel.z = pixel.z * pixel.w + col.z * (1.0f - pixel.w);
+
+            r = byte(pixel.x * 255.0f);
+            g = byte(pixel.y * 255.0f);
+            b = byte(pixel.z * 255.0f);
           }
 
-          col.x = powf(col.x, 1.0f / 2.2f);
-          col.y = powf(col.y, 1.0f / 2.2f);
-          col.z = powf(col.z, 1.0f / 2.2f);
-
-          FloatVector pixel = FloatVector(float(r) / 255.0f, float(g) / 255.0f, float(b) / 255.0f,
-                                          float(a) / 255.0f);
-
-          pixel.x = pixel.x * pixel.w + col.x * (1.0f - pixel.w);
-          pixel.y = pixel.y * pixel.w + col.y * (1.0f - pixel.w);
-          pixel.z = pixel.z * pixel.w + col.z * (1.0f - pixel.w);
-
-          r = byte(pixel.x * 255.0f);
-          g = byte(pixel.y * 255.0f);
-          b = byte(pixel.z * 255.0f);
+          nonalpha[(y * td.width + x) * 3 + 0] = r;
+          nonalpha[(y * td.width + x) * 3 + 1] = g;
+          nonalpha[(y * td.width + x) * 3 + 2] = b;
         }
-
-        nonalpha[(y * td.width + x) * 3 + 0] = r;
-        nonalpha[(y * td.width + x) * 3 + 1] = g;
-        nonalpha[(y * td.width + x) * 3 + 2] = b;
       }
-    }
+    });
 
     delete[] subdata[0];
 
@@ -1246,22 +1142,24 @@ bool ReplayController::SaveTexture(const TextureSave &saveData, const char *path
   {
     byte *rg0 = new byte[td.width * td.height * 3];
 
-    for(uint32_t y = 0; y < td.height; y++)
-    {
-      for(uint32_t x = 0; x < td.width; x++)
+    ParallelRows(td.width, td.height, [&](uint32_t firstRow, uint32_t endRow) {
+      for(uint32_t y = firstRow; y < endRow; y++)
       {
-        byte r = subdata[0][(y * td.width + x) * 2 + 0];
-        byte g = subdata[0][(y * td.width + x) * 2 + 1];
+        for(uint32_t x = 0; x < td.width; x++)
+        {
+          byte r = subdata[0][(y * td.width + x) * 2 + 0];
+          byte g = subdata[0][(y * td.width + x) * 2 + 1];
 
-        rg0[(y * td.width + x) * 3 + 0] = r;
-        rg0[(y * td.width + x) * 3 + 1] = g;
-        rg0[(y * td.width + x) * 3 + 2] = 0;
+          rg0[(y * td.width + x) * 3 + 0] = r;
+          rg0[(y * td.width + x) * 3 + 1] = g;
+          rg0[(y * td.width + x) * 3 + 2] = 0;
 
-        // if we're greyscaling the image, then keep the greyscale here.
-        if(sd.channelExtract >= 0)
-          rg0[(y * td.width + x) * 3 + 2] = r;
+          // if we're greyscaling the image, then keep the greyscale here.
+          if(sd.channelExtract >= 0)
+            rg0[(y * td.width + x) * 3 + 2] = r;
+        }
       }
-    }
+    });
 
     delete[] subdata[0];
 
@@ -1314,12 +1212,8 @@ bool ReplayController::SaveTexture(const TextureSave &saveData, const char *path
     }
     else if(sd.destType == FileType::PNG)
     {
-      int ret = stbi_write_png_to_func(fileWriteFunc, (void *)f, td.width, td.height, numComps,
-                                       subdata[0], rowPitch);
-      success = (ret != 0);
-
-      if(!success)
-        RDCERR("stbi_write_png_to_func failed: %d", ret);
+      // deflated in parallel bands, unlike stb's encoder
+      success = write_png_to_file(f, td.width, td.height, numComps, subdata[0], rowPitch);
     }
     else if(sd.destType == FileType::TGA)
     {
@@ -1355,22 +1249,7 @@ bool ReplayController::SaveTexture(const TextureSave &saveData, const char *path
     }
     else if(sd.destType == FileType::HDR || sd.destType == FileType::EXR)
     {
-      float *fldata = NULL;
-      float *abgr[4] = {NULL, NULL, NULL, NULL};
-
-      if(sd.destType == FileType::HDR)
-      {
-        fldata = new float[td.width * td.height * 4];
-      }
-      else
-      {
-        abgr[0] = new float[td.width * td.height];
-        abgr[1] = new float[td.width * td.height];
-        abgr[2] = new float[td.width * td.height];
-        abgr[3] = new float[td.width * td.height];
-      }
-
-      byte *srcData = subdata[0];
+      const byte *srcData = subdata[0];
 
       ResourceFormat saveFmt = td.format;
       if(saveFmt.compType == CompType::Typeless)
@@ -1378,63 +1257,31 @@ bool ReplayController::SaveTexture(const TextureSave &saveData, const char *path
       if(saveFmt.compType == CompType::Typeless)
         saveFmt.compType = saveFmt.compByteWidth == 4 ? CompType::Float : CompType::UNorm;
 
-      uint32_t pixStride = saveFmt.compCount * saveFmt.compByteWidth;
+      uint32_t pixStride = saveFmt.ElementSize();
 
       // 24-bit depth still has a stride of 4 bytes.
       if(saveFmt.compType == CompType::Depth && pixStride == 3)
         pixStride = 4;
 
-      for(uint32_t y = 0; y < td.height; y++)
-      {
-        for(uint32_t x = 0; x < td.width; x++)
-        {
-          float r = 0.0f;
-          float g = 0.0f;
-          float b = 0.0f;
-          float a = 1.0f;
-
-          if(saveFmt.type == ResourceFormatType::R10G10B10A2)
-          {
-            uint32_t *u32 = (uint32_t *)srcData;
-
-            Vec4f vec = ConvertFromR10G10B10A2(*u32);
-
-            r = vec.x;
-            g = vec.y;
-            b = vec.z;
-            a = vec.w;
-
-            srcData += 4;
-          }
-          else if(saveFmt.type == ResourceFormatType::R11G11B10)
-          {
-            uint32_t *u32 = (uint32_t *)srcData;
-
-            Vec3f vec = ConvertFromR11G11B10(*u32);
-
-            r = vec.x;
-            g = vec.y;
-            b = vec.z;
-            a = 1.0f;
+      // decode a whole row at a time, then apply the remapping
+      auto convertRow = [&](uint32_t y, float *rgba) {
+        Vec4f *row = (Vec4f *)rgba;
 
-            srcData += 4;
-          }
-          else
-          {
-            if(saveFmt.compCount >= 1)
-              r = ConvertComponent(saveFmt, srcData + saveFmt.compByteWidth * 0);
-            if(saveFmt.compCount >= 2)
-              g = ConvertComponent(saveFmt, srcData + saveFmt.compByteWidth * 1);
-            if(saveFmt.compCount >= 3)
-              b = ConvertComponent(saveFmt, srcData + saveFmt.compByteWidth * 2);
-            if(saveFmt.compCount >= 4)
-              a = ConvertComponent(saveFmt, srcData + saveFmt.compByteWidth * 3);
-
-            srcData += pixStride;
-          }
+        if(!DecodeFormattedPixels(saveFmt, srcData + y * td.width * pixStride, td.width, row))
+        {
+          // only complain once, not for every row
+          if(y == 0)
+            RDCERR("Unexpected format to convert from %s", saveFmt.Name().c_str());
+          for(uint32_t x = 0; x < td.width; x++)
+            row[x] = Vec4f(0.0f, 0.0f, 0.0f, 1.0f);
+        }
 
-          if(saveFmt.BGRAOrder())
-            std::swap(r, b);
+        for(uint32_t x = 0; x < td.width; x++)
+        {
+          float &r = row[x].x;
+          float &g = row[x].y;
+          float &b = row[x].z;
+          float &a = row[x].w;
 
           // HDR can't represent negative values
           if(sd.destType == FileType::HDR)
@@ -1465,95 +1312,19 @@ bool ReplayController::SaveTexture(const TextureSave &saveData, const char *path
             r = g = b = a;
             a = 1.0f;
           }
-
-          if(fldata)
-          {
-            fldata[(y * td.width + x) * 4 + 0] = r;
-            fldata[(y * td.width + x) * 4 + 1] = g;
-            fldata[(y * td.width + x) * 4 + 2] = b;
-            fldata[(y * td.width + x) * 4 + 3] = a;
-          }
-          else
-          {
-            abgr[0][(y * td.width + x)] = a;
-            abgr[1][(y * td.width + x)] = b;
-            abgr[2][(y * td.width + x)] = g;
-            abgr[3][(y * td.width + x)] = r;
-          }
         }
-      }
+      };
 
+      // for both, rows are converted and encoded a band at a time in parallel as the file is
+      // written, so there's no full copy of the image
       if(sd.destType == FileType::HDR)
       {
-        int ret = stbi_write_hdr_to_func(fileWriteFunc, (void *)f, td.width, td.height, 4, fldata);
-        success = (ret != 0);
-
-        if(!success)
-          RDCERR("stbi_write_hdr_to_func failed: %d", ret);
+        success = write_hdr_to_file(f, td.width, td.height, convertRow);
       }
       else if(sd.destType == FileType::EXR)
       {
-        const char *err = NULL;
-
-        EXRHeader exrHeader;
-        InitEXRHeader(&exrHeader);
-
-        EXRImage exrImage;
-        InitEXRImage(&exrImage);
-
-        int pixTypes[4] = {TINYEXR_PIXELTYPE_FLOAT, TINYEXR_PIXELTYPE_FLOAT,
-                           TINYEXR_PIXELTYPE_FLOAT, TINYEXR_PIXELTYPE_FLOAT};
-
-        // must be in this order as many viewers don't pay attention to channels and just assume
-        // they are in this order
-        EXRChannelInfo bgraChannels[4] = {
-            {"A"}, {"B"}, {"G"}, {"R"},
-        };
-
-        exrHeader.num_channels = 4;
-        exrHeader.channels = bgraChannels;
-        exrImage.images = (unsigned char **)abgr;
-        exrImage.width = td.width;
-        exrImage.height = td.height;
-        exrHeader.pixel_types = pixTypes;
-
-        if(saveFmt.compByteWidth == 4)
-        {
-          int reqTypes[4] = {TINYEXR_PIXELTYPE_FLOAT, TINYEXR_PIXELTYPE_FLOAT,
-                             TINYEXR_PIXELTYPE_FLOAT, TINYEXR_PIXELTYPE_FLOAT};
-          exrHeader.requested_pixel_types = reqTypes;
-        }
-        else
-        {
-          int reqTypes[4] = {TINYEXR_PIXELTYPE_HALF, TINYEXR_PIXELTYPE_HALF, TINYEXR_PIXELTYPE_HALF,
-                             TINYEXR_PIXELTYPE_HALF};
-          exrHeader.requested_pixel_types = reqTypes;
-        }
-        
-
-        unsigned char *mem = NULL;
-
-        size_t ret = SaveEXRImageToMemory(&exrImage, &exrHeader, &mem, &err);
-
-        success = (ret > 0);
-        if(success)
-          FileIO::fwrite(mem, 1, ret, f);
-        else
-          RDCERR("Error saving EXR file %d: '%s'", ret, err);
-
-        free(mem);
-      }
-
-      if(fldata)
-      {
-        delete[] fldata;
-      }
-      else
-      {
-        delete[] abgr[0];
-        delete[] abgr[1];
-        delete[] abgr[2];
-        delete[] abgr[3];
+        success = write_exr_to_file(f, td.width, td.height, saveFmt.compByteWidth != 4,
+                                    sd.exrCompression, convertRow);
       }
     }
 
@@ -1703,6 +1474,77 @@ PixelValue ReplayController::PickPixel(ResourceId tex, uint32_t x, uint32_t y,
   return ret;
 }
 
+rdcarray<PixelValue> ReplayController::PickPixels(ResourceId tex, const rdcarray<uint32_t> &coords,
+                                                  const Subresource &sub, CompType typeCast)
+{
+  CHECK_REPLAY_THREAD();
+
+  rdcarray<PixelValue> ret;
+
+  if(tex == ResourceId() || coords.size() < 2)
+  {
+    ret.resize(coords.size() / 2);
+
+    for(PixelValue &pix : ret)
+      RDCEraseEl(pix.floatValue);
+
+    return ret;
+  }
+
+  // the driver picks the whole batch at once, which with a remote replay is a single round trip
+  ret = m_pDevice->PickPixels(m_pDevice->GetLiveID(tex), coords, sub, typeCast);
+
+  return ret;
+}
+
+rdcarray<PixelValue> ReplayController::PickPixelRegion(ResourceId tex, uint32_t x, uint32_t y,
+                                                       uint32_t width, uint32_t height,
+                                                       const Subresource &sub, CompType typeCast)
+{
+  CHECK_REPLAY_THREAD();
+
+  rdcarray<PixelValue> ret;
+
+  if(tex == ResourceId())
+    return ret;
+
+  TextureDescription texDesc = m_pDevice->GetTexture(m_pDevice->GetLiveID(tex));
+
+  uint32_t mipWidth = RDCMAX(1U, texDesc.width >> sub.mip);
+  uint32_t mipHeight = RDCMAX(1U, texDesc.height >> sub.mip);
+
+  // clip the region to the subresource, so that x + width and y + height can't wrap
+  if(x >= mipWidth || y >= mipHeight)
+    return ret;
+
+  width = RDCMIN(width, mipWidth - x);
+  height = RDCMIN(height, mipHeight - y);
+
+  if(width == 0 || height == 0)
+    return ret;
+
+  if(uint64_t(width) * height > maxPickRegionPixels)
+  {
+    RDCERR("Can't pick %ux%u region, more than %u pixels", width, height, maxPickRegionPixels);
+    return ret;
+  }
+
+  rdcarray<uint32_t> coords;
+  coords.resize(size_t(width) * height * 2);
+
+  uint32_t *c = coords.data();
+  for(uint32_t row = 0; row < height; row++)
+  {
+    for(uint32_t col = 0; col < width; col++)
+    {
+      *(c++) = x + col;
+      *(c++) = y + row;
+    }
+  }
+
+  return PickPixels(tex, coords, sub, typeCast);
+}
+
 rdcpair<PixelValue, PixelValue> ReplayController::GetMinMax(ResourceId textureId,
                                                             const Subresource &sub, CompType typeCast)
 {
@@ -180,6 +180,10 @@ public:
 
   PixelValue PickPixel(ResourceId textureId, uint32_t x, uint32_t y, const Subresource &sub,
                        CompType typeCast);
+  rdcarray<PixelValue> PickPixels(ResourceId textureId, const rdcarray<uint32_t> &coords,
+                                  const Subresource &sub, CompType typeCast);
+  rdcarray<PixelValue> PickPixelRegion(ResourceId textureId, uint32_t x, uint32_t y, uint32_t width,
+                                       uint32_t height, const Subresource &sub, CompType typeCast);
   rdcpair<PixelValue, PixelValue> GetMinMax(ResourceId textureId, const Subresource &sub,
                                             CompType typeCast);
   rdcarray<uint32_t> GetHistogram(ResourceId textureId, const Subresource &sub, CompType typeCast,
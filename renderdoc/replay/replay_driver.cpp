@@ -23,6 +23,8 @@
  ******************************************************************************/
 
 #include "replay_driver.h"
+#include <float.h>
+#include "common/threading.h"
 #include "maths/formatpacking.h"
 #include "serialise/serialiser.h"
 
@@ -547,6 +549,60 @@ void StandardFillCBufferVariables(ResourceId shader, const rdcarray<ShaderConsta
   StandardFillCBufferVariables(shader, invars, outvars, data, 0);
 }
 
+static void DiffShaderVariables(const rdcarray<ShaderVariable> &prev,
+                                const rdcarray<ShaderVariable> &cur,
+                                rdcarray<ShaderVariableChange> &changes)
+{
+  for(int32_t i = 0; i < cur.count(); i++)
+  {
+    if(!(prev[i] == cur[i]))
+    {
+      ShaderVariableChange change;
+      change.index = (uint32_t)i;
+      change.value = cur[i];
+      changes.push_back(change);
+    }
+  }
+}
+
+void ShaderDebugStateEncoder::AddState(const ShaderDebugState &state)
+{
+  ShaderDebugStateDelta delta;
+  delta.modified = state.modified;
+  delta.nextInstruction = state.nextInstruction;
+  delta.flags = state.flags;
+
+  // the variable lists normally never change size, but if they do we can't express it as changes
+  bool keyframe = m_Trace.steps.empty() || m_SinceKeyframe >= m_KeyframeInterval ||
+                  state.registers.count() != m_Prev.registers.count() ||
+                  state.outputs.count() != m_Prev.outputs.count() ||
+                  state.indexableTemps.count() != m_Prev.indexableTemps.count();
+
+  if(keyframe)
+  {
+    delta.keyframe = m_Trace.keyframes.count();
+    m_Trace.keyframes.push_back(state);
+    m_SinceKeyframe = 0;
+  }
+  else
+  {
+    DiffShaderVariables(m_Prev.registers, state.registers, delta.registers);
+    DiffShaderVariables(m_Prev.outputs, state.outputs, delta.outputs);
+    DiffShaderVariables(m_Prev.indexableTemps, state.indexableTemps, delta.indexableTemps);
+
+    if(!(m_Prev.locals == state.locals))
+    {
+      delta.localsChanged = true;
+      delta.locals = state.locals;
+    }
+  }
+
+  m_Trace.steps.push_back(delta);
+  m_SinceKeyframe++;
+
+  m_Prev = state;
+}
+
 uint64_t CalcMeshOutputSize(uint64_t curSize, uint64_t requiredOutput)
 {
   // resize exponentially up to 256MB to avoid repeated resizes
@@ -561,6 +617,429 @@ uint64_t CalcMeshOutputSize(uint64_t curSize, uint64_t requiredOutput)
   return curSize;
 }
 
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define REPLAY_SSE2 OPTION_ON
+#include <emmintrin.h>
+#else
+#define REPLAY_SSE2 OPTION_OFF
+#endif
+
+// matches HGRAM_NUM_BUCKETS in the shaders
+static const uint32_t histogramBuckets = 256;
+
+// texels are decoded and processed in chunks of this many, each chunk on its own thread
+static const size_t statsChunkSize = 16 * 1024;
+
+static bool CanDecodeForStats(const ResourceFormat &fmt)
+{
+  switch(fmt.type)
+  {
+    case ResourceFormatType::Regular:
+      return fmt.compType != CompType::Typeless && fmt.compCount >= 1 && fmt.compCount <= 4;
+    case ResourceFormatType::R10G10B10A2:
+    case ResourceFormatType::R11G11B10:
+    case ResourceFormatType::R9G9B9E5:
+    case ResourceFormatType::R5G6B5:
+    case ResourceFormatType::R5G5B5A1:
+    case ResourceFormatType::R4G4B4A4:
+    case ResourceFormatType::R4G4:
+    case ResourceFormatType::D16S8:
+    case ResourceFormatType::D24S8:
+    case ResourceFormatType::D32S8:
+    case ResourceFormatType::S8:
+    case ResourceFormatType::A8: return true;
+    default: break;
+  }
+
+  return false;
+}
+
+size_t GetTextureStatsStride(const ResourceFormat &fmt)
+{
+  if(!CanDecodeForStats(fmt))
+    return 0;
+
+  // 24-bit depth still has a stride of 4 bytes.
+  if(fmt.type == ResourceFormatType::Regular && fmt.compType == CompType::Depth &&
+     fmt.compByteWidth == 3)
+    return 4 * fmt.compCount;
+
+  if(fmt.type == ResourceFormatType::D16S8)
+    return 3;
+  if(fmt.type == ResourceFormatType::D32S8)
+    return 5;
+  if(fmt.type == ResourceFormatType::S8 || fmt.type == ResourceFormatType::A8)
+    return 1;
+
+  return fmt.ElementSize();
+}
+
+bool CalcTextureMinMax(const ResourceFormat &fmt, const byte *data, size_t count, float *minval,
+                       float *maxval)
+{
+  if(!CanDecodeForStats(fmt) || count == 0)
+    return false;
+
+  const size_t stride = GetTextureStatsStride(fmt);
+  const uint32_t numChunks = uint32_t((count + statsChunkSize - 1) / statsChunkSize);
+
+  std::vector<Vec4f> chunkMin(numChunks), chunkMax(numChunks);
+
+  Threading::ParallelFor(numChunks, [&](uint32_t chunk) {
+    const size_t first = chunk * statsChunkSize;
+    const size_t num = RDCMIN(statsChunkSize, count - first);
+
+    std::vector<Vec4f> texels(num);
+    DecodeFormattedPixels(fmt, data + first * stride, num, texels.data());
+
+    // NaNs are skipped, like the min() and max() in the shaders
+    size_t i = 0;
+
+#if ENABLED(REPLAY_SSE2)
+    // minps and maxps return the second operand if either is NaN, so keep the running value there
+    __m128 mn = _mm_set1_ps(FLT_MAX);
+    __m128 mx = _mm_set1_ps(-FLT_MAX);
+
+    for(; i < num; i++)
+    {
+      __m128 v = _mm_loadu_ps(&texels[i].x);
+      mn = _mm_min_ps(v, mn);
+      mx = _mm_max_ps(v, mx);
+    }
+
+    _mm_storeu_ps(&chunkMin[chunk].x, mn);
+    _mm_storeu_ps(&chunkMax[chunk].x, mx);
+#else
+    Vec4f mn(FLT_MAX, FLT_MAX, FLT_MAX, FLT_MAX);
+    Vec4f mx(-FLT_MAX, -FLT_MAX, -FLT_MAX, -FLT_MAX);
+
+    for(; i < num; i++)
+    {
+      for(int c = 0; c < 4; c++)
+      {
+        float v = (&texels[i].x)[c];
+        (&mn.x)[c] = v < (&mn.x)[c] ? v : (&mn.x)[c];
+        (&mx.x)[c] = v > (&mx.x)[c] ? v : (&mx.x)[c];
+      }
+    }
+
+    chunkMin[chunk] = mn;
+    chunkMax[chunk] = mx;
+#endif
+  });
+
+  for(int c = 0; c < 4; c++)
+  {
+    minval[c] = FLT_MAX;
+    maxval[c] = -FLT_MAX;
+  }
+
+  for(uint32_t chunk = 0; chunk < numChunks; chunk++)
+  {
+    for(int c = 0; c < 4; c++)
+    {
+      minval[c] = RDCMIN(minval[c], (&chunkMin[chunk].x)[c]);
+      maxval[c] = RDCMAX(maxval[c], (&chunkMax[chunk].x)[c]);
+    }
+  }
+
+  return true;
+}
+
+bool CalcTextureHistogram(const ResourceFormat &fmt, const byte *data, size_t count, float minval,
+                          float maxval, const bool channels[4], std::vector<uint32_t> &histogram)
+{
+  if(!CanDecodeForStats(fmt) || minval >= maxval)
+    return false;
+
+  histogram.assign(histogramBuckets, 0);
+
+  if(count == 0 || !(channels[0] || channels[1] || channels[2] || channels[3]))
+    return true;
+
+  const size_t stride = GetTextureStatsStride(fmt);
+  const uint32_t numChunks = uint32_t((count + statsChunkSize - 1) / statsChunkSize);
+  const float range = maxval - minval;
+
+  // each chunk fills its own set of buckets, which are summed at the end
+  std::vector<uint32_t> chunkBuckets(size_t(numChunks) * histogramBuckets);
+
+  Threading::ParallelFor(numChunks, [&](uint32_t chunk) {
+    const size_t first = chunk * statsChunkSize;
+    const size_t num = RDCMIN(statsChunkSize, count - first);
+
+    uint32_t *buckets = chunkBuckets.data() + chunk * histogramBuckets;
+
+    std::vector<Vec4f> texels(num);
+    DecodeFormattedPixels(fmt, data + first * stride, num, texels.data());
+
+    // a value lands in bucket floor((v - min) / (max - min) * buckets), and is skipped if that's
+    // out of range. As in the shaders, max itself falls off the end.
+#if ENABLED(REPLAY_SSE2)
+    const __m128 vmin = _mm_set1_ps(minval);
+    const __m128 vrange = _mm_set1_ps(range);
+    const __m128 vbuckets = _mm_set1_ps(float(histogramBuckets));
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 channelMask = _mm_castsi128_ps(
+        _mm_set_epi32(channels[3] ? -1 : 0, channels[2] ? -1 : 0, channels[1] ? -1 : 0,
+                      channels[0] ? -1 : 0));
+
+    for(size_t i = 0; i < num; i++)
+    {
+      __m128 norm = _mm_div_ps(_mm_sub_ps(_mm_loadu_ps(&texels[i].x), vmin), vrange);
+      __m128 scaled = _mm_mul_ps(norm, vbuckets);
+
+      // comparisons are false for NaN, so those are skipped too
+      __m128 valid = _mm_and_ps(_mm_cmpge_ps(norm, zero), _mm_cmplt_ps(scaled, vbuckets));
+      int mask = _mm_movemask_ps(_mm_and_ps(valid, channelMask));
+
+      if(mask == 0)
+        continue;
+
+      // scaled is non-negative wherever it's used, so truncating is the same as floor
+      alignas(16) int32_t idx[4];
+      _mm_store_si128((__m128i *)idx, _mm_cvttps_epi32(scaled));
+
+      for(int c = 0; c < 4; c++)
+        if(mask & (1 << c))
+          buckets[idx[c]]++;
+    }
+#else
+    for(size_t i = 0; i < num; i++)
+    {
+      for(int c = 0; c < 4; c++)
+      {
+        if(!channels[c])
+          continue;
+
+        float norm = ((&texels[i].x)[c] - minval) / range;
+        float scaled = norm * float(histogramBuckets);
+
+        if(norm >= 0.0f && scaled < float(histogramBuckets))
+          buckets[uint32_t(scaled)]++;
+      }
+    }
+#endif
+  });
+
+  for(uint32_t chunk = 0; chunk < numChunks; chunk++)
+    for(uint32_t b = 0; b < histogramBuckets; b++)
+      histogram[b] += chunkBuckets[chunk * histogramBuckets + b];
+
+  return true;
+}
+
+// reads back a subresource for processing on the CPU, returning the format to decode it with and
+// where the texels for the subresource start.
+static bool FetchSubresourceTexels(IRemoteDriver *driver, ResourceId texid, const Subresource &sub,
+                                   CompType typeCast, bytebuf &data, ResourceFormat &fmt,
+                                   size_t &offset, uint32_t &width, uint32_t &height)
+{
+  TextureDescription tex = driver->GetTexture(texid);
+
+  fmt = tex.format;
+  if(typeCast != CompType::Typeless)
+    fmt.compType = typeCast;
+
+  // depth formats are read back differently by each API and the GPU path remaps stencil, so leave
+  // those to it, along with anything we can't decode.
+  if(tex.msSamp > 1 || fmt.compType == CompType::Depth || fmt.type == ResourceFormatType::D16S8 ||
+     fmt.type == ResourceFormatType::D24S8 || fmt.type == ResourceFormatType::D32S8 ||
+     fmt.type == ResourceFormatType::S8 || !CanDecodeForStats(fmt))
+    return false;
+
+  GetTextureDataParams params;
+  params.typeCast = typeCast;
+  driver->GetTextureData(texid, sub, params, data);
+
+  width = RDCMAX(1U, tex.width >> sub.mip);
+  height = RDCMAX(1U, tex.height >> sub.mip);
+
+  const size_t stride = GetTextureStatsStride(fmt);
+  const size_t count = size_t(width) * height;
+  const uint32_t depth = RDCMAX(1U, tex.depth >> sub.mip);
+
+  offset = 0;
+
+  // 3D textures are read back with every slice in the mip, so pick out the one we want
+  if(depth > 1 && data.size() >= count * stride * depth)
+    offset = count * stride * RDCMIN(sub.slice, depth - 1);
+
+  return data.size() >= offset + count * stride;
+}
+
+bool GetMinMaxFromTextureData(IRemoteDriver *driver, ResourceId texid, const Subresource &sub,
+                              CompType typeCast, float *minval, float *maxval)
+{
+  bytebuf data;
+  ResourceFormat fmt;
+  size_t offset = 0;
+  uint32_t width = 0, height = 0;
+
+  if(!FetchSubresourceTexels(driver, texid, sub, typeCast, data, fmt, offset, width, height))
+    return false;
+
+  return CalcTextureMinMax(fmt, data.data() + offset, size_t(width) * height, minval, maxval);
+}
+
+bool GetHistogramFromTextureData(IRemoteDriver *driver, ResourceId texid, const Subresource &sub,
+                                 CompType typeCast, float minval, float maxval,
+                                 const bool channels[4], std::vector<uint32_t> &histogram)
+{
+  bytebuf data;
+  ResourceFormat fmt;
+  size_t offset = 0;
+  uint32_t width = 0, height = 0;
+
+  if(minval >= maxval ||
+     !FetchSubresourceTexels(driver, texid, sub, typeCast, data, fmt, offset, width, height))
+    return false;
+
+  return CalcTextureHistogram(fmt, data.data() + offset, size_t(width) * height, minval, maxval,
+                              channels, histogram);
+}
+
+bool DecodePickedPixels(const ResourceFormat &fmt, const byte *data, uint32_t width,
+                        uint32_t height, const rdcarray<uint32_t> &coords,
+                        rdcarray<PixelValue> &pixels)
+{
+  if(!CanDecodeForStats(fmt))
+    return false;
+
+  const size_t stride = GetTextureStatsStride(fmt);
+  const size_t count = coords.size() / 2;
+
+  pixels.resize(count);
+
+  // integer formats are returned as integers, so decode those directly rather than via floats which
+  // would lose precision on 32-bit values.
+  const bool integer = fmt.type == ResourceFormatType::Regular &&
+                       (fmt.compType == CompType::UInt || fmt.compType == CompType::SInt);
+
+  for(size_t i = 0; i < count; i++)
+  {
+    PixelValue &pix = pixels[i];
+    RDCEraseEl(pix);
+
+    const uint32_t x = coords[i * 2 + 0], y = coords[i * 2 + 1];
+
+    if(x >= width || y >= height)
+      continue;
+
+    const byte *src = data + (size_t(y) * width + x) * stride;
+
+    if(integer)
+    {
+      pix.uintValue[3] = 1;
+
+      for(uint32_t c = 0; c < RDCMIN(4U, (uint32_t)fmt.compCount); c++)
+      {
+        const byte *comp = src + c * fmt.compByteWidth;
+
+        if(fmt.compByteWidth == 4)
+        {
+          memcpy(&pix.uintValue[c], comp, sizeof(uint32_t));
+        }
+        else if(fmt.compByteWidth == 2)
+        {
+          uint16_t u16;
+          memcpy(&u16, comp, sizeof(u16));
+          if(fmt.compType == CompType::SInt)
+            pix.intValue[c] = int16_t(u16);
+          else
+            pix.uintValue[c] = u16;
+        }
+        else if(fmt.compByteWidth == 1)
+        {
+          if(fmt.compType == CompType::SInt)
+            pix.intValue[c] = int8_t(*comp);
+          else
+            pix.uintValue[c] = *comp;
+        }
+      }
+    }
+    else
+    {
+      Vec4f val;
+      DecodeFormattedPixels(fmt, src, 1, &val);
+
+      // packed integer formats are small enough to be exact as floats
+      if(fmt.compType == CompType::UInt)
+      {
+        pix.uintValue[0] = uint32_t(val.x);
+        pix.uintValue[1] = uint32_t(val.y);
+        pix.uintValue[2] = uint32_t(val.z);
+        pix.uintValue[3] = uint32_t(val.w);
+      }
+      else
+      {
+        memcpy(pix.floatValue, &val, sizeof(val));
+      }
+    }
+  }
+
+  return true;
+}
+
+bool ShouldPickPixelsFromTextureData(const TextureDescription &tex, const Subresource &sub,
+                                     size_t numPicks, bool remote)
+{
+  // roughly how many bytes can be read back in the time a single pick takes, which is dominated by
+  // the GPU sync. Remotely each pick also costs a network round trip, but the readback has to be
+  // sent over the network too, which is slower per byte than a local copy.
+  const uint64_t bytesPerPick = remote ? 64 * 1024 : 256 * 1024;
+
+  const uint64_t width = RDCMAX(1U, tex.width >> sub.mip);
+  const uint64_t height = RDCMAX(1U, tex.height >> sub.mip);
+  const uint64_t depth = tex.dimension == 3 ? RDCMAX(1U, tex.depth >> sub.mip) : 1;
+
+  const uint64_t readbackBytes = width * height * depth * RDCMAX(1U, tex.format.ElementSize());
+
+  return readbackBytes <= uint64_t(numPicks) * bytesPerPick;
+}
+
+bool PickPixelsFromTextureData(IRemoteDriver *driver, ResourceId texid,
+                               const rdcarray<uint32_t> &coords, const Subresource &sub,
+                               CompType typeCast, rdcarray<PixelValue> &pixels)
+{
+  bytebuf data;
+  ResourceFormat fmt;
+  size_t offset = 0;
+  uint32_t width = 0, height = 0;
+
+  if(!FetchSubresourceTexels(driver, texid, sub, typeCast, data, fmt, offset, width, height))
+    return false;
+
+  return DecodePickedPixels(fmt, data.data() + offset, width, height, coords, pixels);
+}
+
+rdcarray<PixelValue> StandardPickPixels(IReplayDriver *driver, ResourceId texid,
+                                        const rdcarray<uint32_t> &coords, const Subresource &sub,
+                                        CompType typeCast, bool readbackAllowed)
+{
+  rdcarray<PixelValue> ret;
+  ret.resize(coords.size() / 2);
+
+  for(PixelValue &pix : ret)
+    RDCEraseEl(pix.floatValue);
+
+  if(ret.empty())
+    return ret;
+
+  if(readbackAllowed &&
+     ShouldPickPixelsFromTextureData(driver->GetTexture(texid), sub, ret.size(),
+                                     driver->IsRemoteProxy()) &&
+     PickPixelsFromTextureData(driver, texid, coords, sub, typeCast, ret))
+    return ret;
+
+  // formats that can't be decoded on the CPU go through the API's pick for each pixel
+  for(size_t i = 0; i < ret.size(); i++)
+    driver->PickPixel(texid, coords[i * 2 + 0], coords[i * 2 + 1], sub, typeCast,
+                      ret[i].floatValue);
+
+  return ret;
+}
+
 FloatVector HighlightCache::InterpretVertex(const byte *data, uint32_t vert, const MeshDisplay &cfg,
                                             const byte *end, bool useidx, bool &valid)
 {
@@ -664,6 +1143,233 @@ FloatVector HighlightCache::InterpretVertex(const byte *data, uint32_t vert,
   return ret;
 }
 
+// vertices are resolved, gathered and decoded in chunks of this many, each chunk on its own thread
+// once there are enough of them to be worth it.
+static const uint32_t vertexChunkSize = 4096;
+static const uint32_t parallelVertexCount = 64 * 1024;
+
+// formats the bulk texel decode handles identically to InterpretVertex. Anything else decodes one
+// vertex at a time through InterpretVertex.
+static bool CanBulkDecodeVertices(const ResourceFormat &fmt)
+{
+  if(fmt.type == ResourceFormatType::Regular)
+    return fmt.compType != CompType::Depth && fmt.compType != CompType::Typeless &&
+           fmt.compCount >= 1 && fmt.compCount <= 4;
+
+  // InterpretVertex decodes UInt 10:10:10:2 as UNorm, so leave it to do that
+  if(fmt.type == ResourceFormatType::R10G10B10A2)
+    return fmt.compType != CompType::UInt;
+
+  return fmt.type == ResourceFormatType::R11G11B10;
+}
+
+static void DecodeMeshVertexChunk(const MeshFormat &fmt, const byte *indexData,
+                                  uint32_t numIndices, const byte *vertexData,
+                                  size_t vertexDataSize, uint32_t first, uint32_t num,
+                                  Vec4f *out, bool *valid)
+{
+  const ResourceFormat &vfmt = fmt.format;
+  const uint32_t idxStride = fmt.indexByteStride;
+  const size_t elemSize = vfmt.ElementSize();
+
+  uint32_t restart = 0;
+  bool useRestart = false;
+  if(idxStride && SupportsRestart(fmt.topology) && fmt.topology != Topology::TriangleFan &&
+     fmt.allowRestart)
+  {
+    useRestart = true;
+    restart = idxStride == 1 ? 0xff : (idxStride == 2 ? 0xffff : 0xffffffff);
+  }
+
+  std::vector<uint32_t> verts(num);
+
+  // resolve indices first, applying the base vertex to anything that isn't a restart
+  for(uint32_t i = 0; i < num; i++)
+  {
+    uint32_t vert = first + i;
+    bool ok = true;
+
+    if(idxStride)
+    {
+      if(vert >= numIndices)
+      {
+        ok = false;
+      }
+      else
+      {
+        const byte *idx = indexData + size_t(vert) * idxStride;
+
+        if(idxStride == 1)
+        {
+          vert = *idx;
+        }
+        else if(idxStride == 2)
+        {
+          uint16_t u16;
+          memcpy(&u16, idx, sizeof(u16));
+          vert = u16;
+        }
+        else
+        {
+          memcpy(&vert, idx, sizeof(vert));
+        }
+
+        if(useRestart && vert == restart)
+          ok = false;
+        else if(fmt.baseVertex < 0)
+          vert = vert < uint32_t(-fmt.baseVertex) ? 0 : vert - uint32_t(-fmt.baseVertex);
+        else
+          vert += uint32_t(fmt.baseVertex);
+      }
+    }
+
+    if(ok && uint64_t(vert) * fmt.vertexByteStride + elemSize > vertexDataSize)
+      ok = false;
+
+    verts[i] = vert;
+    valid[i] = ok;
+  }
+
+  if(!CanBulkDecodeVertices(vfmt))
+  {
+    const byte *end = vertexData + vertexDataSize;
+
+    for(uint32_t i = 0; i < num; i++)
+    {
+      out[i] = Vec4f(0.0f, 0.0f, 0.0f, 1.0f);
+
+      if(valid[i])
+      {
+        FloatVector v = HighlightCache::InterpretVertex(vertexData, verts[i], fmt.vertexByteStride,
+                                                        vfmt, end, valid[i]);
+        out[i] = Vec4f(v.x, v.y, v.z, v.w);
+      }
+    }
+
+    return;
+  }
+
+  // 32-bit float positions are by far the most common, and need no conversion at all
+  if(vfmt.type == ResourceFormatType::Regular && vfmt.compType == CompType::Float &&
+     vfmt.compByteWidth == 4)
+  {
+    for(uint32_t i = 0; i < num; i++)
+    {
+      out[i] = Vec4f(0.0f, 0.0f, 0.0f, 1.0f);
+
+      if(valid[i])
+        memcpy(&out[i].x, vertexData + size_t(verts[i]) * fmt.vertexByteStride, elemSize);
+    }
+
+    return;
+  }
+
+  // otherwise gather the vertices tightly packed so they can be decoded together
+  std::vector<byte> packed(num * elemSize);
+
+  for(uint32_t i = 0; i < num; i++)
+  {
+    if(valid[i])
+      memcpy(&packed[i * elemSize], vertexData + size_t(verts[i]) * fmt.vertexByteStride, elemSize);
+  }
+
+  DecodeFormattedPixels(vfmt, packed.data(), num, out);
+
+  for(uint32_t i = 0; i < num; i++)
+  {
+    if(!valid[i])
+      out[i] = Vec4f(0.0f, 0.0f, 0.0f, 1.0f);
+  }
+}
+
+template <typename WriteFunc>
+static void DecodeMeshVertexChunks(const MeshFormat &fmt, const byte *indexData,
+                                   size_t indexDataSize, const byte *vertexData,
+                                   size_t vertexDataSize, uint32_t first, uint32_t count,
+                                   bool *valid, WriteFunc write)
+{
+  if(count == 0)
+    return;
+
+  uint32_t numIndices = 0;
+
+  if(fmt.indexByteStride != 0)
+  {
+    if(fmt.indexByteStride != 1 && fmt.indexByteStride != 2 && fmt.indexByteStride != 4)
+      RDCERR("Unexpected index stride %u", fmt.indexByteStride);
+    else
+      numIndices = uint32_t(RDCMIN(size_t(fmt.numIndices), indexDataSize / fmt.indexByteStride));
+  }
+
+  const uint32_t numChunks = (count + vertexChunkSize - 1) / vertexChunkSize;
+
+  Threading::ParallelFor(
+      numChunks,
+      [&](uint32_t chunk) {
+        const uint32_t offs = chunk * vertexChunkSize;
+        const uint32_t num = RDCMIN(vertexChunkSize, count - offs);
+
+        std::vector<Vec4f> decoded(num);
+
+        bool scratchValid[vertexChunkSize];
+        bool *chunkValid = valid ? valid + offs : scratchValid;
+
+        DecodeMeshVertexChunk(fmt, indexData, numIndices, vertexData, vertexDataSize, first + offs,
+                              num, decoded.data(), chunkValid);
+
+        write(offs, num, decoded.data());
+      },
+      count >= parallelVertexCount ? 0 : 1);
+}
+
+void DecodeMeshVertices(const MeshFormat &fmt, const byte *indexData, size_t indexDataSize,
+                        const byte *vertexData, size_t vertexDataSize, uint32_t first,
+                        uint32_t count, FloatVector *out, bool *valid)
+{
+  RDCCOMPILE_ASSERT(sizeof(FloatVector) == sizeof(Vec4f), "FloatVector must match Vec4f");
+
+  DecodeMeshVertexChunks(fmt, indexData, indexDataSize, vertexData, vertexDataSize, first, count,
+                         valid, [out](uint32_t offs, uint32_t num, const Vec4f *decoded) {
+                           memcpy(out + offs, decoded, num * sizeof(Vec4f));
+                         });
+}
+
+void DecodeMeshVertices(const MeshFormat &fmt, const byte *indexData, size_t indexDataSize,
+                        const byte *vertexData, size_t vertexDataSize, uint32_t first,
+                        uint32_t count, float *x, float *y, float *z, float *w, bool *valid)
+{
+  DecodeMeshVertexChunks(
+      fmt, indexData, indexDataSize, vertexData, vertexDataSize, first, count, valid,
+      [x, y, z, w](uint32_t offs, uint32_t num, const Vec4f *decoded) {
+        uint32_t i = 0;
+
+#if ENABLED(REPLAY_SSE2)
+        for(; i + 4 <= num; i += 4)
+        {
+          __m128 r0 = _mm_loadu_ps(&decoded[i + 0].x);
+          __m128 r1 = _mm_loadu_ps(&decoded[i + 1].x);
+          __m128 r2 = _mm_loadu_ps(&decoded[i + 2].x);
+          __m128 r3 = _mm_loadu_ps(&decoded[i + 3].x);
+
+          _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+
+          _mm_storeu_ps(x + offs + i, r0);
+          _mm_storeu_ps(y + offs + i, r1);
+          _mm_storeu_ps(z + offs + i, r2);
+          _mm_storeu_ps(w + offs + i, r3);
+        }
+#endif
+
+        for(; i < num; i++)
+        {
+          x[offs + i] = decoded[i].x;
+          y[offs + i] = decoded[i].y;
+          z[offs + i] = decoded[i].z;
+          w[offs + i] = decoded[i].w;
+        }
+      });
+}
+
 uint64_t inthash(uint64_t val, uint64_t seed)
 {
   return (seed << 5) + seed + val; /* hash * 33 + c */
@@ -1161,3 +1867,724 @@ const Vec4f colorRamp[22] = {
     Vec4f(1.000000f, 0.376471f, 0.752941f, 1.0f), Vec4f(1.000000f, 0.627451f, 1.000000f, 1.0f),
     Vec4f(1.000000f, 0.878431f, 1.000000f, 1.0f), Vec4f(1.000000f, 1.000000f, 1.000000f, 1.0f),
 };
+
+#if ENABLED(ENABLE_UNIT_TESTS)
+
+#include "3rdparty/catch/catch.hpp"
+#include <limits>
+
+TEST_CASE("Check delta-encoded shader debug states", "[shaderdebug]")
+{
+  std::vector<ShaderDebugState> states;
+
+  ShaderDebugState state;
+  state.registers.resize(8);
+  state.outputs.resize(2);
+  state.indexableTemps.resize(1);
+  state.indexableTemps[0].members.resize(4);
+  state.nextInstruction = 0;
+  state.flags = ShaderEvents::NoEvent;
+
+  for(uint32_t i = 0; i < 8; i++)
+    state.registers[i].name = StringFormat::Fmt("r%u", i);
+
+  states.push_back(state);
+
+  // simulate a loop touching a couple of registers each step
+  for(uint32_t step = 1; step < 300; step++)
+  {
+    state.nextInstruction = step % 17;
+    state.flags = (step % 5) == 0 ? ShaderEvents::SampleLoadGather : ShaderEvents::NoEvent;
+    state.registers[step % 8].value.u.x = step;
+    state.registers[(step * 3) % 8].value.f.y = float(step) * 0.5f;
+
+    if((step % 50) == 0)
+      state.outputs[1].value.u.w = step;
+
+    if((step % 70) == 0)
+      state.indexableTemps[0].members[step % 4].value.u.z = step;
+
+    if((step % 90) == 0)
+      state.locals.resize(state.locals.size() + 1);
+
+    state.modified.clear();
+    RegisterRange range;
+    range.type = RegisterType::Temporary;
+    range.index = uint16_t(step % 8);
+    state.modified.push_back(range);
+
+    states.push_back(state);
+  }
+
+  SECTION("Every step is reconstructed exactly")
+  {
+    for(int32_t interval : {1, 7, 64, 1000})
+    {
+      ShaderDebugTrace trace;
+      ShaderDebugStateEncoder encoder(trace, interval);
+
+      for(const ShaderDebugState &s : states)
+        encoder.AddState(s);
+
+      REQUIRE(trace.GetNumStates() == (int32_t)states.size());
+
+      for(int32_t i = 0; i < trace.GetNumStates(); i++)
+      {
+        CHECK((trace.GetState(i) == states[i]));
+        CHECK((trace.GetState(i).modified == states[i].modified));
+        CHECK(trace.steps[i].nextInstruction == states[i].nextInstruction);
+      }
+
+      CHECK(trace.keyframes.count() == ((int32_t)states.size() + interval - 1) / interval);
+
+      rdcarray<ShaderDebugState> all = trace.GetAllStates();
+
+      REQUIRE(all.count() == (int32_t)states.size());
+
+      for(int32_t i = 0; i < all.count(); i++)
+        CHECK((all[i] == states[i]));
+    }
+  };
+
+  SECTION("Only changed variables are stored")
+  {
+    ShaderDebugTrace trace;
+    ShaderDebugStateEncoder encoder(trace, 64);
+
+    for(const ShaderDebugState &s : states)
+      encoder.AddState(s);
+
+    for(int32_t i = 0; i < trace.GetNumStates(); i++)
+    {
+      if(trace.steps[i].keyframe < 0)
+      {
+        CHECK(trace.steps[i].registers.count() <= 2);
+        CHECK(trace.steps[i].outputs.count() <= 1);
+      }
+    }
+  };
+
+  SECTION("Size changes force a keyframe")
+  {
+    ShaderDebugTrace trace;
+    ShaderDebugStateEncoder encoder(trace, 64);
+
+    encoder.AddState(states[0]);
+    encoder.AddState(states[1]);
+
+    ShaderDebugState grown = states[2];
+    grown.registers.resize(9);
+    encoder.AddState(grown);
+
+    CHECK(trace.steps[1].keyframe == -1);
+    CHECK(trace.steps[2].keyframe == 1);
+    CHECK((trace.GetState(2) == grown));
+  };
+
+  SECTION("Out of range steps are empty")
+  {
+    ShaderDebugTrace trace;
+
+    CHECK(trace.GetNumStates() == 0);
+    CHECK(trace.GetState(0).registers.empty());
+    CHECK(trace.GetState(-1).registers.empty());
+  };
+
+  SECTION("Changes outside of the keyframe are ignored")
+  {
+    ShaderDebugTrace trace;
+    ShaderDebugStateEncoder encoder(trace, 64);
+
+    encoder.AddState(states[0]);
+    encoder.AddState(states[1]);
+
+    // e.g. a corrupted trace read back from a remote replay
+    ShaderVariableChange bad;
+    bad.index = 100;
+    trace.steps[1].registers.push_back(bad);
+    trace.steps[1].outputs.push_back(bad);
+    trace.steps[1].indexableTemps.push_back(bad);
+
+    CHECK((trace.GetState(1) == states[1]));
+    CHECK((trace.GetAllStates()[1] == states[1]));
+  };
+};
+
+
+TEST_CASE("CPU texture min/max and histogram", "[texstats]")
+{
+  // enough texels to span several chunks, with a partial one at the end
+  const size_t count = 40000;
+
+  SECTION("RGBA8 min/max")
+  {
+    ResourceFormat fmt;
+    fmt.type = ResourceFormatType::Regular;
+    fmt.compType = CompType::UNorm;
+    fmt.compCount = 4;
+    fmt.compByteWidth = 1;
+
+    std::vector<byte> data(count * 4);
+    for(size_t i = 0; i < count; i++)
+    {
+      data[i * 4 + 0] = byte(10 + (i % 100));
+      data[i * 4 + 1] = byte(i % 256);
+      data[i * 4 + 2] = 77;
+      data[i * 4 + 3] = byte(255 - (i % 50));
+    }
+
+    float minval[4], maxval[4];
+    REQUIRE(CalcTextureMinMax(fmt, data.data(), count, minval, maxval));
+
+    CHECK(minval[0] == 10.0f / 255.0f);
+    CHECK(maxval[0] == 109.0f / 255.0f);
+    CHECK(minval[1] == 0.0f);
+    CHECK(maxval[1] == 1.0f);
+    CHECK(minval[2] == 77.0f / 255.0f);
+    CHECK(maxval[2] == 77.0f / 255.0f);
+    CHECK(minval[3] == 206.0f / 255.0f);
+    CHECK(maxval[3] == 1.0f);
+  };
+
+  SECTION("Missing channels and NaNs")
+  {
+    ResourceFormat fmt;
+    fmt.type = ResourceFormatType::Regular;
+    fmt.compType = CompType::Float;
+    fmt.compCount = 1;
+    fmt.compByteWidth = 4;
+
+    std::vector<float> data(count);
+    for(size_t i = 0; i < count; i++)
+      data[i] = float(i) - 1000.0f;
+    data[5] = data[count - 1] = std::numeric_limits<float>::quiet_NaN();
+
+    float minval[4], maxval[4];
+    REQUIRE(CalcTextureMinMax(fmt, (const byte *)data.data(), count, minval, maxval));
+
+    CHECK(minval[0] == -1000.0f);
+    CHECK(maxval[0] == float(count - 2) - 1000.0f);
+    CHECK(minval[1] == 0.0f);
+    CHECK(maxval[1] == 0.0f);
+    CHECK(minval[3] == 1.0f);
+    CHECK(maxval[3] == 1.0f);
+  };
+
+  SECTION("Histogram")
+  {
+    ResourceFormat fmt;
+    fmt.type = ResourceFormatType::Regular;
+    fmt.compType = CompType::Float;
+    fmt.compCount = 2;
+    fmt.compByteWidth = 4;
+
+    std::vector<float> data(count * 2);
+    for(size_t i = 0; i < count; i++)
+    {
+      data[i * 2 + 0] = float(i % 1000) / 500.0f - 0.5f;
+      data[i * 2 + 1] = float(i % 7) / 7.0f;
+    }
+    data[2] = std::numeric_limits<float>::quiet_NaN();
+
+    const float minval = 0.0f, maxval = 1.0f;
+
+    for(int mask = 1; mask < 4; mask++)
+    {
+      const bool channels[4] = {(mask & 1) != 0, (mask & 2) != 0, false, true};
+
+      std::vector<uint32_t> expected(256);
+      for(size_t i = 0; i < count; i++)
+      {
+        for(int c = 0; c < 4; c++)
+        {
+          float v = c < 2 ? data[i * 2 + c] : (c == 3 ? 1.0f : 0.0f);
+          float norm = (v - minval) / (maxval - minval);
+          if(channels[c] && norm >= 0.0f && norm * 256.0f < 256.0f)
+            expected[uint32_t(floorf(norm * 256.0f))]++;
+        }
+      }
+
+      std::vector<uint32_t> histogram;
+      REQUIRE(CalcTextureHistogram(fmt, (const byte *)data.data(), count, minval, maxval, channels,
+                                   histogram));
+
+      INFO("Channel mask " << mask);
+      CHECK((histogram == expected));
+    }
+
+    std::vector<uint32_t> histogram;
+    const bool channels[4] = {true, true, true, true};
+    CHECK_FALSE(CalcTextureHistogram(fmt, (const byte *)data.data(), count, 1.0f, 1.0f, channels,
+                                     histogram));
+
+    fmt.type = ResourceFormatType::BC1;
+    CHECK_FALSE(CalcTextureHistogram(fmt, (const byte *)data.data(), count, minval, maxval,
+                                     channels, histogram));
+  };
+
+  SECTION("sRGB alpha is linear")
+  {
+    ResourceFormat fmt;
+    fmt.type = ResourceFormatType::Regular;
+    fmt.compType = CompType::UNormSRGB;
+    fmt.compCount = 4;
+    fmt.compByteWidth = 1;
+
+    bytebuf data;
+    data.resize(count * 4);
+    for(size_t i = 0; i < count; i++)
+    {
+      data[i * 4 + 0] = 64;
+      data[i * 4 + 1] = 128;
+      data[i * 4 + 2] = 192;
+      data[i * 4 + 3] = byte(32 + (i % 64));
+    }
+
+    float minval[4], maxval[4];
+    REQUIRE(CalcTextureMinMax(fmt, data.data(), count, minval, maxval));
+
+    CHECK(minval[0] == SRGB8_lookuptable[64]);
+    CHECK(maxval[2] == SRGB8_lookuptable[192]);
+    CHECK(minval[3] == 32.0f / 255.0f);
+    CHECK(maxval[3] == 95.0f / 255.0f);
+
+    // the public entry points give the same results, working out the texel count from the data
+    rdcpair<PixelValue, PixelValue> minmax;
+    RENDERDOC_CalcTextureMinMax(fmt, data, &minmax);
+
+    CHECK(minmax.first.floatValue[0] == minval[0]);
+    CHECK(minmax.first.floatValue[3] == minval[3]);
+    CHECK(minmax.second.floatValue[3] == maxval[3]);
+
+    bool channels[4] = {false, false, false, true};
+    rdcarray<uint32_t> histogram;
+    RENDERDOC_CalcTextureHistogram(fmt, data, 0.0f, 1.0f, channels, &histogram);
+
+    REQUIRE(histogram.size() == 256);
+    // every alpha value lands in its own bucket, spread evenly
+    CHECK(histogram[32] == count / 64);
+    CHECK(histogram[95] == count / 64);
+    CHECK(histogram[0] == 0);
+
+    fmt.type = ResourceFormatType::BC1;
+    RENDERDOC_CalcTextureMinMax(fmt, data, &minmax);
+    CHECK(minmax.first.floatValue[0] == 0.0f);
+    CHECK(minmax.second.floatValue[0] == 1.0f);
+    RENDERDOC_CalcTextureHistogram(fmt, data, 0.0f, 1.0f, channels, &histogram);
+    CHECK(histogram.empty());
+  };
+};
+
+TEST_CASE("CPU pixel picking from texture data", "[pick]")
+{
+  const uint32_t width = 5, height = 3;
+
+  rdcarray<uint32_t> coords = {0, 0, 4, 2, 2, 1, 5, 0, 0, 3};
+
+  SECTION("RGBA8 UNorm")
+  {
+    ResourceFormat fmt;
+    fmt.type = ResourceFormatType::Regular;
+    fmt.compType = CompType::UNorm;
+    fmt.compCount = 4;
+    fmt.compByteWidth = 1;
+
+    std::vector<byte> data(width * height * 4);
+    for(uint32_t i = 0; i < width * height; i++)
+    {
+      data[i * 4 + 0] = byte(i);
+      data[i * 4 + 1] = byte(i * 10);
+      data[i * 4 + 2] = 255;
+      data[i * 4 + 3] = 0;
+    }
+
+    rdcarray<PixelValue> pixels;
+    REQUIRE(DecodePickedPixels(fmt, data.data(), width, height, coords, pixels));
+    REQUIRE(pixels.size() == 5);
+
+    CHECK(pixels[0].floatValue[0] == 0.0f);
+    CHECK(pixels[0].floatValue[2] == 1.0f);
+
+    CHECK(pixels[1].floatValue[0] == 14.0f / 255.0f);
+    CHECK(pixels[1].floatValue[1] == 140.0f / 255.0f);
+    CHECK(pixels[1].floatValue[3] == 0.0f);
+
+    CHECK(pixels[2].floatValue[0] == 7.0f / 255.0f);
+
+    // out of range coordinates come back as zero
+    for(int i = 3; i < 5; i++)
+    {
+      CHECK(pixels[i].floatValue[0] == 0.0f);
+      CHECK(pixels[i].floatValue[2] == 0.0f);
+    }
+  };
+
+  SECTION("R32 UInt is exact")
+  {
+    ResourceFormat fmt;
+    fmt.type = ResourceFormatType::Regular;
+    fmt.compType = CompType::UInt;
+    fmt.compCount = 1;
+    fmt.compByteWidth = 4;
+
+    std::vector<uint32_t> data(width * height);
+    for(uint32_t i = 0; i < width * height; i++)
+      data[i] = 0xfffffff0U + i;
+
+    rdcarray<PixelValue> pixels;
+    REQUIRE(DecodePickedPixels(fmt, (const byte *)data.data(), width, height, coords, pixels));
+    REQUIRE(pixels.size() == 5);
+
+    CHECK(pixels[0].uintValue[0] == 0xfffffff0U);
+    CHECK(pixels[1].uintValue[0] == 0xfffffffeU);
+    CHECK(pixels[2].uintValue[0] == 0xfffffff7U);
+    CHECK(pixels[2].uintValue[1] == 0);
+    CHECK(pixels[2].uintValue[3] == 1);
+    CHECK(pixels[3].uintValue[0] == 0);
+  };
+
+  SECTION("R16 SInt is sign extended")
+  {
+    ResourceFormat fmt;
+    fmt.type = ResourceFormatType::Regular;
+    fmt.compType = CompType::SInt;
+    fmt.compCount = 1;
+    fmt.compByteWidth = 2;
+
+    std::vector<int16_t> data(width * height, -1234);
+
+    rdcarray<PixelValue> pixels;
+    REQUIRE(DecodePickedPixels(fmt, (const byte *)data.data(), width, height, coords, pixels));
+
+    CHECK(pixels[0].intValue[0] == -1234);
+    CHECK(pixels[1].intValue[0] == -1234);
+  };
+
+  SECTION("sRGB alpha is linear")
+  {
+    ResourceFormat fmt;
+    fmt.type = ResourceFormatType::Regular;
+    fmt.compType = CompType::UNormSRGB;
+    fmt.compCount = 4;
+    fmt.compByteWidth = 1;
+    fmt.SetBGRAOrder(true);
+
+    std::vector<byte> data(width * height * 4);
+    for(uint32_t i = 0; i < width * height; i++)
+    {
+      data[i * 4 + 0] = 200;
+      data[i * 4 + 1] = 100;
+      data[i * 4 + 2] = 50;
+      data[i * 4 + 3] = byte(i * 16);
+    }
+
+    rdcarray<PixelValue> pixels;
+    REQUIRE(DecodePickedPixels(fmt, data.data(), width, height, coords, pixels));
+
+    CHECK(pixels[1].floatValue[0] == SRGB8_lookuptable[50]);
+    CHECK(pixels[1].floatValue[1] == SRGB8_lookuptable[100]);
+    CHECK(pixels[1].floatValue[2] == SRGB8_lookuptable[200]);
+    CHECK(pixels[1].floatValue[3] == 224.0f / 255.0f);
+    CHECK(pixels[2].floatValue[3] == 112.0f / 255.0f);
+  };
+
+  SECTION("Block compressed formats are declined")
+  {
+    ResourceFormat fmt;
+    fmt.type = ResourceFormatType::BC1;
+
+    std::vector<byte> data(64);
+    rdcarray<PixelValue> pixels;
+    CHECK_FALSE(DecodePickedPixels(fmt, data.data(), 4, 4, coords, pixels));
+  };
+
+  SECTION("Readback is only used when it's cheaper than picking")
+  {
+    TextureDescription tex;
+    tex.dimension = 2;
+    tex.width = 1024;
+    tex.height = 1024;
+    tex.depth = 1;
+    tex.format.type = ResourceFormatType::Regular;
+    tex.format.compType = CompType::UNorm;
+    tex.format.compCount = 4;
+    tex.format.compByteWidth = 1;
+
+    Subresource sub;
+
+    // a 4MB subresource isn't worth reading back for a handful of pixels
+    CHECK_FALSE(ShouldPickPixelsFromTextureData(tex, sub, 8, false));
+    CHECK(ShouldPickPixelsFromTextureData(tex, sub, 4096, false));
+
+    // but a small mip is, even for a couple of pixels
+    sub.mip = 6;
+    CHECK(ShouldPickPixelsFromTextureData(tex, sub, 2, false));
+
+    // a remote readback has to go over the network too, so needs more picks to pay off
+    sub.mip = 0;
+    size_t localPicks = 1, remotePicks = 1;
+    while(!ShouldPickPixelsFromTextureData(tex, sub, localPicks, false))
+      localPicks *= 2;
+    while(!ShouldPickPixelsFromTextureData(tex, sub, remotePicks, true))
+      remotePicks *= 2;
+    CHECK(remotePicks > localPicks);
+
+    // 3D textures read back every slice in the mip
+    tex.dimension = 3;
+    tex.depth = 64;
+    CHECK_FALSE(ShouldPickPixelsFromTextureData(tex, sub, localPicks, false));
+  };
+};
+
+TEST_CASE("Batched mesh vertex decoding", "[meshdecode]")
+{
+  // enough vertices to span a few chunks
+  const uint32_t numVerts = 10000;
+
+  auto compare = [](const FloatVector &a, const FloatVector &b) {
+    return memcmp(&a, &b, sizeof(FloatVector)) == 0;
+  };
+
+  SECTION("Matches InterpretVertex")
+  {
+    rdcarray<ResourceFormat> formats;
+
+    ResourceFormat fmt;
+    fmt.type = ResourceFormatType::Regular;
+
+    for(CompType compType : {CompType::Float, CompType::UNorm, CompType::SNorm, CompType::UInt,
+                             CompType::SInt})
+    {
+      for(uint8_t width : {1, 2, 4})
+      {
+        // no 8- or 16-bit floats, or 32-bit normalised values
+        if(compType == CompType::Float && width == 1)
+          continue;
+        if((compType == CompType::UNorm || compType == CompType::SNorm) && width == 4)
+          continue;
+
+        fmt.compType = compType;
+        fmt.compByteWidth = width;
+
+        for(uint8_t comps = 1; comps <= 4; comps++)
+        {
+          fmt.compCount = comps;
+          formats.push_back(fmt);
+        }
+      }
+    }
+
+    fmt.compType = CompType::UNorm;
+    fmt.compByteWidth = 1;
+    fmt.compCount = 4;
+    fmt.SetBGRAOrder(true);
+    formats.push_back(fmt);
+
+    fmt = ResourceFormat();
+    fmt.type = ResourceFormatType::R10G10B10A2;
+    fmt.compType = CompType::UNorm;
+    fmt.compCount = 4;
+    formats.push_back(fmt);
+    fmt.compType = CompType::UInt;
+    formats.push_back(fmt);
+
+    fmt.type = ResourceFormatType::R11G11B10;
+    fmt.compType = CompType::Float;
+    fmt.compCount = 3;
+    formats.push_back(fmt);
+
+    for(const ResourceFormat &f : formats)
+    {
+      MeshFormat mesh;
+      mesh.format = f;
+      mesh.vertexByteStride = 20;
+
+      // pseudo-random data, but avoid NaNs which won't compare equal
+      bytebuf vb;
+      vb.resize(numVerts * mesh.vertexByteStride);
+      uint32_t seed = 12345;
+      for(size_t i = 0; i < vb.size(); i++)
+      {
+        seed = seed * 1103515245 + 12345;
+        vb[i] = byte((seed >> 16) & 0x3f);
+      }
+
+      std::vector<FloatVector> decoded(numVerts);
+      rdcarray<bool> valid;
+      valid.resize(numVerts);
+      DecodeMeshVertices(mesh, NULL, 0, vb.data(), vb.size(), 0, numVerts, decoded.data(),
+                         valid.data());
+
+      uint32_t mismatches = 0;
+      for(uint32_t v = 0; v < numVerts; v++)
+      {
+        bool expectedValid = true;
+        FloatVector expected = HighlightCache::InterpretVertex(
+            vb.data(), v, mesh.vertexByteStride, f, vb.data() + vb.size(), expectedValid);
+
+        if(!compare(expected, decoded[v]) || !valid[v])
+          mismatches++;
+      }
+
+      INFO("Format " << f.Name().c_str());
+      CHECK(mismatches == 0);
+    }
+  };
+
+  MeshFormat mesh;
+  mesh.format.type = ResourceFormatType::Regular;
+  mesh.format.compType = CompType::Float;
+  mesh.format.compByteWidth = 4;
+  mesh.format.compCount = 3;
+  mesh.vertexByteStride = 16;
+  mesh.topology = Topology::TriangleStrip;
+
+  std::vector<float> vertices(numVerts * 4);
+  for(uint32_t v = 0; v < numVerts; v++)
+  {
+    vertices[v * 4 + 0] = float(v);
+    vertices[v * 4 + 1] = float(v) * 2.0f;
+    vertices[v * 4 + 2] = -float(v);
+    vertices[v * 4 + 3] = 99.0f;
+  }
+
+  const byte *vb = (const byte *)vertices.data();
+  const size_t vbSize = vertices.size() * sizeof(float);
+
+  SECTION("Indices, base vertex and restart")
+  {
+    std::vector<uint16_t> indices = {5, 6, 7, 0xffff, 7, 8, 9, 1, 20000};
+
+    mesh.indexByteStride = 2;
+    mesh.baseVertex = 100;
+    // one more than actually present
+    mesh.numIndices = uint32_t(indices.size() + 1);
+
+    FloatVector out[11];
+    bool valid[11];
+    DecodeMeshVertices(mesh, (const byte *)indices.data(), indices.size() * 2, vb, vbSize, 0, 11,
+                       out, valid);
+
+    CHECK(valid[0]);
+    CHECK(compare(out[0], FloatVector(105.0f, 210.0f, -105.0f, 1.0f)));
+    CHECK(compare(out[2], FloatVector(107.0f, 214.0f, -107.0f, 1.0f)));
+
+    // restart index
+    CHECK_FALSE(valid[3]);
+    CHECK(compare(out[3], FloatVector(0.0f, 0.0f, 0.0f, 1.0f)));
+
+    CHECK(valid[7]);
+    CHECK(compare(out[7], FloatVector(101.0f, 202.0f, -101.0f, 1.0f)));
+
+    // past the end of the vertex buffer, then past the end of the index buffer
+    CHECK_FALSE(valid[8]);
+    CHECK_FALSE(valid[9]);
+    CHECK_FALSE(valid[10]);
+
+    // without restart enabled, 0xffff is just a vertex past the end and the base vertex is
+    // subtracted from the rest
+    mesh.allowRestart = false;
+    mesh.baseVertex = -6;
+    DecodeMeshVertices(mesh, (const byte *)indices.data(), indices.size() * 2, vb, vbSize, 0, 8,
+                       out, valid);
+
+    CHECK(valid[0]);
+    CHECK(compare(out[0], FloatVector(0.0f, 0.0f, -0.0f, 1.0f)));
+    CHECK(compare(out[1], FloatVector(0.0f, 0.0f, -0.0f, 1.0f)));
+    CHECK(compare(out[2], FloatVector(1.0f, 2.0f, -1.0f, 1.0f)));
+    CHECK_FALSE(valid[3]);
+  };
+
+  SECTION("Patched line strip indices")
+  {
+    DrawcallDescription draw;
+    draw.topology = Topology::TriangleList;
+    draw.numIndices = 6;
+
+    uint32_t idx32[] = {10, 11, 12, 13, 14, 15};
+
+    std::vector<uint32_t> patched;
+    PatchLineStripIndexBuffer(&draw, NULL, NULL, idx32, patched);
+    REQUIRE(patched.size() == 10);
+
+    mesh.indexByteStride = 4;
+    mesh.baseVertex = 0;
+    mesh.topology = Topology::LineStrip;
+    mesh.numIndices = uint32_t(patched.size());
+
+    std::vector<float> x(10), y(10), z(10), w(10);
+    bool valid[10];
+    DecodeMeshVertices(mesh, (const byte *)patched.data(), patched.size() * sizeof(uint32_t), vb,
+                       vbSize, 0, 10, x.data(), y.data(), z.data(), w.data(), valid);
+
+    CHECK((x == std::vector<float>({10.0f, 11.0f, 12.0f, 10.0f, 0.0f, 13.0f, 14.0f, 15.0f, 13.0f,
+                                    0.0f})));
+    CHECK(y[1] == 22.0f);
+    CHECK(z[5] == -13.0f);
+    CHECK(w[0] == 1.0f);
+    CHECK(w[4] == 1.0f);
+    CHECK_FALSE(valid[4]);
+    CHECK_FALSE(valid[9]);
+    CHECK(valid[8]);
+  };
+
+  SECTION("Separate components match interleaved")
+  {
+    mesh.format.compType = CompType::UNorm;
+    mesh.format.compByteWidth = 2;
+    mesh.format.compCount = 4;
+
+    // start part way through and end with a partial chunk and a partial group of 4
+    const uint32_t first = 123, count = numVerts - first - 2;
+
+    std::vector<FloatVector> interleaved(count);
+    DecodeMeshVertices(mesh, NULL, 0, vb, vbSize, first, count, interleaved.data(), NULL);
+
+    std::vector<float> x(count), y(count), z(count), w(count);
+    DecodeMeshVertices(mesh, NULL, 0, vb, vbSize, first, count, x.data(), y.data(), z.data(),
+                       w.data(), NULL);
+
+    uint32_t mismatches = 0;
+    for(uint32_t i = 0; i < count; i++)
+    {
+      if(!compare(interleaved[i], FloatVector(x[i], y[i], z[i], w[i])))
+        mismatches++;
+    }
+
+    CHECK(mismatches == 0);
+    CHECK(interleaved[0].x == float(vb[first * 16 + 0] | vb[first * 16 + 1] << 8) / 65535.0f);
+  };
+
+  SECTION("Public entry point applies buffer offsets")
+  {
+    std::vector<uint32_t> indices = {0xcccccccc, 3, 4, 0xffffffff, 5};
+
+    mesh.indexByteStride = 4;
+    mesh.indexByteOffset = 4;
+    mesh.numIndices = 4;
+    mesh.vertexByteOffset = 16 * 10;
+
+    bytebuf ib, vbuf;
+    ib.assign((const byte *)indices.data(), indices.size() * sizeof(uint32_t));
+    vbuf.assign(vb, vbSize);
+
+    rdcarray<FloatVector> positions;
+    RENDERDOC_DecodeMeshVertices(mesh, ib, vbuf, 0, 5, &positions);
+
+    REQUIRE(positions.size() == 5);
+    CHECK(compare(positions[0], FloatVector(13.0f, 26.0f, -13.0f, 1.0f)));
+    CHECK(compare(positions[2], FloatVector(0.0f, 0.0f, 0.0f, 1.0f)));
+    CHECK(compare(positions[3], FloatVector(15.0f, 30.0f, -15.0f, 1.0f)));
+    // past the mesh's index count
+    CHECK(compare(positions[4], FloatVector(0.0f, 0.0f, 0.0f, 1.0f)));
+
+    mesh.indexByteStride = 0;
+    mesh.vertexByteOffset = vbSize + 16;
+    RENDERDOC_DecodeMeshVertices(mesh, bytebuf(), vbuf, 0, 2, &positions);
+
+    CHECK(compare(positions[0], FloatVector(0.0f, 0.0f, 0.0f, 1.0f)));
+    CHECK(compare(positions[1], FloatVector(0.0f, 0.0f, 0.0f, 1.0f)));
+  };
+};
+
+#endif    // ENABLED(ENABLE_UNIT_TESTS)
@@ -195,6 +195,8 @@ public:
                             float maxval, bool channels[4], std::vector<uint32_t> &histogram) = 0;
   virtual void PickPixel(ResourceId texture, uint32_t x, uint32_t y, const Subresource &sub,
                          CompType typeCast, float pixel[4]) = 0;
+  virtual rdcarray<PixelValue> PickPixels(ResourceId texture, const rdcarray<uint32_t> &coords,
+                                          const Subresource &sub, CompType typeCast) = 0;
 
   virtual ResourceId CreateProxyTexture(const TextureDescription &templateTex) = 0;
   virtual void SetProxyTextureData(ResourceId texid, const Subresource &sub, byte *data,
@@ -237,12 +239,89 @@ void PatchTriangleFanRestartIndexBufer(std::vector<uint32_t> &patchedIndices, ui
 
 uint64_t CalcMeshOutputSize(uint64_t curSize, uint64_t requiredOutput);
 
+// CPU implementations of GetMinMax and GetHistogram, over count tightly packed texels of fmt. They
+// give the same results as the GPU implementations and can be used directly on texture data that
+// isn't in a replay, e.g. from a DDS file. Returns false if the format can't be decoded.
+bool CalcTextureMinMax(const ResourceFormat &fmt, const byte *data, size_t count, float *minval,
+                       float *maxval);
+bool CalcTextureHistogram(const ResourceFormat &fmt, const byte *data, size_t count, float minval,
+                          float maxval, const bool channels[4], std::vector<uint32_t> &histogram);
+// the size in bytes of each texel in the data passed to the functions above, or 0 if the format
+// isn't supported.
+size_t GetTextureStatsStride(const ResourceFormat &fmt);
+
+// drivers can call these from GetMinMax/GetHistogram to read the subresource back and process it
+// on the CPU instead, for when that's faster than running the compute shaders. They return false
+// if the texture must go through the GPU path - multisampled, depth or block compressed formats.
+bool GetMinMaxFromTextureData(IRemoteDriver *driver, ResourceId texid, const Subresource &sub,
+                              CompType typeCast, float *minval, float *maxval);
+bool GetHistogramFromTextureData(IRemoteDriver *driver, ResourceId texid, const Subresource &sub,
+                                 CompType typeCast, float minval, float maxval,
+                                 const bool channels[4], std::vector<uint32_t> &histogram);
+
+// decodes the texels at pairs of x, y co-ordinates from tightly packed data the same way PickPixel
+// returns them - integer formats as integers and anything else as floats. Co-ordinates outside of
+// the data give zeroes. Returns false if the format can't be decoded.
+bool DecodePickedPixels(const ResourceFormat &fmt, const byte *data, uint32_t width,
+                        uint32_t height, const rdcarray<uint32_t> &coords,
+                        rdcarray<PixelValue> &pixels);
+
+// whether one readback of the subresource is expected to be cheaper than picking numPicks pixels
+// one at a time through the API, weighing the bytes read back against the round trips saved.
+bool ShouldPickPixelsFromTextureData(const TextureDescription &tex, const Subresource &sub,
+                                     size_t numPicks, bool remote);
+
+// picks many pixels with one readback of the subresource, for texture types the CPU can decode
+bool PickPixelsFromTextureData(IRemoteDriver *driver, ResourceId texid,
+                               const rdcarray<uint32_t> &coords, const Subresource &sub,
+                               CompType typeCast, rdcarray<PixelValue> &pixels);
+
+// drivers can implement PickPixels with this. It uses one readback of the subresource when that's
+// cheaper and the format can be decoded, and otherwise calls PickPixel for each pair of
+// co-ordinates. readbackAllowed should be false if the API returns texture data bottom-up.
+rdcarray<PixelValue> StandardPickPixels(IReplayDriver *driver, ResourceId texid,
+                                        const rdcarray<uint32_t> &coords, const Subresource &sub,
+                                        CompType typeCast, bool readbackAllowed);
+
+// decodes the positions of count vertices in a mesh starting at first in one pass, to the same
+// values HighlightCache::InterpretVertex gives. indexData and vertexData begin at the mesh's index
+// and vertex byte offsets. For indexed meshes first and count are in indices and the base vertex is
+// applied, so the output of PatchLineStripIndexBuffer can be passed directly as 4-byte indices.
+// Primitive restarts and reads past the end of either buffer give (0, 0, 0, 1) and are marked as
+// invalid, if valid is non-NULL.
+void DecodeMeshVertices(const MeshFormat &fmt, const byte *indexData, size_t indexDataSize,
+                        const byte *vertexData, size_t vertexDataSize, uint32_t first,
+                        uint32_t count, FloatVector *out, bool *valid);
+// as above, but with each component written to its own array
+void DecodeMeshVertices(const MeshFormat &fmt, const byte *indexData, size_t indexDataSize,
+                        const byte *vertexData, size_t vertexDataSize, uint32_t first,
+                        uint32_t count, float *x, float *y, float *z, float *w, bool *valid);
+
 void StandardFillCBufferVariable(ResourceId shader, const ShaderVariableDescriptor &desc,
                                  uint32_t dataOffset, const bytebuf &data, ShaderVariable &outvar,
                                  uint32_t matStride);
 void StandardFillCBufferVariables(ResourceId shader, const rdcarray<ShaderConstant> &invars,
                                   rdcarray<ShaderVariable> &outvars, const bytebuf &data);
 
+// appends states to a shader debug trace one at a time, storing only the variables that changed
+// since the previous state plus a full keyframe every so often to bound reconstruction cost.
+class ShaderDebugStateEncoder
+{
+public:
+  ShaderDebugStateEncoder(ShaderDebugTrace &trace, int32_t keyframeInterval = 64)
+      : m_Trace(trace), m_KeyframeInterval(keyframeInterval)
+  {
+  }
+
+  void AddState(const ShaderDebugState &state);
+
+private:
+  ShaderDebugTrace &m_Trace;
+  ShaderDebugState m_Prev;
+  int32_t m_KeyframeInterval;
+  int32_t m_SinceKeyframe = 0;
+};
+
 // simple cache for when we need buffer data for highlighting
 // vertices, typical use will be lots of vertices in the same
 // mesh, not jumping back and forth much between meshes.
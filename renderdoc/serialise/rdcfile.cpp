@@ -229,6 +229,9 @@ RDCFile::~RDCFile()
 
   if(m_Thumb.pixels)
     delete[] m_Thumb.pixels;
+
+  for(RDCThumb &thumb : m_ScaledThumbs)
+    delete[] thumb.pixels;
 }
 
 void RDCFile::Open(const char *path)
@@ -613,6 +616,43 @@ void RDCFile::Init(StreamReader &reader)
       delete thumbReader;
     }
   }
+
+  index = SectionIndex(SectionType::ScaledThumbnails);
+  if(index >= 0)
+  {
+    StreamReader *thumbReader = ReadSection(index);
+
+    // this section is small and stored uncompressed, so this is a single read
+    uint32_t count = 0;
+    if(thumbReader && thumbReader->Read(count) && count <= 16)
+    {
+      for(uint32_t i = 0; i < count; i++)
+      {
+        ExtThumbnailHeader thumbHeader;
+        if(!thumbReader->Read(thumbHeader) || thumbHeader.len > 10 * 1024 * 1024 ||
+           (uint32_t)thumbHeader.format >= (uint32_t)FileType::Count)
+          break;
+
+        thumbData = new byte[thumbHeader.len];
+        if(!thumbReader->Read(thumbData, thumbHeader.len) || thumbReader->IsErrored())
+        {
+          delete[] thumbData;
+          break;
+        }
+
+        RDCThumb thumb;
+        thumb.width = thumbHeader.width;
+        thumb.height = thumbHeader.height;
+        thumb.len = thumbHeader.len;
+        thumb.format = thumbHeader.format;
+        thumb.pixels = thumbData;
+        m_ScaledThumbs.push_back(thumb);
+      }
+      thumbData = NULL;
+    }
+
+    delete thumbReader;
+  }
 }
 
 bool RDCFile::CopyFileTo(const char *filename)
@@ -655,6 +695,22 @@ void RDCFile::SetData(RDCDriver driver, const char *driverName, uint64_t machine
   }
 }
 
+void RDCFile::SetScaledThumbnails(const std::vector<RDCThumb> &thumbs)
+{
+  for(RDCThumb &thumb : m_ScaledThumbs)
+    delete[] thumb.pixels;
+
+  m_ScaledThumbs = thumbs;
+
+  for(RDCThumb &thumb : m_ScaledThumbs)
+  {
+    byte *pixels = new byte[thumb.len];
+    memcpy(pixels, thumb.pixels, thumb.len);
+
+    thumb.pixels = pixels;
+  }
+}
+
 void RDCFile::Create(const char *filename)
 {
   m_File = FileIO::fopen(filename, "wb");
@@ -55,6 +55,9 @@ struct ExtThumbnailHeader
   FileType format;
 };
 
+// the ScaledThumbnails section is a uint32_t count, followed by that many thumbnails each stored as
+// an ExtThumbnailHeader and then its data, largest first.
+
 class RDCFile
 {
 public:
@@ -79,6 +82,8 @@ public:
   // Sets the parameters of an RDCFile in memory.
   void SetData(RDCDriver driver, const char *driverName, uint64_t machineIdent,
                const RDCThumb *thumb);
+  // Sets the pre-scaled copies of the thumbnail, to be written out as the ScaledThumbnails section.
+  void SetScaledThumbnails(const std::vector<RDCThumb> &thumbs);
 
   // creates a new file with current properties, file will be overwritten if it already exists
   void Create(const char *filename);
@@ -86,9 +91,11 @@ public:
   ContainerError ErrorCode() const { return m_Error; }
   std::string ErrorString() const { return m_ErrorString; }
   RDCDriver GetDriver() const { return m_Driver; }
+  const std::string &GetFilename() const { return m_Filename; }
   const std::string &GetDriverName() const { return m_DriverName; }
   uint64_t GetMachineIdent() const { return m_MachineIdent; }
   const RDCThumb &GetThumbnail() const { return m_Thumb; }
+  const std::vector<RDCThumb> &GetScaledThumbnails() const { return m_ScaledThumbs; }
   int SectionIndex(SectionType type) const;
   int SectionIndex(const char *name) const;
   int NumSections() const { return int(m_Sections.size()); }
@@ -115,6 +122,7 @@ private:
   std::string m_DriverName;
   uint64_t m_MachineIdent = 0;
   RDCThumb m_Thumb;
+  std::vector<RDCThumb> m_ScaledThumbs;
 
   ContainerError m_Error = ContainerError::NoError;
   std::string m_ErrorString;
@@ -26,7 +26,11 @@
 #include "renderdoccmd.h"
 #include <app/renderdoc_app.h>
 #include <replay/version.h>
+#include <algorithm>
+#include <atomic>
+#include <mutex>
 #include <string>
+#include <thread>
 
 // normally this is in the renderdoc core library, but it's needed for the 'unknown enum' path,
 // so we implement it here using ostringstream. It's not great, but this is a very uncommon path -
@@ -218,20 +222,64 @@ struct HelpCommand : public Command
   }
 };
 
+static bool WriteCaptureThumbnail(const std::string &filename, const std::string &outfile,
+                                  FileType type, uint32_t maxsize, std::string &error)
+{
+  bytebuf buf;
+
+  ICaptureFile *file = RENDERDOC_OpenCaptureFile();
+  ReplayStatus st = file->OpenFile(filename.c_str(), "rdc", NULL);
+  if(st == ReplayStatus::Succeeded)
+  {
+    buf = file->GetThumbnail(type, maxsize).data;
+  }
+  else
+  {
+    error = "Couldn't open '" + filename + "': " + ToStr(st).c_str();
+    file->Shutdown();
+    return false;
+  }
+  file->Shutdown();
+
+  if(buf.empty())
+  {
+    error = "Couldn't fetch the thumbnail in '" + filename + "'";
+    return false;
+  }
+
+  FILE *f = fopen(outfile.c_str(), "wb");
+
+  if(!f)
+  {
+    error = "Couldn't open destination file '" + outfile + "'";
+    return false;
+  }
+
+  fwrite(buf.data(), 1, buf.size(), f);
+  fclose(f);
+
+  return true;
+}
+
 struct ThumbCommand : public Command
 {
   ThumbCommand(const GlobalEnvironment &env) : Command(env) {}
   virtual void AddOptions(cmdline::parser &parser)
   {
-    parser.set_footer("<filename.rdc>");
-    parser.add<std::string>("out", 'o', "The output filename to save the file to", true,
-                            "filename.jpg");
+    parser.set_footer("<filename.rdc> [<filename2.rdc> ...]");
+    parser.add<std::string>("out", 'o',
+                            "The output filename to save the file to, or the output directory "
+                            "with --batch",
+                            true, "filename.jpg");
     parser.add<std::string>("format", 'f',
                             "The format of the output file. If empty, detected from filename",
                             false, "", cmdline::oneof<std::string>("jpg", "png", "bmp", "tga"));
     parser.add<uint32_t>(
         "max-size", 's',
         "The maximum dimension of the thumbnail. Default is 0, which is unlimited.", false, 0);
+    parser.add("batch", 'b',
+               "Process every capture given, in parallel. Each thumbnail is written to the output "
+               "directory named after its capture.");
   }
   virtual const char *Description() { return "Saves a capture's embedded thumbnail to disk."; }
   virtual bool IsInternalOnly() { return false; }
@@ -247,9 +295,20 @@ struct ThumbCommand : public Command
       return 0;
     }
 
-    std::string filename = rest[0];
+    const bool batch = parser.exist("batch");
 
-    rest.erase(rest.begin());
+    std::vector<std::string> filenames;
+
+    if(batch)
+    {
+      // in batch mode every remaining argument is a capture
+      filenames.swap(rest);
+    }
+    else
+    {
+      filenames.push_back(rest[0]);
+      rest.erase(rest.begin());
+    }
 
     RENDERDOC_InitGlobalEnv(m_Env, convertArgs(rest));
 
@@ -273,6 +332,10 @@ struct ThumbCommand : public Command
     {
       type = FileType::BMP;
     }
+    else if(batch)
+    {
+      format = "jpg";
+    }
     else
     {
       const char *dot = strrchr(outfile.c_str(), '.');
@@ -290,40 +353,68 @@ struct ThumbCommand : public Command
                   << std::endl;
     }
 
-    bytebuf buf;
-
-    ICaptureFile *file = RENDERDOC_OpenCaptureFile();
-    ReplayStatus st = file->OpenFile(filename.c_str(), "rdc", NULL);
-    if(st == ReplayStatus::Succeeded)
+    if(!batch)
     {
-      buf = file->GetThumbnail(type, maxsize).data;
-    }
-    else
-    {
-      std::cerr << "Couldn't open '" << filename << "': " << ToStr(st) << std::endl;
-    }
-    file->Shutdown();
+      std::string error;
+      if(WriteCaptureThumbnail(filenames[0], outfile, type, maxsize, error))
+        std::cout << "Wrote thumbnail from '" << filenames[0] << "' to '" << outfile << "'."
+                  << std::endl;
+      else
+        std::cerr << error << std::endl;
 
-    if(buf.empty())
-    {
-      std::cerr << "Couldn't fetch the thumbnail in '" << filename << "'" << std::endl;
+      return 0;
     }
-    else
-    {
-      FILE *f = fopen(outfile.c_str(), "wb");
 
-      if(!f)
-      {
-        std::cerr << "Couldn't open destination file '" << outfile << "'" << std::endl;
-      }
-      else
+    // each capture is independent, so hand them out to worker threads. Every worker opens its own
+    // capture files so there's nothing shared except the output stream.
+    std::atomic<size_t> next(0);
+    std::atomic<size_t> written(0);
+    std::mutex outputLock;
+
+    auto worker = [&]() {
+      for(size_t i = next++; i < filenames.size(); i = next++)
       {
-        fwrite(buf.data(), 1, buf.size(), f);
-        fclose(f);
+        const std::string &filename = filenames[i];
+
+        std::string basename = filename;
+        size_t slash = basename.find_last_of("/\\");
+        if(slash != std::string::npos)
+          basename.erase(0, slash + 1);
+        size_t dot = basename.find_last_of('.');
+        if(dot != std::string::npos && dot > 0)
+          basename.erase(dot);
+
+        std::string out = outfile + "/" + basename + "." + format;
+
+        std::string error;
+        bool success = WriteCaptureThumbnail(filename, out, type, maxsize, error);
 
-        std::cout << "Wrote thumbnail from '" << filename << "' to '" << outfile << "'." << std::endl;
+        std::lock_guard<std::mutex> lock(outputLock);
+        if(success)
+        {
+          written++;
+          std::cout << "Wrote thumbnail from '" << filename << "' to '" << out << "'." << std::endl;
+        }
+        else
+        {
+          std::cerr << error << std::endl;
+        }
       }
-    }
+    };
+
+    size_t numThreads = std::max(1U, std::thread::hardware_concurrency());
+    numThreads = std::min(numThreads, filenames.size());
+
+    std::vector<std::thread> threads;
+    for(size_t i = 1; i < numThreads; i++)
+      threads.push_back(std::thread(worker));
+
+    worker();
+
+    for(std::thread &t : threads)
+      t.join();
+
+    std::cout << "Wrote " << written << " of " << filenames.size() << " thumbnails." << std::endl;
 
     return 0;
   }